@@ -3,16 +3,18 @@
 #include <vector>
 #include <algorithm>
 #include <string>
-#include <memory>
+#include <cstdint>
+#include <cstring>
 
 #include <UDP_Prot.h>
 
 static const int DESPOT_PORT = 5678;
 
-static const bool saveEachTrialInSingleFile = true;
 static const char *TREE_FILE_NAME = "tree";
+static const char *TRACE_FILE_EXT = ".trace";
+static const char *INDEX_FILE_EXT = ".tidx";
 
-// for tree sending
+// for tree sending (same as TreeSender of solver)
 static int s_END_OF_SEND_TREE = -1;
 static int s_START_NEW_TRIAL = 1;
 static int s_START_NEW_STEP = 2;
@@ -20,99 +22,116 @@ static int s_END_RUNNING = 3;
 static int s_ERROR_READING = 4;
 
 static int s_numActions = -1;
-static const int s_numValsInNode = 4;
+static const int s_numValsInNode = 5;
+static const int s_numHeaderVals = 4;
+
+// frame header and payload idx
+static const int s_frameSeqIdx = 1;
+static const int s_chunkIdx = 2;
+static const int s_numChunksIdx = 3;
+static const int s_isKeyFrameIdx = 0;
+static const int s_rootIdIdx = 1;
+static const int s_stateSizeIdx = 2;
 
 static const int s_parentIdx = 0;
 static const int s_idIdx = 1;
 static const int s_valueIdx = 2;
 static const int s_countIdx = 3;
+static const int s_actionIdx = 4;
 
-class TreeNode
+/// nodes of the current tree stored in an array indexed by id.
+/// frames are applied in place and the children lists are rebuilt linearly after each frame
+/// (slot of node = id - base id, base id is the smallest id alive)
+class TreeStore
 {
 public:
-	using TreeNodePtr = std::shared_ptr<TreeNode>;
-	TreeNode(TreeNodePtr parent, float value, unsigned int count, unsigned int id)
-	: m_parent(parent), m_value(value), m_count(count), m_id(id), m_children()
-	{}
+	TreeStore() : m_nodes(), m_baseId(0), m_rootId(0), m_state(), m_childStart(), m_children() {}
 
-	~TreeNode() = default;
+	void Clear();
+	/// apply payload of frame (key frame replaces tree). return false if frame is not consistent with current tree
+	bool ApplyFrame(const unsigned int * payload, int size);
+	/// write tree of current step in text
+	void SaveTree(int step, std::ostream & out) const;
 
+	bool Empty() const { return !Exist(m_rootId); }
 
-	void AddChild(TreeNodePtr child) { m_children.emplace_back(child); };
-	/// preform function on root only
-	void SortActionsChilds() 
+private:
+	struct NodeRecord
 	{
-		// get curr node shared ptr
-		TreeNodePtr currNodePtr(GetNodePtr());
-		if (currNodePtr == nullptr)
-			return;
-
-		std::vector<int> childActionsId(s_numActions);
-		for (int i = 0; i < s_numActions; ++i)
-			childActionsId[i] = i + m_id + 1;
-
-		std::vector<TreeNodePtr> sorted;
-		for (int a = 0; a < s_numActions; ++a)
-		{
-			TreeNodePtr node = nullptr;
-			for (int n = 0; n < m_children.size(); ++n)
-			{
-				if (childActionsId[a] == m_children[n]->m_id)
-				{
-					node = m_children[n];
-					m_children.erase(m_children.begin() + n);
-					break;
-				}
-			}
-			if (node == nullptr)
-			{
-				TreeNodePtr newNode(new TreeNode(currNodePtr, 0, 0, childActionsId[a]));
-				node = newNode;
-			}
+		unsigned int m_parentId;
+		float m_value;
+		unsigned int m_count;
+		/// idx of action node in its belief node
+		unsigned int m_action;
+		bool m_exist;
+	};
+
+	bool Exist(unsigned int id) const { return id >= m_baseId && id - m_baseId < m_nodes.size() && m_nodes[id - m_baseId].m_exist; }
+	/// remove nodes unreachable from root, build children lists and rebase array
+	void Prune();
+	void SaveTreeRec(unsigned int id, int depth, std::ostream & out) const;
+	void SaveNode(unsigned int id, float value, unsigned int count, int depth, std::ostream & out) const;
+
+	std::vector<NodeRecord> m_nodes;
+	unsigned int m_baseId;
+	unsigned int m_rootId;
+	std::vector<unsigned int> m_state;
+
+	/// children ids of slot s are m_children[m_childStart[s]..m_childStart[s + 1]) (ordered by id)
+	std::vector<unsigned int> m_childStart;
+	std::vector<unsigned int> m_children;
+};
 
-			sorted.emplace_back(node);
-		}
+/// binary trace of received frames (frames are saved as received, deltas included).
+/// trace record : trial, step, num actions, payload size, payload
+/// index file is array of TraceIndexEntry so a step is found without reading the trace
+static const int s_numRecordHeaderVals = 4;
 
-		m_children = sorted;
-		// sort garndsons
-		for (auto child : m_children)
-		{
-			for (auto grandsons : child->m_children)
-				grandsons->SortActionsChilds();
-		}
-	}
+struct TraceIndexEntry
+{
+	uint32_t m_trial;
+	uint32_t m_step;
+	uint64_t m_offset;
+	/// entry idx of the key frame the frame is based on
+	uint64_t m_keyFrameEntry;
+};
 
-	int Depth() const
-	{
-		if (m_parent == nullptr)
-			return 0;
+class TraceWriter
+{
+public:
+	bool Open(const std::string & fName);
+	void Write(unsigned int trial, unsigned int step, const std::vector<unsigned int> & payload);
+
+private:
+	std::ofstream m_trace;
+	std::ofstream m_index;
+	uint64_t m_numEntries = 0;
+	uint64_t m_keyFrameEntry = 0;
+};
 
-		return m_parent->Depth() + 1;
-	}
+int ReadMSg(UDP_Client * sock, std::vector<unsigned int> * payload, unsigned int & frameSeq, std::vector<unsigned int> * trialDetails);
+int Record();
+int Replay(const std::string & fName, unsigned int trial, unsigned int step);
 
-	TreeNodePtr GetNodePtr()
+int main(int argc, char *argv[])
+{
+	// replay mode : TreeVisualizer replay <trial> <step> [trace name]
+	if (argc > 1 && std::string(argv[1]) == "replay")
 	{
-		if (m_children.size() == 0)
-			return nullptr;
+		if (argc < 4)
+		{
+			std::cerr << "usage: " << argv[0] << " replay <trial> <step> [trace name]\n";
+			exit(1);
+		}
 
-		return m_children[0]->m_parent;
+		std::string fName = argc > 4 ? argv[4] : TREE_FILE_NAME;
+		return Replay(fName, std::stoi(argv[2]), std::stoi(argv[3]));
 	}
- 
-	TreeNodePtr m_parent;
-	float m_value;
-	unsigned int m_count;
-	unsigned int m_id;
-	std::vector<TreeNodePtr> m_children;
-};
 
-int ReadMSg(UDP_Client * sock, std::vector<unsigned int> * treeVec, std::vector<unsigned int> * state);
-TreeNode::TreeNodePtr BuildTree(std::vector<unsigned int> & treeVec);
-TreeNode * SearchId(TreeNode *root, unsigned int id);
-void SaveTree(std::vector<unsigned int> & state, TreeNode::TreeNodePtr root, int step, std::ofstream & out);
-std::ofstream & operator<<(std::ofstream & out, TreeNode::TreeNodePtr node);
-void PrintTree(TreeNode::TreeNodePtr root);
+	return Record();
+}
 
-int main()
+int Record()
 {
 	UDP_Client sock;
 	if (!sock.Init(DESPOT_PORT))
@@ -123,45 +142,42 @@ int main()
 	}
 
 	sock.TimeOut(500);
-	std::ofstream out;
 	char c = 1;
 	sock.Write(&c, 1);
 	Sleep(1000);
 
-	if (saveEachTrialInSingleFile)
+	TraceWriter trace;
+	if (!trace.Open(TREE_FILE_NAME))
 	{
-		std::string fName = TREE_FILE_NAME;
-		fName += ".txt";
-		out.open(fName, std::ios::out);
+		std::cerr << "error in opening trace file\n";
+		exit(1);
 	}
+
 	std::vector<unsigned int> firstRead(2);
+	unsigned int frameSeq = 0;
 	
-	unsigned int Readstatus = ReadMSg(&sock, nullptr, &firstRead);
+	unsigned int Readstatus = ReadMSg(&sock, nullptr, frameSeq, &firstRead);
 	s_numActions = firstRead[0];
-	int numObjects = firstRead[1];
 
 	bool isRunning = Readstatus == s_START_NEW_TRIAL;
 	int trial = 0;
+	// buffer is reused between frames
+	std::vector<unsigned int> payload;
 	// run on all trials
 	std::cout << "reading msg...\n";
 	while (isRunning)
 	{
-		if (saveEachTrialInSingleFile)
-		{
-			out.close();
-			std::string treeFName(TREE_FILE_NAME);
-			treeFName += "_trial" + std::to_string(trial) + ".txt";
-			out.open(treeFName, std::ios::out);
-		}
-		out << "\n\n\ntrial num " << trial << ":\n\n\n";
 		// run on all steps
 		int step = 0;
+		TreeStore tree;
+		unsigned int lastFrameSeq = 0;
+		bool waitForKeyFrame = true;
 		while (1)
 		{
-			std::vector<unsigned int> treeVec;
-			std::vector<unsigned int> state(numObjects);
+			payload.clear();
+			std::vector<unsigned int> trialDetails(2);
 
-			int status = ReadMSg(&sock, &treeVec, &state);
+			int status = ReadMSg(&sock, &payload, frameSeq, &trialDetails);
 			if (status == s_END_RUNNING)
 			{
 				isRunning = false;
@@ -169,169 +185,373 @@ int main()
 			}
 			else if (status == s_START_NEW_TRIAL)		
 			{
-				s_numActions = state[0];
-				numObjects = state[1];
+				s_numActions = trialDetails[0];
 				break;
 			}
 			else if (status == s_ERROR_READING)
+			{
+				// part of frame is lost, deltas cannot be applied until next full tree
+				waitForKeyFrame = true;
 				continue;
+			}
 
-			std::cout << "finished reading msg\n";
-			TreeNode::TreeNodePtr root = BuildTree(treeVec);
-			std::cout << "finished parsing tree\n";
-			SaveTree(state, root, step, out);
-			std::cout << "save tree in file\n";
-			out.flush();
+			// frames were lost between last frame and current
+			if (frameSeq != lastFrameSeq + 1)
+				waitForKeyFrame = true;
+			lastFrameSeq = frameSeq;
+
+			if (payload.size() == 0)
+			{
+				waitForKeyFrame = true;
+				continue;
+			}
+
+			bool isKeyFrame = payload[s_isKeyFrameIdx] != 0;
+			if (waitForKeyFrame && !isKeyFrame)
+			{
+				std::cout << "frame " << frameSeq << " dropped (waiting for full tree)\n";
+				continue;
+			}
+			waitForKeyFrame = false;
+
+			if (!tree.ApplyFrame(payload.data(), payload.size()))
+			{
+				waitForKeyFrame = true;
+				continue;
+			}
+
+			trace.Write(trial, step, payload);
 			++step;
-			std::cout << "reading msg...\n";
 		}
+
+		std::cout << "trial " << trial << " saved " << step << " steps\n";
 		++trial;
 	}
 
 	return 0;
 }
 
-int ReadMSg(UDP_Client * sock, std::vector<unsigned int> * treeVec, std::vector<unsigned int> * state)
+int Replay(const std::string & fName, unsigned int trial, unsigned int step)
 {
-	// TODO : make this function more compatible if we watn to keep saving trees in file
-	static char buf[UDP_Server::s_BUF_LEN];
+	std::ifstream index(fName + INDEX_FILE_EXT, std::ios::binary);
+	std::ifstream trace(fName + TRACE_FILE_EXT, std::ios::binary);
+	if (!index.is_open() || !trace.is_open())
+	{
+		std::cerr << "error in opening trace " << fName << "\n";
+		exit(1);
+	}
 
-	unsigned int * ptr;
-	int maxToRead = UDP_Server::s_BUF_LEN + UDP_Server::s_BUF_LEN % sizeof (int);
-	int size = maxToRead;
-	
-	int startOfMsg;
-	int status;
-	bool readStatus = false;
-	bool readState = false;
+	index.seekg(0, std::ios::end);
+	uint64_t numEntries = index.tellg() / sizeof(TraceIndexEntry);
 
-	while (size == maxToRead)
+	auto readEntry = [&index](uint64_t idx)
 	{
-		size = sock->Read(buf);
-		if (size == -1)
-			return s_ERROR_READING;
+		TraceIndexEntry entry;
+		index.seekg(idx * sizeof(TraceIndexEntry));
+		index.read(reinterpret_cast<char *>(&entry), sizeof(entry));
+		return entry;
+	};
+
+	// entries are ordered by (trial, step)
+	uint64_t low = 0, high = numEntries;
+	while (low < high)
+	{
+		uint64_t mid = (low + high) / 2;
+		TraceIndexEntry entry = readEntry(mid);
+		if (entry.m_trial < trial || (entry.m_trial == trial && entry.m_step < step))
+			low = mid + 1;
+		else
+			high = mid;
+	}
 
-		int toInit = size / sizeof(int);
-		ptr = reinterpret_cast<unsigned int *>(buf);
+	TraceIndexEntry target = low < numEntries ? readEntry(low) : TraceIndexEntry{};
+	if (low == numEntries || target.m_trial != trial || target.m_step != step)
+	{
+		std::cerr << "step " << step << " of trial " << trial << " is not in trace\n";
+		exit(1);
+	}
 
-		// search for end of msg in middle message if fount return error in read
-		int *currPtr = reinterpret_cast<int *>(buf);
-		for (int i = 0; i < toInit - 1; ++i)
+	// apply frames from last key frame to requested step
+	TreeStore tree;
+	std::vector<unsigned int> payload;
+	for (uint64_t e = target.m_keyFrameEntry; e <= low; ++e)
+	{
+		TraceIndexEntry entry = readEntry(e);
+		unsigned int record[s_numRecordHeaderVals];
+		trace.seekg(entry.m_offset);
+		trace.read(reinterpret_cast<char *>(record), sizeof(record));
+		s_numActions = record[2];
+		payload.resize(record[3]);
+		trace.read(reinterpret_cast<char *>(payload.data()), payload.size() * sizeof(unsigned int));
+
+		// a record with empty payload is not a frame
+		if (!trace || payload.size() == 0 || !tree.ApplyFrame(payload.data(), payload.size()))
 		{
-			if (currPtr[i] == s_END_OF_SEND_TREE)
-				return s_ERROR_READING;
+			std::cerr << "trace is corrupted\n";
+			exit(1);
 		}
+	}
 
-		if (!readStatus)
-		{
-			status = *reinterpret_cast<int *>(ptr);
-			
-			if (status != s_START_NEW_STEP)
-			{
-				if (status != s_END_RUNNING)
-				{
-					int endOfTrialMsg = reinterpret_cast<int *>(ptr)[3];
-					if (endOfTrialMsg != s_END_OF_SEND_TREE)
-						return s_ERROR_READING;
-
-					(*state)[0] = ptr[1];
-					(*state)[1] = ptr[2];
-				}
-				return status;
-			}
-			readStatus = true;
-			++ptr;
-			--toInit;
-		}
+	tree.SaveTree(step, std::cout);
+	return 0;
+}
 
-		if (!readState)
+int ReadMSg(UDP_Client * sock, std::vector<unsigned int> * payload, unsigned int & frameSeq, std::vector<unsigned int> * trialDetails)
+{
+	static char buf[UDP_Server::s_BUF_LEN];
+
+	unsigned int expectedChunk = 0;
+	while (true)
+	{
+		int size = sock->Read(buf);
+		if (size == -1)
+			return s_ERROR_READING;
+
+		int toInit = size / sizeof(int);
+		unsigned int * ptr = reinterpret_cast<unsigned int *>(buf);
+		int status = ptr[0];
+
+		if (status != s_START_NEW_STEP)
 		{
-			for (int i = 0; i < state->size(); ++i)
+			if (status == s_START_NEW_TRIAL)
 			{
-				(*state)[i] = ptr[i];
+				int endOfTrialMsg = ptr[3];
+				if (endOfTrialMsg != s_END_OF_SEND_TREE)
+					return s_ERROR_READING;
+
+				(*trialDetails)[0] = ptr[1];
+				(*trialDetails)[1] = ptr[2];
 			}
-			readState = true;
-			ptr += state->size();
-			toInit -= state->size();
+			return status;
 		}
 
-		for (int i = 0; i < toInit; ++i)
-			treeVec->emplace_back(ptr[i]);
+		if (toInit < s_numHeaderVals)
+			return s_ERROR_READING;
+
+		// chunks of frame are arriving by order, missing chunk or chunk of other frame means a lost datagram
+		unsigned int chunk = ptr[s_chunkIdx];
+		if (chunk != expectedChunk || (chunk > 0 && ptr[s_frameSeqIdx] != frameSeq))
+			return s_ERROR_READING;
+
+		frameSeq = ptr[s_frameSeqIdx];
+		payload->insert(payload->end(), ptr + s_numHeaderVals, ptr + toInit);
+
+		if (chunk + 1 == ptr[s_numChunksIdx])
+			break;
+		++expectedChunk;
 	}
 
-	int endMsg = (*treeVec)[treeVec->size() - 1];
-	treeVec->pop_back();
+	int endMsg = payload->back();
+	payload->pop_back();
 	if (endMsg != s_END_OF_SEND_TREE)
-		status = s_ERROR_READING;
+		return s_ERROR_READING;
 
-	return status;
+	return s_START_NEW_STEP;
 }
 
+void TreeStore::Clear()
+{
+	m_nodes.clear();
+	m_baseId = 0;
+	m_rootId = 0;
+	m_childStart.clear();
+	m_children.clear();
+}
 
-TreeNode::TreeNodePtr BuildTree(std::vector<unsigned int> & treeVec)
+bool TreeStore::ApplyFrame(const unsigned int * payload, int size)
 {
-	
-	// read nodes
-	std::vector<std::pair<TreeNode::TreeNodePtr, int>> allNodes;
+	int stateStart = s_stateSizeIdx + 1;
+	if (size < stateStart)
+		return false;
+
+	unsigned int stateSize = payload[s_stateSizeIdx];
+	int numNodesIdx = stateStart + stateSize;
+	if (size <= numNodesIdx)
+		return false;
+
+	unsigned int numNodes = payload[numNodesIdx];
+	int numRemovedIdx = numNodesIdx + 1 + numNodes * s_numValsInNode;
+	if (size <= numRemovedIdx || size != numRemovedIdx + 1 + payload[numRemovedIdx])
+		return false;
 
-	int toRun = treeVec.size() - treeVec.size() % sizeof(int);
-	for (int i = 0; i < toRun; i += s_numValsInNode)
+	const unsigned int * nodesStart = payload + numNodesIdx + 1;
+	const unsigned int * nodesEnd = payload + numRemovedIdx;
+
+	if (payload[s_isKeyFrameIdx] != 0)
 	{
-		unsigned int parentId = treeVec[i + s_parentIdx];
-		unsigned int count = treeVec[i + s_countIdx];
-		unsigned int id = treeVec[i + s_idIdx];
-		float value = *reinterpret_cast<float *>(&treeVec[i + s_valueIdx]);
+		Clear();
+		m_baseId = 0xFFFFFFFF;
+		for (const unsigned int * node = nodesStart; node < nodesEnd; node += s_numValsInNode)
+			m_baseId = std::min(m_baseId, node[s_idIdx]);
+	}
 
-		TreeNode::TreeNodePtr node(new TreeNode(nullptr, value, count, id));
-		allNodes.emplace_back(node, parentId);
+	m_rootId = payload[s_rootIdIdx];
+	m_state.assign(payload + stateStart, payload + stateStart + stateSize);
+
+	for (const unsigned int * node = nodesStart; node < nodesEnd; node += s_numValsInNode)
+	{
+		unsigned int id = node[s_idIdx];
+		// ids of new nodes are always larger than ids of existing nodes
+		if (id < m_baseId)
+			return false;
+
+		unsigned int slot = id - m_baseId;
+		if (slot >= m_nodes.size())
+			m_nodes.resize(slot + 1, NodeRecord{ 0, 0.0, 0, 0, false });
+
+		NodeRecord & record = m_nodes[slot];
+		record.m_parentId = node[s_parentIdx];
+		std::memcpy(&record.m_value, &node[s_valueIdx], sizeof(record.m_value));
+		record.m_count = node[s_countIdx];
+		record.m_action = node[s_actionIdx];
+		record.m_exist = true;
 	}
 
-	TreeNode::TreeNodePtr root = nullptr;
+	// subtrees of removed nodes are not reachable anymore and dropped by Prune
+	for (const unsigned int * removed = nodesEnd + 1; removed < payload + size; ++removed)
+	{
+		if (Exist(*removed))
+			m_nodes[*removed - m_baseId].m_exist = false;
+	}
+
+	Prune();
+	return true;
+}
 
-	// create heirarchi
-	for (int parent = 0; parent < allNodes.size(); ++parent)
+void TreeStore::Prune()
+{
+	if (!Exist(m_rootId))
 	{
-		for (int child = 0; child < allNodes.size(); ++child)
-		{
-			// init parents & children
-			if (allNodes[child].second == allNodes[parent].first->m_id)
-			{
-				allNodes[child].first->m_parent = allNodes[parent].first;
-				allNodes[parent].first->AddChild(allNodes[child].first);
-			}
-		}
+		Clear();
+		return;
+	}
+
+	int numSlots = m_nodes.size();
+	// count children of each slot
+	m_childStart.assign(numSlots + 1, 0);
+	for (int s = 0; s < numSlots; ++s)
+	{
+		unsigned int id = s + m_baseId;
+		if (m_nodes[s].m_exist && id != m_rootId && Exist(m_nodes[s].m_parentId))
+			++m_childStart[m_nodes[s].m_parentId - m_baseId + 1];
+	}
+
+	for (int s = 0; s < numSlots; ++s)
+		m_childStart[s + 1] += m_childStart[s];
+
+	m_children.resize(m_childStart[numSlots]);
+	std::vector<unsigned int> fill(m_childStart.begin(), m_childStart.end() - 1);
+	for (int s = 0; s < numSlots; ++s)
+	{
+		unsigned int id = s + m_baseId;
+		if (m_nodes[s].m_exist && id != m_rootId && Exist(m_nodes[s].m_parentId))
+			m_children[fill[m_nodes[s].m_parentId - m_baseId]++] = id;
+	}
 
-		if (allNodes[parent].second == 0)
-			root = allNodes[parent].first;
+	// mark nodes reachable from root, nodes not reachable are not part of the tree anymore
+	std::vector<bool> reachable(numSlots, false);
+	std::vector<unsigned int> toVisit{ m_rootId };
+	while (toVisit.size() > 0)
+	{
+		unsigned int slot = toVisit.back() - m_baseId;
+		toVisit.pop_back();
+		reachable[slot] = true;
+		toVisit.insert(toVisit.end(), m_children.begin() + m_childStart[slot], m_children.begin() + m_childStart[slot + 1]);
 	}
 
-	root->SortActionsChilds();
+	int firstAlive = numSlots;
+	for (int s = 0; s < numSlots; ++s)
+	{
+		m_nodes[s].m_exist = reachable[s];
+		if (reachable[s] && firstAlive == numSlots)
+			firstAlive = s;
+	}
 
-	return root;
+	// rebase when most of the array is freed
+	if (firstAlive > numSlots / 2)
+	{
+		m_nodes.erase(m_nodes.begin(), m_nodes.begin() + firstAlive);
+		m_childStart.erase(m_childStart.begin(), m_childStart.begin() + firstAlive);
+		m_baseId += firstAlive;
+	}
 }
 
-void SaveTree(std::vector<unsigned int> & state, TreeNode::TreeNodePtr root, int step, std::ofstream & out)
+void TreeStore::SaveTree(int step, std::ostream & out) const
 {
 	out << "decision for step = " << step << " state = ";
-	for (auto loc : state)
+	for (auto loc : m_state)
 		out << loc << ", ";
 	
 	out << ":\n\n";
-	out << root;
+	if (!Empty())
+		SaveTreeRec(m_rootId, 0, out);
 	out << "\n\n\n";
 }
 
-std::ofstream & operator<<(std::ofstream & out, TreeNode::TreeNodePtr node)
+void TreeStore::SaveTreeRec(unsigned int id, int depth, std::ostream & out) const
 {
-	std::string prefix("");
-	int depth = node->Depth();
-	for (int i = 0; i < depth; ++i)
-		prefix += "\t";
+	const NodeRecord & node = m_nodes[id - m_baseId];
+	SaveNode(id, node.m_value, node.m_count, depth, out);
 
-	out << prefix << "id = " << node->m_id << " value = " << node->m_value << " count = " << node->m_count << "\n";
+	// children of belief node are its action nodes, ordered by action idx (actions without node are written as empty nodes with id 0)
+	std::vector<unsigned int> actionIds(std::max(s_numActions, 0), 0);
+	unsigned int slot = id - m_baseId;
+	for (unsigned int c = m_childStart[slot]; c < m_childStart[slot + 1]; ++c)
+	{
+		unsigned int action = m_nodes[m_children[c] - m_baseId].m_action;
+		if (action >= actionIds.size())
+			actionIds.resize(action + 1, 0);
+		actionIds[action] = m_children[c];
+	}
+
+	for (auto actionId : actionIds)
+	{
+		if (actionId == 0)
+		{
+			SaveNode(0, 0, 0, depth + 1, out);
+			continue;
+		}
+
+		const NodeRecord & action = m_nodes[actionId - m_baseId];
+		SaveNode(actionId, action.m_value, action.m_count, depth + 1, out);
 
-	for (auto node : node->m_children)
-		out << node;
+		unsigned int actionSlot = actionId - m_baseId;
+		for (unsigned int c = m_childStart[actionSlot]; c < m_childStart[actionSlot + 1]; ++c)
+			SaveTreeRec(m_children[c], depth + 2, out);
+	}
+}
 
-	return out;
+void TreeStore::SaveNode(unsigned int id, float value, unsigned int count, int depth, std::ostream & out) const
+{
+	std::string prefix(depth, '\t');
+	out << prefix << "id = " << id << " value = " << value << " count = " << count << "\n";
+}
+
+bool TraceWriter::Open(const std::string & fName)
+{
+	m_trace.open(fName + TRACE_FILE_EXT, std::ios::out | std::ios::binary);
+	m_index.open(fName + INDEX_FILE_EXT, std::ios::out | std::ios::binary);
+	return m_trace.is_open() && m_index.is_open();
+}
+
+void TraceWriter::Write(unsigned int trial, unsigned int step, const std::vector<unsigned int> & payload)
+{
+	if (payload[s_isKeyFrameIdx] != 0)
+		m_keyFrameEntry = m_numEntries;
+
+	TraceIndexEntry entry;
+	entry.m_trial = trial;
+	entry.m_step = step;
+	entry.m_offset = m_trace.tellp();
+	entry.m_keyFrameEntry = m_keyFrameEntry;
+
+	unsigned int record[s_numRecordHeaderVals] = { trial, step, static_cast<unsigned int>(s_numActions), static_cast<unsigned int>(payload.size()) };
+	m_trace.write(reinterpret_cast<const char *>(record), sizeof(record));
+	m_trace.write(reinterpret_cast<const char *>(&payload[0]), payload.size() * sizeof(unsigned int));
+	m_index.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+	++m_numEntries;
+
+	// index is flushed after trace so an entry always points to a complete record
+	m_trace.flush();
+	m_index.flush();
 }
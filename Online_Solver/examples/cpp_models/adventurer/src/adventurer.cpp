@@ -214,7 +214,7 @@ void Adventurer::PrintMDPPolicy() const {
 }
 
 State* Adventurer::CreateStartState(string type) const {
-	double prob = Random::RANDOM.NextDouble();
+	double prob = Random::s_threadRand.NextDouble();
 	int goal = 0;
 	double sum = 0;
 	for (; goal < num_goals_; goal++) {
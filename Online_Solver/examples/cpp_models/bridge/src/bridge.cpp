@@ -72,7 +72,7 @@ double Bridge::ObsProb(OBS_TYPE obs, const State& s, int a) const {
 }
 
 State* Bridge::CreateStartState(string type) const {
-	// return new BridgeState(Random::RANDOM.NextInt(2));
+	// return new BridgeState(Random::s_threadRand.NextInt(2));
 	return new BridgeState(0);	// Always start at the left end
 }
 
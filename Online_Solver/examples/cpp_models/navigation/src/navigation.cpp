@@ -219,7 +219,7 @@ void Navigation::PrintMDPPolicy() const {
 }
 
 State* Navigation::CreateStartState(string type) const {
-	// double prob = Random::RANDOM.NextDouble();
+	// double prob = Random::s_threadRand.NextDouble();
 	// return new NavigationState((prob <= 0.51) ? (xsize_ - 2) : 1);
 	return new NavigationState(0);
 }
@@ -24,7 +24,7 @@ void PocmanBelief::Update(int action, OBS_TYPE obs) {
 	int cur = 0, N = particles_.size(), trials = 0;
 	while (updated.size() < num_particles && trials < 10 * num_particles) {
 		State* particle = pocman_->Copy(particles_[cur]);
-		bool terminal = pocman_->Step(*particle, Random::RANDOM.NextDouble(),
+		bool terminal = pocman_->Step(*particle, Random::s_threadRand.NextDouble(),
 			action, reward, o);
 
 		if ((!terminal && o == obs)
@@ -165,7 +165,7 @@ public:
 			if (newpos.x >= 0 && newpos.y >= 0)
 				legal.push_back(a);
 		}
-		return ValuedAction(legal[Random::RANDOM.NextInt(legal.size())],
+		return ValuedAction(legal[Random::s_threadRand.NextInt(legal.size())],
 			State::Weight(particles)
 				* (pocman_->reward_die_
 					+ pocman_->reward_default_ / (1 - Globals::Discount())));
@@ -214,7 +214,7 @@ public:
 			}
 
 			if (preferred_.size() > 0)
-				return preferred_[Random::RANDOM.NextInt(preferred_.size())];
+				return preferred_[Random::s_threadRand.NextInt(preferred_.size())];
 		}
 
 		for (int a = 0; a < 4; ++a) {
@@ -223,7 +223,7 @@ public:
 				legal_.push_back(a);
 		}
 
-		return legal_[Random::RANDOM.NextInt(legal_.size())];
+		return legal_[Random::s_threadRand.NextInt(legal_.size())];
 	}
 };
 
@@ -511,11 +511,11 @@ int Pocman::MakeObservations(const PocmanState& pocstate) const {
 bool Pocman::LocalMove(State& state, const History& history, int obs) const {
 	PocmanState& pocstate = static_cast<PocmanState&>(state);
 
-	int numGhosts = Random::RANDOM.NextInt(1, 3); // Change 1 or 2 ghosts at a time
+	int numGhosts = Random::s_threadRand.NextInt(1, 3); // Change 1 or 2 ghosts at a time
 	for (int i = 0; i < numGhosts; ++i) {
-		int g = Random::RANDOM.NextInt(num_ghosts_);
-		pocstate.ghost_pos[g] = Coord(Random::RANDOM.NextInt(maze_.xsize()),
-			Random::RANDOM.NextInt(maze_.ysize()));
+		int g = Random::s_threadRand.NextInt(num_ghosts_);
+		pocstate.ghost_pos[g] = Coord(Random::s_threadRand.NextInt(maze_.xsize()),
+			Random::s_threadRand.NextInt(maze_.ysize()));
 		if (!Passable(pocstate.ghost_pos[g])
 			|| pocstate.ghost_pos[g] == pocstate.pocman_pos)
 			return false;
@@ -527,7 +527,7 @@ bool Pocman::LocalMove(State& state, const History& history, int obs) const {
 			Coord pos = pocstate.pocman_pos + smellPos;
 			if (smellPos != Coord(0, 0) && maze_.Inside(pos)
 				&& CheckFlag(maze_(pos), E_SEED)) {
-				double v = Random::RANDOM.NextDouble();
+				double v = Random::s_threadRand.NextDouble();
 				pocstate.food[maze_.Index(pos)] = v < (food_prob_ * 0.5);
 			}
 		}
@@ -633,7 +633,7 @@ void Pocman::NewLevel(PocmanState& pocstate) const {
 			// cout << maze_(x, y) << " " << CheckFlag(maze_(x, y), E_SEED) << " " << CheckFlag(maze_(x, y), E_POWER) << endl;
 			if (CheckFlag(maze_(x, y), E_SEED)
 				&& (CheckFlag(maze_(x, y), E_POWER)
-					|| Random::RANDOM.NextDouble() < food_prob_)) {
+					|| Random::s_threadRand.NextDouble() < food_prob_)) {
 				pocstate.food[pocIndex] = 1;
 				pocstate.num_food++;
 			} else {
@@ -859,7 +859,7 @@ void Pocman::PrintAction(int action, ostream& out) const {
 	out << Compass::CompassString[action] << endl;
 }
 
-State* Pocman::Allocate(int state_id, double weight) const {
+State* Pocman::Allocate(STATE_TYPE state_id, double weight) const {
 	PocmanState* state = memory_pool_.Allocate();
 	state->state_id = state_id;
 	state->weight = weight;
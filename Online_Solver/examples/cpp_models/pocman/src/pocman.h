@@ -78,7 +78,7 @@ public:
 	void PrintBelief(const Belief& belief, std::ostream& out = std::cout) const;
 	virtual void PrintAction(int action, std::ostream& out = std::cout) const;
 
-	State* Allocate(int state_id, double weight) const;
+	State* Allocate(STATE_TYPE state_id, double weight) const;
 	virtual State* Copy(const State* particle) const;
 	virtual void Free(State* particle) const;
 	int NumActiveParticles() const;
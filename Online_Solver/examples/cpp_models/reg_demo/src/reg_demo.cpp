@@ -166,7 +166,7 @@ void RegDemo::PrintMDPPolicy() const {
 }
 
 State* RegDemo::CreateStartState(string type) const {
-	double prob = Random::RANDOM.NextDouble();
+	double prob = Random::s_threadRand.NextDouble();
 	return new RegDemoState((prob <= 0.5) ? 0 : 1);
 }
 
@@ -76,7 +76,8 @@ BaseRockSample::BaseRockSample(int size, int rocks) :
 		InitGeneral();
 	}
 
-	// InitStates();
+	// the belief MDP functions (Tau, Observe, GetMDPState) index the enumerated states
+	InitStates();
 }
 
 void BaseRockSample::InitStates() {
@@ -93,8 +94,8 @@ void BaseRockSample::InitGeneral() {
 	for (int i = 0; i < num_rocks_; i++) {
 		Coord pos;
 		do {
-			pos = Coord(Random::RANDOM.NextInt(size_),
-				Random::RANDOM.NextInt(size_));
+			pos = Coord(Random::s_threadRand.NextInt(size_),
+				Random::s_threadRand.NextInt(size_));
 		} while (grid_(pos) >= 0);
 		grid_(pos) = i;
 		rock_pos_.push_back(pos);
@@ -176,7 +177,7 @@ void BaseRockSample::Init_11_11() {
 State* BaseRockSample::CreateStartState(string type) const {
 	int state = (1 << num_rocks_) * CoordToIndex(start_pos_);
 	for (int i = 0; i < num_rocks_; i++) {
-		if (Random::RANDOM.NextInt(2))
+		if (Random::s_threadRand.NextInt(2))
 			SetFlag(state, i);
 	}
 	return new RockSampleState(state);
@@ -860,7 +861,7 @@ void BaseRockSample::PrintAction(int action, ostream& out) const {
 		out << "Check " << (action - E_SAMPLE - 1) << endl;
 }
 
-State* BaseRockSample::Allocate(int state_id, double weight) const {
+State* BaseRockSample::Allocate(STATE_TYPE state_id, double weight) const {
 	RockSampleState* state = memory_pool_.Allocate();
 	state->state_id = state_id;
 	state->weight = weight;
@@ -1011,7 +1012,8 @@ bool BaseRockSample::GetObservation(double rand_num,
 }
 
 void BaseRockSample::SampleRock(State* state, int rock) const {
-	UnsetFlag(state->state_id, rock);
+	// state id is wider than the int flags of UnsetFlag
+	state->state_id &= ~((STATE_TYPE)1 << rock);
 }
 
 int BaseRockSample::GetX(const State* state) const {
@@ -116,7 +116,7 @@ public:
 	virtual void PrintObs(const State& state, OBS_TYPE observation, std::ostream& out = std::cout) const = 0;
 	void PrintAction(int action, std::ostream& out = std::cout) const;
 
-	State* Allocate(int state_id, double weight) const;
+	State* Allocate(STATE_TYPE state_id, double weight) const;
 	State* Copy(const State* particle) const;
 	void Free(State* particle) const;
 	int NumActiveParticles() const;
@@ -118,7 +118,7 @@ double SimpleRockSample::ObsProb(OBS_TYPE obs, const State& state,
 }
 
 State* SimpleRockSample::CreateStartState(string type) const {
-	return new SimpleState(1, Random::RANDOM.NextInt(2));
+	return new SimpleState(1, Random::s_threadRand.NextInt(2));
 }
 
 Belief* SimpleRockSample::InitialBelief(const State* start, string type) const {
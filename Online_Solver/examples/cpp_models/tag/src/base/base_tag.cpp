@@ -1,4 +1,5 @@
 #include <queue>
+#include <sstream>
 
 #include "base_tag.h"
 #include <despot/util/coord.h>
@@ -79,7 +80,7 @@ public:
 		History& history) const {
 		// If history is empty then take a random move
 		if (history.Size() == 0) {
-			return Random::RANDOM.NextInt(tag_model_->NumActions() - 1);
+			return Random::s_threadRand.NextInt(tag_model_->NumActions() - 1);
 		}
 
 		// If we just saw an opponent then TAG
@@ -116,7 +117,7 @@ public:
 		if (actions.size() == 0)
 			return 0;
 
-		int action = actions[Random::RANDOM.NextInt(actions.size())];
+		int action = actions[Random::s_threadRand.NextInt(actions.size())];
 		return action;
 	}
 };
@@ -197,7 +198,7 @@ public:
 		else {
 			vector<int> policy = floor_.ComputeShortestPath(rob, opp);
 
-			first_action_ = (policy.size() > 0) ? policy[0] : Random::RANDOM.NextInt(4);
+			first_action_ = (policy.size() > 0) ? policy[0] : Random::s_threadRand.NextInt(4);
 		}
 
 		paths_.clear();
@@ -261,7 +262,7 @@ public:
 		if (actions.size() == 0) // Rob may be trapped by the obstacles
 		return 0;
 
-		int act = actions[Random::RANDOM.NextInt(actions.size())];
+		int act = actions[Random::s_threadRand.NextInt(actions.size())];
 		return act;
 	}
 };
@@ -422,7 +423,7 @@ string BaseTag::RandomMap(int height, int width, int obstacles) {
 		map[h * (width + 1) - 1] = '\n';
 
 	for (int i = 0; i < obstacles;) {
-		int p = Random::RANDOM.NextInt(map.length());
+		int p = Random::s_threadRand.NextInt(map.length());
 		if (map[p] != '\n' && map[p] != '#') {
 			map[p] = '#';
 			i++;
@@ -637,7 +638,7 @@ void BaseTag::PrintTransitions() const {
 }
 
 State* BaseTag::CreateStartState(string type) const {
-	int n = Random::RANDOM.NextInt(states_.size());
+	int n = Random::s_threadRand.NextInt(states_.size());
 	return new TagState(*states_[n]);
 }
 
@@ -672,6 +673,15 @@ ScenarioUpperBound* BaseTag::CreateScenarioUpperBound(string name,
 	}
 }
 
+string BaseTag::ParametersKey() const {
+	// the floor and the reward, the opponent moves are the same for all maps
+	ostringstream key;
+	key << TAG_REWARD << " " << robot_pos_unknown_;
+	for (int i = 0; i < floor_.NumCells(); i++)
+		key << " " << floor_.GetCell(i).x << "," << floor_.GetCell(i).y;
+	return key.str();
+}
+
 BeliefUpperBound* BaseTag::CreateBeliefUpperBound(string name) const {
 	if (name == "TRIVIAL") {
 		return new TrivialBeliefUpperBound(this);
@@ -798,7 +808,7 @@ void BaseTag::PrintAction(int action, ostream& out) const {
 	}
 }
 
-State* BaseTag::Allocate(int state_id, double weight) const {
+State* BaseTag::Allocate(STATE_TYPE state_id, double weight) const {
 	TagState* state = memory_pool_.Allocate();
 	state->state_id = state_id;
 	state->weight = weight;
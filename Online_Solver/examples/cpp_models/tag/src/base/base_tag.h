@@ -120,6 +120,7 @@ public:
 	ScenarioUpperBound* CreateScenarioUpperBound(std::string name = "DEFAULT",
 		std::string particle_bound_name = "DEFAULT") const;
 	BeliefUpperBound* CreateBeliefUpperBound(std::string name = "DEFAULT") const;
+	std::string ParametersKey() const;
 
 	inline ValuedAction GetMinRewardAction() const {
 		return ValuedAction(0, -1);
@@ -135,7 +136,7 @@ public:
 	virtual void PrintObs(const State& state, OBS_TYPE obs, std::ostream& out = std::cout) const = 0;
 	void PrintAction(int action, std::ostream& out = std::cout) const;
 
-	State* Allocate(int state_id, double weight) const;
+	State* Allocate(STATE_TYPE state_id, double weight) const;
 	State* Copy(const State* particle) const;
 	void Free(State* particle) const;
 	int NumActiveParticles() const;
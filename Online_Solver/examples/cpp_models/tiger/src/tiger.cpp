@@ -106,7 +106,7 @@ double Tiger::ObsProb(OBS_TYPE obs, const State& s, int a) const {
 }
 
 State* Tiger::CreateStartState(string type) const {
-	return new TigerState(Random::RANDOM.NextInt(2));
+	return new TigerState(Random::s_threadRand.NextInt(2));
 }
 
 Belief* Tiger::InitialBelief(const State* start, string type) const {
@@ -169,7 +169,7 @@ void Tiger::PrintAction(int action, ostream& out) const {
 	}
 }
 
-State* Tiger::Allocate(int state_id, double weight) const {
+State* Tiger::Allocate(STATE_TYPE state_id, double weight) const {
 	TigerState* particle = memory_pool_.Allocate();
 	particle->state_id = state_id;
 	particle->weight = weight;
@@ -1,7 +1,7 @@
 #ifndef TIGER_H
 #define TIGER_H
 
-#include <..\core\pomdp.h>
+#include <despot/core/pomdp.h>
 
 namespace despot {
 
@@ -59,7 +59,7 @@ public:
 	void PrintObs(const State& state, OBS_TYPE obs, std::ostream& out = std::cout) const;
 	void PrintAction(int action, std::ostream& out = std::cout) const;
 
-	State* Allocate(int state_id, double weight) const;
+	State* Allocate(STATE_TYPE state_id, double weight) const;
 	State* Copy(const State* particle) const;
 	void Free(State* particle) const;
 	int NumActiveParticles() const;
@@ -6,6 +6,9 @@
 #include <pomcp.h>
 
 #include <UDP_Prot.h>
+#include <UDP_Receiver.h>
+
+#include "TreeSender.h"
 
 namespace despot 
 {
@@ -44,8 +47,6 @@ class OnlineSolverModel : public DSPOMDP
 {	
 public:
 	using OnlineSolverLUT = std::map < STATE_TYPE, doubleVec >;
-	// prams for tree sending
-	enum TREE_SEND_PARAMS { END_TREE, START_NEW_TRIAL, START_NEW_STEP, END_RUN };
 
 	OnlineSolverModel() = default;
 	~OnlineSolverModel() = default;
@@ -62,6 +63,8 @@ public:
 
 	/// init udp server
 	static bool InitUDP(int portNum = -1, int sendTreePort = -1);
+	/// set max depth of sent tree (-1 for whole tree) and number of delta frames between full trees
+	static void InitTreeSendParams(int maxDepth, int keyFrameInterval);
 	/// init model type, periodOfdecision
 	static void InitSolverParams(bool isOnline, bool parallelRun, bool treeReuse, int periodOfDecision = 1);
 
@@ -69,6 +72,8 @@ public:
 
 	/// send action to simulator
 	void SendAction(int action);
+	/// wait up to timeoutMs for the next state from simulator (0 for not waiting). return true if state arrived
+	static bool WaitState(int timeoutMs);
 
 
 	/*TREE VISUALISATOR FUNCTIONS*/
@@ -77,7 +82,7 @@ public:
 	static void SendEndRun();
 	/// send num actions to tree visualsiator
 	static void SendModelDetails2TreeVisualizator(int numActions);
-	/// send tree in udp for tree visualisation
+	/// send tree in udp for tree visualisation (tree is sent from a background thread)
 	static void SendTree(State * state, VNode *root);
 
 
@@ -92,6 +97,8 @@ public:
 	virtual State* Copy(const State* particle) const override;
 	virtual void Free(State* particle) const override;
 	virtual int NumActiveParticles() const override;
+	/// the memory pool is guarded and step is using the random of the calling thread
+	virtual bool IsThreadSafe() const override { return true; }
 
 	/// return the max reward available
 	virtual double GetMaxReward() const override = 0;
@@ -102,7 +109,7 @@ public:
 	/*STEP AND ACTION CALC*/
 protected:
 
-	inline static double RandomNum() { return Random::s_threadSafeRand[GetCurrentThreadId()].NextDouble(); }
+	inline static double RandomNum() { return Random::s_threadRand.NextDouble(); }
 	/// create a vector of random numbers between 0 - 1
 	static void CreateRandomVec(doubleVec & randomVec, int size);
 
@@ -110,11 +117,6 @@ protected:
 
 private:
 
-	/*TREE VISU FUNCS*/
-	///// fill values of subtrees
-	static unsigned int SendTreeRec(VNode *node, unsigned int parentId, unsigned int id, uintVec & buffer);
-	static unsigned int SendTreeRec(QNode *node, unsigned int parentId, unsigned int id, unsigned int nextAvailableId, uintVec & buffer);
-
 	/*SOLVER FUNCS*/
 	
 
@@ -140,7 +142,7 @@ public:
 
 	/// recieve init state from simulator
 	virtual void InitState();
-	/// recieve current state from simulator and update reward and observation
+	/// recieve current state from simulator and update reward and observation (blocking until state arrives)
 	bool RcvState(State * s, double & reward, OBS_TYPE & obs);
 
 	/// display model params to out
@@ -165,10 +167,11 @@ protected:
 	static std::mutex s_memoryMutex;
 	static MemoryPool<OnlineSolverState> memory_pool_;
 
-	/// for comunication with VBS
-	static UDP_Server s_udpSimulator;
+	/// for comunication with VBS (states are received in a background thread)
+	static UDP_Receiver s_udpSimulator;
 	/// for sending tree
 	static UDP_Server s_udpTree;
+	static TreeSender s_treeSender;
 
 public:
 
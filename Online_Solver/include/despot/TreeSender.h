@@ -0,0 +1,111 @@
+#ifndef TREE_SENDER_H
+#define TREE_SENDER_H
+
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <UDP_Prot.h>
+
+namespace despot
+{
+
+class VNode;
+class QNode;
+
+/* =============================================================================
+* TreeSender class
+* =============================================================================*/
+/// streams search trees to the tree visualizator from a background thread.
+/// the solver thread only snapshots the tree (up to a depth limit) into a buffer, the sender thread is writing it to the socket.
+/// every node keeps its id between steps so a frame contains only new nodes, nodes whose count or value changed
+/// and the ids of nodes removed from the tree (key frames containing all nodes are sent periodically and after a frame was dropped)
+///
+/// each datagram : START_NEW_STEP, frame seq, chunk idx, num chunks, payload chunk
+/// payload of frame : is key frame, root id, state size, state, num nodes, nodes (parent id, id, value, count, action),
+/// num removed, removed ids, END_TREE
+/// (action is the idx of an action node in its belief node, 0 for belief nodes. the address of a removed node may be
+/// reused by a new node under the same parent, the new node keeps the id and is sent with its own count and value)
+class TreeSender
+{
+public:
+	// prams for tree sending
+	enum TREE_SEND_PARAMS : unsigned int { START_NEW_TRIAL = 1, START_NEW_STEP = 2, END_RUN = 3, END_TREE = 0xFFFFFFFF };
+
+	TreeSender();
+	~TreeSender();
+
+	TreeSender(const TreeSender &) = delete;
+	TreeSender & operator=(const TreeSender &) = delete;
+
+	/// start sender thread writing to sock
+	void Init(UDP_Server * sock);
+	/// set max depth of vnodes sent (-1 for whole tree) and the number of frames between key frames
+	void SetParams(int maxDepth, int keyFrameInterval);
+
+	/// snapshot tree to buffer and pass it to sender thread (does not wait for sending)
+	void SendTree(const std::vector<unsigned int> & state, VNode * root);
+	/// send control msg after all frames were sent (next frame will be key frame)
+	void SendControlMsg(std::vector<unsigned int> & msg);
+
+	/// number of datagram header values
+	static const int s_NUM_HEADER_VALS = 4;
+	/// number of values of each node
+	static const int s_NUM_VALS_IN_NODE = 5;
+	static const int s_NO_DEPTH_LIMIT = -1;
+
+private:
+	/// data of node from last frame
+	struct SentNode
+	{
+		unsigned int m_id;
+		unsigned int m_parentId;
+		unsigned int m_action;
+		unsigned int m_count;
+		float m_value;
+		/// seq of last frame node appeared in
+		unsigned int m_frameSeq;
+	};
+
+	void SenderMainFunction();
+	/// write frame in datagrams
+	void WriteFrame(const std::vector<unsigned int> & frame);
+
+	unsigned int SnapshotRec(VNode * node, unsigned int parentId, int depth, bool isRoot, std::vector<unsigned int> & frame);
+	void SnapshotRec(QNode * node, unsigned int id, int depth, std::vector<unsigned int> & frame);
+	/// return id of node and insert node to frame if new or changed
+	unsigned int InsertNode(const void * node, unsigned int parentId, unsigned int action, unsigned int count, float value, bool isRoot, std::vector<unsigned int> & frame);
+
+	/// wait until all frames were written (the sender thread notifies m_cond when it is done with a frame)
+	void Flush();
+
+	UDP_Server * m_sock;
+
+	int m_maxDepth;
+	int m_keyFrameInterval;
+
+	/// nodes data of the previous frame (accessed only by the solver thread)
+	std::unordered_map<const void *, SentNode> m_sentNodes;
+	unsigned int m_nextId;
+	unsigned int m_frameSeq;
+	bool m_isKeyFrame;
+	int m_framesSinceKeyFrame;
+
+	/// filled by solver thread, passed to sender through pending buffer
+	std::vector<unsigned int> m_fillBuffer;
+	std::vector<unsigned int> m_pendingBuffer;
+	std::vector<unsigned int> m_sendBuffer;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	bool m_isPending;
+	bool m_isSending;
+	bool m_stop;
+	std::thread m_thread;
+};
+
+} // end ns despot
+
+#endif // TREE_SENDER_H
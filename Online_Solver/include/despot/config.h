@@ -19,6 +19,16 @@ struct Config {
 	int max_policy_sim_len; // Maximum number of steps for simulating the default policy
 	double noise;
 	bool silence;
+	int num_expansion_threads; // Number of threads expanding DESPOT nodes (1 for serial expansion)
+	bool despot_tree_reuse; // Keep the DESPOT subtree of the executed action and observation for the next search
+	double min_reuse_ratio; // Min. fraction of the scenarios the kept subtree must have (otherwise a new tree is built)
+	std::string bound_cache_dir; // Directory of precomputed bound tables (empty for no cache)
+	int num_vi_threads; // Threads of MDP value iteration sweeps (0 for one per core)
+	bool vi_gauss_seidel; // Update values in place (Gauss-Seidel) when value iteration runs on one thread
+	int pomcp_transposition; // Number of last observations POMCP belief nodes are shared by (0 for no transpositions)
+	int max_tree_nodes; // Max. number of POMCP belief nodes, the least visited are evicted above it (0 for no limit)
+	double widening_k; // POMCP QNodes create an observation child only below widening_k * N^widening_alpha children (0 for no widening)
+	double widening_alpha;
 	
 
 	Config() :
@@ -34,7 +44,17 @@ struct Config {
 		default_action(""),
 		max_policy_sim_len(90),
 		noise(0.1),
-		silence(false) {
+		silence(false),
+		num_expansion_threads(1),
+		despot_tree_reuse(false),
+		min_reuse_ratio(0.2),
+		bound_cache_dir(""),
+		num_vi_threads(0),
+		vi_gauss_seidel(true),
+		pomcp_transposition(0),
+		max_tree_nodes(0),
+		widening_k(0),
+		widening_alpha(0.5) {
 }
 };
 
@@ -47,6 +47,29 @@ public:
 		return observations_.back();
 	}
 
+	/**
+	 * Hash of the last n observations and of the actions between them (the
+	 * action leading to the first of them is left out).
+	 */
+	unsigned long long Hash(int n) const {
+		unsigned long long hash = 0;
+		int start = Size() > n ? Size() - n : 0;
+		for (int t = start; t < Size(); t++) {
+			if (t > start)
+				Combine(hash, actions_[t]);
+			Combine(hash, observations_[t]);
+		}
+		return hash;
+	}
+
+	static void Combine(unsigned long long& hash, unsigned long long value) {
+		hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+		// splitmix64 finalizer, observations often differ in a few low bits
+		hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+		hash ^= hash >> 31;
+	}
+
 	History Suffix(int s) const {
 		History history;
 		for (int i = s; i < Size(); i++)
@@ -27,6 +27,11 @@ public:
 	ScenarioLowerBound(const DSPOMDP* model, Belief* belief = NULL);
 
 	virtual void Init(const RandomStreams& streams);
+	/**
+	 * Called when streams were shifted by one step for a reused tree.
+	 * Initializes the bound again by default.
+	 */
+	virtual void Shift(const RandomStreams& streams);
 
 	virtual ValuedAction Search();
 	virtual void Learn(VNode* tree);
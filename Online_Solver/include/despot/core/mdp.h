@@ -21,6 +21,19 @@ protected:
 
 	std::vector<std::vector<double> > blind_alpha_; // For blind policy
 
+	/**
+	 * Transitions in compressed sparse rows: row s * NumActions() + a holds
+	 * entries transition_start_[row] .. transition_start_[row + 1] - 1 of
+	 * transition_next_ (next state index) and transition_prob_.
+	 */
+	std::vector<int> transition_start_;
+	std::vector<int> transition_next_;
+	std::vector<double> transition_prob_;
+	std::vector<double> reward_; // reward_[s * NumActions() + a]
+
+	/** Read TransitionProbability and Reward of all states once */
+	void BuildTransitionMatrix();
+
 public:
 	virtual ~MDP();
 
@@ -43,6 +43,9 @@ public:
 
 	VNode(std::vector<State*>& particles, int depth = 0, QNode* parent = NULL,
 		OBS_TYPE edge = -1);
+	/** Take over the particles instead of copying them */
+	VNode(std::vector<State*>&& particles, int depth = 0, QNode* parent = NULL,
+		OBS_TYPE edge = -1);
 	VNode(Belief* belief, int depth = 0, QNode* parent = NULL, OBS_TYPE edge =
 		-1);
 	VNode(int count, double value, int depth = 0, QNode* parent = NULL,
@@ -85,6 +88,7 @@ public:
 	void PrintPolicyTree(int depth = -1, std::ostream& os = std::cout);
 
 	int Height(); // NATAN CHANGES
+	void CountInAncestors(int num); // num = 1 for a new node, -1 for a freed one
 	void LevelSize(std::vector<double> & DividedSize, int currLevel); // NATAN CHANGES
 	void LevelActionSize(std::vector<std::vector<double>> & DividedSize, int currLevel); // NATAN CHANGES
 	void PreferredActionPortion(std::vector<double> & portion, const std::vector<double> & sizes, int currLevel); // NATAN CHANGES
@@ -111,6 +115,10 @@ protected:
 	int count_; // Number of visits on the node
 	double value_; // Value of the node
 
+	// For POMCP and AEMS, maintained by the solver as belief nodes are added
+	int subtree_size_; // Number of belief nodes below the node
+	int subtree_height_; // Height of the subtree (not lowered when nodes are freed)
+
 public:
 	double default_value;
 	double utility_upper_bound;
@@ -143,6 +151,10 @@ public:
 	void value(double v);
 	double value() const;
 	int height() const;
+
+	int subtree_size() const;
+	int subtree_height() const;
+	void subtree_stats(int size, int height);
 };
 
 } // namespace despot
@@ -43,11 +43,11 @@ struct ValuedAction {
 
 class Policy: public ScenarioLowerBound {
 private:
-	mutable int initial_depth_;
 	ParticleLowerBound* particle_lower_bound_;
 
+	// initial_depth is passed down (not a member) so the policy can be valued by several threads
 	ValuedAction RecursiveValue(const std::vector<State*>& particles,
-		RandomStreams& streams, History& history) const;
+		RandomStreams& streams, History& history, int initial_depth) const;
 
 public:
 	Policy(const DSPOMDP* model, ParticleLowerBound* particle_lower_bound,
@@ -229,6 +229,24 @@ public:
 		return NULL;
 	}
 
+	/**
+	 * Returns true if Copy, Step and Free of this model, and the bounds it
+	 * creates, can be called by several threads at once (DESPOT expands
+	 * with one thread otherwise).
+	 */
+	inline virtual bool IsThreadSafe() const {
+		return false;
+	}
+
+	/**
+	 * Returns the parameters of this model that are not given by its type and
+	 * sizes (probabilities, rewards, offline tables). Tables precomputed for
+	 * the model, like the lookahead bound cache, are keyed by it.
+	 */
+	inline virtual std::string ParametersKey() const {
+		return "";
+	}
+
 };
 
 /* =============================================================================
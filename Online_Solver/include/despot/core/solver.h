@@ -42,6 +42,8 @@ struct SearchStatistics {
 class SolverBase
 {
 public:
+	virtual ~SolverBase() {}
+
 	virtual void Search(TreeDevelopThread * threadData, int action)  = 0;
 	virtual ValuedAction Search() = 0;
 
@@ -49,6 +51,11 @@ public:
 	virtual void UpdateHistory(int action, OBS_TYPE obs) = 0;
 
 	virtual void GetTreeProperties(Tree_Properties & treeProp) const = 0;
+	/// number of simulations (trials) run by the solver since it was created
+	virtual int NumSimulations() const = 0;
+	/// develop tree of action (already sent) for timeout seconds while waiting for the observation.
+	/// return false if solver cannot use the time (caller should block instead)
+	virtual bool SearchWhileWaiting(int action, double timeout) = 0;
 
 	virtual void belief(Belief* b) = 0;
 	virtual Belief* belief() = 0;
@@ -79,6 +86,8 @@ public:
 	virtual void Search(TreeDevelopThread * threadData, int action) {};
 	virtual void GetTreeProperties(Tree_Properties & treeProp) const {};
 	virtual void GetSingleActionTreeProp(SingleNodeTreeProp & treeProp, int action) const {};
+	virtual int NumSimulations() const { return 0; };
+	virtual bool SearchWhileWaiting(int action, double timeout) { return false; };
 
 	/**
 	 * Update current belief, history, and any other internal states that is
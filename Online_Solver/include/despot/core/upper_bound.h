@@ -6,6 +6,7 @@
 
 #include "../random_streams.h"
 #include "../core/history.h"
+#include "../util/mapped_file.h"
 
 namespace despot {
 
@@ -26,6 +27,11 @@ public:
 	virtual ~ScenarioUpperBound();
 
 	virtual void Init(const RandomStreams& streams);
+	/**
+	 * Called when streams were shifted by one step for a reused tree.
+	 * Initializes the bound again by default.
+	 */
+	virtual void Shift(const RandomStreams& streams);
 
 	virtual double Value(const std::vector<State*>& particles,
 		RandomStreams& streams, History& history) const = 0;
@@ -75,14 +81,42 @@ class LookaheadUpperBound: public ScenarioUpperBound {
 protected:
 	const DSPOMDP* model_;
 	const StateIndexer& indexer_;
-	std::vector<std::vector<std::vector<double> > > bounds_;
 	ParticleUpperBound* particle_upper_bound_;
 
+	/**
+	 * bounds_[(p * (length_ + 1) + t) * num_states_ + s] is the bound of state s
+	 * at depth t of scenario p. It points either to table_ or to the mapped
+	 * cache file.
+	 */
+	const double* bounds_;
+	std::vector<double> table_;
+	MappedFile cache_;
+	int length_;
+	int num_states_;
+
+	/** Fill table_ for streams, one scenario per task on several threads */
+	void Compute(const RandomStreams& streams);
+	/** Key of the table of streams (model type and parameters, sizes, discount and streams) */
+	unsigned long long CacheKey(const RandomStreams& streams) const;
+	bool LoadCache(const std::string& path, unsigned long long key, int num_particles);
+	void SaveCache(const std::string& path, unsigned long long key, int num_particles) const;
+
 public:
 	LookaheadUpperBound(const DSPOMDP* model, const StateIndexer& indexer,
 		ParticleUpperBound* bound);
 
+	/**
+	 * Compute the bounds of the scenarios of streams. When
+	 * Globals::config.bound_cache_dir is set, the table is loaded from
+	 * (or saved to) a cache file of the model and streams.
+	 */
 	virtual void Init(const RandomStreams& streams);
+	/**
+	 * Move the rows of every scenario one depth up instead of computing the
+	 * table again. The last step of the shifted streams is bounded by the
+	 * particle upper bound, so the bound stays valid (one step looser).
+	 */
+	virtual void Shift(const RandomStreams& streams);
 
 	double Value(const std::vector<State*>& particles,
 		RandomStreams& streams, History& history) const;
@@ -110,6 +110,8 @@ public:
  * known, then the set of parents that the child depends on will be smaller.
  */
 class HierarchyCPT: public CPT {
+	friend class POMDPXTables;
+
 protected:
   std::vector<TabularCPT*> cpts_;
 
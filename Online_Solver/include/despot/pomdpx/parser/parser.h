@@ -30,6 +30,7 @@ struct TerminalPattern {
 
 class Parser {
 	friend class Func;
+	friend class POMDPXTables;
 
 private:
   typedef util::tinyxml::TiXmlBase TiXmlBase;
@@ -1,9 +1,12 @@
 #ifndef POMDPX_H
 #define POMDPX_H
 
+#include <mutex>
+
 #include "../core/pomdp.h"
 #include "../core/mdp.h"
 #include "../pomdpx/parser/parser.h"
+#include "../pomdpx/pomdpx_tables.h"
 
 namespace despot {
 
@@ -38,6 +41,7 @@ class POMDPX: public MDP,
 
 private:
 	Parser* parser_;
+	POMDPXTables* tables_; // reentrant Step/ObsProb, NULL if not compiled
 	bool is_small_;
 
 	ValuedAction min_reward_action_;
@@ -48,6 +52,7 @@ private:
 	mutable std::vector<std::vector<double> > rewards_;
 
 	mutable MemoryPool<POMDPXState> memory_pool_;
+	mutable std::mutex memory_mutex_; // guards memory_pool_
 
 	void InitStates();
 	void InitTransitions();
@@ -118,6 +123,11 @@ public:
 
 	virtual DSPOMDP* MakeCopy() const;
 
+	// Step and ObsProb go through the shared parser unless the tables are compiled
+	inline virtual bool IsThreadSafe() const {
+		return tables_ != NULL;
+	}
+
 	void PrintMDPBound(const std::vector<ValuedAction>& policy, const char* fn);
 
 	// For server-client messages in IPPC competition
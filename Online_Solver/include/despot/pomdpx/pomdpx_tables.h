@@ -0,0 +1,123 @@
+#ifndef POMDPX_TABLES_H
+#define POMDPX_TABLES_H
+
+#include <vector>
+#include "../core/globals.h"
+
+namespace despot {
+
+class Parser;
+class Function;
+class CPT;
+class TabularCPT;
+class NamedVar;
+
+/* =============================================================================
+ * POMDPXTables class
+ * =============================================================================*/
+
+/**
+ * Immutable flat tables compiled from a parsed POMDPX model. Unlike the
+ * Parser, which keeps the values of the variables of the current step in its
+ * variable objects, all functions take the state explicitly, so they can be
+ * called from any thread.
+ *
+ * Distributions are scanned in the order of the parser's sparse rows and the
+ * random number is rescaled the same way as TabularCPT::ComputeIndex, so the
+ * sampled trajectories are the same as the ones of the parser.
+ */
+class POMDPXTables {
+public:
+	/**
+	 * Compile the model of parser. Returns NULL if the model uses a
+	 * dependency the tables do not support (the parser is used then).
+	 */
+	static POMDPXTables* Compile(const Parser& parser);
+
+	bool Step(std::vector<int>& state, double random, int action,
+		double& reward, OBS_TYPE& obs) const;
+	bool NoisyStep(std::vector<int>& state, double random, int action) const;
+	double ObsProb(OBS_TYPE obs, const std::vector<int>& state, int action) const;
+	bool IsTerminalState(const std::vector<int>& state) const;
+
+private:
+	/** Where the value of a parent variable is read from */
+	enum SlotType {
+		PREV_STATE, CURR_STATE, ACTION
+	};
+
+	struct Slot {
+		SlotType type;
+		int index;
+		int size;
+	};
+
+	/**
+	 * Rows of a tabular function: entries row_start[pid] .. row_start[pid + 1]
+	 * - 1 of child/prob are the non-zero values for parent index pid.
+	 */
+	struct Table {
+		std::vector<Slot> parents;
+		std::vector<int> row_start;
+		std::vector<int> child;
+		std::vector<double> prob;
+	};
+
+	/**
+	 * A CPT: a single table, or one table per value of the selector (for
+	 * HierarchyCPT).
+	 */
+	struct CompiledCPT {
+		bool has_selector;
+		Slot selector;
+		std::vector<Table> tables;
+	};
+
+	struct CompiledFunction {
+		std::vector<Slot> parents;
+		std::vector<double> values; // values[pid]
+	};
+
+	/** Values of the variables of a step */
+	struct Context {
+		const int* prev;
+		const int* curr;
+		int action;
+	};
+
+	std::vector<CompiledCPT> transitions_;
+	std::vector<CompiledCPT> noisy_transitions_;
+	std::vector<CompiledCPT> observations_;
+	std::vector<int> obs_sizes_;
+	std::vector<CompiledFunction> rewards_;
+	std::vector<std::vector<char> > is_identity_; // is_identity_[s][a]
+	int num_actions_;
+	bool has_terminal_;
+	const Parser* parser_; // for the terminal state patterns
+
+	POMDPXTables();
+
+	static bool CompileSlots(const Parser& parser,
+		const std::vector<NamedVar*>& vars, std::vector<Slot>& slots);
+	static bool CompileTable(const Parser& parser, const TabularCPT& cpt,
+		Table& table);
+	static bool CompileCPT(const Parser& parser, const CPT* cpt,
+		CompiledCPT& compiled);
+	static bool CompileFunction(const Parser& parser, const Function& func,
+		CompiledFunction& compiled);
+
+	static int Value(const Slot& slot, const Context& context);
+	static int ParentIndex(const std::vector<Slot>& parents,
+		const Context& context);
+	const Table& SelectTable(const CompiledCPT& cpt, const Context& context) const;
+	int Sample(const CompiledCPT& cpt, const Context& context,
+		double& random) const;
+	double Probability(const CompiledCPT& cpt, const Context& context,
+		int child) const;
+	double Reward(const Context& context) const;
+	bool IsSelfLoopingWithoutReward(const std::vector<int>& state) const;
+};
+
+} // namespace despot
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
 #include <stdlib.h>
 #include "./util/random.h"
 
@@ -11,10 +12,12 @@ namespace despot {
 /**
  * A RandomStreams object represents multiple random number sequences, where each
  * entry is independently and identically drawn from [0, 1].
+ * Copies share the sequences and keep their own position, so tasks running in
+ * parallel on the same scenarios each use a copy.
  */
 class RandomStreams {
 private:
-  std::vector<std::vector<double> > streams_; // streams_[i] is associated with i-th particle
+  std::shared_ptr<const std::vector<std::vector<double> > > streams_; // (*streams_)[i] is associated with i-th particle
 	mutable int position_;
 
 public:
@@ -36,6 +39,13 @@ public:
 	 */
 	int Length() const;
 
+	/**
+	 * Drops the first entry of every sequence and appends a new one, so
+	 * position i now holds the entry of position i + 1. Other copies keep
+	 * the old sequences.
+	 */
+	void Shift();
+
 	void Advance() const;
 	void Back() const;
 
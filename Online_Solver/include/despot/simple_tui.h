@@ -57,6 +57,7 @@ enum OptionIndex {
   E_SERVER,
   E_PORT,
   E_LOG,
+  E_BOUND_CACHE,
 };
 
 // option::Arg::Required is a misnomer. The program won't complain if these
@@ -109,6 +110,9 @@ const option::Descriptor usage[] = {
     "-u <arg>  \t--ubtype <arg>  \tUpper bound strategy." },
   { E_BUBTYPE, 0, "", "bubtype", option::Arg::Required,
     "  \t--bubtype <arg>  \tBase upper bound." },
+  { E_BOUND_CACHE, 0, "", "bound-cache", option::Arg::Required,
+    "  \t--bound-cache <arg>  \tDirectory for caching precomputed bound "
+    "tables (default no cache)." },
 
   { E_BELIEF, 0, "b", "belief", option::Arg::Required,
     "-b <arg>  \t--belief <arg>  \tBelief update strategy, if applicable." },
@@ -12,6 +12,8 @@ class ParallelSolver : public SolverBase
 {
 public:
 	ParallelSolver(std::vector<Solver *> solver, int numActions);
+	/// stop and join tree threads and delete solvers (call between rounds)
+	~ParallelSolver();
 	
 	ParallelSolver(const ParallelSolver & solv) = delete;
 	ParallelSolver & operator=(const ParallelSolver & solv) = delete;
@@ -20,6 +22,8 @@ public:
 	void TreeThreadsMainFunction(int action);
 
 	virtual void GetTreeProperties(Tree_Properties & treeProp) const override;
+	virtual int NumSimulations() const override;
+	virtual bool SearchWhileWaiting(int action, double timeout) override { return false; };
 
 	virtual ValuedAction Search() override;
 	
@@ -52,7 +56,11 @@ private:
 	std::vector<std::thread> threads_;
 
 	std::mutex barrierMutex_;
+	std::condition_variable barrierCond_;
 	int barrierCounter_;
+
+	void WaitBarrier();
+	void PassBarrier();
 };
 
 } // namespace despot
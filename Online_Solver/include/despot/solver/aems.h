@@ -17,15 +17,21 @@ private:
 	SearchStatistics statistics_;
 	const BeliefMDP* model_;
 	bool reuse_;
+	int num_trials_;
 
 public:
 	AEMS(const DSPOMDP* model, BeliefLowerBound* lower_bound,
 		BeliefUpperBound* upper_bound, Belief* belief = NULL);
+	/** Deletes the tree and the bounds (the belief is deleted by its owner) */
+	virtual ~AEMS();
 
 	ValuedAction Search();
 	virtual void Update(int action, OBS_TYPE obs);
 	virtual void belief(Belief* belief);
 
+	virtual void GetTreeProperties(Tree_Properties & treeProp) const override;
+	virtual int NumSimulations() const override { return num_trials_; };
+
 private:
 	static void InitLowerBound(VNode* vnode, BeliefLowerBound* lower_bound,
 		History& history);
@@ -8,6 +8,7 @@
 #include "../core/globals.h"
 #include "../core/history.h"
 #include "../random_streams.h"
+#include "../util/task_pool.h"
 
 namespace despot {
 
@@ -15,34 +16,72 @@ class DESPOT: public Solver {
 friend class VNode;
 
 protected:
+	/**
+	 * Scratch space of a qnode expansion, reused across the actions of a
+	 * vnode: the stepped particles and their (observation, index) keys.
+	 */
+	struct ExpansionBuffer {
+		std::vector<State*> stepped;
+		std::vector<std::pair<OBS_TYPE, int> > keys;
+
+		ExpansionBuffer(int num_particles) {
+			stepped.reserve(num_particles);
+			keys.reserve(num_particles);
+		}
+	};
+
+
 	VNode* root_;
 	SearchStatistics statistics_;
+	int num_trials_;
+	/// scenarios of the solver (owned by the instance so several solvers can run in parallel)
+	RandomStreams streams_;
+	bool streams_initialized_;
+	/// workers expanding nodes in parallel (NULL when Globals::config.num_expansion_threads is 1)
+	TaskPool* pool_;
+	/// keep the subtree of the executed action and observation between searches
+	bool reuse_;
+	/// number of belief nodes of the subtree kept by Update
+	int reused_size_;
 
 	ScenarioLowerBound* lower_bound_;
 	ScenarioUpperBound* upper_bound_;
 
 public:
 	DESPOT(const DSPOMDP* model, ScenarioLowerBound* lb, ScenarioUpperBound* ub, Belief* belief = NULL);
+	/** Deletes the tree and the bounds (the belief is deleted by its owner) */
 	virtual ~DESPOT();
 
 	ValuedAction Search();
 
+	void reuse(bool r);
 	void belief(Belief* b);
 	void Update(int action, OBS_TYPE obs);
 
+	virtual void GetTreeProperties(Tree_Properties & treeProp) const override;
+	virtual int NumSimulations() const override { return num_trials_; };
+
 	ScenarioLowerBound* lower_bound() const;
 	ScenarioUpperBound* upper_bound() const;
 
 	static VNode* ConstructTree(std::vector<State*>& particles, RandomStreams& streams,
 		ScenarioLowerBound* lower_bound, ScenarioUpperBound* upper_bound,
 		const DSPOMDP* model, History& history, double timeout,
-		SearchStatistics* statistics = NULL);
+		SearchStatistics* statistics = NULL, TaskPool* pool = NULL);
+	/**
+	 * Run trials from root until timeout (real time) or until the gap at the
+	 * root is closed.
+	 */
+	static void RunTrials(VNode* root, RandomStreams& streams,
+		ScenarioLowerBound* lower_bound, ScenarioUpperBound* upper_bound,
+		const DSPOMDP* model, History& history, double timeout,
+		SearchStatistics* statistics = NULL, TaskPool* pool = NULL);
 
 protected:
 	static VNode* Trial(VNode* root, RandomStreams& streams,
 		ScenarioLowerBound* lower_bound, ScenarioUpperBound* upper_bound,
 		const DSPOMDP* model, History& history, SearchStatistics* statistics =
-			NULL);
+			NULL, TaskPool* pool = NULL);
 	static void InitLowerBound(VNode* vnode, ScenarioLowerBound* lower_bound,
 		RandomStreams& streams, History& history);
 	static void InitUpperBound(VNode* vnode, ScenarioUpperBound* upper_bound,
@@ -50,10 +89,26 @@ protected:
 	static void InitBounds(VNode* vnode, ScenarioLowerBound* lower_bound,
 		ScenarioUpperBound* upper_bound, RandomStreams& streams, History& history);
 
+	/**
+	 * Expand all actions of vnode. When pool is given, actions are expanded as
+	 * tasks, each with its own copy of streams and history.
+	 */
 	static void Expand(VNode* vnode,
 		ScenarioLowerBound* lower_bound, ScenarioUpperBound* upper_bound,
-		const DSPOMDP* model, RandomStreams& streams, History& history);
+		const DSPOMDP* model, RandomStreams& streams, History& history,
+		TaskPool* pool = NULL, int worker = 0);
 	static void Backup(VNode* vnode);
+	/**
+	 * Prepare a kept subtree to be the new root: move it one level up
+	 * (streams are shifted by the caller), scale particle weights by
+	 * weight_scale and node values by value_scale, and recompute the bounds
+	 * of internal nodes from their children. Only leaves closed at the old
+	 * search horizon get their upper bound evaluated again. Returns the number
+	 * of belief nodes of the subtree.
+	 */
+	static int RefreshReused(VNode* vnode, double weight_scale,
+		double value_scale, ScenarioUpperBound* upper_bound,
+		RandomStreams& streams, History& history);
 
 	static double Gap(VNode* vnode);
 
@@ -65,7 +120,8 @@ protected:
 	static VNode* FindBlocker(VNode* vnode);
 	static void Expand(QNode* qnode, ScenarioLowerBound* lower_bound,
 		ScenarioUpperBound* upper_bound, const DSPOMDP* model,
-		RandomStreams& streams, History& history);
+		RandomStreams& streams, History& history, ExpansionBuffer& buffer,
+		TaskPool* pool = NULL, int worker = 0);
 	static void Update(VNode* vnode);
 	static void Update(QNode* qnode);
 	static VNode* Prune(VNode* vnode, int& pruned_action, double& pruned_value);
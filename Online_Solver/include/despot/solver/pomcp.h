@@ -5,6 +5,8 @@
 #include "../core/node.h"
 #include "../core/globals.h"
 
+#include <unordered_map>
+#include <unordered_set>
 
 namespace despot {
 
@@ -85,6 +87,45 @@ public:
 	void ComputePreference(const State& state);
 };
 
+/* =============================================================================
+ * POMCPTranspositionTable class
+ * =============================================================================*/
+
+/**
+ * Belief nodes of a POMCP search keyed by the depth and the last observations
+ * of their history. Paths of different actions and observations that end in
+ * the same key share a single VNode, so its statistics are pooled across the
+ * transpositions and the tree becomes a DAG. The table owns all the nodes.
+ */
+class POMCPTranspositionTable {
+protected:
+	typedef std::unordered_map<unsigned long long, VNode*> KeyMap;
+
+	int window_;
+	int size_;
+	std::vector<KeyMap> nodes_; // nodes_[depth][key], so keys never collide across depths
+
+	static void Delete(std::vector<VNode*>& nodes);
+
+public:
+	/** window: number of last observations in the key */
+	POMCPTranspositionTable(int window);
+	virtual ~POMCPTranspositionTable();
+
+	VNode* Find(const History& history, int depth) const;
+	void Insert(const History& history, VNode* vnode);
+
+	/** Delete the nodes not reachable from root */
+	void Retain(VNode* root);
+	/** Remove the given nodes from the table without deleting them */
+	void Erase(const std::unordered_set<VNode*>& nodes);
+	void Clear();
+
+	inline int Size() const {
+		return size_;
+	}
+};
+
 /* =============================================================================
  * POMCP class
  * =============================================================================*/
@@ -94,16 +135,42 @@ protected:
 	VNode* root_;
 	POMCPPrior* prior_;
 	bool reuse_;
+	int num_sims_;
+	POMCPTranspositionTable* table_; // NULL without transpositions
+	/** Particles of SearchWhileWaiting, kept between its slices until the belief changes */
+	std::vector<State*> waiting_particles_;
+	int next_waiting_particle_;
+
+	void CreateRoot();
+	void DeleteTree();
+	/** Number of belief nodes, from the subtree statistics of the root's q-nodes */
+	int TreeSize() const;
+	/**
+	 * Rebuild the subtree statistics after Retain: a node shared between
+	 * branches is counted below the q-node it is first reached through.
+	 */
+	void RecountTree();
+	/** Evict nodes if config.max_tree_nodes is exceeded */
+	void ApplyNodeBudget();
+	/** Delete up to num least visited nodes whose children are all evicted, returns the number deleted */
+	int EvictColdNodes(int num);
+	void FreeWaitingParticles();
 
 public:
 	POMCP(const DSPOMDP* model, POMCPPrior* prior, Belief* belief = NULL);
+	/** Deletes the tree, the transposition table and the prior (the belief is deleted by its owner) */
+	virtual ~POMCP();
 	virtual ValuedAction Search();
 	virtual ValuedAction Search(double timeout);
 	virtual void Search(TreeDevelopThread * threadData, int action) override;
+	/// develop subtree of action (kept for next step only when reusing tree)
+	virtual bool SearchWhileWaiting(int action, double timeout) override;
 
 	inline VNode* root() const { return root_; };
 
 	void reuse(bool r);
+	/** Share belief nodes with the same last window observations (0 for none) */
+	void transposition(int window);
 	virtual void belief(Belief* b);
 	virtual void Update(int action, OBS_TYPE obs);
 
@@ -112,13 +179,25 @@ public:
 
 	virtual void GetTreeProperties(Tree_Properties & treeProp) const override;
 	virtual void GetSingleActionTreeProp(SingleNodeTreeProp & treeProp, int action) const override;
+	virtual int NumSimulations() const override { return num_sims_; };
 
 	void SaveTreeInFile(std::ofstream & out) const;
 
 	static VNode* CreateVNode(int depth, const State*, POMCPPrior* prior,
 		const DSPOMDP* model);
-	static double Simulate(State* particle, VNode* root, const DSPOMDP* model, POMCPPrior* prior);
-	static double Simulate(State* particle, VNode* root, const DSPOMDP* model, POMCPPrior* prior, int firstAction);
+	/**
+	 * Child of qnode to continue a simulation with after observing obs: the
+	 * existing child, a node shared through table if progressive widening
+	 * allows a new child, or, when it allows none, an existing child sampled
+	 * by its visits (obs and the prior's history are changed to its
+	 * observation). NULL if a new child should be created.
+	 */
+	static VNode* FindChild(QNode* qnode, OBS_TYPE& obs, int depth,
+		POMCPPrior* prior, POMCPTranspositionTable* table);
+	static double Simulate(State* particle, VNode* root, const DSPOMDP* model, POMCPPrior* prior,
+		POMCPTranspositionTable* table = NULL);
+	static double Simulate(State* particle, VNode* root, const DSPOMDP* model, POMCPPrior* prior, int firstAction,
+		POMCPTranspositionTable* table = NULL);
 
 	static double Simulate(State* particle, RandomStreams& streams,
 		VNode* vnode, const DSPOMDP* model, POMCPPrior* prior);
@@ -0,0 +1,46 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+namespace despot {
+
+/**
+ * Read-only memory mapping of a whole file. The mapping is released on
+ * Close() or destruction.
+ */
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/** Map the file. Returns false if it does not exist or is empty */
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const {
+		return data_ != NULL;
+	}
+	const char* data() const {
+		return data_;
+	}
+	size_t size() const {
+		return size_;
+	}
+
+private:
+	const char* data_;
+	size_t size_;
+#ifdef _WIN32
+	void* file_;
+	void* mapping_;
+#endif
+};
+
+} // namespace despot
+
+#endif
@@ -2,7 +2,6 @@
 #define RANDOM_H
 
 #include <vector>
-#include <map>
 
 namespace despot {
 
@@ -13,7 +12,16 @@ private:
 public:
 	static Random RANDOM;
 
-	static std::map<int, Random> s_threadSafeRand;
+	/// largest value of NextUnsigned
+	static const unsigned MAX_UNSIGNED = 0x7fffffff;
+
+	/// random of the current thread (each thread has its own so it is read and set without locking).
+	/// a thread not calling InitThreadRand is seeded by the thread seed base mixed with the number of the thread
+	static thread_local Random s_threadRand;
+	/// set random of current thread
+	static void InitThreadRand(const Random & ran);
+	/// set base of seeds of threads not calling InitThreadRand (set by Seeds::root_seed)
+	static void ThreadSeedBase(unsigned seed);
 
 	Random();
 	Random(double seed);
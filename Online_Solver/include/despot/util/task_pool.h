@@ -0,0 +1,87 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace despot {
+
+/**
+ * Work-stealing pool of worker threads. Worker 0 is the thread that owns the
+ * pool (it runs tasks only while waiting for them). Each worker pushes and pops
+ * tasks at the back of its own queue, and idle workers steal from the front of
+ * the other queues. A task gets the index of the worker running it so it can
+ * submit subtasks and wait for them without blocking a worker. Each task runs
+ * with the thread random seeded when it was submitted, so for a fixed seed the
+ * results do not depend on which worker ran which task.
+ */
+class TaskPool {
+public:
+	typedef std::function<void(int worker)> Task;
+
+	/**
+	 * Tasks submitted together. Wait() returns when all tasks of the group
+	 * are done.
+	 */
+	class Group {
+	public:
+		Group() : pending_(0) {}
+
+	private:
+		std::atomic<int> pending_;
+		friend class TaskPool;
+	};
+
+	/**
+	 * @param num_workers number of workers including the owning thread
+	 * @param seed seed of the thread random of worker threads
+	 */
+	TaskPool(int num_workers, unsigned seed);
+	~TaskPool();
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+
+	int NumWorkers() const {
+		return queues_.size();
+	}
+
+	void Submit(Group& group, int worker, const Task& task);
+	/** Run tasks until all tasks of group are done */
+	void Wait(Group& group, int worker);
+
+private:
+	struct Entry {
+		Task task;
+		Group* group;
+		/// seed of the thread random while the task runs
+		unsigned seed;
+	};
+
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Entry> entries;
+	};
+
+	/** Run one task (own queue first). Return false if no task was found */
+	bool RunOne(int worker);
+	void WorkerMain(int worker, unsigned seed);
+
+	std::vector<std::unique_ptr<Queue> > queues_;
+	std::vector<std::thread> threads_;
+
+	std::atomic<int> num_queued_;
+	std::atomic<bool> stop_;
+	std::mutex idle_mutex_;
+	std::condition_variable idle_cond_;
+};
+
+} // namespace despot
+
+#endif
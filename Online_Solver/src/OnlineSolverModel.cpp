@@ -1,5 +1,6 @@
 #include <string>
 #include <math.h>
+#include <cstring>
 
 #include "../include/despot/OnlineSolverModel.h"
 
@@ -24,8 +25,9 @@ bool OnlineSolverModel::s_isExternalSimulator = false;
 bool OnlineSolverModel::s_toSendTree = false;
 bool OnlineSolverModel::s_treeReuse = false;
 
-UDP_Server OnlineSolverModel::s_udpSimulator;
+UDP_Receiver OnlineSolverModel::s_udpSimulator;
 UDP_Server OnlineSolverModel::s_udpTree;
+TreeSender OnlineSolverModel::s_treeSender;
 
 // for memory allocating
 std::mutex OnlineSolverModel::s_memoryMutex;
@@ -52,6 +54,7 @@ bool OnlineSolverModel::InitUDP(int vbsPort, int sendTreePort)
 		char c;
 		s_udpTree.Read(&c);
 		s_toSendTree = c;
+		s_treeSender.Init(&s_udpTree);
 	}
 	else
 		s_toSendTree = false;
@@ -72,100 +75,31 @@ void OnlineSolverModel::InitSolverParams(bool isOnline, bool parallelRun, bool t
 	s_treeReuse = treeReuse;
 }
 
-void OnlineSolverModel::SendEndRun()
+void OnlineSolverModel::InitTreeSendParams(int maxDepth, int keyFrameInterval)
 {
-	unsigned int buf[1];
+	s_treeSender.SetParams(maxDepth, keyFrameInterval);
+}
 
-	buf[0] = END_RUN;
-	s_udpTree.Write(reinterpret_cast<char *>(buf), 1 * sizeof (int));
+void OnlineSolverModel::SendEndRun()
+{
+	uintVec buf{ TreeSender::END_RUN };
+	s_treeSender.SendControlMsg(buf);
 }
 
 
 void OnlineSolverModel::SendModelDetails2TreeVisualizator(int numActions)
 {
 	// insert to unsigned int for sending tree compatibility
-	unsigned int buf[4];
-
-	buf[0] = START_NEW_TRIAL;
-	buf[1] = numActions;
-	buf[2] = END_TREE;
-
-	s_udpTree.Write(reinterpret_cast<char *>(buf), 4 * sizeof (int));
+	uintVec buf{ TreeSender::START_NEW_TRIAL, static_cast<unsigned int>(numActions), 0, TreeSender::END_TREE };
+	s_treeSender.SendControlMsg(buf);
 }
 
 void OnlineSolverModel::SendTree(State * state, VNode *root)
 {
-	// create tree
-	uintVec buffer;
-
-	buffer.emplace_back(START_NEW_STEP);
-
-	InsertState2Buffer(buffer, state);
-
-	SendTreeRec(root, 0, 1, buffer);
-
-	buffer.emplace_back(END_TREE);
-
-	// send to client
-	int sent = 0;
-	// to make sure bufsize is divided by sizeof int
-	int maxWrite = UDP_Server::s_BUF_LEN - UDP_Server::s_BUF_LEN % sizeof(int);
-	while ( sent < (buffer.size()) )
-	{
-		char *ptr = reinterpret_cast<char *>(&buffer[sent]);
-		int leftToWrite = buffer.size() - sent;
-		int size = min(leftToWrite * sizeof(int), maxWrite);
-		s_udpTree.Write(ptr, size);
-		sent += size / sizeof(int);
-	}
-}
-
-unsigned int OnlineSolverModel::SendTreeRec(VNode *node, unsigned int parentId, unsigned int id, uintVec & buffer)
-{
-	if (node == nullptr || node->count() == 0)
-		return id - 1;
-
-	float val = node->value();
-	unsigned int count = node->count();
-
-	buffer.emplace_back(parentId);
-	buffer.emplace_back(id);
-	buffer.emplace_back(*reinterpret_cast<int *>(&val));
-	buffer.emplace_back(count);
-
-	int numch = node->children().size() + 1;
-	int nextId = id + node->children().size();
-	int actionId = id + 1;
-	for (auto action : node->children())
-	{
-		nextId = SendTreeRec(action, id, actionId, nextId, buffer);
-		++actionId;
-	}
-
-	return nextId;
-}
-
-unsigned int OnlineSolverModel::SendTreeRec(QNode *node, unsigned int parentId, unsigned int id, unsigned int nextAvailableId, uintVec & buffer)
-{
-	if (node == nullptr) 
-		return id; // for action node need to remember id for completion of non initialized nodes
-
-	float val = node->value();
-	unsigned int count = node->count();
+	uintVec stateBuffer;
+	InsertState2Buffer(stateBuffer, state);
 
-	buffer.emplace_back(parentId);
-	buffer.emplace_back(id);
-	buffer.emplace_back(*reinterpret_cast<int *>(&val));
-	buffer.emplace_back(count);
-
-	int nextId = nextAvailableId;
-	for (auto obs : node->children())
-	{
-		++nextId;
-		nextId = SendTreeRec(obs.second, id, nextId, buffer);
-	}
-
-	return nextId;
+	s_treeSender.SendTree(stateBuffer, root);
 }
 
 
@@ -258,10 +192,19 @@ void OnlineSolverModel::SendAction(int action)
 	s_udpSimulator.Write(reinterpret_cast<char *>(&a), sizeof(char));
 }
 
+bool OnlineSolverModel::WaitState(int timeoutMs)
+{
+	return s_udpSimulator.Wait(timeoutMs);
+}
+
 bool OnlineSolverModel::RcvState(State * s, double & reward, OBS_TYPE & obs)
 {
-	intVec buffer(100);
-	int length = s_udpSimulator.Read(reinterpret_cast<char *>(&buffer[0]));
+	std::vector<char> msg;
+	s_udpSimulator.Read(msg);
+
+	intVec buffer(std::max<int>(100, msg.size() / sizeof(int)));
+	if (msg.size() > 0)
+		memcpy(&buffer[0], &msg[0], msg.size() - msg.size() % sizeof(int));
 
 	return RcvStateIMP(buffer, s, reward, obs);
 }
@@ -3,6 +3,7 @@
 
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 
 namespace despot
 {
@@ -19,6 +20,8 @@ struct TreeMngrThread
 
 	std::mutex m_mainMutex;
 	std::mutex m_flagsMutex;
+	/// notified on every change of the flags
+	std::condition_variable m_flagsCond;
 
 	bool m_actionNeeded;
 	bool m_observationRecieved;
@@ -33,22 +36,30 @@ struct TreeDevelopThread
 {
 	TreeDevelopThread()
 	: m_toDevelop(false)
+	, m_developCount(0)
 	, m_toUpdate(false)
 	, m_terminal(false)
+	, m_stop(false)
 	{};
 
 	TreeDevelopThread(const TreeDevelopThread &) = delete;
 	TreeDevelopThread &operator=(const TreeDevelopThread &) = delete;
 
 	std::mutex m_treeFlagsMutex;
+	/// notified on every change of the flags
+	std::condition_variable m_treeFlagsCond;
 	
 	int m_actionToUpdate;
 	OBS_TYPE m_obsToUpdate;
 	float m_value;
 
 	bool m_toDevelop;
+	/// number of searches requested (a search is run even if develop flag was turned off before the thread noticed it)
+	int m_developCount;
 	bool m_toUpdate;
 	bool m_terminal;
+	/// thread exits (solver is deleted)
+	bool m_stop;
 };
 
 } // ns despot
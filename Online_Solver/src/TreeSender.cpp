@@ -0,0 +1,246 @@
+#include "../include/despot/TreeSender.h"
+
+#include <cstring>
+
+#include "../include/despot/core/node.h"
+
+namespace despot
+{
+
+/* =============================================================================
+* TreeSender Functions
+* =============================================================================*/
+
+TreeSender::TreeSender()
+: m_sock(nullptr)
+, m_maxDepth(s_NO_DEPTH_LIMIT)
+, m_keyFrameInterval(20)
+, m_sentNodes()
+, m_nextId(1)
+, m_frameSeq(0)
+, m_isKeyFrame(true)
+, m_framesSinceKeyFrame(0)
+, m_fillBuffer()
+, m_pendingBuffer()
+, m_sendBuffer()
+, m_mutex()
+, m_cond()
+, m_isPending(false)
+, m_isSending(false)
+, m_stop(false)
+, m_thread()
+{
+}
+
+TreeSender::~TreeSender()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cond.notify_all();
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void TreeSender::Init(UDP_Server * sock)
+{
+	m_sock = sock;
+	if (!m_thread.joinable())
+		m_thread = std::thread([this] { this->SenderMainFunction(); });
+}
+
+void TreeSender::SetParams(int maxDepth, int keyFrameInterval)
+{
+	m_maxDepth = maxDepth;
+	m_keyFrameInterval = keyFrameInterval;
+}
+
+void TreeSender::SendTree(const std::vector<unsigned int> & state, VNode * root)
+{
+	{ // if the previous frame was not sent it will be dropped so the current frame cannot be a delta
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_isPending)
+			m_isKeyFrame = true;
+	}
+
+	if (m_framesSinceKeyFrame >= m_keyFrameInterval)
+		m_isKeyFrame = true;
+
+	++m_frameSeq;
+	std::vector<unsigned int> & frame = m_fillBuffer;
+	frame.clear();
+
+	// seq is used by sender for datagrams header (not part of payload)
+	frame.emplace_back(m_frameSeq);
+	frame.emplace_back(m_isKeyFrame);
+	int rootIdIdx = frame.size();
+	frame.emplace_back(0);
+	frame.emplace_back(state.size());
+	frame.insert(frame.end(), state.begin(), state.end());
+	int numNodesIdx = frame.size();
+	frame.emplace_back(0);
+
+	unsigned int rootId = 0;
+	if (root != nullptr && root->count() > 0)
+		rootId = SnapshotRec(root, 0, 0, true, frame);
+
+	frame[rootIdIdx] = rootId;
+	frame[numNodesIdx] = (frame.size() - numNodesIdx - 1) / s_NUM_VALS_IN_NODE;
+	int numRemovedIdx = frame.size();
+	frame.emplace_back(0);
+
+	// forget nodes that are not in the tree anymore (a delta frame removes them from the visualizer tree)
+	for (auto itr = m_sentNodes.begin(); itr != m_sentNodes.end();)
+	{
+		if (itr->second.m_frameSeq != m_frameSeq)
+		{
+			if (!m_isKeyFrame)
+				frame.emplace_back(itr->second.m_id);
+			itr = m_sentNodes.erase(itr);
+		}
+		else
+			++itr;
+	}
+
+	frame[numRemovedIdx] = frame.size() - numRemovedIdx - 1;
+	frame.emplace_back(END_TREE);
+
+	m_framesSinceKeyFrame = m_isKeyFrame ? 0 : m_framesSinceKeyFrame + 1;
+	m_isKeyFrame = false;
+
+	{ // pass frame to sender
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_fillBuffer.swap(m_pendingBuffer);
+		m_isPending = true;
+	}
+	m_cond.notify_all();
+}
+
+void TreeSender::SendControlMsg(std::vector<unsigned int> & msg)
+{
+	Flush();
+	m_sock->Write(reinterpret_cast<char *>(&msg[0]), msg.size() * sizeof(int));
+	m_isKeyFrame = true;
+}
+
+unsigned int TreeSender::SnapshotRec(VNode * node, unsigned int parentId, int depth, bool isRoot, std::vector<unsigned int> & frame)
+{
+	unsigned int id = InsertNode(node, parentId, 0, node->count(), node->value(), isRoot, frame);
+
+	// actions are sent with their idx, their ids are not following the node id (actions without node are not sent)
+	for (unsigned int a = 0; a < node->children().size(); ++a)
+	{
+		QNode * action = node->children()[a];
+		if (action == nullptr)
+			continue;
+
+		unsigned int actionId = InsertNode(action, id, a, action->count(), action->value(), false, frame);
+		if (m_maxDepth == s_NO_DEPTH_LIMIT || depth < m_maxDepth)
+			SnapshotRec(action, actionId, depth, frame);
+	}
+
+	return id;
+}
+
+void TreeSender::SnapshotRec(QNode * node, unsigned int id, int depth, std::vector<unsigned int> & frame)
+{
+	for (auto obs : node->children())
+	{
+		if (obs.second != nullptr && obs.second->count() > 0)
+			SnapshotRec(obs.second, id, depth + 1, false, frame);
+	}
+}
+
+unsigned int TreeSender::InsertNode(const void * node, unsigned int parentId, unsigned int action, unsigned int count, float value, bool isRoot, std::vector<unsigned int> & frame)
+{
+	size_t prevSize = m_sentNodes.size();
+	SentNode & sent = m_sentNodes[node];
+	// the address may be reused by a new node (identified by a different parent)
+	bool isNew = m_sentNodes.size() != prevSize || (!isRoot && sent.m_parentId != parentId);
+	if (isNew)
+		sent.m_id = m_nextId++;
+
+	bool isChanged = isNew || m_isKeyFrame || sent.m_parentId != parentId || sent.m_action != action || sent.m_count != count || sent.m_value != value;
+
+	sent.m_parentId = parentId;
+	sent.m_action = action;
+	sent.m_count = count;
+	sent.m_value = value;
+	sent.m_frameSeq = m_frameSeq;
+
+	if (isChanged)
+	{
+		unsigned int valueBits;
+		std::memcpy(&valueBits, &value, sizeof(valueBits));
+
+		frame.emplace_back(parentId);
+		frame.emplace_back(sent.m_id);
+		frame.emplace_back(valueBits);
+		frame.emplace_back(count);
+		frame.emplace_back(action);
+	}
+
+	return sent.m_id;
+}
+
+void TreeSender::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cond.wait(lock, [this] { return (!m_isPending && !m_isSending) || m_stop; });
+}
+
+void TreeSender::SenderMainFunction()
+{
+	while (true)
+	{
+		{ // wait for frame
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cond.wait(lock, [this] { return m_isPending || m_stop; });
+			if (m_stop)
+				return;
+
+			m_sendBuffer.swap(m_pendingBuffer);
+			m_isPending = false;
+			m_isSending = true;
+		}
+
+		WriteFrame(m_sendBuffer);
+
+		{ // wake Flush
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isSending = false;
+		}
+		m_cond.notify_all();
+	}
+}
+
+void TreeSender::WriteFrame(const std::vector<unsigned int> & frame)
+{
+	unsigned int frameSeq = frame[0];
+	auto payload = frame.begin() + 1;
+	int payloadSize = frame.size() - 1;
+
+	int maxChunk = UDP_Server::s_BUF_LEN / sizeof(int) - s_NUM_HEADER_VALS;
+	unsigned int numChunks = (payloadSize + maxChunk - 1) / maxChunk;
+
+	std::vector<unsigned int> datagram;
+	datagram.reserve(UDP_Server::s_BUF_LEN / sizeof(int));
+	for (unsigned int chunk = 0; chunk < numChunks; ++chunk)
+	{
+		datagram.clear();
+		datagram.emplace_back(START_NEW_STEP);
+		datagram.emplace_back(frameSeq);
+		datagram.emplace_back(chunk);
+		datagram.emplace_back(numChunks);
+
+		auto start = payload + chunk * maxChunk;
+		auto end = chunk + 1 == numChunks ? frame.end() : start + maxChunk;
+		datagram.insert(datagram.end(), start, end);
+
+		m_sock->Write(reinterpret_cast<char *>(&datagram[0]), datagram.size() * sizeof(int));
+	}
+}
+
+} // end ns despot
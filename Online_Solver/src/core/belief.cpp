@@ -28,7 +28,7 @@ namespace despot {
 	vector<State*> Belief::Sample(int num, vector<State*> particles,
 		const DSPOMDP* model) {
 		double unit = 1.0 / num;
-		double mass = Random::RANDOM.NextDouble(0, unit);
+		double mass = Random::s_threadRand.NextDouble(0, unit);
 		int pos = 0;
 		double cur = particles[0]->weight;
 
@@ -64,7 +64,7 @@ namespace despot {
 		const DSPOMDP* model, History history, int hstart) 
 	{
 		double unit = 1.0 / num;
-		double mass = Random::RANDOM.NextDouble(0, unit);
+		double mass = Random::s_threadRand.NextDouble(0, unit);
 		int pos = 0;
 		double cur = belief[0]->weight;
 
@@ -94,7 +94,7 @@ namespace despot {
 			double log_wgt = 0;
 			for (int i = hstart; i < history.Size(); i++) 
 			{
-				model->Step(*particle, Random::RANDOM.NextDouble(), history.Action(i), reward, obs);
+				model->Step(*particle, Random::s_threadRand.NextDouble(), history.Action(i), reward, obs);
 
 				double prob = model->ObsProb(history.Observation(i), *particle,
 					history.Action(i));
@@ -192,7 +192,7 @@ namespace despot {
 			// Step through history
 			double log_wgt = 0;
 			for (int i = hstart; i < history.Size(); i++) {
-				belief.model_->Step(*particle, Random::RANDOM.NextDouble(),
+				belief.model_->Step(*particle, Random::s_threadRand.NextDouble(),
 					history.Action(i), reward, obs);
 
 				double prob = belief.model_->ObsProb(history.Observation(i),
@@ -341,7 +341,7 @@ namespace despot {
 		// Update particles
 		for (int i = 0; i <particles_.size(); i++) {
 			State* particle = particles_[i];
-			bool terminal = model_->Step(*particle, Random::RANDOM.NextDouble(),
+			bool terminal = model_->Step(*particle, Random::s_threadRand.NextDouble(),
 				action, reward, o);
 			double prob = model_->ObsProb(obs, *particle, action);
 
@@ -37,6 +37,10 @@ ScenarioLowerBound::ScenarioLowerBound(const DSPOMDP* model, Belief* belief) :
 void ScenarioLowerBound::Init(const RandomStreams& streams) {
 }
 
+void ScenarioLowerBound::Shift(const RandomStreams& streams) {
+	Init(streams);
+}
+
 void ScenarioLowerBound::Reset() {
 }
 
@@ -1,4 +1,9 @@
 #include "../../include/despot/core/mdp.h"
+#include "../../include/despot/util/task_pool.h"
+
+#include <algorithm>
+#include <thread>
+#include <memory>
 
 using namespace std;
 
@@ -7,98 +12,196 @@ namespace despot {
 MDP::~MDP() {
 }
 
-void MDP::ComputeOptimalPolicyUsingVI() {
-	if (policy_.size() != 0)
+void MDP::BuildTransitionMatrix() {
+	if (transition_start_.size() != 0)
 		return;
 
 	int num_states = NumStates(), num_actions = NumActions();
-	policy_.resize(num_states);
+	transition_start_.resize(num_states * num_actions + 1);
+	reward_.resize(num_states * num_actions);
 
-	policy_ = vector<ValuedAction>(num_states);
+	int num_entries = 0;
 	for (int s = 0; s < num_states; s++) {
-		policy_[s].value = 0;
+		for (int a = 0; a < num_actions; a++) {
+			transition_start_[s * num_actions + a] = num_entries;
+			num_entries += TransitionProbability(s, a).size();
+		}
+	}
+	transition_start_[num_states * num_actions] = num_entries;
+
+	transition_next_.resize(num_entries);
+	transition_prob_.resize(num_entries);
+	for (int s = 0; s < num_states; s++) {
+		for (int a = 0; a < num_actions; a++) {
+			int row = s * num_actions + a;
+			reward_[row] = Reward(s, a);
+
+			const vector<State>& transition = TransitionProbability(s, a);
+			for (int i = 0; i < transition.size(); i++) {
+				assert(transition[i].state_id >= 0);
+				transition_next_[transition_start_[row] + i] = transition[i].state_id;
+				transition_prob_[transition_start_[row] + i] = transition[i].weight;
+			}
+		}
+	}
+}
+
+/**
+ * Number of threads of value iteration.
+ */
+static int NumVIThreads(int num_jobs) {
+	int num_threads = Globals::config.num_vi_threads;
+	if (num_threads <= 0)
+		num_threads = max(1, (int) thread::hardware_concurrency());
+	return min(num_threads, max(num_jobs, 1));
+}
+
+/**
+ * Run job(i) for i in [0, num_jobs), on pool when given.
+ */
+static void RunJobs(TaskPool* pool, int num_jobs, const function<void(int)>& job) {
+	if (pool == NULL) {
+		for (int i = 0; i < num_jobs; i++)
+			job(i);
+		return;
 	}
 
-	clock_t start = clock();
+	TaskPool::Group group;
+	for (int i = 0; i < num_jobs; i++)
+		pool->Submit(group, 0, [&job, i](int worker) { job(i); });
+	pool->Wait(group, 0);
+}
+
+void MDP::ComputeOptimalPolicyUsingVI() {
+	if (policy_.size() != 0)
+		return;
+
+	double start = get_time_second();
 	logi << "[MDP::ComputeOptimalPolicyUsingVI] Computing optimal MDP policy...";
-	vector<ValuedAction> next_policy = vector<ValuedAction>(num_states);
+	BuildTransitionMatrix();
 
-	int iter = 0;
-	double diff;
-	while (true) {
-		for (int s = 0; s < num_states; s++) {
-			next_policy[s].action = -1;
-			next_policy[s].value = Globals::NEG_INFTY;
+	int num_states = NumStates(), num_actions = NumActions();
+	double discount = Globals::Discount();
 
-			for (int a = 0; a < num_actions; a++) {
-				double v = Reward(s, a);
-				const vector<State>& transition = TransitionProbability(s, a);
-				for (int i = 0; i < transition.size(); i++) {
-					const State& next = transition[i];
-					assert(next.state_id >= 0);
-					v += next.weight * Globals::Discount()
-						* policy_[next.state_id].value;
-				}
+	// stop when values are within 1e-6 of the fixed point
+	double tol = discount < 1 ? 1E-6 * (1 - discount) / discount : 1E-6;
+
+	int num_threads = NumVIThreads(num_states);
+	unique_ptr<TaskPool> pool(num_threads > 1 ?
+		new TaskPool(num_threads, Globals::config.root_seed) : NULL);
+	// values are updated in place only when no other thread reads them
+	bool in_place = Globals::config.vi_gauss_seidel && num_threads == 1;
+
+	// states are swept in blocks, several per thread for balancing the load
+	int num_blocks = min(num_states, num_threads * 4);
+	int block_size = num_blocks > 0 ? (num_states + num_blocks - 1) / num_blocks : 0;
+	vector<double> block_diff(num_blocks);
+
+	vector<double> value(num_states, 0), next_value(num_states);
+	vector<int> action(num_states, -1);
+
+	const int* start_row = transition_start_.empty() ? NULL : &transition_start_[0];
+	const int* next_state = transition_next_.empty() ? NULL : &transition_next_[0];
+	const double* prob = transition_prob_.empty() ? NULL : &transition_prob_[0];
+
+	auto sweep = [&](int block) {
+		int first = block * block_size;
+		int last = min(num_states, first + block_size);
+		const double* prev = &value[0];
+		double* cur = in_place ? &value[0] : &next_value[0];
+		double diff = 0;
+
+		for (int s = first; s < last; s++) {
+			double best = Globals::NEG_INFTY;
+			int best_action = -1;
 
-				if (v > next_policy[s].value) {
-					next_policy[s].value = v;
-					next_policy[s].action = a;
+			for (int a = 0; a < num_actions; a++) {
+				int row = s * num_actions + a;
+				double sum = 0;
+				for (int i = start_row[row]; i < start_row[row + 1]; i++)
+					sum += prob[i] * prev[next_state[i]];
+
+				double v = reward_[row] + discount * sum;
+				if (v > best) {
+					best = v;
+					best_action = a;
 				}
 			}
-		}
 
-		diff = 0;
-		for (int s = 0; s < num_states; s++) {
-			diff += fabs(next_policy[s].value - policy_[s].value);
-			policy_[s] = next_policy[s];
+			diff = max(diff, fabs(best - prev[s]));
+			cur[s] = best;
+			action[s] = best_action;
 		}
 
+		block_diff[block] = diff;
+	};
+
+	int iter = 0;
+	double diff = 0;
+	while (num_states > 0) {
+		RunJobs(pool.get(), num_blocks, sweep);
+		if (!in_place)
+			value.swap(next_value);
+
+		diff = *max_element(block_diff.begin(), block_diff.end());
 		iter++;
-		if (diff < 1E-6)
+		if (diff < tol)
 			break;
 	}
+
+	policy_.resize(num_states);
+	for (int s = 0; s < num_states; s++) {
+		policy_[s].value = value[s];
+		policy_[s].action = action[s];
+	}
+
 	logi << "Done [" << iter << " iters, tol = " << diff << ", "
-		<< (double) (clock() - start) / CLOCKS_PER_SEC << "s]!" << endl;
+		<< num_threads << " threads, " << (get_time_second() - start) << "s]!"
+		<< endl;
 }
 
 void MDP::ComputeBlindAlpha() {
+	BuildTransitionMatrix();
+
 	int num_states = NumStates(), num_actions = NumActions();
+	double discount = Globals::Discount();
 
 	blind_alpha_.resize(num_actions);
+	vector<double> tols(num_actions);
+	vector<int> iters(num_actions);
 
-	for (int action = 0; action < num_actions; action++) {
+	// the alpha vector of each action is an independent job
+	int num_threads = NumVIThreads(num_actions);
+	unique_ptr<TaskPool> pool(num_threads > 1 ?
+		new TaskPool(num_threads, Globals::config.root_seed) : NULL);
+
+	RunJobs(pool.get(), num_actions, [&](int action) {
 		vector<double> cur(num_states), prev(num_states);
 
 		double min = Globals::POS_INFTY;
 		for (int s = 0; s < num_states; s++) {
-			double reward = Reward(s, action);
+			double reward = reward_[s * num_actions + action];
 			if (reward < min)
 				min = reward;
 		}
 
 		for (int s = 0; s < num_states; s++)
-			cur[s] = min / (1 - Globals::Discount());
+			cur[s] = min / (1 - discount);
 
 		double tol = 0;
 		int iter = 0;
 		for (iter = 0; iter < 1000; iter++) {
 			tol = 0;
-
-			for (int s = 0; s < num_states; s++)
-				prev[s] = cur[s];
+			cur.swap(prev);
 
 			for (int s = 0; s < num_states; s++) {
-				cur[s] = 0;
-				const vector<State>& transition = TransitionProbability(s,
-					action);
-				for (int i = 0; i < transition.size(); i++) {
-					const State& next = transition[i];
-					assert(next.state_id >= 0);
-					cur[s] += next.weight * prev[next.state_id];
-				}
-				cur[s] = Reward(s, action) + Globals::Discount() * cur[s];
+				int row = s * num_actions + action;
+				double sum = 0;
+				for (int i = transition_start_[row]; i < transition_start_[row + 1]; i++)
+					sum += transition_prob_[i] * prev[transition_next_[i]];
+				cur[s] = reward_[row] + discount * sum;
 
-				tol += abs(cur[s] - prev[s]);
+				tol += fabs(cur[s] - prev[s]);
 			}
 
 			if (tol < 0.0001) {
@@ -106,10 +209,15 @@ void MDP::ComputeBlindAlpha() {
 				break;
 			}
 		}
-		logi << "[MDP::ComputeBlindAlpha] Tol(alpha_" << action << ") after " << iter << " iters = "
-			<< tol << endl;
 
-		blind_alpha_[action] = cur;
+		tols[action] = tol;
+		iters[action] = iter;
+		blind_alpha_[action].swap(cur);
+	});
+
+	for (int action = 0; action < num_actions; action++) {
+		logi << "[MDP::ComputeBlindAlpha] Tol(alpha_" << action << ") after "
+			<< iters[action] << " iters = " << tols[action] << endl;
 	}
 }
 
@@ -48,6 +48,19 @@ VNode::VNode(vector<State*>& particles, int depth, QNode* parent,
 	}
 }
 
+VNode::VNode(vector<State*>&& particles, int depth, QNode* parent,
+	OBS_TYPE edge) :
+	particles_(move(particles)),
+	belief_(NULL),
+	depth_(depth),
+	parent_(parent),
+	edge_(edge),
+	vstar(this),
+	likelihood(1) {
+	logd << "Constructed vnode with " << particles_.size() << " particles"
+		<< endl;
+}
+
 VNode::VNode(Belief* belief, int depth, QNode* parent, OBS_TYPE edge) :
 	belief_(belief),
 	depth_(depth),
@@ -261,6 +274,16 @@ int VNode::Height() // NATAN CHANGES
 	return maxHeight + 1;
 }
 
+void VNode::CountInAncestors(int num) {
+	int height = 1;
+	for (QNode* qnode = parent_; qnode != NULL; height++) {
+		qnode->subtree_stats(qnode->subtree_size() + num,
+			max(qnode->subtree_height(), num > 0 ? height : 0));
+		VNode* vnode = qnode->parent();
+		qnode = vnode != NULL ? vnode->parent() : NULL;
+	}
+}
+
 void  VNode::LevelSize(std::vector<double> & DividedSize, int currLevel)// NATAN CHANGES
 {
 	for (int a = 0; a < children_.size(); a++)
@@ -372,12 +395,16 @@ void VNode::PrintTree(int depth, ostream& os) {
 QNode::QNode(VNode* parent, int edge) :
 	parent_(parent),
 	edge_(edge),
+	subtree_size_(0),
+	subtree_height_(0),
 	vstar(NULL) {
 }
 
 QNode::QNode(int count, double value) :
 	count_(count),
-	value_(value) {
+	value_(value),
+	subtree_size_(0),
+	subtree_height_(0) {
 }
 
 QNode::~QNode() {
@@ -482,4 +509,17 @@ int QNode::height() const
 	return maxHeight;
 }
 
+int QNode::subtree_size() const {
+	return subtree_size_;
+}
+
+int QNode::subtree_height() const {
+	return subtree_height_;
+}
+
+void QNode::subtree_stats(int size, int height) {
+	subtree_size_ = size;
+	subtree_height_ = height;
+}
+
 } // namespace despot
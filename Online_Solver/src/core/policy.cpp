@@ -27,8 +27,7 @@ ValuedAction Policy::Value(const vector<State*>& particles,
 	for (int i = 0; i < particles.size(); i++)
 		copy.push_back(model_->Copy(particles[i]));
 
-	initial_depth_ = history.Size();
-	ValuedAction va = RecursiveValue(copy, streams, history);
+	ValuedAction va = RecursiveValue(copy, streams, history, history.Size());
 
 	for (int i = 0; i < copy.size(); i++)
 		model_->Free(copy[i]);
@@ -37,9 +36,9 @@ ValuedAction Policy::Value(const vector<State*>& particles,
 }
 
 ValuedAction Policy::RecursiveValue(const vector<State*>& particles,
-	RandomStreams& streams, History& history) const {
+	RandomStreams& streams, History& history, int initial_depth) const {
 	if (streams.Exhausted()
-		|| (history.Size() - initial_depth_
+		|| (history.Size() - initial_depth
 			>= Globals::config.max_policy_sim_len)) {
 		return particle_lower_bound_->Value(particles);
 	} else 
@@ -68,7 +67,7 @@ ValuedAction Policy::RecursiveValue(const vector<State*>& particles,
 			OBS_TYPE obs = it->first;
 			history.Add(action, obs);
 			streams.Advance();
-			ValuedAction va = RecursiveValue(it->second, streams, history);
+			ValuedAction va = RecursiveValue(it->second, streams, history, initial_depth);
 			value += Globals::Discount() * va.value;
 			streams.Back();
 			history.RemoveLast();
@@ -145,9 +144,9 @@ RandomPolicy::RandomPolicy(const DSPOMDP* model,
 int RandomPolicy::Action(const vector<State*>& particles,
 	RandomStreams& streams, History& history) const {
 	if (action_probs_.size() > 0) {
-		return Random::GetCategory(action_probs_, Random::RANDOM.NextDouble());
+		return Random::GetCategory(action_probs_, Random::s_threadRand.NextDouble());
 	} else {
-		return Random::RANDOM.NextInt(model_->NumActions());
+		return Random::s_threadRand.NextInt(model_->NumActions());
 	}
 }
 
@@ -155,10 +154,10 @@ ValuedAction RandomPolicy::Search() {
 	double dummy_value = Globals::NEG_INFTY;
 	if (action_probs_.size() > 0) {
 		return ValuedAction(
-			Random::GetCategory(action_probs_, Random::RANDOM.NextDouble()),
+			Random::GetCategory(action_probs_, Random::s_threadRand.NextDouble()),
 			dummy_value);
 	} else {
-		return ValuedAction(Random::RANDOM.NextInt(model_->NumActions()),
+		return ValuedAction(Random::s_threadRand.NextInt(model_->NumActions()),
 			dummy_value);
 	}
 }
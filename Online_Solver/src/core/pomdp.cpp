@@ -69,7 +69,7 @@ DSPOMDP::~DSPOMDP() {
 }
 
 bool DSPOMDP::Step(State& state, int action, double& reward, OBS_TYPE& obs) const {
-	return Step(state, Random::RANDOM.NextDouble(), action, reward, obs);
+	return Step(state, Random::s_threadRand.NextDouble(), action, reward, obs);
 }
 
 bool DSPOMDP::Step(State& state, double random_num, int action,
@@ -2,6 +2,13 @@
 #include "../../include/despot/core/pomdp.h"
 #include "../../include/despot/core/mdp.h"
 
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <typeinfo>
+
 using namespace std;
 
 namespace despot {
@@ -19,6 +26,10 @@ ScenarioUpperBound::~ScenarioUpperBound() {
 void ScenarioUpperBound::Init(const RandomStreams& streams) {
 }
 
+void ScenarioUpperBound::Shift(const RandomStreams& streams) {
+	Init(streams);
+}
+
 /* =============================================================================
  * ParticleUpperBound
  * =============================================================================*/
@@ -63,64 +74,251 @@ double TrivialParticleUpperBound::Value(const vector<State*>& particles,
  * LookaheadUpperBound
  * =============================================================================*/
 
+static const unsigned int LOOKAHEAD_CACHE_MAGIC = 0x3142554C; // "LUB1"
+
+struct LookaheadCacheHeader {
+	unsigned int magic;
+	int num_particles;
+	int length;
+	int num_states;
+	unsigned long long key;
+};
+
 LookaheadUpperBound::LookaheadUpperBound(const DSPOMDP* model,
 	const StateIndexer& indexer, ParticleUpperBound* bound) :
 	model_(model),
 	indexer_(indexer),
-	particle_upper_bound_(bound) {
+	particle_upper_bound_(bound),
+	bounds_(NULL),
+	length_(0),
+	num_states_(0) {
 }
 
-void LookaheadUpperBound::Init(const RandomStreams& streams) 
-{
-	int num_states = indexer_.NumStates();
-	int length = streams.Length();
+void LookaheadUpperBound::Init(const RandomStreams& streams) {
+	num_states_ = indexer_.NumStates();
+	length_ = streams.Length();
 	int num_particles = streams.NumStreams();
 
-	SetSize(bounds_, num_particles, length + 1, num_states);
+	double start = get_time_second();
+	string path;
+	unsigned long long key = 0;
+	if (Globals::config.bound_cache_dir != "") {
+		key = CacheKey(streams);
+		ostringstream name;
+		name << Globals::config.bound_cache_dir << "/lookahead_" << hex << key
+			<< ".bin";
+		path = name.str();
+
+		if (LoadCache(path, key, num_particles)) {
+			logi << "[LookaheadUpperBound::Init] Loaded " << path << " in "
+				<< (get_time_second() - start) << "s" << endl;
+			return;
+		}
+	}
 
-	clock_t start = clock();
-	for (int p = 0; p < num_particles; p++) {
-		if (p % 10 == 0)
-			cerr << p << " scenarios done! ["
-				<< (double(clock() - start) / CLOCKS_PER_SEC) << "s]" << endl;
-		for (int t = length; t >= 0; t--) {
-			if (t == length) { // base case
-				for (int s = 0; s < num_states; s++) {
-					bounds_[p][t][s] = particle_upper_bound_->Value(*indexer_.GetState(s));
-				}
-			} else { // lookahead
-				for (int s = 0; s < num_states; s++) {
+	Compute(streams);
+	logi << "[LookaheadUpperBound::Init] Computed " << num_particles
+		<< " scenarios in " << (get_time_second() - start) << "s" << endl;
+
+	if (path != "")
+		SaveCache(path, key, num_particles);
+}
+
+void LookaheadUpperBound::Compute(const RandomStreams& streams) {
+	int num_particles = streams.NumStreams();
+	int num_actions = model_->NumActions();
+	size_t depth_size = num_states_;
+	size_t scenario_size = (length_ + 1) * depth_size;
+
+	cache_.Close();
+	table_.assign(num_particles * scenario_size, 0);
+	bounds_ = table_.empty() ? NULL : &table_[0];
+
+	// base case does not depend on the scenario
+	vector<double> base(num_states_);
+	for (int s = 0; s < num_states_; s++)
+		base[s] = particle_upper_bound_->Value(*indexer_.GetState(s));
+
+	// each thread steps particles with its own model copy, as memory pools
+	// of models are not shared between threads. The copies may still share
+	// state with model_ (the parser of POMDPX), so models that are not
+	// thread safe are stepped by this thread only.
+	int num_threads = 1;
+	if (model_->IsThreadSafe())
+		num_threads = max(1, (int) thread::hardware_concurrency());
+	num_threads = min(num_threads, num_particles);
+	vector<DSPOMDP*> models(1, const_cast<DSPOMDP*>(model_));
+	for (int i = 1; i < num_threads; i++) {
+		DSPOMDP* copy = model_->MakeCopy();
+		if (copy == NULL)
+			break;
+		models.push_back(copy);
+	}
+
+	atomic<int> next_particle(0);
+	auto compute = [&](const DSPOMDP* model) {
+		for (int p = next_particle++; p < num_particles; p = next_particle++) {
+			double* scenario = &table_[p * scenario_size];
+			memcpy(scenario + length_ * depth_size, &base[0],
+				num_states_ * sizeof(double));
+
+			for (int t = length_ - 1; t >= 0; t--) {
+				double random_num = streams.Entry(p, t);
+				const double* next = scenario + (t + 1) * depth_size;
+				double* cur = scenario + t * depth_size;
+				for (int s = 0; s < num_states_; s++) {
 					double best = Globals::NEG_INFTY;
 
-					for (int a = 0; a < model_->NumActions(); a++) {
+					for (int a = 0; a < num_actions; a++) {
 						double reward = 0;
-						State* copy = model_->Copy(indexer_.GetState(s));
+						State* copy = model->Copy(indexer_.GetState(s));
 						// for adding observation adding the observation of step s (FRAGILE : obs = state_id) NATAN CHANGES 
-						bool terminal = model_->Step(*copy, streams.Entry(p, t), a, reward);
-						model_->Free(copy);
-						reward += (!terminal) * Globals::Discount()
-							* bounds_[p][t + 1][indexer_.GetIndex(copy)];
+						bool terminal = model->Step(*copy, random_num, a, reward);
+						if (!terminal)
+							reward += Globals::Discount() * next[indexer_.GetIndex(copy)];
+						model->Free(copy);
 
 						if (reward > best)
 							best = reward;
 					}
 
-					bounds_[p][t][s] = best;
+					cur[s] = best;
 				}
 			}
 		}
+	};
+
+	vector<thread> threads;
+	for (int i = 1; i < models.size(); i++)
+		threads.push_back(thread(compute, models[i]));
+	compute(model_);
+
+	for (int i = 0; i < threads.size(); i++)
+		threads[i].join();
+	for (int i = 1; i < models.size(); i++)
+		delete models[i];
+}
+
+unsigned long long LookaheadUpperBound::CacheKey(const RandomStreams& streams) const {
+	// FNV-1a
+	unsigned long long key = 14695981039346656037ULL;
+	auto add = [&key](const void* data, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++) {
+			key ^= bytes[i];
+			key *= 1099511628211ULL;
+		}
+	};
+
+	string name = typeid(*model_).name();
+	add(name.c_str(), name.size());
+	int sizes[] = { streams.NumStreams(), length_, num_states_, model_->NumActions() };
+	add(sizes, sizeof(sizes));
+	double discount = Globals::Discount();
+	add(&discount, sizeof(discount));
+	string params = model_->ParametersKey();
+	add(params.data(), params.size());
+	for (int p = 0; p < streams.NumStreams(); p++) {
+		for (int t = 0; t < length_; t++) {
+			double entry = streams.Entry(p, t);
+			add(&entry, sizeof(entry));
+		}
+	}
+
+	return key;
+}
+
+bool LookaheadUpperBound::LoadCache(const string& path, unsigned long long key,
+	int num_particles) {
+	if (!cache_.Open(path))
+		return false;
+
+	size_t table_size = (size_t) num_particles * (length_ + 1) * num_states_;
+	const LookaheadCacheHeader* header =
+		reinterpret_cast<const LookaheadCacheHeader*>(cache_.data());
+	if (cache_.size() != sizeof(LookaheadCacheHeader) + table_size * sizeof(double)
+		|| header->magic != LOOKAHEAD_CACHE_MAGIC || header->key != key
+		|| header->num_particles != num_particles || header->length != length_
+		|| header->num_states != num_states_) {
+		cerr << "Ignoring lookahead bound cache " << path
+			<< " (does not match the model)" << endl;
+		cache_.Close();
+		return false;
+	}
+
+	table_.clear();
+	table_.shrink_to_fit();
+	bounds_ = reinterpret_cast<const double*>(cache_.data()
+		+ sizeof(LookaheadCacheHeader));
+	return true;
+}
+
+void LookaheadUpperBound::SaveCache(const string& path, unsigned long long key,
+	int num_particles) const {
+	// written to a temporary file first so readers never map a partial table
+	string tmp_path = path + ".tmp";
+	ofstream out(tmp_path.c_str(), ios::binary | ios::trunc);
+	if (!out.is_open()) {
+		cerr << "Failed to write lookahead bound cache " << path << endl;
+		return;
+	}
+
+	LookaheadCacheHeader header = { LOOKAHEAD_CACHE_MAGIC, num_particles,
+		length_, num_states_, key };
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (!table_.empty())
+		out.write(reinterpret_cast<const char*>(&table_[0]),
+			table_.size() * sizeof(double));
+	out.close();
+
+#ifdef _WIN32
+	// rename does not replace an existing file on Windows, elsewhere it
+	// replaces it atomically and readers keep the old table until then
+	remove(path.c_str());
+#endif
+	if (out.fail() || rename(tmp_path.c_str(), path.c_str()) != 0) {
+		cerr << "Failed to write lookahead bound cache " << path << endl;
+		remove(tmp_path.c_str());
+	}
+}
+
+void LookaheadUpperBound::Shift(const RandomStreams& streams) {
+	size_t depth_size = num_states_;
+	size_t scenario_size = (length_ + 1) * depth_size;
+	int num_particles = streams.NumStreams();
+	if (bounds_ == NULL || streams.Length() != length_
+		|| (size_t) num_particles * scenario_size == 0) {
+		Init(streams);
+		return;
+	}
+
+	// a table mapped from the cache is read only
+	if (table_.empty()) {
+		table_.assign(bounds_, bounds_ + num_particles * scenario_size);
+		cache_.Close();
+		bounds_ = &table_[0];
+	}
+
+	// row t + 1 of the old streams is row t of the shifted ones, the last
+	// row (the particle upper bound) stays as it is
+	for (int p = 0; p < num_particles; p++) {
+		double* scenario = &table_[p * scenario_size];
+		memmove(scenario, scenario + depth_size,
+			length_ * depth_size * sizeof(double));
 	}
 }
 
 double LookaheadUpperBound::Value(const vector<State*>& particles,
 	RandomStreams& streams, History& history) const {
+	const double* bounds = bounds_ + streams.position() * num_states_;
+	size_t scenario_size = (size_t) (length_ + 1) * num_states_;
+
 	double bound = 0;
 	for (int i = 0; i < particles.size(); i++) {
 		State* particle = particles[i];
-		bound +=
-			particle->weight
-				* bounds_[particle->scenario_id][streams.position()][indexer_.GetIndex(
-					particle)];
+		bound += particle->weight
+			* bounds[particle->scenario_id * scenario_size
+				+ indexer_.GetIndex(particle)];
 	}
 	return bound;
 }
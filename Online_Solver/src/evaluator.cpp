@@ -9,6 +9,11 @@ using namespace std;
 
 namespace despot {
 
+/// time (sec) of search between checks for the simulator state
+static const double s_SEARCH_SLICE = 0.005;
+/// wait time for simulator state when solver is not searching
+static const int s_WAIT_STATE_MS = 100;
+
 inline int Max(int a, int b)
 {
 	return a * (a >= b) + b * (a < b);
@@ -163,13 +168,12 @@ void Evaluator::RunRoundForParallel(int round)
 		{
 			std::lock_guard<std::mutex> lock(treeMngrData.m_flagsMutex);
 			treeMngrData.m_actionNeeded = true;
+			treeMngrData.m_flagsCond.notify_all();
 		}
 		// wait for action is ready
-		bool actionRecieved = false;
-		while (!actionRecieved)
 		{
-			std::lock_guard<std::mutex> lock(treeMngrData.m_flagsMutex);
-			actionRecieved = treeMngrData.m_actionRecieved;
+			std::unique_lock<std::mutex> lock(treeMngrData.m_flagsMutex);
+			treeMngrData.m_flagsCond.wait(lock, [&treeMngrData] { return treeMngrData.m_actionRecieved; });
 		}
 
 		int action = -1;
@@ -192,6 +196,7 @@ void Evaluator::RunRoundForParallel(int round)
 			treeMngrData.m_observationRecieved = true;
 			treeMngrData.m_actionRecieved = false;
 			treeMngrData.m_terminal = terminal;
+			treeMngrData.m_flagsCond.notify_all();
 		}
 
 		// print data
@@ -840,6 +845,12 @@ bool POMDPEvaluator::ExecuteAction(int action, double& reward, OBS_TYPE& obs)
 	{
 		// send action to simulator
 		static_cast<OnlineSolverModel *>(model_)->SendAction(action);
+
+		// keep developing the tree of the chosen action until simulator returns the next state
+		bool isSearching = true;
+		while (!OnlineSolverModel::WaitState(isSearching ? 0 : s_WAIT_STATE_MS))
+			isSearching = solver_->SearchWhileWaiting(action, s_SEARCH_SLICE);
+
 		// read state and update reward and observation
 		terminal = static_cast<OnlineSolverModel *>(model_)->RcvState(state_, reward, obs);
 	}
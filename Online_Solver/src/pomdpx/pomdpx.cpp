@@ -33,13 +33,15 @@ string POMDPXState::text() const {
 POMDPX* POMDPX::current_ = NULL;
 int POMDPX::STATE_NUM_THRESHOLD = 1000000;
 
-POMDPX::POMDPX() {
+POMDPX::POMDPX() :
+	tables_(NULL) {
 	current_ = this;
 }
 
 POMDPX::POMDPX(string params_file) {
 	current_ = this;
 	parser_ = new Parser(params_file);
+	tables_ = POMDPXTables::Compile(*parser_);
 
 	max_reward_action_ = parser_->ComputeMaxRewardAction();
 	logi << "Max reward action = " << max_reward_action_ << " ";
@@ -92,6 +94,9 @@ void POMDPX::PrintModel(ostream& out) const {
 bool POMDPX::NoisyStep(State& s, double random_num, int action) const {
 	POMDPXState& state = static_cast<POMDPXState&>(s);
 
+	if (tables_ != NULL)
+		return tables_->NoisyStep(state.vec_id, random_num, action);
+
 	parser_->GetNoisyNextState(state.vec_id, action, random_num);
 
 	return parser_->IsTerminalState(state.vec_id);
@@ -101,6 +106,9 @@ bool POMDPX::Step(State& s, double random_num, int action, double& reward,
 	OBS_TYPE& obs) const {
 	POMDPXState& state = static_cast<POMDPXState&>(s);
 
+	if (tables_ != NULL)
+		return tables_->Step(state.vec_id, random_num, action, reward, obs);
+
 	parser_->GetNextState(state.vec_id, action, random_num);
 	reward = parser_->GetReward(action); // Prev state and curr state set in GetNextState
 	obs = parser_->GetObservation(state.vec_id, action, random_num);
@@ -119,11 +127,14 @@ int POMDPX::NumStates() const {
 double POMDPX::ObsProb(OBS_TYPE obs, const State& s, int a) const {
 	const POMDPXState& state = static_cast<const POMDPXState&>(s);
 
+	if (tables_ != NULL)
+		return tables_->ObsProb(obs, state.vec_id, a);
+
 	return parser_->ObsProb(obs, state.vec_id, a);
 }
 
 State* POMDPX::CreateStartState(string type) const {
-	double random_value = Random::RANDOM.NextDouble();
+	double random_value = Random::s_threadRand.NextDouble();
 	return new POMDPXState(parser_->ComputeState(random_value));
 }
 
@@ -155,7 +166,7 @@ public:
 				State* particle = particles_[j];
 				State* copy = model_->Copy(particle);
 
-				bool terminal = model_->Step(*copy, Random::RANDOM.NextDouble(), action, reward, o);
+				bool terminal = model_->Step(*copy, Random::s_threadRand.NextDouble(), action, reward, o);
 				double prob = model_->ObsProb(obs, *copy, action);
 
 				if (!terminal && prob) { // Terminal state is not required to be explicitly represented and may not have any observation
@@ -184,7 +195,7 @@ public:
 					State* copy = model_->Copy(particle);
 
 					bool terminal = model_->NoisyStep(*copy,
-						Random::RANDOM.NextDouble(), action);
+						Random::s_threadRand.NextDouble(), action);
 					double prob = model_->ObsProb(obs, *copy, action);
 
 					if (i == max_iter_ && prob < 1E-6) // NOTE: never kill a particle at the last iteration
@@ -261,7 +272,7 @@ vector<State*> POMDPX::ApproxInitialParticleSet() const {
 		<< "[POMDPX::ApproximatePrior] Drawing 1000 random particles from initial belief."
 		<< endl;
 	for (int i = 0; i < 1000; i++) {
-		double random_value = Random::RANDOM.NextDouble();
+		double random_value = Random::s_threadRand.NextDouble();
 		POMDPXState* state = static_cast<POMDPXState*>(Allocate(-1, 0.001));
 		state->vec_id = parser_->ComputeState(random_value);
 		particles.push_back(state);
@@ -535,24 +546,34 @@ void POMDPX::PrintAction(int action, ostream& out) const {
 }
 
 State* POMDPX::Allocate(STATE_TYPE state_id, double weight) const {
-	POMDPXState* particle = memory_pool_.Allocate();
+	POMDPXState* particle;
+	{
+		lock_guard<mutex> lock(memory_mutex_);
+		particle = memory_pool_.Allocate();
+	}
 	particle->state_id = state_id;
 	particle->weight = weight;
 	return particle;
 }
 
 State* POMDPX::Copy(const State* particle) const {
-	POMDPXState* new_particle = memory_pool_.Allocate();
+	POMDPXState* new_particle;
+	{
+		lock_guard<mutex> lock(memory_mutex_);
+		new_particle = memory_pool_.Allocate();
+	}
 	*new_particle = *static_cast<const POMDPXState*>(particle);
 	new_particle->SetAllocated();
 	return new_particle;
 }
 
 void POMDPX::Free(State* particle) const {
+	lock_guard<mutex> lock(memory_mutex_);
 	memory_pool_.Free(static_cast<POMDPXState*>(particle));
 }
 
 int POMDPX::NumActiveParticles() const {
+	lock_guard<mutex> lock(memory_mutex_);
 	return memory_pool_.num_allocated();
 }
 
@@ -573,6 +594,7 @@ DSPOMDP* POMDPX::MakeCopy() const {
 	POMDPX* pomdpx = new POMDPX();
 
 	pomdpx->parser_ = this->parser_;
+	pomdpx->tables_ = this->tables_;
 	pomdpx->is_small_ = this->is_small_;
 	pomdpx->min_reward_action_ = this->min_reward_action_;
 	pomdpx->max_reward_action_ = this->max_reward_action_;
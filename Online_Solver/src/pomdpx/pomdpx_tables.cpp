@@ -0,0 +1,317 @@
+#include "../../include/despot/pomdpx/pomdpx_tables.h"
+#include "../../include/despot/pomdpx/parser/parser.h"
+
+using namespace std;
+
+namespace despot {
+
+/* =============================================================================
+ * POMDPXTables class
+ * =============================================================================*/
+
+POMDPXTables::POMDPXTables() :
+	num_actions_(0),
+	has_terminal_(false),
+	parser_(NULL) {
+}
+
+POMDPXTables* POMDPXTables::Compile(const Parser& parser) {
+	POMDPXTables* tables = new POMDPXTables();
+	tables->parser_ = &parser;
+	tables->num_actions_ = parser.NumActions();
+	tables->has_terminal_ = parser.has_terminal_;
+
+	bool ok = true;
+	int num_state_vars = parser.transition_funcs_.size();
+	tables->transitions_.resize(num_state_vars);
+	tables->noisy_transitions_.resize(num_state_vars);
+	for (int s = 0; s < num_state_vars && ok; s++) {
+		ok = CompileCPT(parser, parser.transition_funcs_[s], tables->transitions_[s])
+			&& CompileCPT(parser, parser.noisy_transition_funcs_[s],
+				tables->noisy_transitions_[s]);
+	}
+
+	int num_obs_vars = parser.obs_funcs_.size();
+	tables->observations_.resize(num_obs_vars);
+	for (int o = 0; o < num_obs_vars && ok; o++) {
+		ok = CompileCPT(parser, parser.obs_funcs_[o], tables->observations_[o]);
+		tables->obs_sizes_.push_back(parser.obs_vars_[o].Size());
+	}
+
+	tables->rewards_.resize(parser.reward_funcs_.size());
+	for (int r = 0; r < parser.reward_funcs_.size() && ok; r++)
+		ok = CompileFunction(parser, parser.reward_funcs_[r], tables->rewards_[r]);
+
+	tables->is_identity_.resize(parser.is_identity_.size());
+	for (int s = 0; s < parser.is_identity_.size(); s++) {
+		tables->is_identity_[s].assign(parser.is_identity_[s].begin(),
+			parser.is_identity_[s].end());
+	}
+
+	if (!ok) {
+		delete tables;
+		return NULL;
+	}
+	return tables;
+}
+
+bool POMDPXTables::CompileSlots(const Parser& parser,
+	const vector<NamedVar*>& vars, vector<Slot>& slots) {
+	slots.clear();
+	for (int i = 0; i < vars.size(); i++) {
+		Slot slot;
+		slot.size = vars[i]->Size();
+		slot.index = -1;
+
+		for (int s = 0; s < parser.prev_state_vars_.size() && slot.index == -1; s++) {
+			if (vars[i] == &parser.prev_state_vars_[s]) {
+				slot.type = PREV_STATE;
+				slot.index = s;
+			}
+		}
+		for (int s = 0; s < parser.curr_state_vars_.size() && slot.index == -1; s++) {
+			if (vars[i] == &parser.curr_state_vars_[s]) {
+				slot.type = CURR_STATE;
+				slot.index = s;
+			}
+		}
+		if (slot.index == -1 && vars[i] == &parser.action_vars_[0]) {
+			slot.type = ACTION;
+			slot.index = 0;
+		}
+
+		if (slot.index == -1) {
+			cerr << "POMDPX tables do not support parent " << vars[i]->name()
+				<< ", using the parser" << endl;
+			return false;
+		}
+		slots.push_back(slot);
+	}
+	return true;
+}
+
+bool POMDPXTables::CompileTable(const Parser& parser, const TabularCPT& cpt,
+	Table& table) {
+	if (!CompileSlots(parser, cpt.parents(), table.parents))
+		return false;
+
+	int parent_size = 1;
+	for (int i = 0; i < table.parents.size(); i++)
+		parent_size *= table.parents[i].size;
+	int child_size = cpt.ChildSize();
+
+	table.row_start.resize(parent_size + 1);
+	table.child.clear();
+	table.prob.clear();
+	for (int p = 0; p < parent_size; p++) {
+		table.row_start[p] = table.child.size();
+		for (int c = 0; c < child_size; c++) {
+			double prob = cpt.GetValue(p, c);
+			if (prob > 0) {
+				table.child.push_back(c);
+				table.prob.push_back(prob);
+			}
+		}
+	}
+	table.row_start[parent_size] = table.child.size();
+	return true;
+}
+
+bool POMDPXTables::CompileCPT(const Parser& parser, const CPT* cpt,
+	CompiledCPT& compiled) {
+	const HierarchyCPT* hierarchy = dynamic_cast<const HierarchyCPT*>(cpt);
+	if (hierarchy == NULL) {
+		compiled.has_selector = false;
+		compiled.tables.resize(1);
+		return CompileTable(parser, *static_cast<const TabularCPT*>(cpt),
+			compiled.tables[0]);
+	}
+
+	vector<Slot> selector;
+	if (!CompileSlots(parser, vector<NamedVar*>(1, hierarchy->parents()[0]),
+		selector))
+		return false;
+
+	compiled.has_selector = true;
+	compiled.selector = selector[0];
+	compiled.tables.resize(hierarchy->cpts_.size());
+	for (int i = 0; i < hierarchy->cpts_.size(); i++) {
+		if (!CompileTable(parser, *hierarchy->cpts_[i], compiled.tables[i]))
+			return false;
+	}
+	return true;
+}
+
+bool POMDPXTables::CompileFunction(const Parser& parser, const Function& func,
+	CompiledFunction& compiled) {
+	if (!CompileSlots(parser, func.parents(), compiled.parents))
+		return false;
+
+	int parent_size = 1;
+	for (int i = 0; i < compiled.parents.size(); i++)
+		parent_size *= compiled.parents[i].size;
+
+	compiled.values.resize(parent_size);
+	for (int p = 0; p < parent_size; p++)
+		compiled.values[p] = func.GetValue(p, 0);
+	return true;
+}
+
+int POMDPXTables::Value(const Slot& slot, const Context& context) {
+	switch (slot.type) {
+	case PREV_STATE:
+		return context.prev[slot.index];
+	case CURR_STATE:
+		return context.curr[slot.index];
+	default:
+		return context.action;
+	}
+}
+
+int POMDPXTables::ParentIndex(const vector<Slot>& parents,
+	const Context& context) {
+	int index = 0;
+	for (int i = 0; i < parents.size(); i++)
+		index = index * parents[i].size + Value(parents[i], context);
+	return index;
+}
+
+const POMDPXTables::Table& POMDPXTables::SelectTable(const CompiledCPT& cpt,
+	const Context& context) const {
+	return cpt.has_selector ? cpt.tables[Value(cpt.selector, context)]
+		: cpt.tables[0];
+}
+
+int POMDPXTables::Sample(const CompiledCPT& cpt, const Context& context,
+	double& random) const {
+	const Table& table = SelectTable(cpt, context);
+	int pid = ParentIndex(table.parents, context);
+
+	// same as TabularCPT::ComputeIndex
+	for (int i = table.row_start[pid]; i < table.row_start[pid + 1]; i++) {
+		if (random < table.prob[i]) {
+			random /= table.prob[i] * (1 + 1E-9);
+			return table.child[i];
+		}
+		random -= table.prob[i];
+	}
+	return -1;
+}
+
+double POMDPXTables::Probability(const CompiledCPT& cpt, const Context& context,
+	int child) const {
+	const Table& table = SelectTable(cpt, context);
+	int pid = ParentIndex(table.parents, context);
+
+	for (int i = table.row_start[pid]; i < table.row_start[pid + 1]; i++) {
+		if (table.child[i] == child)
+			return table.prob[i];
+	}
+	return 0;
+}
+
+double POMDPXTables::Reward(const Context& context) const {
+	double reward = 0;
+	for (int r = 0; r < rewards_.size(); r++)
+		reward += rewards_[r].values[ParentIndex(rewards_[r].parents, context)];
+	return reward;
+}
+
+/**
+ * Copy of the state before the step (on the stack for usual models).
+ */
+class PrevState {
+public:
+	PrevState(const vector<int>& state) {
+		if (state.size() <= MAX_LOCAL) {
+			copy(state.begin(), state.end(), local_);
+			data_ = local_;
+		} else {
+			heap_ = state;
+			data_ = &heap_[0];
+		}
+	}
+
+	const int* data() const {
+		return data_;
+	}
+
+private:
+	static const int MAX_LOCAL = 64;
+	int local_[MAX_LOCAL];
+	vector<int> heap_;
+	const int* data_;
+};
+
+bool POMDPXTables::Step(vector<int>& state, double random, int action,
+	double& reward, OBS_TYPE& obs) const {
+	PrevState prev(state);
+	Context context = { prev.data(), state.empty() ? NULL : &state[0], action };
+
+	for (int s = 0; s < state.size(); s++) {
+		if (!is_identity_[s][action])
+			state[s] = Sample(transitions_[s], context, random);
+	}
+
+	reward = Reward(context);
+
+	obs = 0;
+	for (int o = 0; o < observations_.size(); o++)
+		obs = obs * obs_sizes_[o] + Sample(observations_[o], context, random);
+
+	return IsTerminalState(state);
+}
+
+bool POMDPXTables::NoisyStep(vector<int>& state, double random,
+	int action) const {
+	PrevState prev(state);
+	Context context = { prev.data(), state.empty() ? NULL : &state[0], action };
+
+	for (int s = 0; s < state.size(); s++) {
+		if (!is_identity_[s][action])
+			state[s] = Sample(noisy_transitions_[s], context, random);
+	}
+
+	return IsTerminalState(state);
+}
+
+double POMDPXTables::ObsProb(OBS_TYPE obs, const vector<int>& state,
+	int action) const {
+	const int* curr = state.empty() ? NULL : &state[0];
+	Context context = { curr, curr, action };
+
+	double prob = 1.0;
+	for (int o = observations_.size() - 1; o >= 0; o--) {
+		prob *= Probability(observations_[o], context, obs % obs_sizes_[o]);
+		obs /= obs_sizes_[o];
+	}
+	return prob;
+}
+
+bool POMDPXTables::IsTerminalState(const vector<int>& state) const {
+	return has_terminal_
+		&& (parser_->IsInTerminalStateSet(state)
+			|| IsSelfLoopingWithoutReward(state));
+}
+
+bool POMDPXTables::IsSelfLoopingWithoutReward(const vector<int>& state) const {
+	// not cached: the cache of the parser is not shared between threads
+	Context context = { state.empty() ? NULL : &state[0],
+		state.empty() ? NULL : &state[0], 0 };
+
+	for (int a = 0; a < num_actions_; a++) {
+		context.action = a;
+
+		for (int s = 0; s < state.size(); s++) {
+			if (Probability(transitions_[s], context, state[s]) != 1.0)
+				return false;
+		}
+
+		if (Reward(context) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+} // namespace despot
@@ -10,21 +10,36 @@ RandomStreams::RandomStreams(int num_streams, int length) :
 	position_(0) {
 	vector<unsigned> seeds = Seeds::Next(num_streams);
 
-	streams_.resize(num_streams);
+	shared_ptr<vector<vector<double> > > streams(new vector<vector<double> >(num_streams));
 	for (int i = 0; i < num_streams; i++) {
 		Random random(seeds[i]);
-		streams_[i].resize(length);
+		(*streams)[i].resize(length);
 		for (int j = 0; j < length; j++)
-			streams_[i][j] = random.NextDouble();
+			(*streams)[i][j] = random.NextDouble();
 	}
+	streams_ = streams;
 }
 
 int RandomStreams::NumStreams() const {
-	return streams_.size();
+	return streams_->size();
 }
 
 int RandomStreams::Length() const {
-	return streams_.size() > 0 ? streams_[0].size() : 0;
+	return streams_->size() > 0 ? (*streams_)[0].size() : 0;
+}
+
+void RandomStreams::Shift() {
+	vector<unsigned> seeds = Seeds::Next(NumStreams());
+
+	shared_ptr<vector<vector<double> > > streams(new vector<vector<double> >(*streams_));
+	for (int i = 0; i < streams->size(); i++) {
+		vector<double>& stream = (*streams)[i];
+		if (stream.size() == 0)
+			continue;
+		stream.erase(stream.begin());
+		stream.push_back(Random(seeds[i]).NextDouble());
+	}
+	streams_ = streams;
 }
 
 void RandomStreams::Advance() const {
@@ -46,11 +61,11 @@ bool RandomStreams::Exhausted() const {
 }
 
 double RandomStreams::Entry(int stream) const {
-	return streams_[stream][position_];
+	return (*streams_)[stream][position_];
 }
 
 double RandomStreams::Entry(int stream, int position) const {
-	return streams_[stream][position];
+	return (*streams_)[stream][position];
 }
 
 ostream& operator<<(ostream& os, const RandomStreams& stream) {
@@ -46,6 +46,7 @@ SolverBase *SimpleTUI::InitializeSolver(std::vector<DSPOMDP*> models, string sol
       logi << "Created upper bound " << typeid(*upper_bound).name() << endl;
 
 	  solver = new DESPOT(models[0], lower_bound, upper_bound);
+	  ((DESPOT *)solver)->reuse(Globals::config.despot_tree_reuse);
     } else
       solver = lower_bound;
   } // AEMS or its default policy
@@ -82,6 +83,7 @@ SolverBase *SimpleTUI::InitializeSolver(std::vector<DSPOMDP*> models, string sol
 	{
 		solver = new POMCP(models[0], prior);
 		((POMCP *)solver)->reuse(true);
+		((POMCP *)solver)->transposition(Globals::config.pomcp_transposition);
 	}
     else
 		solver = new DPOMCP(models[0], prior);
@@ -96,6 +98,7 @@ SolverBase *SimpleTUI::InitializeSolver(std::vector<DSPOMDP*> models, string sol
 		  POMCPPrior *prior = models[a]->CreatePOMCPPrior(ptype);
 		  solvers.emplace_back(new POMCP(models[a], prior));
 		  ((POMCP *)solvers[a])->reuse(true);
+		  ((POMCP *)solvers[a])->transposition(Globals::config.pomcp_transposition);
 	  }
 
 	  solver = new ParallelSolver(solvers, models[0]->NumActions());
@@ -167,6 +170,9 @@ void SimpleTUI::OptionParse(option::Option *options, int &num_runs,
   if (options[E_NOISE])
     Globals::config.noise = atof(options[E_NOISE].arg);
 
+  if (options[E_BOUND_CACHE])
+    Globals::config.bound_cache_dir = options[E_BOUND_CACHE].arg;
+
   search_solver = options[E_SEARCH_SOLVER];
 
   if (options[E_SOLVER])
@@ -388,6 +394,7 @@ int SimpleTUI::run(int argc, char *argv[], std::ofstream & result, std::string s
 	unsigned world_seed = Seeds::Next();
 	unsigned seed = Seeds::Next();
 	Random::RANDOM = Random(seed);
+	Random::InitThreadRand(Random(seed));
 
 	/* =========================
 	* initialize model
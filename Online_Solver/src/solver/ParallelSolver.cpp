@@ -27,6 +27,22 @@ ParallelSolver::ParallelSolver(std::vector<Solver *> solvers, int numActions)
 	}
 }
 
+ParallelSolver::~ParallelSolver()
+{
+	for (int a = 0; a < threadsData_.size(); ++a)
+	{
+		std::lock_guard<std::mutex> lock(threadsData_[a].m_treeFlagsMutex);
+		threadsData_[a].m_stop = true;
+		threadsData_[a].m_treeFlagsCond.notify_all();
+	}
+
+	for (auto & thread : threads_)
+		thread.join();
+
+	for (auto solver : solvers_)
+		delete solver;
+}
+
 
 
 void ParallelSolver::ThreadsMngrFunction()
@@ -46,17 +62,16 @@ void ParallelSolver::ThreadsMngrFunction()
 			mngrData_.m_actionNeeded = false;
 			mngrData_.m_actionRecieved = true;
 			terminal = mngrData_.m_terminal;
+			mngrData_.m_flagsCond.notify_all();
 		}
 
 		if (terminal)
 			break;
 
 		// wait until recieved observation from evaluator
-		bool observationRecieved = false;
-		while (!observationRecieved)
 		{
-			std::lock_guard<std::mutex> lock(mngrData_.m_flagsMutex);
-			observationRecieved = mngrData_.m_observationRecieved;
+			std::unique_lock<std::mutex> lock(mngrData_.m_flagsMutex);
+			mngrData_.m_flagsCond.wait(lock, [this] { return mngrData_.m_observationRecieved; });
 			terminal = mngrData_.m_terminal;
 		}
 
@@ -80,32 +95,31 @@ void ParallelSolver::ThreadsMngrFunction()
 
 void ParallelSolver::TreeThreadsMainFunction(int actionToDevelop)
 {
-	/// seed tree thread random num
-	Random ran((unsigned)time(NULL));
-	Random::s_threadSafeRand[GetCurrentThreadId()] = ran;
+	/// seed tree thread random num (each thread has its own stream, the mngr uses time + 0)
+	Random ran((unsigned)time(NULL) + actionToDevelop + 1);
+	Random::InitThreadRand(ran);
 
 	TreeDevelopThread * currThreadData = &threadsData_[actionToDevelop];
+	int developCount = 0;
 	
 	while (true)
 	{
 		bool endRound = false;
 
-		{ // init flags
-			std::lock_guard<std::mutex> lock(currThreadData->m_treeFlagsMutex);
-			currThreadData->m_toDevelop = false;
+		{ // wait until a search is requested (develop flag is owned by the mngr, it may already be off again)
+			std::unique_lock<std::mutex> lock(currThreadData->m_treeFlagsMutex);
 			currThreadData->m_toUpdate = false;
-		}
+			currThreadData->m_treeFlagsCond.wait(lock, [&] { return currThreadData->m_developCount != developCount || currThreadData->m_terminal || currThreadData->m_stop; });
+			if (currThreadData->m_stop)
+				return;
 
-		// wait until search flag is on and search when its on
-		bool waitToPing = true;
-		while (waitToPing)
-		{
-			std::lock_guard<std::mutex> lock(currThreadData->m_treeFlagsMutex);
-			waitToPing = !currThreadData->m_toDevelop;
+			developCount = currThreadData->m_developCount;
 			if (currThreadData->m_terminal)
 			{
+				// acknowledge end of round to mngr
+				currThreadData->m_terminal = false;
 				endRound = true;
-				break;
+				currThreadData->m_treeFlagsCond.notify_all();
 			}
 		}
 
@@ -115,30 +129,28 @@ void ParallelSolver::TreeThreadsMainFunction(int actionToDevelop)
 		solvers_[actionToDevelop]->Search(currThreadData, actionToDevelop);
 		QNode * currAction = ((POMCP *)solvers_[actionToDevelop])->root()->Child(actionToDevelop);
 		// signal to barrier that search is finished
-		{
-			std::lock_guard<std::mutex> lock(barrierMutex_);
-			++barrierCounter_;
-		}
+		PassBarrier();
 
 		OBS_TYPE observation;
 		int actionToUpdate;
 
-		// wait for mngr to signal to update
-		waitToPing = true;
-		while (waitToPing)
-		{
-			std::lock_guard<std::mutex> lock(currThreadData->m_treeFlagsMutex);
-			if (currThreadData->m_toUpdate)
-			{
-				waitToPing = false;
-				observation = currThreadData->m_obsToUpdate;
-				actionToUpdate = currThreadData->m_actionToUpdate;
-			}
+		{ // wait for mngr to signal to update
+			std::unique_lock<std::mutex> lock(currThreadData->m_treeFlagsMutex);
+			currThreadData->m_treeFlagsCond.wait(lock, [&] { return currThreadData->m_toUpdate || currThreadData->m_terminal || currThreadData->m_stop; });
+			if (currThreadData->m_stop)
+				return;
 
 			if (currThreadData->m_terminal)
 			{
+				// acknowledge end of round to mngr
+				currThreadData->m_terminal = false;
 				endRound = true;
-				break;
+				currThreadData->m_treeFlagsCond.notify_all();
+			}
+			else
+			{
+				observation = currThreadData->m_obsToUpdate;
+				actionToUpdate = currThreadData->m_actionToUpdate;
 			}
 		}
 
@@ -146,13 +158,25 @@ void ParallelSolver::TreeThreadsMainFunction(int actionToDevelop)
 			continue;
 
 		solvers_[actionToDevelop]->Update(actionToUpdate, observation);
-		{
-			std::lock_guard<std::mutex> lock(barrierMutex_);
-			++barrierCounter_;
-		}
+		PassBarrier();
 	}
 }
 
+void ParallelSolver::PassBarrier()
+{
+	std::lock_guard<std::mutex> lock(barrierMutex_);
+	++barrierCounter_;
+	barrierCond_.notify_all();
+}
+
+void ParallelSolver::WaitBarrier()
+{
+	// wait for all threads to pass and reset for the next step
+	std::unique_lock<std::mutex> lock(barrierMutex_);
+	barrierCond_.wait(lock, [this] { return barrierCounter_ == threads_.size(); });
+	barrierCounter_ = 0;
+}
+
 ValuedAction ParallelSolver::Search()
 {
 	// build tree (exit when action is needed)
@@ -160,15 +184,14 @@ ValuedAction ParallelSolver::Search()
 	{
 		std::lock_guard<std::mutex> lock(threadsData_[a].m_treeFlagsMutex);
 		threadsData_[a].m_toDevelop = true;
+		++threadsData_[a].m_developCount;
+		threadsData_[a].m_treeFlagsCond.notify_all();
 	}
 
 	// wait for signal to end of search 
-	bool actionNeeded = false, terminal = false;
-	while (!actionNeeded && !terminal)
 	{
-		std::lock_guard<std::mutex> lock(mngrData_.m_flagsMutex);
-		actionNeeded = mngrData_.m_actionNeeded;
-		terminal = mngrData_.m_terminal;
+		std::unique_lock<std::mutex> lock(mngrData_.m_flagsMutex);
+		mngrData_.m_flagsCond.wait(lock, [this] { return mngrData_.m_actionNeeded || mngrData_.m_terminal; });
 	}
 
 	return FindPrefferedAction();
@@ -176,7 +199,7 @@ ValuedAction ParallelSolver::Search()
 
 ValuedAction ParallelSolver::FindPrefferedAction()
 {
-	//pass signal to threads to end search 
+	//pass signal to threads to end search (a thread that did not start yet runs a search that ends immediately)
 	for (int a = 0; a < threadsData_.size(); ++a)
 	{
 		std::lock_guard<std::mutex> lock(threadsData_[a].m_treeFlagsMutex);
@@ -184,12 +207,7 @@ ValuedAction ParallelSolver::FindPrefferedAction()
 	}
 
 	// wait for all thread to finish build tree
-	int threadsCounter = 0;
-	while (threadsCounter != threads_.size())
-	{
-		std::lock_guard<std::mutex> lock(barrierMutex_);
-		threadsCounter = barrierCounter_;
-	}
+	WaitBarrier();
 
 	// find max reward action
 	float maxValue = Globals::NEG_INFTY;
@@ -203,11 +221,6 @@ ValuedAction ParallelSolver::FindPrefferedAction()
 		}
 	}
 
-	{
-		std::lock_guard<std::mutex> lock(barrierMutex_);
-		barrierCounter_ = 0;
-	}
-
 	return ValuedAction(prefferredAction, maxValue);
 }
 
@@ -219,25 +232,18 @@ void ParallelSolver::Update(int action, OBS_TYPE obs)
 		threadsData_[a].m_actionToUpdate = action;
 		threadsData_[a].m_obsToUpdate = obs;
 		threadsData_[a].m_toUpdate = true;
+		threadsData_[a].m_treeFlagsCond.notify_all();
 	}
 
 	// wait for all thread to finish update
-	int threadsCounter = 0;
-	while (threadsCounter != threads_.size())
-	{
-		std::lock_guard<std::mutex> lock(barrierMutex_);
-		threadsCounter = barrierCounter_;
-	}
-
-	std::lock_guard<std::mutex> lock(barrierMutex_);
-	barrierCounter_ = 0;
+	WaitBarrier();
 }
 
 void ParallelSolver::StartRoundMngr()
 {
 	/// seed mngr thread random num
 	Random ran((unsigned)time(NULL));
-	Random::s_threadSafeRand[GetCurrentThreadId()] = ran;
+	Random::InitThreadRand(ran);
 
 	// make sure that terminal flag is off
 	for (int a = 0; a < threadsData_.size(); ++a)
@@ -262,6 +268,14 @@ void ParallelSolver::EndRoundMngr()
 	{
 		std::lock_guard<std::mutex> lock(threadsData_[a].m_treeFlagsMutex);
 		threadsData_[a].m_terminal = true;
+		threadsData_[a].m_treeFlagsCond.notify_all();
+	}
+
+	// wait for all threads to acknowledge (so next round will not reset the flag before they noticed it)
+	for (int a = 0; a < threadsData_.size(); ++a)
+	{
+		std::unique_lock<std::mutex> lock(threadsData_[a].m_treeFlagsMutex);
+		threadsData_[a].m_treeFlagsCond.wait(lock, [&] { return !threadsData_[a].m_terminal; });
 	}
 }
 
@@ -323,3 +337,12 @@ void ParallelSolver::GetTreeProperties(Tree_Properties & treeProp) const
 	treeProp.m_rootTreeProp.m_nodeValue = value;
 	treeProp.m_rootTreeProp.m_height = maxHeight + 1;
 }
+
+int ParallelSolver::NumSimulations() const
+{
+	int numSims = 0;
+	for (int sol = 0; sol < solvers_.size(); ++sol)
+		numSims += solvers_[sol]->NumSimulations();
+
+	return numSims;
+}
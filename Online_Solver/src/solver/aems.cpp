@@ -14,6 +14,13 @@ AEMS::AEMS(const DSPOMDP* model, BeliefLowerBound* lower_bound,
 	upper_bound_(upper_bound) {
 	model_ = static_cast<const BeliefMDP*>(model);
 	reuse_ = false;
+	num_trials_ = 0;
+}
+
+AEMS::~AEMS() {
+	delete root_;
+	delete lower_bound_;
+	delete upper_bound_;
 }
 
 ValuedAction AEMS::Search() {
@@ -56,13 +63,17 @@ ValuedAction AEMS::Search() {
 
 	statistics_.num_tree_particles = model_->NumActiveParticles()
 		- num_active_particles;
-	statistics_.num_tree_nodes = root_->Size();
-	statistics_.num_policy_nodes = root_->PolicyTreeSize();
+	statistics_.num_tree_nodes = 1;
+	for (int a = 0; a < root_->children().size(); a++)
+		statistics_.num_tree_nodes += root_->Child(a)->subtree_size();
+	if (logging::level() >= logging::INFO_)
+		statistics_.num_policy_nodes = root_->PolicyTreeSize();
 	statistics_.num_particles_after_search = model_->NumActiveParticles();
 
 	statistics_.final_lb = root_->lower_bound();
 	statistics_.final_ub = root_->upper_bound();
 	statistics_.time_search = (double) (clock() - begin) / CLOCKS_PER_SEC;
+	num_trials_ += statistics_.num_trials;
 
 	logi << "[AEMS::Search]" << statistics_ << endl;
 
@@ -71,6 +82,24 @@ ValuedAction AEMS::Search() {
 	return astar;
 }
 
+void AEMS::GetTreeProperties(Tree_Properties & treeProp) const
+{
+	if (root_ == NULL)
+		return;
+
+	// maintained by Expand, so no walk of the tree
+	int size = 1, height = 0;
+	for (int a = 0; a < root_->children().size(); a++) {
+		size += root_->Child(a)->subtree_size();
+		height = max(height, root_->Child(a)->subtree_height());
+	}
+
+	treeProp.m_rootTreeProp.m_size = size;
+	treeProp.m_rootTreeProp.m_nodeCount = statistics_.num_trials;
+	treeProp.m_rootTreeProp.m_nodeValue = root_->lower_bound();
+	treeProp.m_rootTreeProp.m_height = height + 1;
+}
+
 ValuedAction AEMS::OptimalAction(const VNode* vnode) {
 	ValuedAction astar(-1, Globals::NEG_INFTY);
 	for (int action = 0; action < vnode->children().size(); action++) {
@@ -250,6 +279,7 @@ void AEMS::Expand(QNode* qnode, BeliefLowerBound* lb, BeliefUpperBound* ub,
 		vnode->likelihood = weight;
 		logd << " New node created!" << endl;
 		children[obs] = vnode;
+		vnode->CountInAncestors(1);
 
 		InitLowerBound(vnode, lb, history);
 		InitUpperBound(vnode, ub, history);
@@ -2,6 +2,8 @@
 #include "../../include/despot/solver/pomcp.h"
 #include "../../include/despot/core/pomdp.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace despot {
@@ -9,12 +11,29 @@ namespace despot {
 DESPOT::DESPOT(const DSPOMDP* model, ScenarioLowerBound* lb, ScenarioUpperBound* ub, Belief* belief) :
 	Solver(model, belief),
 	root_(NULL), 
+	num_trials_(0),
+	streams_(0, 0),
+	streams_initialized_(false),
+	pool_(NULL),
+	reuse_(false),
+	reused_size_(0),
 	lower_bound_(lb),
 	upper_bound_(ub) {
 	assert(model != NULL);
 }
 
 DESPOT::~DESPOT() {
+	if (root_ != NULL) {
+		root_->Free(*model_);
+		delete root_;
+	}
+	delete pool_;
+	delete lower_bound_;
+	delete upper_bound_;
+}
+
+void DESPOT::reuse(bool r) {
+	reuse_ = r;
 }
 
 ScenarioLowerBound* DESPOT::lower_bound() const {
@@ -27,7 +46,8 @@ ScenarioUpperBound* DESPOT::upper_bound() const {
 
 VNode* DESPOT::Trial(VNode* root, RandomStreams& streams,
 	ScenarioLowerBound* lower_bound, ScenarioUpperBound* upper_bound,
-	const DSPOMDP* model, History& history, SearchStatistics* statistics) {
+	const DSPOMDP* model, History& history, SearchStatistics* statistics,
+	TaskPool* pool) {
 	VNode* cur = root;
 
 	int hist_size = history.Size();
@@ -46,13 +66,15 @@ VNode* DESPOT::Trial(VNode* root, RandomStreams& streams,
 
 		if (cur->IsLeaf()) {
 			double start = clock();
-			Expand(cur, lower_bound, upper_bound, model, streams, history);
+			Expand(cur, lower_bound, upper_bound, model, streams, history, pool);
 
 			if (statistics != NULL) {
 				statistics->time_node_expansion += (double) (clock() - start)
 					/ CLOCKS_PER_SEC;
 				statistics->num_expanded_nodes++;
 				statistics->num_tree_particles += cur->particles().size();
+				for (int a = 0; a < cur->children().size(); a++)
+					statistics->num_tree_nodes += cur->Child(a)->children().size();
 			}
 		}
 
@@ -121,16 +143,14 @@ void DESPOT::ExploitBlockers(VNode* vnode) {
 VNode* DESPOT::ConstructTree(vector<State*>& particles, RandomStreams& streams,
 	ScenarioLowerBound* lower_bound, ScenarioUpperBound* upper_bound,
 	const DSPOMDP* model, History& history, double timeout,
-	SearchStatistics* statistics) {
-	if (statistics != NULL) {
-		statistics->num_particles_before_search = model->NumActiveParticles();
-	}
-
+	SearchStatistics* statistics, TaskPool* pool) {
 	for (int i = 0; i < particles.size(); i++) {
 		particles[i]->scenario_id = i;
 	}
 
 	VNode* root = new VNode(particles);
+	if (statistics != NULL)
+		statistics->num_tree_nodes = 1;
 
 	logd
 		<< "[DESPOT::ConstructTree] START - Initializing lower and upper bounds at the root node.";
@@ -138,24 +158,36 @@ VNode* DESPOT::ConstructTree(vector<State*>& particles, RandomStreams& streams,
 	logd
 		<< "[DESPOT::ConstructTree] END - Initializing lower and upper bounds at the root node.";
 
+	RunTrials(root, streams, lower_bound, upper_bound, model, history, timeout,
+		statistics, pool);
+
+	return root;
+}
+
+void DESPOT::RunTrials(VNode* root, RandomStreams& streams,
+	ScenarioLowerBound* lower_bound, ScenarioUpperBound* upper_bound,
+	const DSPOMDP* model, History& history, double timeout,
+	SearchStatistics* statistics, TaskPool* pool) {
 	if (statistics != NULL) {
+		statistics->num_particles_before_search = model->NumActiveParticles();
 		statistics->initial_lb = root->lower_bound();
 		statistics->initial_ub = root->upper_bound();
 	}
 
+	// elapsed time is measured in real time (cpu time of all expansion threads would exceed the timeout)
 	double used_time = 0;
 	int num_trials = 0;
 	do {
-		double start = clock();
-		VNode* cur = Trial(root, streams, lower_bound, upper_bound, model, history, statistics);
-		used_time += double(clock() - start) / CLOCKS_PER_SEC;
+		double start = get_time_second();
+		VNode* cur = Trial(root, streams, lower_bound, upper_bound, model, history, statistics, pool);
+		used_time += get_time_second() - start;
 
-		start = clock();
+		start = get_time_second();
 		Backup(cur);
 		if (statistics != NULL) {
-			statistics->time_backup += double(clock() - start) / CLOCKS_PER_SEC;
+			statistics->time_backup += get_time_second() - start;
 		}
-		used_time += double(clock() - start) / CLOCKS_PER_SEC;
+		used_time += get_time_second() - start;
 
 		num_trials++;
 	} while (used_time * (num_trials + 1.0) / num_trials < timeout
@@ -163,15 +195,15 @@ VNode* DESPOT::ConstructTree(vector<State*>& particles, RandomStreams& streams,
 
 	if (statistics != NULL) {
 		statistics->num_particles_after_search = model->NumActiveParticles();
-		statistics->num_policy_nodes = root->PolicyTreeSize();
-		statistics->num_tree_nodes = root->Size();
+		// num_tree_nodes is counted by Trial; the policy tree needs a walk, so
+		// it is only measured for the search statistics log
+		if (logging::level() >= logging::INFO_)
+			statistics->num_policy_nodes = root->PolicyTreeSize();
 		statistics->final_lb = root->lower_bound();
 		statistics->final_ub = root->upper_bound();
 		statistics->time_search = used_time;
 		statistics->num_trials = num_trials;
 	}
-
-	return root;
 }
 
 void DESPOT::Compare() {
@@ -224,51 +256,83 @@ ValuedAction DESPOT::Search() {
 	}
 
 	if (Globals::config.time_per_move <= 0) // Return a random action if no time is allocated for planning
-		return ValuedAction(Random::RANDOM.NextInt(model_->NumActions()),
+		return ValuedAction(Random::s_threadRand.NextInt(model_->NumActions()),
 			Globals::NEG_INFTY);
 
+	// a tree kept by Update is searched further instead of sampling new scenarios
+	bool reused = reuse_ && root_ != NULL;
+
 	double start = get_time_second();
-	vector<State*> particles = belief_->Sample(Globals::config.num_scenarios);
-	logi << "[DESPOT::Search] Time for sampling " << particles.size()
-		<< " particles: " << (get_time_second() - start) << "s" << endl;
+	vector<State*> particles;
+	if (!reused) {
+		particles = belief_->Sample(Globals::config.num_scenarios);
+		logi << "[DESPOT::Search] Time for sampling " << particles.size()
+			<< " particles: " << (get_time_second() - start) << "s" << endl;
+	}
 
 	statistics_ = SearchStatistics();
 
 	start = get_time_second();
-	static RandomStreams streams = RandomStreams(Globals::config.num_scenarios,
-		Globals::config.search_depth);
-
 	LookaheadUpperBound* ub = dynamic_cast<LookaheadUpperBound*>(upper_bound_);
-	if (ub != NULL) { // Avoid using new streams for LookaheadUpperBound
-		static bool initialized = false;
-		if (!initialized ) {
-			lower_bound_->Init(streams);
-			upper_bound_->Init(streams);
-			initialized = true;
+	if (reused) { // Streams of the kept tree are shifted in Update
+	} else if (ub != NULL) { // Avoid using new streams for LookaheadUpperBound
+		if (!streams_initialized_) {
+			streams_ = RandomStreams(Globals::config.num_scenarios,
+				Globals::config.search_depth);
+			lower_bound_->Init(streams_);
+			upper_bound_->Init(streams_);
+			streams_initialized_ = true;
 		}
 	} else {
-		streams = RandomStreams(Globals::config.num_scenarios,
+		streams_ = RandomStreams(Globals::config.num_scenarios,
 			Globals::config.search_depth);
-		lower_bound_->Init(streams);
-		upper_bound_->Init(streams);
+		lower_bound_->Init(streams_);
+		upper_bound_->Init(streams_);
 	}
 
-	root_ = ConstructTree(particles, streams, lower_bound_, upper_bound_,
-		model_, history_, Globals::config.time_per_move, &statistics_);
-	logi << "[DESPOT::Search] Time for tree construction: "
-		<< (get_time_second() - start) << "s" << endl;
+	// the expansion threads share the model and the bounds
+	int num_threads = Globals::config.num_expansion_threads;
+	if (num_threads > 1 && !model_->IsThreadSafe()) {
+		logw << "[DESPOT::Search] Model is not thread safe, expanding with one thread" << endl;
+		num_threads = 1;
+	}
 
-	start = get_time_second();
-	root_->Free(*model_);
-	logi << "[DESPOT::Search] Time for freeing particles in search tree: "
+	if (num_threads > 1
+		&& (pool_ == NULL || pool_->NumWorkers() != num_threads)) {
+		delete pool_;
+		pool_ = new TaskPool(num_threads, Globals::config.root_seed);
+	}
+
+	TaskPool* pool = num_threads > 1 ? pool_ : NULL;
+	if (reused) {
+		logi << "[DESPOT::Search] Reusing tree with " << root_->particles().size()
+			<< " particles" << endl;
+		statistics_.num_tree_nodes = reused_size_;
+		RunTrials(root_, streams_, lower_bound_, upper_bound_, model_, history_,
+			Globals::config.time_per_move, &statistics_, pool);
+	} else {
+		root_ = ConstructTree(particles, streams_, lower_bound_, upper_bound_,
+			model_, history_, Globals::config.time_per_move, &statistics_, pool);
+	}
+	num_trials_ += statistics_.num_trials;
+	logi << "[DESPOT::Search] Time for tree construction: "
 		<< (get_time_second() - start) << "s" << endl;
 
 	ValuedAction astar = OptimalAction(root_);
-	start = get_time_second();
-	delete root_;
 
-	logi << "[DESPOT::Search] Time for deleting tree: "
-		<< (get_time_second() - start) << "s" << endl;
+	if (!reuse_) {
+		start = get_time_second();
+		root_->Free(*model_);
+		logi << "[DESPOT::Search] Time for freeing particles in search tree: "
+			<< (get_time_second() - start) << "s" << endl;
+
+		start = get_time_second();
+		delete root_;
+		root_ = NULL;
+
+		logi << "[DESPOT::Search] Time for deleting tree: "
+			<< (get_time_second() - start) << "s" << endl;
+	}
 	logi << "[DESPOT::Search] Search statistics:" << endl << statistics_
 		<< endl;
 
@@ -578,6 +642,65 @@ void DESPOT::Update(QNode* qnode) {
 	}
 }
 
+int DESPOT::RefreshReused(VNode* vnode, double weight_scale,
+	double value_scale, ScenarioUpperBound* upper_bound,
+	RandomStreams& streams, History& history) {
+	double pruning_constant = Globals::config.pruning_constant;
+	bool closed_at_horizon = vnode->depth() == Globals::config.search_depth - 1;
+	vnode->depth(vnode->depth() - 1);
+
+	const vector<State*>& particles = vnode->particles();
+	for (int i = 0; i < particles.size(); i++) {
+		particles[i]->weight *= weight_scale;
+	}
+
+	ValuedAction move = vnode->default_move();
+	move.value *= value_scale;
+	vnode->default_move(move);
+
+	if (vnode->IsLeaf()) {
+		vnode->lower_bound(move.value);
+		if (closed_at_horizon) {
+			InitUpperBound(vnode, upper_bound, streams, history);
+			if (vnode->upper_bound() < vnode->lower_bound()) {
+				vnode->upper_bound(vnode->lower_bound());
+			}
+		} else {
+			vnode->upper_bound((vnode->upper_bound() + pruning_constant)
+				* value_scale - pruning_constant);
+			vnode->utility_upper_bound *= value_scale;
+		}
+		return 1;
+	}
+
+	int size = 1;
+	for (int action = 0; action < vnode->children().size(); action++) {
+		QNode* qnode = vnode->Child(action);
+		qnode->step_reward = (qnode->step_reward + pruning_constant)
+			* value_scale - pruning_constant;
+
+		map<OBS_TYPE, VNode*>& children = qnode->children();
+		for (map<OBS_TYPE, VNode*>::iterator it = children.begin();
+			it != children.end(); it++) {
+			history.Add(action, it->first);
+			size += RefreshReused(it->second, weight_scale, value_scale,
+				upper_bound, streams, history);
+			history.RemoveLast();
+		}
+
+		qnode->lower_bound(Globals::NEG_INFTY);
+		qnode->upper_bound(Globals::POS_INFTY);
+		qnode->utility_upper_bound = Globals::POS_INFTY;
+		Update(qnode);
+	}
+
+	vnode->lower_bound(Globals::NEG_INFTY);
+	vnode->upper_bound(Globals::POS_INFTY);
+	vnode->utility_upper_bound = Globals::POS_INFTY;
+	Update(vnode);
+	return size;
+}
+
 void DESPOT::Backup(VNode* vnode) {
 	int iter = 0;
 	logd << "- Backup " << vnode << " at depth " << vnode->depth() << endl;
@@ -622,23 +745,46 @@ VNode* DESPOT::FindBlocker(VNode* vnode) {
 void DESPOT::Expand(VNode* vnode,
 	ScenarioLowerBound* lower_bound, ScenarioUpperBound* upper_bound,
 	const DSPOMDP* model, RandomStreams& streams,
-	History& history) {
+	History& history, TaskPool* pool, int worker) {
 	vector<QNode*>& children = vnode->children();
 	logd << "- Expanding vnode " << vnode << endl;
-	for (int action = 0; action < model->NumActions(); action++) {
-		logd << " Action " << action << endl;
-		QNode* qnode = new QNode(vnode, action);
-		children.push_back(qnode);
-
-		Expand(qnode, lower_bound, upper_bound, model, streams, history);
+	if (pool == NULL) {
+		// one scratch buffer for all actions
+		ExpansionBuffer buffer(vnode->particles().size());
+		for (int action = 0; action < model->NumActions(); action++) {
+			logd << " Action " << action << endl;
+			QNode* qnode = new QNode(vnode, action);
+			children.push_back(qnode);
+
+			Expand(qnode, lower_bound, upper_bound, model, streams, history,
+				buffer);
+		}
+	} else {
+		int first = children.size();
+		for (int action = 0; action < model->NumActions(); action++)
+			children.push_back(new QNode(vnode, action));
+
+		// streams and history are not changed until all tasks are done
+		TaskPool::Group group;
+		for (int action = 0; action < model->NumActions(); action++) {
+			QNode* qnode = children[first + action];
+			pool->Submit(group, worker, [=, &streams, &history](int task_worker) {
+				RandomStreams task_streams(streams);
+				History task_history(history);
+				ExpansionBuffer task_buffer(qnode->parent()->particles().size());
+				Expand(qnode, lower_bound, upper_bound, model, task_streams,
+					task_history, task_buffer, pool, task_worker);
+			});
+		}
+		pool->Wait(group, worker);
 	}
 	logd << "* Expansion complete!" << endl;
 }
 
 void DESPOT::Expand(QNode* qnode, ScenarioLowerBound* lb,
 	ScenarioUpperBound* ub, const DSPOMDP* model,
-	RandomStreams& streams,
-	History& history) {
+	RandomStreams& streams, History& history, ExpansionBuffer& buffer,
+	TaskPool* pool, int worker) {
 	VNode* parent = qnode->parent();
 	streams.position(parent->depth());
 	map<OBS_TYPE, VNode*>& children = qnode->children();
@@ -647,8 +793,11 @@ void DESPOT::Expand(QNode* qnode, ScenarioLowerBound* lb,
 
 	double step_reward = 0;
 
-	// Partition particles by observation
-	map<OBS_TYPE, vector<State*> > partitions;
+	// Step particles into the buffer and key the survivors by observation
+	vector<State*>& stepped = buffer.stepped;
+	vector<pair<OBS_TYPE, int> >& keys = buffer.keys;
+	stepped.clear();
+	keys.clear();
 	OBS_TYPE obs;
 	double reward;
 	for (int i = 0; i < particles.size(); i++) {
@@ -668,7 +817,8 @@ void DESPOT::Expand(QNode* qnode, ScenarioLowerBound* lb,
 			<< " " << reward << " " << copy->weight << endl;
 
 		if (!terminal) {
-			partitions[obs].push_back(copy);
+			keys.push_back(make_pair(obs, (int) stepped.size()));
+			stepped.push_back(copy);
 		} else {
 			model->Free(copy);
 		}
@@ -679,24 +829,58 @@ void DESPOT::Expand(QNode* qnode, ScenarioLowerBound* lb,
 	double lower_bound = step_reward;
 	double upper_bound = step_reward;
 
+	// Partition by observation: keys are unique, so sorting keeps the
+	// original particle order inside each partition
+	sort(keys.begin(), keys.end());
+
 	// Create new belief nodes
-	for (map<OBS_TYPE, vector<State*> >::iterator it = partitions.begin();
-		it != partitions.end(); it++) {
-		OBS_TYPE obs = it->first;
+	vector<VNode*> new_nodes;
+	for (int start = 0; start < keys.size();) {
+		OBS_TYPE obs = keys[start].first;
+		int end = start + 1;
+		while (end < keys.size() && keys[end].first == obs)
+			end++;
+
+		vector<State*> partition(end - start);
+		for (int i = start; i < end; i++)
+			partition[i - start] = stepped[keys[i].second];
+
 		logd << " Creating node for obs " << obs << endl;
-		VNode* vnode = new VNode(partitions[obs], parent->depth() + 1,
+		VNode* vnode = new VNode(move(partition), parent->depth() + 1,
 			qnode, obs);
 		logd << " New node created!" << endl;
-		children[obs] = vnode;
+		children.insert(children.end(), make_pair(obs, vnode));
+		new_nodes.push_back(vnode);
+		start = end;
+	}
 
-		history.Add(qnode->edge(), obs);
-		InitBounds(vnode, lb, ub, streams, history);
-		history.RemoveLast();
-		logd << " New node's bounds: (" << vnode->lower_bound() << ", "
-			<< vnode->upper_bound() << ")" << endl;
+	if (pool == NULL || new_nodes.size() == 1) {
+		for (int i = 0; i < new_nodes.size(); i++) {
+			history.Add(qnode->edge(), new_nodes[i]->edge());
+			InitBounds(new_nodes[i], lb, ub, streams, history);
+			history.RemoveLast();
+		}
+	} else {
+		// bounds of each child are initialized as a task
+		TaskPool::Group group;
+		for (int i = 0; i < new_nodes.size(); i++) {
+			VNode* vnode = new_nodes[i];
+			pool->Submit(group, worker, [=, &streams, &history](int task_worker) {
+				RandomStreams task_streams(streams);
+				History task_history(history);
+				task_history.Add(qnode->edge(), vnode->edge());
+				InitBounds(vnode, lb, ub, task_streams, task_history);
+			});
+		}
+		pool->Wait(group, worker);
+	}
+
+	for (int i = 0; i < new_nodes.size(); i++) {
+		logd << " New node's bounds: (" << new_nodes[i]->lower_bound() << ", "
+			<< new_nodes[i]->upper_bound() << ")" << endl;
 
-		lower_bound += vnode->lower_bound();
-		upper_bound += vnode->upper_bound();
+		lower_bound += new_nodes[i]->lower_bound();
+		upper_bound += new_nodes[i]->upper_bound();
 	}
 
 	qnode->step_reward = step_reward;
@@ -767,11 +951,26 @@ ValuedAction DESPOT::Evaluate(VNode* root, vector<State*>& particles,
 	return ValuedAction(OptimalAction(root).action, value / particles.size());
 }
 
+void DESPOT::GetTreeProperties(Tree_Properties & treeProp) const
+{
+	// the tree is deleted at the end of each search, so only its statistics remain
+	treeProp.m_rootTreeProp.m_size = statistics_.num_tree_nodes;
+	treeProp.m_rootTreeProp.m_nodeCount = statistics_.num_trials;
+	treeProp.m_rootTreeProp.m_nodeValue = statistics_.final_lb;
+	treeProp.m_rootTreeProp.m_height = statistics_.longest_trial_length;
+}
+
 void DESPOT::belief(Belief* b) {
 	logi << "[DESPOT::belief] Start: Set initial belief." << endl;
 	belief_ = b;
 	history_.Truncate(0);
 
+	if (root_ != NULL) {
+		root_->Free(*model_);
+		delete root_;
+		root_ = NULL;
+	}
+
 	lower_bound_->belief(b); // needed for POMCPScenarioLowerBound
 	logi << "[DESPOT::belief] End: Set initial belief." << endl;
 }
@@ -779,11 +978,49 @@ void DESPOT::belief(Belief* b) {
 void DESPOT::Update(int action, OBS_TYPE obs) {
 	double start = get_time_second();
 
+	if (root_ != NULL) {
+		// detach the subtree of the executed action and observation
+		VNode* node = NULL;
+		if (action < root_->children().size()) {
+			map<OBS_TYPE, VNode*>& children = root_->Child(action)->children();
+			map<OBS_TYPE, VNode*>::iterator it = children.find(obs);
+			if (it != children.end()) {
+				node = it->second;
+				children.erase(it);
+			}
+		}
+
+		root_->Free(*model_);
+		delete root_;
+		root_ = node;
+	}
+
 	belief_->Update(action, obs);
 	history_.Add(action, obs);
 
 	lower_bound_->belief(belief_);
 
+	if (root_ != NULL) {
+		double weight = root_->Weight();
+		if (root_->particles().size()
+			< Globals::config.min_reuse_ratio * Globals::config.num_scenarios
+			|| weight <= 0) {
+			root_->Free(*model_);
+			delete root_;
+			root_ = NULL;
+		} else {
+			// the scenarios left are the particle approximation of the
+			// updated belief, so they are renormalized
+			root_->parent(NULL);
+			streams_.Shift();
+			lower_bound_->Shift(streams_);
+			upper_bound_->Shift(streams_);
+			reused_size_ = RefreshReused(root_, 1 / weight,
+				1 / (weight * Globals::config.discount), upper_bound_, streams_,
+				history_);
+		}
+	}
+
 	logi << "[Solver::Update] Updated belief, history and root with action "
 		<< action << ", observation " << obs
 		<< " in " << (get_time_second() - start) << "s" << endl;
@@ -34,12 +34,12 @@ int POMCPPrior::GetAction(const State& state) {
 	ComputePreference(state);
 
 	if (preferred_actions_.size() != 0)
-		return Random::RANDOM.NextElement(preferred_actions_);
+		return Random::s_threadRand.NextElement(preferred_actions_);
 
 	if (legal_actions_.size() != 0)
-		return Random::RANDOM.NextElement(legal_actions_);
+		return Random::s_threadRand.NextElement(legal_actions_);
 
-	return Random::RANDOM.NextInt(model_->NumActions());
+	return Random::s_threadRand.NextInt(model_->NumActions());
 }
 
 /* =============================================================================
@@ -56,30 +56,298 @@ UniformPOMCPPrior::~UniformPOMCPPrior() {
 void UniformPOMCPPrior::ComputePreference(const State& state) {
 }
 
+/* =============================================================================
+ * POMCPTranspositionTable class
+ * =============================================================================*/
+
+POMCPTranspositionTable::POMCPTranspositionTable(int window) :
+	window_(window),
+	size_(0) {
+}
+
+POMCPTranspositionTable::~POMCPTranspositionTable() {
+	Clear();
+}
+
+VNode* POMCPTranspositionTable::Find(const History& history, int depth) const {
+	if (depth >= nodes_.size())
+		return NULL;
+
+	KeyMap::const_iterator it = nodes_[depth].find(history.Hash(window_));
+	return it != nodes_[depth].end() ? it->second : NULL;
+}
+
+void POMCPTranspositionTable::Insert(const History& history, VNode* vnode) {
+	int depth = vnode->depth();
+	if (depth >= nodes_.size())
+		nodes_.resize(depth + 1);
+
+	VNode*& entry = nodes_[depth][history.Hash(window_)];
+	assert(entry == NULL);
+	entry = vnode;
+	size_++;
+}
+
+// Nodes are shared, so the child links are dropped before deleting any node
+// to keep ~QNode from deleting them a second time
+void POMCPTranspositionTable::Delete(vector<VNode*>& nodes) {
+	for (int i = 0; i < nodes.size(); i++) {
+		vector<QNode*>& qnodes = nodes[i]->children();
+		for (int a = 0; a < qnodes.size(); a++)
+			qnodes[a]->children().clear();
+	}
+	for (int i = 0; i < nodes.size(); i++)
+		delete nodes[i];
+}
+
+void POMCPTranspositionTable::Retain(VNode* root) {
+	unordered_set<VNode*> reachable;
+	vector<VNode*> stack(1, root);
+	reachable.insert(root);
+	while (!stack.empty()) {
+		VNode* vnode = stack.back();
+		stack.pop_back();
+		for (int a = 0; a < vnode->children().size(); a++) {
+			map<OBS_TYPE, VNode*>& vnodes = vnode->Child(a)->children();
+			for (map<OBS_TYPE, VNode*>::iterator it = vnodes.begin();
+				it != vnodes.end(); it++) {
+				if (it->second != NULL && reachable.insert(it->second).second)
+					stack.push_back(it->second);
+			}
+		}
+	}
+
+	vector<VNode*> unreachable;
+	for (int depth = 0; depth < nodes_.size(); depth++) {
+		for (KeyMap::iterator it = nodes_[depth].begin(); it != nodes_[depth].end();) {
+			if (reachable.find(it->second) == reachable.end()) {
+				unreachable.push_back(it->second);
+				it = nodes_[depth].erase(it);
+			} else {
+				it++;
+			}
+		}
+	}
+	size_ -= unreachable.size();
+	Delete(unreachable);
+}
+
+void POMCPTranspositionTable::Erase(const unordered_set<VNode*>& nodes) {
+	for (int depth = 0; depth < nodes_.size(); depth++) {
+		for (KeyMap::iterator it = nodes_[depth].begin(); it != nodes_[depth].end();) {
+			if (nodes.find(it->second) != nodes.end()) {
+				it = nodes_[depth].erase(it);
+				size_--;
+			} else {
+				it++;
+			}
+		}
+	}
+}
+
+void POMCPTranspositionTable::Clear() {
+	vector<VNode*> nodes;
+	for (int depth = 0; depth < nodes_.size(); depth++) {
+		for (KeyMap::iterator it = nodes_[depth].begin(); it != nodes_[depth].end();
+			it++)
+			nodes.push_back(it->second);
+	}
+	nodes_.clear();
+	size_ = 0;
+	Delete(nodes);
+}
+
 /* =============================================================================
  * POMCP class
  * =============================================================================*/
 
 POMCP::POMCP(const DSPOMDP* model, POMCPPrior* prior, Belief* belief) :
 	Solver(model, belief),
-	root_(NULL) {
+	root_(NULL),
+	num_sims_(0),
+	table_(NULL),
+	next_waiting_particle_(0) {
 	reuse_ = false;
 	prior_ = prior;
 	assert(prior_ != NULL);
 }
 
+POMCP::~POMCP() {
+	FreeWaitingParticles();
+	DeleteTree();
+	delete table_;
+	delete prior_;
+}
+
 void POMCP::reuse(bool r) {
 	reuse_ = r;
 }
+
+void POMCP::transposition(int window) {
+	DeleteTree();
+	delete table_;
+	table_ = window > 0 ? new POMCPTranspositionTable(window) : NULL;
+}
+
+void POMCP::CreateRoot() {
+	State* state = belief_->Sample(1)[0];
+	root_ = CreateVNode(0, state, prior_, model_);
+	model_->Free(state);
+
+	if (table_ != NULL)
+		table_->Insert(prior_->history(), root_);
+}
+
+void POMCP::DeleteTree() {
+	if (table_ != NULL)
+		table_->Clear();
+	else
+		delete root_;
+	root_ = NULL;
+}
+
+int POMCP::TreeSize() const {
+	if (root_ == NULL)
+		return 0;
+
+	int size = 1;
+	for (int a = 0; a < root_->children().size(); a++)
+		size += root_->Child(a)->subtree_size();
+	return size;
+}
+
+void POMCP::RecountTree() {
+	// Breadth first, so the descendants of a node come after it
+	vector<VNode*> nodes(1, root_);
+	unordered_set<VNode*> visited(nodes.begin(), nodes.end());
+	for (int i = 0; i < nodes.size(); i++) {
+		VNode* vnode = nodes[i];
+		for (int a = 0; a < vnode->children().size(); a++) {
+			QNode* qnode = vnode->Child(a);
+			qnode->subtree_stats(0, 0);
+			map<OBS_TYPE, VNode*>& vnodes = qnode->children();
+			for (map<OBS_TYPE, VNode*>::iterator it = vnodes.begin();
+				it != vnodes.end(); it++) {
+				if (it->second != NULL && visited.insert(it->second).second) {
+					it->second->parent(qnode);
+					nodes.push_back(it->second);
+				}
+			}
+		}
+	}
+
+	for (int i = nodes.size() - 1; i > 0; i--) {
+		VNode* vnode = nodes[i];
+		int size = 1, height = 1;
+		for (int a = 0; a < vnode->children().size(); a++) {
+			size += vnode->Child(a)->subtree_size();
+			height = max(height, vnode->Child(a)->subtree_height() + 1);
+		}
+		QNode* parent = vnode->parent();
+		parent->subtree_stats(parent->subtree_size() + size,
+			max(parent->subtree_height(), height));
+	}
+}
+
+// Evicting down to this fraction of the budget keeps the (sorting) evictions
+// at least max_tree_nodes / 10 simulations apart.
+static const double NODE_BUDGET_LOW_WATER = 0.9;
+
+void POMCP::ApplyNodeBudget() {
+	int budget = Globals::config.max_tree_nodes;
+	int size = TreeSize();
+	if (budget <= 0 || size <= budget)
+		return;
+
+	int evicted = EvictColdNodes(size - (int) (budget * NODE_BUDGET_LOW_WATER));
+	logd << "[POMCP::ApplyNodeBudget] Evicted " << evicted << " nodes, "
+		<< TreeSize() << " left" << endl;
+}
+
+int POMCP::EvictColdNodes(int num) {
+	// Belief nodes below the root (shared nodes once)
+	vector<VNode*> nodes;
+	unordered_set<VNode*> visited;
+	vector<VNode*> stack(1, root_);
+	visited.insert(root_);
+	while (!stack.empty()) {
+		VNode* vnode = stack.back();
+		stack.pop_back();
+		if (vnode != root_)
+			nodes.push_back(vnode);
+		for (int a = 0; a < vnode->children().size(); a++) {
+			map<OBS_TYPE, VNode*>& vnodes = vnode->Child(a)->children();
+			for (map<OBS_TYPE, VNode*>::iterator it = vnodes.begin();
+				it != vnodes.end(); it++) {
+				if (it->second != NULL && visited.insert(it->second).second)
+					stack.push_back(it->second);
+			}
+		}
+	}
+
+	// Least visited first, deeper first among equal counts. A node shared
+	// through the transposition table can be visited more often than a
+	// parent it comes after, so the order alone does not put children first;
+	// a node is evicted only once all its children are (the leaf check),
+	// which keeps the remaining tree connected.
+	sort(nodes.begin(), nodes.end(), [](const VNode* a, const VNode* b) {
+		return a->count() != b->count() ? a->count() < b->count()
+			: a->depth() > b->depth();
+	});
+
+	unordered_set<VNode*> evicted;
+	for (int i = 0; i < nodes.size() && evicted.size() < num; i++) {
+		VNode* vnode = nodes[i];
+		bool leaf = true;
+		for (int a = 0; a < vnode->children().size() && leaf; a++) {
+			map<OBS_TYPE, VNode*>& vnodes = vnode->Child(a)->children();
+			for (map<OBS_TYPE, VNode*>::iterator it = vnodes.begin();
+				it != vnodes.end() && leaf; it++)
+				leaf = it->second == NULL || evicted.find(it->second) != evicted.end();
+		}
+		if (leaf)
+			evicted.insert(vnode);
+	}
+
+	// Unlink the evicted nodes from the kept ones, then delete them
+	nodes.push_back(root_);
+	for (int i = 0; i < nodes.size(); i++) {
+		VNode* vnode = nodes[i];
+		bool is_evicted = evicted.find(vnode) != evicted.end();
+		for (int a = 0; a < vnode->children().size(); a++) {
+			map<OBS_TYPE, VNode*>& vnodes = vnode->Child(a)->children();
+			if (is_evicted) {
+				vnodes.clear();
+				continue;
+			}
+			for (map<OBS_TYPE, VNode*>::iterator it = vnodes.begin();
+				it != vnodes.end();) {
+				if (it->second == NULL || evicted.find(it->second) != evicted.end())
+					vnodes.erase(it++);
+				else
+					it++;
+			}
+		}
+	}
+
+	if (table_ != NULL)
+		table_->Erase(evicted);
+	for (unordered_set<VNode*>::iterator it = evicted.begin(); it != evicted.end();
+		it++)
+		delete *it;
+
+	// Subtree sizes and heights of shared nodes are not along one parent
+	// chain, count them again
+	RecountTree();
+
+	return evicted.size();
+}
 ValuedAction POMCP::Search(double timeout) {
 	double start_cpu = clock(), start_real = get_time_second();
 
 	double searchStart = get_time_second();
-	if (root_ == NULL) {
-		State* state = belief_->Sample(1)[0];
-		root_ = CreateVNode(0, state, prior_, model_);
-		model_->Free(state);
-	}
+	if (root_ == NULL)
+		CreateRoot();
 
 	int hist_size = history_.Size();
 	bool done = false;
@@ -90,7 +358,8 @@ ValuedAction POMCP::Search(double timeout) {
 			State* particle = particles[i];
 			logd << "[POMCP::Search] Starting simulation " << num_sims << endl;
 
-			Simulate(particle, root_, model_, prior_);
+			Simulate(particle, root_, model_, prior_, table_);
+			ApplyNodeBudget();
 			num_sims++;
 			logd << "[POMCP::Search] " << num_sims << " simulations done" << endl;
 			history_.Truncate(hist_size);
@@ -109,6 +378,7 @@ ValuedAction POMCP::Search(double timeout) {
 			break;
 	}
 
+	num_sims_ += num_sims;
 	ValuedAction astar = OptimalAction(root_);
 
 	logi << "[POMCP::Search] Search statistics" << endl
@@ -116,7 +386,7 @@ ValuedAction POMCP::Search(double timeout) {
 		<< "# Simulations = " << root_->count() << endl
 		<< "Time: CPU / Real = " << ((clock() - start_cpu) / CLOCKS_PER_SEC) << " / " << (get_time_second() - start_real) << endl
 		<< "# active particles = " << model_->NumActiveParticles() << endl
-		<< "Tree size = " << root_->Size() << endl;
+		<< "Tree size = " << TreeSize() << endl;
 
 	if (astar.action == -1) {
 		for (int action = 0; action < model_->NumActions(); action++) {
@@ -138,13 +408,8 @@ void POMCP::Search(TreeDevelopThread * threadData, int action)
 {	
 	double searchStart = get_time_second();
 
-	if (root_ == NULL) 
-	{
-
-		State* state = belief_->Sample(1)[0];
-		root_ = CreateVNode(0, state, prior_, model_);
-		model_->Free(state);
-	}
+	if (root_ == NULL)
+		CreateRoot();
 
 	int hist_size = history_.Size();
 	
@@ -156,7 +421,9 @@ void POMCP::Search(TreeDevelopThread * threadData, int action)
 		{
 			State* particle = particles[i];
 
-			Simulate(particle, root_, model_, prior_, action);
+			Simulate(particle, root_, model_, prior_, action, table_);
+			ApplyNodeBudget();
+			++num_sims_;
 			history_.Truncate(hist_size);
 
 			std::lock_guard<std::mutex> lock(threadData->m_treeFlagsMutex);
@@ -177,17 +444,64 @@ void POMCP::Search(TreeDevelopThread * threadData, int action)
 
 }
 
+bool POMCP::SearchWhileWaiting(int action, double timeout)
+{
+	// without reuse the tree is deleted in Update
+	if (!reuse_ || root_ == NULL)
+		return false;
+
+	double searchStart = get_time_second();
+	int hist_size = history_.Size();
+
+	// the slices are short, particles are sampled in batches that last over several slices
+	while (get_time_second() - searchStart < timeout)
+	{
+		if (next_waiting_particle_ == waiting_particles_.size())
+		{
+			FreeWaitingParticles();
+			waiting_particles_ = belief_->Sample(100);
+		}
+
+		Simulate(waiting_particles_[next_waiting_particle_++], root_, model_, prior_, action, table_);
+		ApplyNodeBudget();
+		++num_sims_;
+		history_.Truncate(hist_size);
+	}
+
+	return true;
+}
+
+void POMCP::FreeWaitingParticles()
+{
+	for (int i = 0; i < waiting_particles_.size(); i++)
+		model_->Free(waiting_particles_[i]);
+
+	waiting_particles_.clear();
+	next_waiting_particle_ = 0;
+}
+
 void POMCP::belief(Belief* b) {
+	FreeWaitingParticles();
 	belief_ = b;
 	history_.Truncate(0);
   prior_->PopAll();
-	delete root_;
-	root_ = NULL;
+	DeleteTree();
 }
 
 void POMCP::Update(int action, OBS_TYPE obs) {
 	double start = get_time_second();
-	if (reuse_) {
+	FreeWaitingParticles();
+	if (reuse_ && table_ != NULL) {
+		VNode* node = root_->Child(action)->Child(obs);
+		if (node != NULL) {
+			table_->Retain(node);
+			root_ = node;
+			root_->parent(NULL);
+			RecountTree();
+		} else {
+			DeleteTree();
+		}
+	} else if (reuse_) {
 		VNode* node = root_->Child(action)->Child(obs);
 		root_->Child(action)->children().erase(obs);
 		delete root_;
@@ -197,8 +511,7 @@ void POMCP::Update(int action, OBS_TYPE obs) {
 			root_->parent(NULL);
 		}
 	} else {
-		delete root_;
-		root_ = NULL;
+		DeleteTree();
 	}
 
 	prior_->Add(action, obs);
@@ -265,6 +578,7 @@ int POMCP::Count(const VNode* vnode) {
 
 void POMCP::UpdateHistory(int action, OBS_TYPE obs)
 {
+	FreeWaitingParticles();
 	history_.Add(action, obs);
 	prior_->Add(action, obs);
 	belief_->Update(action, obs);
@@ -286,25 +600,10 @@ void POMCP::GetTreeProperties(Tree_Properties & treeProp) const // NATAN CHANGES
 	int maxHeight = 0;
 	for (int a = 0; a < numChildren; ++a)
 	{
-		auto actionTree = root_->Child(a);
-
-		if (actionTree != nullptr)
-		{
-			treeProp.m_actionsChildren[a].m_nodeCount = actionTree->count();
-			treeProp.m_actionsChildren[a].m_nodeValue = actionTree->value();
-			treeProp.m_actionsChildren[a].m_size = actionTree->Size();
-			treeProp.m_actionsChildren[a].m_height = actionTree->height();
+		GetSingleActionTreeProp(treeProp.m_actionsChildren[a], a);
 
-			maxHeight = max(actionTree->height(), maxHeight);
-			rootSize += treeProp.m_actionsChildren[a].m_size;
-		}
-		else
-		{
-			treeProp.m_actionsChildren[a].m_nodeCount = 0;
-			treeProp.m_actionsChildren[a].m_nodeValue = 0;
-			treeProp.m_actionsChildren[a].m_size = 0;
-			treeProp.m_actionsChildren[a].m_height = 0;
-		}
+		maxHeight = max(treeProp.m_actionsChildren[a].m_height, maxHeight);
+		rootSize += treeProp.m_actionsChildren[a].m_size;
 	}
 
 	treeProp.m_rootTreeProp.m_size = rootSize;
@@ -322,10 +621,11 @@ void POMCP::GetSingleActionTreeProp(SingleNodeTreeProp & treeProp, int action) c
 
 	if (actionTree != nullptr)
 	{
+		// maintained as nodes are added and evicted, so no walk of the tree
 		treeProp.m_nodeCount = actionTree->count();
 		treeProp.m_nodeValue = actionTree->value();
-		treeProp.m_size = actionTree->Size();
-		treeProp.m_height = actionTree->height();
+		treeProp.m_size = actionTree->subtree_size();
+		treeProp.m_height = actionTree->subtree_height();
 	}
 	else
 	{
@@ -393,6 +693,51 @@ VNode* POMCP::CreateVNode(int depth, const State* state, POMCPPrior* prior,
 	return vnode;
 }
 
+VNode* POMCP::FindChild(QNode* qnode, OBS_TYPE& obs, int depth,
+	POMCPPrior* prior, POMCPTranspositionTable* table) {
+	map<OBS_TYPE, VNode*>& vnodes = qnode->children();
+	map<OBS_TYPE, VNode*>::iterator it = vnodes.find(obs);
+	if (it != vnodes.end() && it->second != NULL)
+		return it->second;
+
+	// Progressive widening: at most k * N^alpha children after N visits. A
+	// node shared through table is a new child as well, so it is linked only
+	// when a new child is allowed.
+	double k = Globals::config.widening_k;
+	if (k <= 0 || vnodes.size() < k * pow(qnode->count() + 1.0, Globals::config.widening_alpha)) {
+		VNode* shared = table != NULL ? table->Find(prior->history(), depth) : NULL;
+		if (shared != NULL)
+			vnodes[obs] = shared;
+		return shared;
+	}
+
+	// Continue with a child drawn by its share of the visits (new children,
+	// which were only rolled out, count once)
+	double total = 0;
+	for (it = vnodes.begin(); it != vnodes.end(); it++) {
+		if (it->second != NULL)
+			total += it->second->count() + 1;
+	}
+	if (total == 0)
+		return NULL;
+
+	double r = Random::s_threadRand.NextDouble() * total;
+	VNode* child = NULL;
+	for (it = vnodes.begin(); it != vnodes.end(); it++) {
+		if (it->second == NULL)
+			continue;
+		obs = it->first;
+		child = it->second;
+		r -= child->count() + 1;
+		if (r < 0)
+			break;
+	}
+
+	prior->PopLast();
+	prior->Add(qnode->edge(), obs);
+	return child;
+}
+
 double POMCP::Simulate(State* particle, RandomStreams& streams, VNode* vnode,
 	const DSPOMDP* model, POMCPPrior* prior) {
 	if (streams.Exhausted())
@@ -422,6 +767,8 @@ double POMCP::Simulate(State* particle, RandomStreams& streams, VNode* vnode,
         * Rollout(particle, streams, vnode->depth() + 1, model, prior);
 			vnodes[obs] = CreateVNode(vnode->depth() + 1, particle, prior,
 				model);
+			vnodes[obs]->parent(qnode);
+			vnodes[obs]->CountInAncestors(1);
 		}
 		streams.Back();
 		prior->PopLast();
@@ -435,7 +782,8 @@ double POMCP::Simulate(State* particle, RandomStreams& streams, VNode* vnode,
 
 
 // static
-double POMCP::Simulate(State* particle, VNode* vnode, const DSPOMDP* model, POMCPPrior* prior, int action)
+double POMCP::Simulate(State* particle, VNode* vnode, const DSPOMDP* model, POMCPPrior* prior, int action,
+	POMCPTranspositionTable* table)
 {
 	assert(vnode != NULL);
 
@@ -452,15 +800,19 @@ double POMCP::Simulate(State* particle, VNode* vnode, const DSPOMDP* model, POMC
 	QNode* qnode = vnode->Child(action);
 	if (!terminal) {
 		prior->Add(action, obs);
-		map<OBS_TYPE, VNode*>& vnodes = qnode->children();
-		if (vnodes[obs] != NULL)
+		VNode* child = FindChild(qnode, obs, vnode->depth() + 1, prior, table);
+		if (child != NULL)
 		{
-			reward += Globals::Discount() * Simulate(particle, vnodes[obs], model, prior);
+			reward += Globals::Discount() * Simulate(particle, child, model, prior, table);
 		}
 		else
 		{ // Rollout upon encountering a node not in curren tree, then add the node
-			vnodes[obs] = CreateVNode(vnode->depth() + 1, particle, prior,
-				model);
+			child = CreateVNode(vnode->depth() + 1, particle, prior, model);
+			qnode->children()[obs] = child;
+			child->parent(qnode);
+			child->CountInAncestors(1);
+			if (table != NULL)
+				table->Insert(prior->history(), child);
 			reward += Globals::Discount()
 				* Rollout(particle, vnode->depth() + 1, model, prior);
 		}
@@ -474,7 +826,8 @@ double POMCP::Simulate(State* particle, VNode* vnode, const DSPOMDP* model, POMC
 }
 
 // static
-double POMCP::Simulate(State* particle, VNode* vnode, const DSPOMDP* model, POMCPPrior* prior) 
+double POMCP::Simulate(State* particle, VNode* vnode, const DSPOMDP* model, POMCPPrior* prior,
+	POMCPTranspositionTable* table)
 {
 	assert(vnode != NULL);
 	
@@ -492,15 +845,19 @@ double POMCP::Simulate(State* particle, VNode* vnode, const DSPOMDP* model, POMC
 	QNode* qnode = vnode->Child(action);
 	if (!terminal) {
 		prior->Add(action, obs);
-		map<OBS_TYPE, VNode*>& vnodes = qnode->children();
-		if (vnodes[obs] != NULL) 
+		VNode* child = FindChild(qnode, obs, vnode->depth() + 1, prior, table);
+		if (child != NULL)
 		{
-			reward += Globals::Discount() * Simulate(particle, vnodes[obs], model, prior);
-		} 
-		else 
+			reward += Globals::Discount() * Simulate(particle, child, model, prior, table);
+		}
+		else
 		{ // Rollout upon encountering a node not in curren tree, then add the node
-			vnodes[obs] = CreateVNode(vnode->depth() + 1, particle, prior,
-				model);
+			child = CreateVNode(vnode->depth() + 1, particle, prior, model);
+			qnode->children()[obs] = child;
+			child->parent(qnode);
+			child->CountInAncestors(1);
+			if (table != NULL)
+				table->Insert(prior->history(), child);
 			reward += Globals::Discount()
 				* Rollout(particle, vnode->depth() + 1, model, prior);
 		}
@@ -665,6 +1022,7 @@ ValuedAction DPOMCP::Search(double timeout) {
 	}
 
 	delete root_;
+	root_ = NULL;
 	return astar;
 }
 
@@ -684,7 +1042,7 @@ VNode* DPOMCP::ConstructTree(vector<State*>& particles, RandomStreams& streams,
 	while (true) {
 		logd << "Simulation " << num_sims << endl;
 
-		int index = Random::RANDOM.NextInt(particles.size());
+		int index = Random::s_threadRand.NextInt(particles.size());
 		State* particle = model->Copy(particles[index]);
 		Simulate(particle, streams, root, model, prior);
 		num_sims++;
@@ -17,8 +17,8 @@ double Gamma::Next(double k, double theta) {
 		double d = (1 - k) * pow(k, k / (1 - k));
 		double z, e, x;
 		while (true) { //Weibull's algorithm
-			double u = Random::RANDOM.NextDouble();
-			double v = Random::RANDOM.NextDouble();
+			double u = Random::s_threadRand.NextDouble();
+			double v = Random::s_threadRand.NextDouble();
 			z = -log(u);
 			e = -log(v);
 			x = pow(z, c);
@@ -32,8 +32,8 @@ double Gamma::Next(double k, double theta) {
 		double e = 1 + log(4.5);
 		double x, y, z, r;
 		while (true) {
-			double u = Random::RANDOM.NextDouble();
-			double v = Random::RANDOM.NextDouble();
+			double u = Random::s_threadRand.NextDouble();
+			double v = Random::s_threadRand.NextDouble();
 			y = log(v / (1 - v)) / d;
 			x = k * exp(y);
 			z = u * v * v;
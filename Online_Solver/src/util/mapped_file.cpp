@@ -0,0 +1,111 @@
+#include "../../include/despot/util/mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace despot {
+
+MappedFile::MappedFile() :
+	data_(NULL),
+	size_(0)
+#ifdef _WIN32
+	, file_(INVALID_HANDLE_VALUE),
+	mapping_(NULL)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const string& path) {
+	Close();
+
+	file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file_ == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+
+	mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping_ == NULL) {
+		Close();
+		return false;
+	}
+
+	data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+	if (data_ == NULL) {
+		Close();
+		return false;
+	}
+	size_ = (size_t) size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (data_ != NULL)
+		UnmapViewOfFile(data_);
+	if (mapping_ != NULL)
+		CloseHandle(mapping_);
+	if (file_ != INVALID_HANDLE_VALUE)
+		CloseHandle(file_);
+
+	data_ = NULL;
+	size_ = 0;
+	mapping_ = NULL;
+	file_ = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::Open(const string& path) {
+	Close();
+
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return false;
+
+	data_ = static_cast<const char*>(data);
+	size_ = st.st_size;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (data_ != NULL)
+		munmap(const_cast<char*>(data_), size_);
+
+	data_ = NULL;
+	size_ = 0;
+}
+
+#endif
+
+} // namespace despot
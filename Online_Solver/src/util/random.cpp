@@ -4,6 +4,7 @@
 #include <math.h>
 #include <cstdlib>
 #include <random>
+#include <atomic>
 
 #include <time.h>
 
@@ -13,7 +14,16 @@ namespace despot {
 
 Random Random::RANDOM((unsigned) 0);
 
-std::map<int, Random> Random::s_threadSafeRand;
+static std::atomic<unsigned> s_threadSeedBase(0);
+static std::atomic<unsigned> s_numThreadRands(0);
+
+// threads that are not seeded explicitly are still drawing different streams
+static unsigned DefaultThreadSeed() {
+	unsigned thread = s_numThreadRands++;
+	return s_threadSeedBase + thread * 2654435761u;
+}
+
+thread_local Random Random::s_threadRand(DefaultThreadSeed());
 
 Random::Random() :
 seed_((unsigned)(time(NULL))) 
@@ -33,30 +43,42 @@ unsigned Random::seed() {
 	return seed_;
 }
 
+// rand_r of glibc, kept here since it is not available on every platform.
+// the state is the seed of the instance, so every Random (and every thread
+// with its own Random) draws its own stream instead of the shared std::rand
 unsigned Random::NextUnsigned() {
-//###	return rand_r(&seed_);
-	return  std::rand();
+	unsigned next = seed_;
+	unsigned result;
+
+	next = next * 1103515245 + 12345;
+	result = (next / 65536) % 2048;
+
+	next = next * 1103515245 + 12345;
+	result <<= 10;
+	result ^= (next / 65536) % 1024;
+
+	next = next * 1103515245 + 12345;
+	result <<= 10;
+	result ^= (next / 65536) % 1024;
+
+	seed_ = next;
+	return result;
 }
 
 int Random::NextInt(int n) {
-	// return (int) (n * ((double) rand_r(&seed_) / RAND_MAX));
-//###	return rand_r(&seed_) % n;
-	return  std::rand() % n;
+	return NextUnsigned() % n;
 }
 
 int Random::NextInt(int min, int max) {
-	//###	return rand_r(&seed_) % (max - min) + min;
-	return std::rand() % (max - min) + min;
+	return NextUnsigned() % (max - min) + min;
 }
 
 double Random::NextDouble(double min, double max) {
-//###	return (double) rand_r(&seed_) / RAND_MAX * (max - min) + min;
-	return static_cast<double>(std::rand()) / RAND_MAX * (max - min) + min;
+	return static_cast<double>(NextUnsigned()) / MAX_UNSIGNED * (max - min) + min;
 }
 
 double Random::NextDouble() {
-//###	return (double) rand_(&seed_) / RAND_MAX;
-	return static_cast<double>(std::rand()) / RAND_MAX;
+	return static_cast<double>(NextUnsigned()) / MAX_UNSIGNED;
 }
 
 double Random::NextGaussian() {
@@ -78,4 +100,12 @@ int Random::GetCategory(const vector<double>& category_probs, double rand_num) {
 	return c;
 }
 
+void Random::InitThreadRand(const Random & ran) {
+	s_threadRand = ran;
+}
+
+void Random::ThreadSeedBase(unsigned seed) {
+	s_threadSeedBase = seed;
+}
+
 } // namespace despot
@@ -11,6 +11,7 @@ Random Seeds::seed_gen_ = Random((unsigned) 0);
 void Seeds::root_seed(unsigned value) {
 	root_seed_ = value;
 	seed_gen_ = Random(root_seed_);
+	Random::ThreadSeedBase(root_seed_);
 }
 
 unsigned Seeds::Next() {
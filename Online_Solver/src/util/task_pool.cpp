@@ -0,0 +1,116 @@
+#include "../../include/despot/util/task_pool.h"
+#include "../../include/despot/util/random.h"
+
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+
+namespace despot {
+
+TaskPool::TaskPool(int num_workers, unsigned seed) :
+	queues_(),
+	threads_(),
+	num_queued_(0),
+	stop_(false) {
+	if (num_workers < 1)
+		num_workers = 1;
+
+	for (int i = 0; i < num_workers; i++)
+		queues_.push_back(unique_ptr<Queue>(new Queue()));
+
+	for (int i = 1; i < num_workers; i++)
+		threads_.push_back(thread(&TaskPool::WorkerMain, this, i, seed + i));
+}
+
+TaskPool::~TaskPool() {
+	{
+		lock_guard<mutex> lock(idle_mutex_);
+		stop_ = true;
+	}
+	idle_cond_.notify_all();
+
+	for (int i = 0; i < threads_.size(); i++)
+		threads_[i].join();
+}
+
+void TaskPool::Submit(Group& group, int worker, const Task& task) {
+	group.pending_++;
+	{
+		Queue& queue = *queues_[worker];
+		lock_guard<mutex> lock(queue.mutex);
+		// the seed is drawn by the submitting thread, so the numbers a task
+		// draws do not depend on the worker that runs it
+		Entry entry = { task, &group, Random::s_threadRand.NextUnsigned() };
+		queue.entries.push_back(entry);
+	}
+	num_queued_++;
+
+	{
+		lock_guard<mutex> lock(idle_mutex_);
+	}
+	idle_cond_.notify_one();
+}
+
+void TaskPool::Wait(Group& group, int worker) {
+	while (group.pending_ > 0) {
+		// tasks of the group may be running on other workers
+		if (!RunOne(worker))
+			this_thread::yield();
+	}
+}
+
+bool TaskPool::RunOne(int worker) {
+	Entry entry;
+	bool found = false;
+
+	{ // newest task of own queue
+		Queue& queue = *queues_[worker];
+		lock_guard<mutex> lock(queue.mutex);
+		if (!queue.entries.empty()) {
+			entry = queue.entries.back();
+			queue.entries.pop_back();
+			found = true;
+		}
+	}
+
+	// steal oldest task of other queues
+	for (int i = 1; i < queues_.size() && !found; i++) {
+		Queue& queue = *queues_[(worker + i) % queues_.size()];
+		lock_guard<mutex> lock(queue.mutex);
+		if (!queue.entries.empty()) {
+			entry = queue.entries.front();
+			queue.entries.pop_front();
+			found = true;
+		}
+	}
+
+	if (!found)
+		return false;
+
+	num_queued_--;
+	// a waiting worker runs tasks in the middle of its own, keep its random
+	Random saved = Random::s_threadRand;
+	Random::InitThreadRand(Random(entry.seed));
+	entry.task(worker);
+	Random::InitThreadRand(saved);
+	entry.group->pending_--;
+	return true;
+}
+
+void TaskPool::WorkerMain(int worker, unsigned seed) {
+	// rand state is kept per thread
+	srand(seed);
+	Random::InitThreadRand(Random(seed));
+
+	while (!stop_) {
+		if (RunOne(worker))
+			continue;
+
+		unique_lock<mutex> lock(idle_mutex_);
+		idle_cond_.wait_for(lock, chrono::milliseconds(10),
+			[this] { return stop_ || num_queued_ > 0; });
+	}
+}
+
+} // namespace despot
@@ -622,7 +622,7 @@ void SC2AgentBelief::Update(int action, OBS_TYPE obs)
 	for (int i = 0; i <particles_.size(); i++) {
 		State* particle = particles_[i];
 
-		bool terminal = model_->Step(*particle, Random::RANDOM.NextDouble(), action, reward, o);
+		bool terminal = model_->Step(*particle, Random::s_threadRand.NextDouble(), action, reward, o);
 		
 		// copy fully observed params from observation
 		SC2DetailedState::CopyFullyObservedFromObservation(obs, particle);
@@ -680,7 +680,7 @@ std::vector<State*> SC2AgentBelief::Resample(int num, const std::vector<State*>&
 	const SC2BasicAgent * modelCast = static_cast<const SC2BasicAgent *>(model);
 
 	double unit = 1.0 / num;
-	double mass = Random::RANDOM.NextDouble(0, unit);
+	double mass = Random::s_threadRand.NextDouble(0, unit);
 	int pos = 0;
 	double cur = belief[0]->weight;
 
@@ -711,7 +711,7 @@ std::vector<State*> SC2AgentBelief::Resample(int num, const std::vector<State*>&
 		
 		for (int i = 0; i < history.Size(); i++)
 		{
-			model->Step(*particle, Random::RANDOM.NextDouble(), history.Action(i), reward, obs);
+			model->Step(*particle, Random::s_threadRand.NextDouble(), history.Action(i), reward, obs);
 
 			double prob = SC2DetailedState::ObsProbPartialObsVars(history.Observation(i), particle->state_id);
 			//double prob = model->ObsProb(history.Observation(i), *particle, history.Action(i));
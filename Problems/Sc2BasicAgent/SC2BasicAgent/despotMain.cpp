@@ -63,7 +63,7 @@ int main(int argc, char* argv[])
 	
 	/// seed main thread random num
 	Random randStream((unsigned)time(NULL));
-	Random::s_threadSafeRand[GetCurrentThreadId()] = randStream;
+	Random::InitThreadRand(randStream);
 
 	int vbsPort = s_EXTERNAL_SIMULATOR ? s_PORT_VBS : -1;
 	int treePort = s_TO_SEND_TREE ? s_PORT_SEND_TREE : -1;
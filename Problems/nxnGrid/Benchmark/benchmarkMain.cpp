@@ -0,0 +1,915 @@
+#include <fstream>      // std::ofstream
+#include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cctype>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include <windows.h>
+#include <psapi.h>		// peak memory of process
+
+/// tui class
+#include <simple_tui.h>
+
+/// models available
+#include "nxnGridGlobalActions.h"
+#include "nxnGridLocalActions.h"
+
+/// for nxnGrid
+
+// properties of objects
+#include "Coordinate.h"
+#include "Move_Properties.h"
+#include "Attacks.h"
+#include "Observations.h"
+
+// objects
+#include "Attack_Obj.h"
+#include "Movable_Obj.h"
+#include "Self_Obj.h"
+#include "ObjInGrid.h"
+
+/// other models (despot examples)
+#include "tag/tag.h"
+#include "rock_sample/rock_sample.h"
+#include "pocman.h"
+#include "tiger.h"
+
+using namespace despot;
+
+/// headless benchmark of the online solvers on nxnGrid and on the despot example models (tag, rock_sample, pocman, tiger).
+/// usage: Benchmark.exe [-o result.json] scenario1.txt scenario2.txt ...
+/// each scenario file is a list of "key = value" lines (see scenarios directory).
+/// the results of all scenarios are written as one json document (to stdout if -o is not given)
+/// solvers not running on a model are reported as skipped:
+/// POMCP and Parallel_POMCP only on nxnGrid (their rollouts use the preferred actions of OnlineSolverModel),
+/// AEMS only on models that are a BeliefMDP (tag and rock_sample)
+
+static const std::vector<std::string> s_DEFAULT_SCENARIOS{ "scenarios\\grid5_1enemy.txt", "scenarios\\grid10_1enemy.txt" };
+static const char * s_BENCHMARK_VERSION = "2";
+
+/// scenario read from file
+struct BenchmarkScenario
+{
+	BenchmarkScenario()
+	: m_name("unnamed"), m_model("nxnGrid"), m_gridSize(10), m_numRocks(8), m_solvers{ "POMCP" }, m_beliefType(), m_numRounds(20), m_numWorkers(1), m_numExpansionThreads(1), m_isDespotReuse(false), m_pomcpTransposition(0), m_maxTreeNodes(0), m_wideningK(0), m_wideningAlpha(0.5), m_seed(42)
+	, m_timePerMove(1.0), m_simLen(150), m_numParticles(-1), m_lutFName("naive"), m_lutGridSize(-1), m_lutCalcType(nxnGrid::WITHOUT)
+	, m_isMoveFromEnemyExist(false), m_self{ 0 }, m_enemies(), m_nonInvolved(), m_shelters()
+	{}
+
+	std::string m_name;
+	/// nxnGrid, tag, rock_sample, pocman or tiger
+	std::string m_model;
+	int m_gridSize;
+	/// number of rocks of rock_sample
+	int m_numRocks;
+	std::vector<std::string> m_solvers;
+	/// empty for the default belief of the model
+	std::string m_beliefType;
+	int m_numRounds;
+	/// number of rounds running simultaneously (each worker with its own model, solver and belief)
+	int m_numWorkers;
+	/// number of threads expanding each DESPOT tree
+	int m_numExpansionThreads;
+	/// keep DESPOT subtree of executed action and observation between moves
+	bool m_isDespotReuse;
+	/// number of last observations POMCP belief nodes are shared by (0 for no transpositions)
+	int m_pomcpTransposition;
+	/// max. number of POMCP belief nodes, least visited are evicted above it (0 for no limit)
+	int m_maxTreeNodes;
+	/// POMCP progressive widening: new observation child only below k * N^alpha children (k = 0 for no widening)
+	double m_wideningK;
+	double m_wideningAlpha;
+	unsigned int m_seed;
+	double m_timePerMove;
+	int m_simLen;
+	int m_numParticles;
+
+	std::string m_lutFName;
+	int m_lutGridSize;
+	nxnGrid::CALCULATION_TYPE m_lutCalcType;
+	bool m_isMoveFromEnemyExist;
+
+	/// init locations of each object
+	intVec m_self;
+	std::vector<intVec> m_enemies;
+	std::vector<intVec> m_nonInvolved;
+	std::vector<intVec> m_shelters;
+};
+
+/// measurements of one solver on one scenario
+struct BenchmarkResult
+{
+	BenchmarkResult() : m_skipped(false), m_reason(), m_numSimulations(0), m_searchTime(0.0), m_decisionTimes(), m_treeSizes()
+	, m_rewards(), m_steps(), m_wins(0), m_losses(0), m_numWorkers(1), m_peakMemory(0), m_wallTime(0.0) {}
+
+	bool m_skipped;
+	std::string m_reason;
+
+	long long m_numSimulations;
+	double m_searchTime;
+	doubleVec m_decisionTimes;
+	std::vector<unsigned int> m_treeSizes;
+
+	doubleVec m_rewards;
+	intVec m_steps;
+	int m_wins;
+	int m_losses;
+
+	int m_numWorkers;
+	/// largest growth of the working set above its size at the start of the scenario
+	size_t m_peakMemory;
+	double m_wallTime;
+};
+
+/// samples the working set while a scenario runs. PeakWorkingSetSize is the peak of the process since it started,
+/// so every scenario after the first would report the largest peak so far instead of its own
+class ScenarioMemory
+{
+public:
+	ScenarioMemory();
+	~ScenarioMemory();
+
+	ScenarioMemory(const ScenarioMemory &) = delete;
+	ScenarioMemory &operator=(const ScenarioMemory &) = delete;
+
+	/// stop sampling and return the peak growth of the working set in bytes
+	size_t Stop();
+
+private:
+	void Sample();
+
+	size_t m_start;
+	size_t m_peak;
+	bool m_stop;
+	std::mutex m_mutex;
+	std::condition_variable m_stopCond;
+	std::thread m_sampler;
+};
+
+bool ReadScenario(const std::string & fName, BenchmarkScenario & scenario);
+void RunScenario(const BenchmarkScenario & scenario, const std::string & solverType, BenchmarkResult & result);
+void RunRound(SolverBase * solver, DSPOMDP * model, const BenchmarkScenario & scenario, int round, BenchmarkResult & result);
+void RunRoundsBatch(std::vector<SolverBase *> & solvers, std::vector<DSPOMDP *> & models, const BenchmarkScenario & scenario, BenchmarkResult & result);
+void MergeResult(BenchmarkResult & result, const BenchmarkResult & roundResult);
+void RunRoundParallel(ParallelSolver * solver, DSPOMDP * model, const BenchmarkScenario & scenario, int round, BenchmarkResult & result);
+void CountEndOfRound(DSPOMDP * model, bool terminal, double reward, BenchmarkResult & result);
+void FreeStartState(DSPOMDP * model, State * state);
+void WriteResult(std::ostream & out, const BenchmarkScenario & scenario, const std::string & solverType, const BenchmarkResult & result);
+std::string JsonString(const std::string & str);
+
+void ReadOfflineLUT(const std::string & lutFName, bool isMoveFromEnemyExist, std::map<STATE_TYPE, std::vector<double>> &offlineLut);
+size_t WorkingSetSize();
+double Percentile(doubleVec sortedVec, double p);
+
+Attack_Obj CreateEnemy(int x, int y, int gridSize);
+Movable_Obj CreateNInv(int x, int y);
+Self_Obj CreateSelf(int x, int y, int gridSize);
+ObjInGrid CreateShelter(int x, int y);
+
+/// create models according to the scenario running
+class BenchmarkTUI : public SimpleTUI {
+public:
+	explicit BenchmarkTUI(const BenchmarkScenario & scenario) : m_scenario(scenario) {}
+
+	DSPOMDP* InitializeModel(option::Option* options) override
+	{
+		// parameters of the example models are the ones of their own main
+		if (m_scenario.m_model == "tag")
+			return new Tag();
+		else if (m_scenario.m_model == "rock_sample")
+			return new RockSample(m_scenario.m_gridSize, m_scenario.m_numRocks);
+		else if (m_scenario.m_model == "pocman")
+			return new FullPocman();
+		else if (m_scenario.m_model == "tiger")
+			return new Tiger();
+
+		// init static members
+		nxnGridDetailedState::InitStatic();
+
+		int gridSize = m_scenario.m_gridSize;
+		Self_Obj self = CreateSelf(0, 0, gridSize);
+		int targetLoc = gridSize * gridSize - 1;
+
+		std::vector<intVec> objVec;
+		objVec.emplace_back(m_scenario.m_self);
+		objVec.insert(objVec.end(), m_scenario.m_enemies.begin(), m_scenario.m_enemies.end());
+		objVec.insert(objVec.end(), m_scenario.m_nonInvolved.begin(), m_scenario.m_nonInvolved.end());
+		objVec.insert(objVec.end(), m_scenario.m_shelters.begin(), m_scenario.m_shelters.end());
+
+		nxnGrid *model = new nxnGridGlobalActions(gridSize, targetLoc, self, objVec, m_scenario.m_isMoveFromEnemyExist);
+
+		// add objects to model
+		for (int i = 0; i < m_scenario.m_enemies.size(); ++i)
+			model->AddObj(CreateEnemy(0, 0, gridSize));
+
+		for (int i = 0; i < m_scenario.m_nonInvolved.size(); ++i)
+			model->AddObj(CreateNInv(0, 0));
+
+		for (int i = 0; i < m_scenario.m_shelters.size(); ++i)
+			model->AddObj(CreateShelter(0, 0));
+
+		return model;
+	}
+
+	void InitializeDefaultParameters() override
+	{
+		if (m_scenario.m_model == "tag")
+			Globals::config.pruning_constant = 0.01;
+		else if (m_scenario.m_model == "pocman")
+			Globals::config.num_scenarios = 100;
+	}
+
+private:
+	const BenchmarkScenario & m_scenario;
+};
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> scenarioFiles;
+	std::string outputFName;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg(argv[i]);
+		if (arg == "-o" && i + 1 < argc)
+			outputFName = argv[++i];
+		else
+			scenarioFiles.emplace_back(arg);
+	}
+
+	if (scenarioFiles.size() == 0)
+		scenarioFiles = s_DEFAULT_SCENARIOS;
+
+	// no tree sending and no vbs simulator in benchmark
+	nxnGrid::InitUDP(-1, -1);
+	Globals::config.silence = true;
+	logging::level(0);
+
+	std::stringstream json;
+	json << "{\n\t\"benchmark\": \"nxnGrid\",\n\t\"version\": " << s_BENCHMARK_VERSION << ",\n\t\"results\": [";
+	bool first = true;
+	for (auto & fName : scenarioFiles)
+	{
+		BenchmarkScenario scenario;
+		if (!ReadScenario(fName, scenario))
+		{
+			std::cerr << "failed read scenario file " << fName << "\n";
+			exit(1);
+		}
+
+		for (auto & solverType : scenario.m_solvers)
+		{
+			std::cerr << "running scenario " << scenario.m_name << " with solver " << solverType << "\n";
+			BenchmarkResult result;
+			RunScenario(scenario, solverType, result);
+
+			json << (first ? "\n" : ",\n");
+			WriteResult(json, scenario, solverType, result);
+			first = false;
+		}
+	}
+	json << "\n\t]\n}\n";
+
+	if (outputFName.size() == 0)
+	{
+		std::cout << json.str();
+		return 0;
+	}
+
+	std::ofstream output(outputFName.c_str(), std::ios::out);
+	output << json.str();
+	if (output.fail())
+	{
+		std::cerr << "failed write result to file\nresults:\n";
+		std::cerr << json.str();
+		exit(1);
+	}
+
+	return 0;
+}
+
+bool ReadScenario(const std::string & fName, BenchmarkScenario & scenario)
+{
+	std::ifstream in(fName.c_str());
+	if (in.fail())
+		return false;
+
+	std::string line;
+	while (std::getline(in, line))
+	{
+		// erase comments
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		size_t eq = line.find('=');
+		if (eq == std::string::npos)
+			continue;
+
+		std::string key = line.substr(0, eq);
+		key.erase(std::remove_if(key.begin(), key.end(), ::isspace), key.end());
+		std::string value = line.substr(eq + 1);
+		// solvers list is comma separated
+		std::replace(value.begin(), value.end(), ',', ' ');
+		std::stringstream values(value);
+
+		if (key == "name")
+			values >> scenario.m_name;
+		else if (key == "model")
+			values >> scenario.m_model;
+		else if (key == "gridSize")
+			values >> scenario.m_gridSize;
+		else if (key == "rocks")
+			values >> scenario.m_numRocks;
+		else if (key == "solvers")
+		{
+			scenario.m_solvers.clear();
+			std::string solver;
+			while (values >> solver)
+				scenario.m_solvers.emplace_back(solver);
+		}
+		else if (key == "belief")
+			values >> scenario.m_beliefType;
+		else if (key == "rounds")
+			values >> scenario.m_numRounds;
+		else if (key == "workers")
+			values >> scenario.m_numWorkers;
+		else if (key == "expansionThreads")
+			values >> scenario.m_numExpansionThreads;
+		else if (key == "despotReuse")
+			values >> scenario.m_isDespotReuse;
+		else if (key == "pomcpTransposition")
+			values >> scenario.m_pomcpTransposition;
+		else if (key == "maxTreeNodes")
+			values >> scenario.m_maxTreeNodes;
+		else if (key == "wideningK")
+			values >> scenario.m_wideningK;
+		else if (key == "wideningAlpha")
+			values >> scenario.m_wideningAlpha;
+		else if (key == "seed")
+			values >> scenario.m_seed;
+		else if (key == "timePerMove")
+			values >> scenario.m_timePerMove;
+		else if (key == "simLen")
+			values >> scenario.m_simLen;
+		else if (key == "numParticles")
+			values >> scenario.m_numParticles;
+		else if (key == "lut")
+			values >> scenario.m_lutFName;
+		else if (key == "lutGridSize")
+			values >> scenario.m_lutGridSize;
+		else if (key == "lutCalcType")
+		{
+			int cType;
+			values >> cType;
+			scenario.m_lutCalcType = static_cast<nxnGrid::CALCULATION_TYPE>(cType);
+		}
+		else if (key == "moveFromEnemy")
+			values >> scenario.m_isMoveFromEnemyExist;
+		else
+		{
+			intVec locations;
+			int loc;
+			while (values >> loc)
+				locations.emplace_back(loc);
+
+			if (key == "self")
+				scenario.m_self = locations;
+			else if (key == "enemy")
+				scenario.m_enemies.emplace_back(locations);
+			else if (key == "nonInvolved")
+				scenario.m_nonInvolved.emplace_back(locations);
+			else if (key == "shelter")
+				scenario.m_shelters.emplace_back(locations);
+			else
+			{
+				std::cerr << "unrecognized key in scenario: " << key << "\n";
+				return false;
+			}
+		}
+
+		if (values.bad())
+			return false;
+	}
+
+	if (scenario.m_lutGridSize < 0)
+		scenario.m_lutGridSize = scenario.m_gridSize;
+
+	if (scenario.m_beliefType.size() == 0)
+		scenario.m_beliefType = scenario.m_model == "nxnGrid" ? "nxnGridBelief" : "DEFAULT";
+
+	if (scenario.m_model != "nxnGrid" && scenario.m_model != "tag" && scenario.m_model != "rock_sample" && scenario.m_model != "pocman" && scenario.m_model != "tiger")
+	{
+		std::cerr << "unrecognized model in scenario: " << scenario.m_model << "\n";
+		return false;
+	}
+
+	return !in.bad();
+}
+
+void RunScenario(const BenchmarkScenario & scenario, const std::string & solverType, BenchmarkResult & result)
+{
+	bool isParallel = solverType == "Parallel_POMCP";
+	BenchmarkTUI tui(scenario);
+	Globals::config = Config();
+	tui.InitializeDefaultParameters();
+	Globals::config.silence = true;
+	Globals::config.root_seed = scenario.m_seed;
+	Globals::config.time_per_move = scenario.m_timePerMove;
+	Globals::config.sim_len = scenario.m_simLen;
+	Globals::config.num_expansion_threads = scenario.m_numExpansionThreads;
+	Globals::config.despot_tree_reuse = scenario.m_isDespotReuse;
+	Globals::config.pomcp_transposition = scenario.m_pomcpTransposition;
+	Globals::config.max_tree_nodes = scenario.m_maxTreeNodes;
+	Globals::config.widening_k = scenario.m_wideningK;
+	Globals::config.widening_alpha = scenario.m_wideningAlpha;
+	if (scenario.m_numParticles > 0)
+		Globals::config.num_scenarios = scenario.m_numParticles;
+
+	// models, solvers and trees of the scenario are counted
+	ScenarioMemory memory;
+
+	if (scenario.m_model == "nxnGrid")
+	{
+		nxnGrid::InitSolverParams(true, isParallel, true);
+
+		// init lut
+		std::map<STATE_TYPE, std::vector<double>> offlineLut;
+		if (scenario.m_lutFName == "naive")
+			nxnGrid::InitLUT(offlineLut, scenario.m_gridSize, nxnGrid::WITHOUT);
+		else
+		{
+			ReadOfflineLUT(scenario.m_lutFName, scenario.m_isMoveFromEnemyExist, offlineLut);
+			nxnGrid::InitLUT(offlineLut, scenario.m_lutGridSize, scenario.m_lutCalcType);
+		}
+	}
+
+	option::Option options[E_LOG + 1];
+
+	std::vector<DSPOMDP *> models{ tui.InitializeModel(options) };
+	if ((solverType == "POMCP" || isParallel) && dynamic_cast<OnlineSolverModel *>(models[0]) == NULL)
+	{
+		result.m_skipped = true;
+		result.m_reason = "model is not an OnlineSolverModel";
+		delete models[0];
+		return;
+	}
+	else if (isParallel)
+	{
+		for (int a = 1; a < models[0]->NumActions(); ++a)
+			models.emplace_back(tui.InitializeModel(options));
+	}
+	else if (solverType == "AEMS" && dynamic_cast<BeliefMDP *>(models[0]) == NULL)
+	{
+		result.m_skipped = true;
+		result.m_reason = "model is not a BeliefMDP";
+		delete models[0];
+		return;
+	}
+
+	Seeds::root_seed(Globals::config.root_seed);
+	SolverBase * solver = tui.InitializeSolver(models, solverType, options);
+
+	// parallel solver is already running a thread for each action so its rounds are not running simultaneously
+	int numWorkers = isParallel ? 1 : min(scenario.m_numWorkers, scenario.m_numRounds);
+	std::vector<SolverBase *> solvers{ solver };
+	// models are created serially (model creation is initializing the static params of the problem)
+	for (int w = 1; w < numWorkers; ++w)
+	{
+		std::vector<DSPOMDP *> workerModels{ tui.InitializeModel(options) };
+		solvers.emplace_back(tui.InitializeSolver(workerModels, solverType, options));
+		models.emplace_back(workerModels[0]);
+	}
+
+	result.m_numWorkers = numWorkers;
+	double start = get_time_second();
+	if (numWorkers > 1)
+		RunRoundsBatch(solvers, models, scenario, result);
+	else
+	{
+		for (int round = 0; round < scenario.m_numRounds; ++round)
+		{
+			if (isParallel)
+				RunRoundParallel(static_cast<ParallelSolver *>(solver), models[0], scenario, round, result);
+			else
+				RunRound(solver, models[0], scenario, round, result);
+		}
+	}
+
+	result.m_wallTime = get_time_second() - start;
+	result.m_peakMemory = memory.Stop();
+
+	// solvers (with their trees, bounds and threads) and then their models are deleted so they are not counted in the memory of the next scenarios
+	for (auto s : solvers)
+		delete s;
+	for (auto m : models)
+		delete m;
+}
+
+void RunRound(SolverBase * solver, DSPOMDP * model, const BenchmarkScenario & scenario, int round, BenchmarkResult & result)
+{
+	// every round is seeded by the scenario seed and its number so runs are reproducible
+	unsigned int seed = scenario.m_seed + round;
+	std::srand(seed);
+	Random::InitThreadRand(Random(seed));
+
+	OnlineSolverModel * solverModel = dynamic_cast<OnlineSolverModel *>(model);
+	if (solverModel != NULL)
+		solverModel->InitState();
+	State * state = model->CreateStartState("DEFAULT");
+	solver->belief(model->InitialBelief(state, scenario.m_beliefType));
+
+	double totalReward = 0.0;
+	int step = 0;
+	bool terminal = false;
+	double reward = 0.0;
+	for (; step < Globals::config.sim_len && !terminal; ++step)
+	{
+		int prevSims = solver->NumSimulations();
+		double start = get_time_second();
+		int action = solver->Search().action;
+		double decisionTime = get_time_second() - start;
+
+		result.m_decisionTimes.emplace_back(decisionTime);
+		result.m_searchTime += decisionTime;
+		result.m_numSimulations += solver->NumSimulations() - prevSims;
+
+		Tree_Properties treeProp(model->NumActions());
+		solver->GetTreeProperties(treeProp);
+		result.m_treeSizes.emplace_back(treeProp.m_rootTreeProp.m_size);
+
+		OBS_TYPE obs;
+		terminal = model->Step(*state, Random::s_threadRand.NextDouble(), action, reward, obs);
+		totalReward += reward;
+
+		if (!terminal)
+			solver->Update(action, obs);
+	}
+
+	result.m_rewards.emplace_back(totalReward);
+	result.m_steps.emplace_back(step);
+	CountEndOfRound(model, terminal, reward, result);
+
+	solver->DeleteBelief();
+	FreeStartState(model, state);
+}
+
+void RunRoundsBatch(std::vector<SolverBase *> & solvers, std::vector<DSPOMDP *> & models, const BenchmarkScenario & scenario, BenchmarkResult & result)
+{
+	// each round is writing to its own result so the merged result is not depending on the order rounds were finished
+	std::vector<BenchmarkResult> roundResults(scenario.m_numRounds);
+	std::atomic<int> nextRound(0);
+
+	std::vector<std::thread> workers;
+	for (int w = 0; w < solvers.size(); ++w)
+	{
+		workers.emplace_back([&, w]
+		{
+			DSPOMDP * model = models[w];
+			for (int round = nextRound++; round < scenario.m_numRounds; round = nextRound++)
+				RunRound(solvers[w], model, scenario, round, roundResults[round]);
+		});
+	}
+
+	for (auto & worker : workers)
+		worker.join();
+
+	for (auto & roundResult : roundResults)
+		MergeResult(result, roundResult);
+}
+
+void MergeResult(BenchmarkResult & result, const BenchmarkResult & roundResult)
+{
+	result.m_numSimulations += roundResult.m_numSimulations;
+	result.m_searchTime += roundResult.m_searchTime;
+	result.m_decisionTimes.insert(result.m_decisionTimes.end(), roundResult.m_decisionTimes.begin(), roundResult.m_decisionTimes.end());
+	result.m_treeSizes.insert(result.m_treeSizes.end(), roundResult.m_treeSizes.begin(), roundResult.m_treeSizes.end());
+	result.m_rewards.insert(result.m_rewards.end(), roundResult.m_rewards.begin(), roundResult.m_rewards.end());
+	result.m_steps.insert(result.m_steps.end(), roundResult.m_steps.begin(), roundResult.m_steps.end());
+	result.m_wins += roundResult.m_wins;
+	result.m_losses += roundResult.m_losses;
+}
+
+void RunRoundParallel(ParallelSolver * solver, DSPOMDP * model, const BenchmarkScenario & scenario, int round, BenchmarkResult & result)
+{
+	// tree threads are seeded by the solver, only the world is seeded here
+	unsigned int seed = scenario.m_seed + round;
+	std::srand(seed);
+	Random::InitThreadRand(Random(seed));
+
+	OnlineSolverModel * solverModel = dynamic_cast<OnlineSolverModel *>(model);
+	if (solverModel != NULL)
+		solverModel->InitState();
+	State * state = model->CreateStartState("DEFAULT");
+	for (int sol = 0; sol < solver->NumSolvers(); ++sol)
+		solver->belief(model->InitialBelief(state, scenario.m_beliefType), sol);
+
+	std::thread treeMngr([solver] { solver->ThreadsMngrFunction(); });
+	TreeMngrThread & treeMngrData = solver->GetTreeMngrData();
+
+	double totalReward = 0.0;
+	int step = 0;
+	bool terminal = false;
+	double reward = 0.0;
+	int prevSims = solver->NumSimulations();
+	for (; step < Globals::config.sim_len && !terminal; ++step)
+	{
+		Sleep(Globals::config.time_per_move * 1000);
+		double start = get_time_second();
+		// inform to builder that action is needed
+		{
+			std::lock_guard<std::mutex> lock(treeMngrData.m_flagsMutex);
+			treeMngrData.m_actionNeeded = true;
+			treeMngrData.m_flagsCond.notify_all();
+		}
+		// wait for action is ready
+		{
+			std::unique_lock<std::mutex> lock(treeMngrData.m_flagsMutex);
+			treeMngrData.m_flagsCond.wait(lock, [&treeMngrData] { return treeMngrData.m_actionRecieved; });
+		}
+
+		// decision latency is the time from request until action is ready
+		double decisionTime = get_time_second() - start;
+		result.m_decisionTimes.emplace_back(decisionTime);
+		result.m_searchTime += decisionTime + Globals::config.time_per_move;
+
+		{ // take action and update observation
+			std::lock_guard<std::mutex> mainLock(treeMngrData.m_mainMutex);
+			int action = treeMngrData.m_action;
+
+			int numSims = solver->NumSimulations();
+			result.m_numSimulations += numSims - prevSims;
+			prevSims = numSims;
+
+			Tree_Properties treeProp(model->NumActions());
+			solver->GetTreeProperties(treeProp);
+			result.m_treeSizes.emplace_back(treeProp.m_rootTreeProp.m_size);
+
+			OBS_TYPE obs;
+			terminal = model->Step(*state, Random::s_threadRand.NextDouble(), action, reward, obs);
+			totalReward += reward;
+
+			treeMngrData.m_lastObservation = obs;
+			std::lock_guard<std::mutex> flagsLock(treeMngrData.m_flagsMutex);
+			treeMngrData.m_observationRecieved = true;
+			treeMngrData.m_actionRecieved = false;
+			treeMngrData.m_terminal = terminal || step + 1 == Globals::config.sim_len;
+			treeMngrData.m_flagsCond.notify_all();
+		}
+	}
+
+	treeMngr.join();
+
+	result.m_rewards.emplace_back(totalReward);
+	result.m_steps.emplace_back(step);
+	CountEndOfRound(model, terminal, reward, result);
+
+	solver->DeleteBelief();
+	FreeStartState(model, state);
+}
+
+void CountEndOfRound(DSPOMDP * model, bool terminal, double reward, BenchmarkResult & result)
+{
+	// only nxnGrid is ending with a win or a loss
+	if (dynamic_cast<OnlineSolverModel *>(model) == NULL)
+		return;
+
+	result.m_wins += terminal && reward == OnlineSolverModel::REWARD_WIN;
+	result.m_losses += terminal && reward == OnlineSolverModel::REWARD_LOSS;
+}
+
+void FreeStartState(DSPOMDP * model, State * state)
+{
+	// nxnGrid is creating its start state with new, the despot examples are taking it from their memory pool
+	if (dynamic_cast<OnlineSolverModel *>(model) != NULL)
+		delete state;
+	else
+		model->Free(state);
+}
+
+void WriteResult(std::ostream & out, const BenchmarkScenario & scenario, const std::string & solverType, const BenchmarkResult & result)
+{
+	out << "\n\t\t{\n";
+	out << "\t\t\t\"scenario\": " << JsonString(scenario.m_name) << ",\n";
+	out << "\t\t\t\"model\": " << JsonString(scenario.m_model) << ",\n";
+	out << "\t\t\t\"solver\": " << JsonString(solverType) << ",\n";
+	out << "\t\t\t\"gridSize\": " << scenario.m_gridSize << ",\n";
+	out << "\t\t\t\"lut\": " << JsonString(scenario.m_lutFName) << ",\n";
+	out << "\t\t\t\"seed\": " << scenario.m_seed << ",\n";
+	out << "\t\t\t\"rounds\": " << scenario.m_numRounds << ",\n";
+	out << "\t\t\t\"workers\": " << result.m_numWorkers << ",\n";
+	out << "\t\t\t\"expansionThreads\": " << scenario.m_numExpansionThreads << ",\n";
+	out << "\t\t\t\"despotReuse\": " << (scenario.m_isDespotReuse ? "true" : "false") << ",\n";
+	out << "\t\t\t\"pomcpTransposition\": " << scenario.m_pomcpTransposition << ",\n";
+	out << "\t\t\t\"maxTreeNodes\": " << scenario.m_maxTreeNodes << ",\n";
+	out << "\t\t\t\"wideningK\": " << scenario.m_wideningK << ",\n";
+	out << "\t\t\t\"wideningAlpha\": " << scenario.m_wideningAlpha << ",\n";
+	out << "\t\t\t\"timePerMove\": " << scenario.m_timePerMove << ",\n";
+	if (result.m_skipped)
+	{
+		out << "\t\t\t\"skipped\": " << JsonString(result.m_reason) << "\n\t\t}";
+		return;
+	}
+
+	doubleVec latency(result.m_decisionTimes);
+	std::sort(latency.begin(), latency.end());
+
+	double numRewards = result.m_rewards.size() > 0 ? result.m_rewards.size() : 1;
+	double avgReward = std::accumulate(result.m_rewards.begin(), result.m_rewards.end(), 0.0) / numRewards;
+	double sqrSum = 0.0;
+	for (auto r : result.m_rewards)
+		sqrSum += (r - avgReward) * (r - avgReward);
+	double stderrReward = sqrt(sqrSum / numRewards) / sqrt(numRewards);
+
+	double avgSteps = std::accumulate(result.m_steps.begin(), result.m_steps.end(), 0.0) / numRewards;
+	double numDecisions = result.m_treeSizes.size() > 0 ? result.m_treeSizes.size() : 1;
+	double avgTreeSize = std::accumulate(result.m_treeSizes.begin(), result.m_treeSizes.end(), 0.0) / numDecisions;
+	unsigned int maxTreeSize = result.m_treeSizes.size() > 0 ? *std::max_element(result.m_treeSizes.begin(), result.m_treeSizes.end()) : 0;
+
+	out << "\t\t\t\"simsPerSec\": " << (result.m_searchTime > 0 ? result.m_numSimulations / result.m_searchTime : 0.0) << ",\n";
+	out << "\t\t\t\"decisionLatency\": { \"p50\": " << Percentile(latency, 0.5) << ", \"p90\": " << Percentile(latency, 0.9)
+		<< ", \"p99\": " << Percentile(latency, 0.99) << ", \"max\": " << Percentile(latency, 1.0) << " },\n";
+	out << "\t\t\t\"treeSize\": { \"mean\": " << avgTreeSize << ", \"max\": " << maxTreeSize << " },\n";
+	out << "\t\t\t\"peakMemoryBytes\": " << result.m_peakMemory << ",\n";
+	out << "\t\t\t\"reward\": { \"mean\": " << avgReward << ", \"stderr\": " << stderrReward << " },\n";
+	out << "\t\t\t\"steps\": " << avgSteps << ",\n";
+	out << "\t\t\t\"wins\": " << result.m_wins << ",\n";
+	out << "\t\t\t\"losses\": " << result.m_losses << ",\n";
+	out << "\t\t\t\"wallTime\": " << result.m_wallTime << "\n\t\t}";
+}
+
+/// quoted json string (names are read from scenario files and may contain any character)
+std::string JsonString(const std::string & str)
+{
+	std::stringstream quoted;
+	quoted << '"';
+	for (char c : str)
+	{
+		switch (c)
+		{
+		case '"': quoted << "\\\""; break;
+		case '\\': quoted << "\\\\"; break;
+		case '\n': quoted << "\\n"; break;
+		case '\r': quoted << "\\r"; break;
+		case '\t': quoted << "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char code[7];
+				snprintf(code, sizeof(code), "\\u%04x", c);
+				quoted << code;
+			}
+			else
+				quoted << c;
+		}
+	}
+	quoted << '"';
+	return quoted.str();
+}
+
+double Percentile(doubleVec sortedVec, double p)
+{
+	if (sortedVec.size() == 0)
+		return 0.0;
+
+	int idx = static_cast<int>(ceil(p * sortedVec.size())) - 1;
+	return sortedVec[idx > 0 ? idx : 0];
+}
+
+size_t WorkingSetSize()
+{
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+
+	return counters.WorkingSetSize;
+}
+
+ScenarioMemory::ScenarioMemory()
+: m_start(WorkingSetSize()), m_peak(m_start), m_stop(false), m_mutex(), m_stopCond(), m_sampler()
+{
+	m_sampler = std::thread([this] { Sample(); });
+}
+
+ScenarioMemory::~ScenarioMemory()
+{
+	Stop();
+}
+
+size_t ScenarioMemory::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+		m_stopCond.notify_all();
+	}
+	if (m_sampler.joinable())
+		m_sampler.join();
+
+	size_t current = WorkingSetSize();
+	if (current > m_peak)
+		m_peak = current;
+	return m_peak - m_start;
+}
+
+void ScenarioMemory::Sample()
+{
+	// the sampler is sleeping between samples so it is not taking cpu from the measured solver
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!m_stopCond.wait_for(lock, std::chrono::milliseconds(10), [this] { return m_stop; }))
+	{
+		size_t current = WorkingSetSize();
+		if (current > m_peak)
+			m_peak = current;
+	}
+}
+
+void ReadOfflineLUT(const std::string & lutFName, bool isMoveFromEnemyExist, std::map<STATE_TYPE, std::vector<double>> &offlineLut)
+{
+	std::ifstream readLut(lutFName, std::ios::in | std::ios::binary);
+	if (readLut.fail())
+	{
+		std::cerr << "failed open lut file " << lutFName << "\n";
+		exit(1);
+	}
+
+	int size;
+	readLut.read(reinterpret_cast<char *>(&size), sizeof(int));
+	int numActions;
+	readLut.read(reinterpret_cast<char *>(&numActions), sizeof(int));
+	for (int i = 0; i < size; ++i)
+	{
+		int state;
+		readLut.read(reinterpret_cast<char *>(&state), sizeof(int));
+
+		std::vector<double> rewards(numActions);
+		for (int a = 0; a < numActions; ++a)
+			readLut.read(reinterpret_cast<char *>(&rewards[a]), sizeof(double));
+
+		if (!isMoveFromEnemyExist)
+			rewards.erase(rewards.begin() + 2);
+
+		offlineLut[state] = rewards;
+	}
+
+	if (readLut.bad())
+	{
+		std::cerr << "failed read lut " << lutFName << "\n";
+		exit(1);
+	}
+}
+
+Attack_Obj CreateEnemy(int x, int y, int gridSize)
+{
+	int attackRange = gridSize / 4;
+
+	double pHit = 0.4;
+	std::shared_ptr<Attack> attack(new DirectAttack(attackRange, pHit));
+
+	double pStay = 0.4;
+	double pTowardSelf = 0.2;
+	double pSpawnIfdead = 0;
+
+	Coordinate location(x, y);
+	std::shared_ptr<Move_Properties> movement(new TargetDerivedMoveProperties(pStay, pTowardSelf, pSpawnIfdead));
+
+	return Attack_Obj(location, movement, attack);
+}
+
+Self_Obj CreateSelf(int x, int y, int gridSize)
+{
+	int attackRange = gridSize / 4;
+
+	double pHit = 0.4;
+	std::shared_ptr<Attack> attack(new DirectAttack(attackRange, pHit));
+	double pDistanceFactor = 0.4;
+	std::shared_ptr<Observation> obs(new ObservationByDistance(pDistanceFactor));
+
+	Coordinate location(x, y);
+	double pMove = 0.75;
+	std::shared_ptr<Move_Properties> movement(new SimpleMoveProperties(pMove));
+
+	return Self_Obj(location, movement, attack, obs);
+}
+
+Movable_Obj CreateNInv(int x, int y)
+{
+	double pStay = 0.4;
+
+	Coordinate location(x, y);
+	std::shared_ptr<Move_Properties> movement(new NaiveMoveProperties(pStay));
+
+	return Movable_Obj(location, movement);
+}
+
+ObjInGrid CreateShelter(int x, int y)
+{
+	Coordinate location(x, y);
+
+	return ObjInGrid(location);
+}
@@ -36,6 +36,10 @@ enum ATTACKS_AVAILABLE { DIRECT_ATTACK };
 // solver params
 static int s_timeOutSec = 30000;
 static double s_diffPrecision = 0.001;
+// seed each shelter variant with the bounds of the previously solved one
+static bool s_warmStartVariants = true;
+// write the policies in binary format, loaded faster by the simulator and the next variant
+static bool s_binaryPolicy = true;
 
 // world
 static int s_gridSize = 4;
@@ -85,6 +89,10 @@ using lutSarsop = std::map<int, std::vector<double>>;
 std::string s_SOLVER_LOCATION = "..\\..\\pomdp_solver\\src\\Release\\";
 static std::ofstream s_BACKUP_FILE;
 
+// policy of the last solved variant and the FIB vectors shared by the variants
+static std::string s_lastPolicyFName = "";
+static std::string s_fibFName = "";
+
 
 void ErrorAndExit(const char * errMsg)
 {
@@ -101,6 +109,22 @@ void RunSolver(std::string &fname, std::string &policy_name, std::string &solver
 	double requiredPrecision = nxnGridOffline::s_REWARD_WIN - nxnGridOffline::s_REWARD_LOSS;
 	requiredPrecision *= s_diffPrecision;
 	std::string cmd = s_SOLVER_LOCATION + "pomdpsol.exe --timeout " + std::to_string(s_timeOutSec) + " --precision " + std::to_string(requiredPrecision) + " ";
+	if (s_warmStartVariants)
+	{
+		if (s_lastPolicyFName != "")
+			cmd += "--seed-policy " + s_lastPolicyFName + " ";
+		if (s_fibFName != "")
+			cmd += "--fib-file " + s_fibFName + " ";
+	}
+
+	// a checkpoint left by a run that did not finish is continued
+	std::string checkpointFName = policy_name + ".ckp";
+	if (std::ifstream(checkpointFName).good())
+		cmd += "--resume " + checkpointFName + " ";
+	cmd += "--checkpoint " + checkpointFName + " ";
+	if (s_binaryPolicy)
+		cmd += "--binary-policy double ";
+
 	cmd += fname + " -o " + policy_name + " > " + solverOutF;
 		
 	int stat = system(cmd.c_str());
@@ -112,6 +136,7 @@ void RunSolver(std::string &fname, std::string &policy_name, std::string &solver
 		std::cin >> c;
 		exit(1);
 	}
+	std::remove(checkpointFName.c_str());
 }
 
 void RunSimulator(std::string &pomdpFName, std::string &policy_name)
@@ -271,6 +296,7 @@ void CreateLUT(nxnGridOffline * model, std::string & prefix, lutSarsop & sarsopM
 	time_t solverStart = time(nullptr);
 	RunSolver(pomdpFName, policyName, solverOutFname);
 	time_t solverDuration = time(nullptr) - solverStart;
+	s_lastPolicyFName = policyName;
 
 	
 	std::cout << "finished creating policy file\n";
@@ -335,6 +361,8 @@ int main()
 	std::string prefix = std::to_string(s_gridSize) + "x" + std::to_string(s_gridSize) + "Grid";
 	prefix += std::to_string(model->CountEnemies()) + "x" + std::to_string(model->CountNInv()) + "x" + std::to_string(model->CountShelters());
 
+	s_fibFName = prefix + ".fib";
+
 	std::string lutFName(prefix);
 	lutFName += "_LUT.bin";
 	lutSarsop sarsopMap;
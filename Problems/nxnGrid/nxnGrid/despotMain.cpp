@@ -107,7 +107,7 @@ int main(int argc, char* argv[])
 	
 	/// seed main thread random num
 	Random ran((unsigned)time(NULL));
-	Random::s_threadSafeRand[GetCurrentThreadId()] = ran;
+	Random::InitThreadRand(ran);
 
 	int vbsPort = s_VBS_EVALUATOR ? s_PORT_VBS : -1;
 	int treePort = s_TO_SEND_TREE ? s_PORT_SEND_TREE : -1;
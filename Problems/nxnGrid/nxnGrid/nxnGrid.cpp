@@ -1,5 +1,6 @@
 #include <string>
 #include <math.h>
+#include <sstream>
 
 
 
@@ -19,15 +20,10 @@ int nxnGridDetailedState::s_numEnemies = 0;
 int nxnGridDetailedState::s_gridSize = 0;
 int nxnGridDetailedState::s_targetLoc = 0;
 
-std::vector<int> nxnGridDetailedState::s_shelters;
-
 
 // model params
-std::vector<std::string> nxnGrid::s_actionsStr;
 int nxnGrid::s_lutGridSize = -1;
 
-std::vector<intVec> nxnGrid::s_objectsInitLocations;
-
 
 // rewards
 const int OnlineSolverModel::REWARD_WIN = 50.0;
@@ -223,7 +219,6 @@ void nxnGridDetailedState::InitStatic()
 	s_numNonInvolved = 0;
 	s_numEnemies = 0;
 	s_gridSize = 0;
-	s_shelters.resize(0);
 }
 
 STATE_TYPE nxnGridDetailedState::MaxState()
@@ -235,7 +230,7 @@ STATE_TYPE nxnGridDetailedState::MaxState()
 	return ret << numBits;
 }
 
-char nxnGridDetailedState::ObjIdentity(int location) const
+char nxnGridDetailedState::ObjIdentity(int location, const intVec & shelters) const
 {
 	if (m_locations[0] == location)
 		return 'M';
@@ -260,9 +255,9 @@ char nxnGridDetailedState::ObjIdentity(int location) const
 			return 'N';
 	}
 
-	for (int s = 0; s < s_shelters.size(); ++s)
+	for (int s = 0; s < shelters.size(); ++s)
 	{
-		if (location == s_shelters[s])
+		if (location == shelters[s])
 			return 'S';
 	}
 
@@ -284,16 +279,16 @@ void nxnGridDetailedState::EraseObject(int objectIdx)
 	m_locations.erase(m_locations.begin() + objectIdx);
 }
 
-bool nxnGridDetailedState::IsProtected(int objIdx) const
+bool nxnGridDetailedState::IsProtected(int objIdx, const intVec & shelters) const
 {
 	bool ret = false;
-	for (auto shelter : s_shelters)
+	for (auto shelter : shelters)
 		ret |= shelter == m_locations[objIdx];
 
 	return ret;
 }
 
-std::string nxnGridDetailedState::text() const
+std::string nxnGridDetailedState::text(const intVec & shelters) const
 {
 	std::string ret = "(";
 	for (int i = 0; i < m_locations.size(); ++i)
@@ -302,18 +297,18 @@ std::string nxnGridDetailedState::text() const
 	}
 	ret += ")\n";
 
-	PrintGrid(ret);
+	PrintGrid(ret, shelters);
 	return ret;
 }
 
-void nxnGridDetailedState::PrintGrid(std::string & buffer) const
+void nxnGridDetailedState::PrintGrid(std::string & buffer, const intVec & shelters) const
 {
 	for (int y = 0; y < s_gridSize; ++y)
 	{
 		for (int x = 0; x < s_gridSize; ++x)
 		{
 			int loc = x + y * s_gridSize;
-			buffer += ObjIdentity(loc);
+			buffer += ObjIdentity(loc, shelters);
 		}
 		buffer += "\n";
 	}
@@ -369,12 +364,12 @@ nxnGrid::nxnGrid(int gridSize, int target, Self_Obj & self, std::vector<intVec>
 	, m_enemyVec()
 	, m_shelters()
 	, m_nonInvolvedVec()
+	, m_objectsInitLocations(objectsInitLoc)
+	, m_actionsStr()
 {
 	// init size  of state for nxnGridstate
 	nxnGridDetailedState::s_gridSize = gridSize;
 	nxnGridDetailedState::s_targetLoc = target;
-
-	s_objectsInitLocations = objectsInitLoc;
 }
 
 
@@ -436,8 +431,6 @@ void nxnGrid::AddObj(Movable_Obj&& obj)
 void nxnGrid::AddObj(ObjInGrid&& obj)
 {
 	m_shelters.emplace_back(std::forward<ObjInGrid>(obj));
-	
-	nxnGridDetailedState::s_shelters.emplace_back(obj.GetLocation().GetIdx(m_gridSize));
 
 	AddActionsToShelter();
 }
@@ -611,7 +604,7 @@ Belief * nxnGrid::InitialBelief(const State * start, std::string type) const
 	int numStates = 1;
 	// assumption : init states cannot be in same locations for different object
 	for (int i = 1; i < CountMovingObjects(); ++i)
-		numStates *= s_objectsInitLocations[i].size();
+		numStates *= m_objectsInitLocations[i].size();
 
 	double stateProb = 1.0 / numStates;
 	
@@ -632,7 +625,7 @@ void nxnGrid::DisplayParameters(std::ofstream & out) const
 	out << "\n\nModel Details:\n";
 	out << "grid size: " + std::to_string(m_gridSize) + "  target idx: " + std::to_string(m_targetIdx);
 	out << "\n\nSELF:\nself possible initial locations: (";
-	for (auto loc : s_objectsInitLocations[0])
+	for (auto loc : m_objectsInitLocations[0])
 		out << loc << ", ";
 	out << ")";
 	out << "\nwith move properties: " + m_self.GetMovement()->String();
@@ -644,7 +637,7 @@ void nxnGrid::DisplayParameters(std::ofstream & out) const
 	{
 		out << "\nenemy #" << i;
 		out << "\nobject possible initial locations : (";
-		for (auto loc : s_objectsInitLocations[i + 1])
+		for (auto loc : m_objectsInitLocations[i + 1])
 			out << loc << ", ";
 		out << ")";
 		out << "\nwith move properties: " + m_enemyVec[i].GetMovement()->String();
@@ -656,7 +649,7 @@ void nxnGrid::DisplayParameters(std::ofstream & out) const
 	{
 		out << "\nnon-involved #" << i;
 		out << "\nobject possible initial locations : (";
-		for (auto loc : s_objectsInitLocations[i + 1 + m_enemyVec.size()])
+		for (auto loc : m_objectsInitLocations[i + 1 + m_enemyVec.size()])
 			out << loc << ", ";
 		out << ")";
 		out << "\nwith move properties: " + m_nonInvolvedVec[i].GetMovement()->String();
@@ -667,16 +660,47 @@ void nxnGrid::DisplayParameters(std::ofstream & out) const
 	{
 		out << "\nshelter #" << i;
 		out << "\nobject possible initial locations : (";
-		for (auto loc : s_objectsInitLocations[i + 1 + m_enemyVec.size() + m_nonInvolvedVec.size()])
+		for (auto loc : m_objectsInitLocations[i + 1 + m_enemyVec.size() + m_nonInvolvedVec.size()])
 			out << loc << ", ";
 		out << ")";
 	}
 }
 
+std::string nxnGrid::ParametersKey() const
+{
+	std::ostringstream key;
+	key << m_gridSize << " " << m_targetIdx << "\n";
+	for (auto & locations : m_objectsInitLocations)
+	{
+		for (auto loc : locations)
+			key << loc << " ";
+		key << "\n";
+	}
+
+	key << m_self.GetMovement()->String() << "\n" << m_self.GetAttack()->String() << "\n" << m_self.GetObservation()->String() << "\n";
+	for (auto & enemy : m_enemyVec)
+		key << enemy.GetMovement()->String() << "\n" << enemy.GetAttack()->String() << "\n";
+	for (auto & nInv : m_nonInvolvedVec)
+		key << nInv.GetMovement()->String() << "\n";
+
+	key << REWARD_WIN << " " << REWARD_LOSS << " " << REWARD_KILL_ENEMY << " " << REWARD_KILL_NINV << " " << REWARD_ILLEGAL_MOVE << " " << REWARD_STEP << " " << REWARD_FIRE << "\n";
+
+	// lut values are written as they are (not rounded by text)
+	key << s_calculationType << " " << s_lutGridSize << " " << s_LUT.size() << "\n";
+	for (auto & entry : s_LUT)
+	{
+		key.write(reinterpret_cast<const char *>(&entry.first), sizeof(entry.first));
+		if (entry.second.size() > 0)
+			key.write(reinterpret_cast<const char *>(&entry.second[0]), entry.second.size() * sizeof(double));
+	}
+
+	return key.str();
+}
+
 void nxnGrid::PrintState(const State & s, std::ostream & out) const
 {
 	nxnGridDetailedState state(s.state_id);
-	out << state.text() << "\n";
+	out << state.text(GetSheltersVec()) << "\n";
 }
 
 void nxnGrid::PrintBelief(const Belief & belief, std::ostream & out) const
@@ -699,7 +723,7 @@ void nxnGrid::PrintObs(const State & state, OBS_TYPE obs, std::ostream & out) co
 
 void nxnGrid::PrintAction(int action, std::ostream & out) const
 {
-	out << s_actionsStr[action] << std::endl;
+	out << m_actionsStr[action] << std::endl;
 }
 
 bool nxnGrid::InRange(int locationSelf, int locationObj, double range, int gridSize)
@@ -851,7 +875,7 @@ void nxnGrid::InitialBeliefStateRec(nxnGridDetailedState & state, int currObj, d
 	}
 	else
 	{
-		for (auto obj : s_objectsInitLocations[currObj])
+		for (auto obj : m_objectsInitLocations[currObj])
 		{
 			state[currObj] = obj;
 			InitialBeliefStateRec(state, currObj + 1, stateProb, particles);
@@ -1067,35 +1091,34 @@ void nxnGrid::InitState()
 		InitStateRandom();
 }
 
-/// init state according to s_objectsInitLocations
+/// init state according to m_objectsInitLocations
 void nxnGrid::InitStateRandom()
 {
 	int obj = 0;
-	int idx = rand() % s_objectsInitLocations[obj].size();
-	int loc = s_objectsInitLocations[obj][idx];
+	int idx = Random::s_threadRand.NextInt(m_objectsInitLocations[obj].size());
+	int loc = m_objectsInitLocations[obj][idx];
 	m_self.SetLocation(Coordinate(loc % m_gridSize, loc / m_gridSize));
 	++obj;
 
 	for (int i = 0; i < m_enemyVec.size(); ++i, ++obj)
 	{
-		idx = rand() % s_objectsInitLocations[obj].size();
-		loc = s_objectsInitLocations[obj][idx];
+		idx = Random::s_threadRand.NextInt(m_objectsInitLocations[obj].size());
+		loc = m_objectsInitLocations[obj][idx];
 		m_enemyVec[i].SetLocation(Coordinate(loc % m_gridSize, loc / m_gridSize));
 	}
 	
 	for (int i = 0; i < m_nonInvolvedVec.size(); ++i, ++obj)
 	{
-		idx = rand() % s_objectsInitLocations[obj].size();
-		loc = s_objectsInitLocations[obj][idx];
+		idx = Random::s_threadRand.NextInt(m_objectsInitLocations[obj].size());
+		loc = m_objectsInitLocations[obj][idx];
 		m_nonInvolvedVec[i].SetLocation(Coordinate(loc % m_gridSize, loc / m_gridSize));
 	}
 
 	for (int i = 0; i < m_shelters.size(); ++i, ++obj)
 	{
-		idx = rand() % s_objectsInitLocations[obj].size();
-		loc = s_objectsInitLocations[obj][idx];
+		idx = Random::s_threadRand.NextInt(m_objectsInitLocations[obj].size());
+		loc = m_objectsInitLocations[obj][idx];
 		m_shelters[i].SetLocation(Coordinate(loc % m_gridSize, loc / m_gridSize));
-		nxnGridDetailedState::s_shelters[i] = loc;
 	}
 
 }
@@ -1176,9 +1199,10 @@ intVec nxnGrid::GetSheltersVec() const
 
 void nxnGrid::GetNonValidLocations(const nxnGridDetailedState & state, int objIdx, intVec & nonValLoc) const
 {
+	intVec shelters(GetSheltersVec());
 	for (int obj = 0; obj < CountMovingObjects(); ++obj)
 	{
-		if (obj != objIdx && state.IsProtected(obj))
+		if (obj != objIdx && state.IsProtected(obj, shelters))
 			nonValLoc.emplace_back(state[obj]);
 	}
 }
@@ -1195,7 +1219,7 @@ void nxnGridBelief::Update(int action, OBS_TYPE obs)
 	for (int i = 0; i <particles_.size(); i++) {
 		State* particle = particles_[i];
 
-		bool terminal = model_->Step(*particle, Random::RANDOM.NextDouble(), action, reward, o);
+		bool terminal = model_->Step(*particle, Random::s_threadRand.NextDouble(), action, reward, o);
 
 		// copy fully observed params from observation
 		double prob = model_->ObsProb(obs, *particle, action);
@@ -1252,7 +1276,7 @@ std::vector<State*> nxnGridBelief::Resample(int num, const std::vector<State*>&
 {
 	// randomization regarding choosing particles
 	double unit = 1.0 / num;
-	double mass = Random::RANDOM.NextDouble(0, unit);
+	double mass = Random::s_threadRand.NextDouble(0, unit);
 	int pos = 0;
 	double cur = belief[0]->weight;
 
@@ -1318,7 +1342,7 @@ std::vector<State*> nxnGridBelief::Resample(int num, const std::vector<State*>&
 
 			for (int i = startSim; i < history.Size(); i++)
 			{
-				model->Step(*particle, Random::RANDOM.NextDouble(), history.Action(i), reward, obs);
+				model->Step(*particle, Random::s_threadRand.NextDouble(), history.Action(i), reward, obs);
 				double prob = modelCast->ObsProbOneObj(history.Observation(i), *particle, history.Action(i), obj);
 				if (prob <= 0)
 				{
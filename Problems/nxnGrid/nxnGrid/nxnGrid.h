@@ -53,11 +53,11 @@ public:
 	
 	// print state functions
 
-	/// print the state
-	std::string text() const;
-	void PrintGrid(std::string & buffer) const;
+	/// print the state (shelters are given by the model)
+	std::string text(const intVec & shelters) const;
+	void PrintGrid(std::string & buffer, const intVec & shelters) const;
 	/// return char identified location
-	char ObjIdentity(int location) const;
+	char ObjIdentity(int location, const intVec & shelters) const;
 
 	// object related functions
 	bool IsEnemyObserved(int enemyIdx) const { return m_isEnemyObserved[enemyIdx]; };
@@ -66,7 +66,7 @@ public:
 	void EraseNonInv();
 	void EraseObject(int objectIdx);
 	
-	bool IsProtected(int objIdx) const;
+	bool IsProtected(int objIdx, const intVec & shelters) const;
 
 	bool NoEnemies(int gridSize) const;
 	bool IsNonInvDead(int gridSize) const;
@@ -80,8 +80,6 @@ public:
 
 	/// bits for location
 	static const int s_NUM_BITS_LOCATION = 8;
-	/// shelter vector
-	static intVec s_shelters;
 
 	/// number of objects in grid (size of state vector)
 	static int s_numNonInvolved;
@@ -99,8 +97,10 @@ public:
 * nxnGrid class
 * =============================================================================*/
 /// base class for nxnGrid model. derived classes are including step and actions implementations
-/// the class is non thread safe. 
-/// the static members are specialized to one type of nxnGrid so only one problem can simultaneously run
+/// Copy, Step and Free may be called by several threads at once (IsThreadSafe returns true): the memory pool is guarded
+/// and step, the belief update and the default policies use the random of the calling thread (Random::s_threadRand). setting the model (objects, lut, static members) is not thread safe.
+/// objects locations and actions are per model, so several models of the same problem (same number of objects and grid size)
+/// can run simultaneously in different threads. the static members (state id params, lut) are specialized to one type of nxnGrid
 class nxnGrid : public OnlineSolverModel
 {	
 public:
@@ -163,6 +163,8 @@ public:
 	virtual double GetMaxReward() const override{ return REWARD_WIN; };
 
 	virtual void DisplayParameters(std::ofstream & out) const override;
+	/// objects and their properties, rewards and offline lut
+	virtual std::string ParametersKey() const override;
 
 	virtual void PrintState(const State& state, std::ostream& out = std::cout) const override;
 	virtual void PrintBelief(const Belief& belief, std::ostream& out = std::cout) const override;
@@ -190,7 +192,7 @@ protected:
 
 	inline static double RandomNum()
 	{	
-		return Random::s_threadSafeRand[GetCurrentThreadId()].NextDouble();
+		return Random::s_threadRand.NextDouble();
 	}
 	/// create a vector of random numbers between 0 - 1
 	static void CreateRandomVec(doubleVec & randomVec, int size);
@@ -246,7 +248,7 @@ private:
 	int NumNonInvInCalc() const;
 
 
-	/// init state according to s_objectsInitLocations
+	/// init state according to m_objectsInitLocations
 	void InitStateRandom();
 	/// init state from vbs simulator
 	void InitStateSimulator();
@@ -273,12 +275,12 @@ protected:
 	std::vector<ObjInGrid> m_shelters;
 
 	// init locations of objects (needs to be in the size of number of objects - including self)
-	static std::vector<intVec> s_objectsInitLocations;
+	std::vector<intVec> m_objectsInitLocations;
 
 	// lut for actions names
-	static std::vector<std::string> s_actionsStr;
+	std::vector<std::string> m_actionsStr;
 
-	/// offline data LUT
+	/// offline data LUT (shared between models, read only after InitLUT)
 	static OnlineSolverLUT s_LUT;
 	static int s_lutGridSize;
 
@@ -8,19 +8,16 @@
 namespace despot 
 {
 
-bool nxnGridGlobalActions::s_isMoveFromEnemy = false;
-
 /* =============================================================================
 * nxnGridLocalActions Functions
 * =============================================================================*/
 
 nxnGridGlobalActions::nxnGridGlobalActions(int gridSize, int target, Self_Obj & self, std::vector<intVec> & objectsInitLoc, bool isMoveFromEnemyExist)
 : nxnGrid(gridSize, target, self, objectsInitLoc)
+, m_isMoveFromEnemy(isMoveFromEnemyExist)
 {
 	// init vector for string of actions
-	s_actionsStr.clear();
-	s_actionsStr.emplace_back("Move To Target");
-	s_isMoveFromEnemy = isMoveFromEnemyExist;
+	m_actionsStr.emplace_back("Move To Target");
 }
 
 bool nxnGridGlobalActions::Step(State& s, double randomSelfAction, int action, double & reward, OBS_TYPE& obs) const
@@ -109,7 +106,7 @@ int nxnGridGlobalActions::NumBasicActions() const
 
 int nxnGridGlobalActions::NumEnemyActions() const
 {
-	return 1 + s_isMoveFromEnemy;
+	return 1 + m_isMoveFromEnemy;
 }
 
 int nxnGridGlobalActions::NumActions() const
@@ -120,22 +117,22 @@ int nxnGridGlobalActions::NumActions() const
 
 ValuedAction nxnGridGlobalActions::GetMinRewardAction() const
 {
-	return ValuedAction(rand() % NumActions(), -10.0);
+	return ValuedAction(Random::s_threadRand.NextInt(NumActions()), -10.0);
 }
 
 void nxnGridGlobalActions::AddActionsToEnemy()
 {
 	int enemyNum = m_enemyVec.size();
-	s_actionsStr.push_back("Attack enemy #" + std::to_string(enemyNum));
-	if (s_isMoveFromEnemy)
-		s_actionsStr.push_back("Move from enemy #" + std::to_string(enemyNum));
+	m_actionsStr.push_back("Attack enemy #" + std::to_string(enemyNum));
+	if (m_isMoveFromEnemy)
+		m_actionsStr.push_back("Move from enemy #" + std::to_string(enemyNum));
 }
 
 void nxnGridGlobalActions::AddActionsToShelter()
 {
 	// insert single move to shelter after first action (move to target)
 	if (m_shelters.size() == 1)
-		s_actionsStr.insert(s_actionsStr.begin() + 1, "Move to shelter");
+		m_actionsStr.insert(m_actionsStr.begin() + 1, "Move to shelter");
 }
 
 void nxnGridGlobalActions::MoveToTarget(nxnGridDetailedState & state, double random) const
@@ -290,7 +287,7 @@ int nxnGridGlobalActions::randLegalAction(OBS_TYPE observation) const
 	int action;
 	do
 	{
-		action = rand() % NumActions();
+		action = Random::s_threadRand.NextInt(NumActions());
 	} while (action > NumBasicActions() && !obsEnemies[EnemyRelatedActionIdx(action)]);
 
 	return action;
@@ -71,7 +71,7 @@ private:
 
 
 	/*MEMBERS*/
-	static bool s_isMoveFromEnemy;
+	bool m_isMoveFromEnemy;
 };
 
 } // end ns despot
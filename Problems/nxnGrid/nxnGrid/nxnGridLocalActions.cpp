@@ -14,7 +14,7 @@ namespace despot
 nxnGridLocalActions::nxnGridLocalActions(int gridSize, int target, Self_Obj & self, std::vector<intVec> & objectsInitLoc)
 : nxnGrid(gridSize, target, self, objectsInitLoc)
 {
-	s_actionsStr = Move_Properties::s_directionNamesLUT;
+	m_actionsStr = Move_Properties::s_directionNamesLUT;
 }
 
 bool nxnGridLocalActions::Step(State& s, double randomSelfAction, int a, double& reward, OBS_TYPE& obs) const
@@ -23,8 +23,7 @@ bool nxnGridLocalActions::Step(State& s, double randomSelfAction, int a, double&
 	enum ACTION action = static_cast<enum ACTION>(a);
 
 	// drawing more random numbers for each variable
-	double randomSelfObservation = rand();
-	randomSelfObservation /= RAND_MAX;
+	double randomSelfObservation = RandomNum();
 
 	std::vector<double> randomObjectMoves;
 	CreateRandomVec(randomObjectMoves, CountMovingObjects() - 1);
@@ -96,7 +95,7 @@ int nxnGridLocalActions::NumActions() const
 
 void nxnGridLocalActions::AddActionsToEnemy()
 {
-	s_actionsStr.push_back("Attack enemy #" + std::to_string(m_enemyVec.size()));
+	m_actionsStr.push_back("Attack enemy #" + std::to_string(m_enemyVec.size()));
 }
 
 void nxnGridLocalActions::AddActionsToShelter()
@@ -200,7 +199,7 @@ int nxnGridLocalActions::randLegalAction(OBS_TYPE observation) const
 	int action;
 	do
 	{
-		action = rand() % NumActions();
+		action = Random::s_threadRand.NextInt(NumActions());
 	} while (action > NUM_BASIC_ACTIONS && !obsEnemies[EnemyRelatedActionIdx(action)]);
 
 	return action;
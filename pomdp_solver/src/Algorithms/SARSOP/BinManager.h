@@ -14,6 +14,8 @@
 using namespace std;
 
 namespace momdp{
+	class SARSOP;
+
 	class BinManagerDataTuple
 	{
 	public:
@@ -21,6 +23,7 @@ namespace momdp{
 	};
 
 	class BinManager{
+		friend class SARSOP;	// saves and restores the bins in checkpoints
 	public:
 		//Constructor
 		BinManager(BeliefValuePairPool * _initialUB, BeliefCache* _beliefCache, state_val _sval);
@@ -1,5 +1,7 @@
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <iomanip>
 
 #include "SARSOP.h"
@@ -10,10 +12,13 @@
 #include "BeliefTreeNode.h"
 #include "CPTimer.h"
 #include "BlindLBInitializer.h"
+#include "SeedLBInitializer.h"
 #include "FastInfUBInitializer.h"
 #include "BackupBeliefValuePairMOMDP.h"
 #include "BackupAlphaPlaneMOMDP.h"
 
+#define CHECKPOINT_MAGIC "APPLCKP2"
+
 
 void printSampleBelief(list<cacherow_stval>& beliefNStates)
 {
@@ -62,10 +67,28 @@ SARSOP::SARSOP(SharedPointer<MOMDP> problem, SolverParams * solverParams)
 	((SampleBP*)sampleEngine)->setup(problem, this);
 	beliefForest->setup(problem, this->sampleEngine, &this->beliefCacheSet);
 	numBackups = 0;
+	ubNode = NULL;
+	ubFailed = false;
+	ubStop = false;
+	lastCheckpointTime = 0;
+	resumedTime = 0;
 }
 
 SARSOP::~SARSOP(void)
 {
+	if (ubThread.joinable())
+	{
+		{
+			lock_guard<mutex> lock(ubMutex);
+			ubStop = true;
+		}
+		ubStart.notify_one();
+		ubThread.join();
+	}
+	if (checkpointThread.joinable())
+	{
+		checkpointThread.join();
+	}
 }
 
 
@@ -74,12 +97,12 @@ void SARSOP::solve(SharedPointer<MOMDP> problem)
 	try
 	{
 
-		bool skipSample = false;	// ADDED_24042009 flag for when all roots have ended their last trial and precision gap  <= 0
+		skipSample = false;	// ADDED_24042009 flag for when all roots have ended their last trial and precision gap  <= 0
 
 		//struct tms now;
 		int policyIndex, checkIndex;//index for policy output file, and index for checking whether to output policy file
+		int checkpointIndex;	// index for checking whether to write a checkpoint
 		bool stop;
-		std::vector<cacherow_stval> currentBeliefIndexArr; //int currentBeliefIndex;
 		// modified for parallel trials
 		//cacherow_stval currentBeliefIndex; //int currentBeliefIndex;
 		currentBeliefIndexArr.resize(problem->initialBeliefX->size());
@@ -90,7 +113,10 @@ void SARSOP::solve(SharedPointer<MOMDP> problem)
 			currentBeliefIndexArr[r].row = -1;
 		}
 
-		list<cacherow_stval> sampledBeliefs;  //modified for factored, prevly: list<int> sampledBeliefs;
+		sampledBeliefs.clear();
+		// no root assigned as active at the beginning
+		activeRoot = -1;
+
 		cacherow_stval lastRootBeliefIndex; //24092008 added to keep track of root chosen for each new trial
 		lastRootBeliefIndex.row = -1;
 		lastRootBeliefIndex.sval = -1;
@@ -99,6 +125,13 @@ void SARSOP::solve(SharedPointer<MOMDP> problem)
 
 		//start timing
 		//times(&start);
+		if (solverParams->parallelBackup || solverParams->backgroundPrune || solverParams->pruneThreads != 1)
+		{
+			// the processor time of the backup and pruning threads adds up
+			runtimeTimer.setWallClock(true);
+			lapTimer.setWallClock(true);
+			GlobalResource::getInstance()->solvingTimer.setWallClock(true);
+		}
 		runtimeTimer.start();
 		cout << "\nSARSOP initializing ..." << endl;
 
@@ -128,26 +161,32 @@ void SARSOP::solve(SharedPointer<MOMDP> problem)
 
 		//ADD SYLTAG - need to expand global root and all the roots for sampling
 		BeliefForest& globalroot = *(sampleEngine->getGlobalNode());
-		beliefForest->globalRootPrepare();//do preparation work for global root
+		if (solverParams->resumeFile.empty())	// the roots of a resumed run are in its checkpoint
+		{
+			beliefForest->globalRootPrepare();//do preparation work for global root
 
-		// cycle through all the roots and do preparation work
-		FOR(r, globalroot.sampleRootEdges.size()) {
-			//		FOR(r, sampleEngine->globalRoot->sampleRootEdges.size()) {
-			if (NULL != globalroot.sampleRootEdges[r]) 
-			{
-				BeliefTreeNode& thisRoot = *(globalroot.sampleRootEdges[r]->sampleRoot);
-				sampleEngine->samplePrepare(thisRoot.cacheIndex);//do preparation work for this root
+			// cycle through all the roots and do preparation work
+			FOR(r, globalroot.sampleRootEdges.size()) {
+				//		FOR(r, sampleEngine->globalRoot->sampleRootEdges.size()) {
+				if (NULL != globalroot.sampleRootEdges[r]) 
+				{
+					BeliefTreeNode& thisRoot = *(globalroot.sampleRootEdges[r]->sampleRoot);
+					sampleEngine->samplePrepare(thisRoot.cacheIndex);//do preparation work for this root
+				}
 			}
 		}
 
 		// TODO:: sampleEngine->dumpData = dumpData;//dump data
 		// TODO:: sampleEngine->dumpPolicyTrace = dumpPolicyTrace;//dump datadone
 		policyIndex = 0;
-		checkIndex = 0;
+		checkIndex = numBackups/CHECK_INTERVAL;	// 0 unless resumed
+		checkpointIndex = checkIndex;
 
 		lapTimer.start();
 		elapsed = runtimeTimer.elapsed();
 		printf("  initialization time : %.2fs\n", elapsed);
+		elapsed += resumedTime;
+		lastCheckpointTime = runtimeTimer.elapsed();
 
 
 		DEBUG_LOG(logFilePrint(policyIndex-1););
@@ -181,9 +220,6 @@ void SARSOP::solve(SharedPointer<MOMDP> problem)
 		//create while loop where:
 		int lastTrial = ((SampleBP*)sampleEngine)->numTrials;
 
-		// no root assigned as active at the beginning
-		int activeRoot = -1;
-
 		while(!stop)
 		{
 			int numTrials = ((SampleBP*)sampleEngine)->numTrials;
@@ -382,11 +418,22 @@ void SARSOP::solve(SharedPointer<MOMDP> problem)
 					else if(this->solverParams->timeoutSeconds >0)
 					{
 						double currentElapsed = runtimeTimer.elapsed();
-						elapsed = currentElapsed;
+						elapsed = currentElapsed + resumedTime;
 					}
 				}//end check periodically for policy write out and elapsed time update 
 			}
 
+			// checkpoint the run every checkpointInterval, checking the time every CHECK_INTERVAL backups
+			if (!this->solverParams->checkpointFile.empty() && (numBackups/CHECK_INTERVAL) >= checkpointIndex)
+			{
+				checkpointIndex++;
+				if (runtimeTimer.elapsed() - lastCheckpointTime >= this->solverParams->checkpointInterval)
+				{
+					writeCheckpoint();
+					lastCheckpointTime = runtimeTimer.elapsed();
+				}
+			}
+
 			//5. do printing for current precision
 			print();
 
@@ -417,6 +464,12 @@ void SARSOP::solve(SharedPointer<MOMDP> problem)
 	printDivider();
 	DEBUG_LOG(logFilePrint(-1););
 
+	if (!this->solverParams->checkpointFile.empty())
+	{
+		writeCheckpoint();
+		checkpointThread.join();
+	}
+
 	//now output policy to the outfile
 	cout << endl << "Writing out policy ..." << endl;
 	cout << "  output file : " << this->solverParams->outPolicyFileName << endl;
@@ -457,7 +510,7 @@ void SARSOP::alwaysPrint()
 	}
 	else
 	{
-		currentTime = runtimeTimer.elapsed();
+		currentTime = resumedTime + runtimeTimer.elapsed();
 	}
 	//printf("%.2fs ", currentTime);
 	cout.precision(6);
@@ -578,7 +631,7 @@ void SARSOP::logFilePrint(int index)
 		//utime = ((float)(now.tms_utime-start.tms_utime))/clk_tck;
 		//stime = ((float)(now.tms_stime-start.tms_stime))/clk_tck;
 		//currentTime = utime+stime;
-		currentTime = runtimeTimer.elapsed();
+		currentTime = resumedTime + runtimeTimer.elapsed();
 		fprintf(fp, "%.2f ", currentTime);		//SYLTEMP FOR EXPTS
 		//printf("<%.2fs> ", currentTime);	
 	}
@@ -681,6 +734,753 @@ void SARSOP::writeIntermediatePolicyTraceToFile(int trial, double time, const st
 	writePolicy(newFileName, problemName);
 }
 
+template <class T> static void appendBinary(vector<char>& buffer, const T* values, int count)
+{
+	const char* bytes = (const char*)values;
+	buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+}
+
+template <class T> static void appendBinary(vector<char>& buffer, T value)
+{
+	appendBinary(buffer, &value, 1);
+}
+
+template <class T> static void readBinary(ifstream& in, T* values, int count)
+{
+	in.read((char*)values, count * sizeof(T));
+}
+
+static void appendValue(vector<char>& buffer, int value)
+{
+	appendBinary(buffer, value);
+}
+
+static void appendValue(vector<char>& buffer, bool value)
+{
+	appendBinary(buffer, (char)value);
+}
+
+static void appendValue(vector<char>& buffer, double value)
+{
+	appendBinary(buffer, value);
+}
+
+static void appendValue(vector<char>& buffer, const string& value)
+{
+	appendBinary(buffer, (int)value.size());
+	appendBinary(buffer, value.data(), value.size());
+}
+
+static void appendValue(vector<char>& buffer, const cacherow_stval& index)
+{
+	appendBinary(buffer, index.sval);
+	appendBinary(buffer, index.row);
+}
+
+// index of the cache row of node, sval -1 for NULL
+static void appendValue(vector<char>& buffer, const BeliefTreeNode* node)
+{
+	cacherow_stval index;
+	index.sval = -1;
+	index.row = -1;
+	if (node != NULL)
+	{
+		index = node->cacheIndex;
+	}
+	appendValue(buffer, index);
+}
+
+static void appendValue(vector<char>& buffer, const belief_vector& b)
+{
+	appendBinary(buffer, (int)b.data.size());
+	FOREACH(SparseVector_Entry, e, b.data)
+	{
+		appendBinary(buffer, e->index);
+		appendBinary(buffer, e->value);
+	}
+}
+
+template <class T> static void appendValue(vector<char>& buffer, const list<T>& values)
+{
+	appendBinary(buffer, (int)values.size());
+	for (typename list<T>::const_iterator value = values.begin(); value != values.end(); value++)
+	{
+		appendValue(buffer, *value);
+	}
+}
+
+template <class T> static void appendValue(vector<char>& buffer, const vector<T>& values)
+{
+	appendBinary(buffer, (int)values.size());
+	FOR (i, values.size())
+	{
+		appendValue(buffer, values[i]);
+	}
+}
+
+template <class K, class V> static void appendValue(vector<char>& buffer, const map<K, V>& values)
+{
+	appendBinary(buffer, (int)values.size());
+	for (typename map<K, V>::const_iterator iter = values.begin(); iter != values.end(); iter++)
+	{
+		appendValue(buffer, iter->first);
+		appendValue(buffer, iter->second);
+	}
+}
+
+// counts of a corrupt file fail the stream
+static int readCount(ifstream& in)
+{
+	int count = 0;
+	readBinary(in, &count, 1);
+	if (!in || count < 0)
+	{
+		in.setstate(ios::failbit);
+		return 0;
+	}
+	return count;
+}
+
+static void readValue(ifstream& in, int& value)
+{
+	readBinary(in, &value, 1);
+}
+
+static void readValue(ifstream& in, bool& value)
+{
+	char c = 0;
+	readBinary(in, &c, 1);
+	value = (c != 0);
+}
+
+static void readValue(ifstream& in, double& value)
+{
+	readBinary(in, &value, 1);
+}
+
+static void readValue(ifstream& in, string& value)
+{
+	value.resize(readCount(in));
+	if (!value.empty())
+	{
+		readBinary(in, &value[0], value.size());
+	}
+}
+
+static void readValue(ifstream& in, cacherow_stval& index)
+{
+	readBinary(in, &index.sval, 1);
+	readBinary(in, &index.row, 1);
+}
+
+static SharedPointer<belief_vector> readBelief(ifstream& in, int size)
+{
+	SharedPointer<belief_vector> b (new belief_vector());
+	b->resize(size);
+	int numEntries = readCount(in);
+	for (int k = 0; k < numEntries && in; k++)
+	{
+		int index;
+		REAL_VALUE value;
+		readBinary(in, &index, 1);
+		readBinary(in, &value, 1);
+		b->push_back(index, value);
+	}
+	b->finalize();
+	return b;
+}
+
+template <class T> static void readValue(ifstream& in, list<T>& values)
+{
+	values.clear();
+	int count = readCount(in);
+	for (int i = 0; i < count && in; i++)
+	{
+		T value;
+		readValue(in, value);
+		values.push_back(value);
+	}
+}
+
+template <class T> static void readValue(ifstream& in, vector<T>& values)
+{
+	values.resize(readCount(in));
+	FOR (i, values.size())
+	{
+		readValue(in, values[i]);
+	}
+}
+
+template <class K, class V> static void readValue(ifstream& in, map<K, V>& values)
+{
+	values.clear();
+	int count = readCount(in);
+	for (int i = 0; i < count && in; i++)
+	{
+		K key;
+		readValue(in, key);
+		readValue(in, values[key]);
+	}
+}
+
+// Checkpoint file, counts are written before the entries of lists, a
+// belief is its number of non-zeros followed by (int index, double value)
+// pairs, a node is referenced by (int sval, int row) of its cache row:
+//   "APPLCKP2", int numX, numY, numActions, double time, int numBackups
+//   lower bound planes, in the pools in order, then those only left in
+//     ALPHA_PLANES of rows, the id of a plane is its place in this list:
+//     int sval, bool inPool, int action, timeStamp, used, numY doubles,
+//     int certed, bool sanityMax, certified nodes, their time stamps,
+//     maxMeta as (int cacheIndex, timestamp, double lastLB)
+//   for each x: numY doubles of corner points, the points as
+//     (double value, bool disabled, belief)
+//   for each x: the cache rows as (belief, double LB, UB,
+//     int ALPHA_TIME_STAMP, ids of ALPHA_PLANES, int UB_ACTION, bool binned)
+//     followed by their node: int count, bool checked, the Q entries as
+//     (double immediateReward, lbVal, ubVal, bool valid, for each x a
+//     bool and if set the outcomes as (child node, double obsProb))
+//   the roots as (bool, and if set the node and double sampleRootProb),
+//     double lbVal, ubVal of the forest
+//   SampleBP: int numTrials, numSubOptimal, numBinProceed,
+//     numStatesExpanded, double logOcc, the per root vectors
+//   for each x: BinManager bins
+//   SARSOPPrune: int pruneInterval, currentRound, double time since the
+//     first pass, bglobal_delta, int state, bool firstPass, for each x
+//     int lastPruneNumPlanes, double global_delta, int numSettled,
+//     double pruneTime, int numPrune, int lastPruneNumPts
+//   solve loop: int activeRoot, bool skipSample, currentBeliefIndexArr,
+//     sampledBeliefs
+// A background prune in progress is not saved, the resumed run prunes again.
+void SARSOP::writeCheckpoint()
+{
+	// the buffer is in use until the previous checkpoint is written
+	if (checkpointThread.joinable())
+	{
+		checkpointThread.join();
+	}
+
+	int numX = problem->XStates->size();
+	int numY = problem->YStates->size();
+	SampleBP* sampleBP = (SampleBP*)sampleEngine;
+	vector<char>& buffer = checkpointBuffer;
+	buffer.clear();
+	appendBinary(buffer, CHECKPOINT_MAGIC, 8);
+	appendValue(buffer, numX);
+	appendValue(buffer, numY);
+	appendValue(buffer, (int)problem->getNumActions());
+	appendValue(buffer, resumedTime + runtimeTimer.elapsed());
+	appendValue(buffer, numBackups);
+
+	// planes pruned from a pool may still be in ALPHA_PLANES of rows
+	vector<AlphaPlane*> planes;
+	vector<bool> inPool;
+	map<AlphaPlane*, int> planeIds;
+	FOR (x, numX)
+	{
+		LISTFOREACH(SharedPointer<AlphaPlane>, plane, lowerBoundSet->set[x]->planes)
+		{
+			planeIds[&**plane] = planes.size();
+			planes.push_back(&**plane);
+			inPool.push_back(true);
+		}
+	}
+	FOR (x, numX)
+	{
+		FOR (row, beliefCacheSet[x]->size())
+		{
+			LISTFOREACH(SharedPointer<AlphaPlane>, plane, *lbDataTableSet[x]->set(row).ALPHA_PLANES)
+			{
+				if (planeIds.find(&**plane) == planeIds.end())
+				{
+					planeIds[&**plane] = planes.size();
+					planes.push_back(&**plane);
+					inPool.push_back(false);
+				}
+			}
+		}
+	}
+
+	appendValue(buffer, (int)planes.size());
+	FOR (i, planes.size())
+	{
+		AlphaPlane* plane = planes[i];
+		SARSOPAlphaPlaneTuple* tuple = (SARSOPAlphaPlaneTuple*)plane->solverData;
+		appendValue(buffer, plane->sval);
+		appendValue(buffer, (bool)inPool[i]);
+		appendValue(buffer, plane->action);
+		appendValue(buffer, plane->timeStamp);
+		appendValue(buffer, plane->used);
+		appendBinary(buffer, &plane->alpha->data[0], numY);
+		appendValue(buffer, tuple->certed);
+		appendValue(buffer, tuple->sanityMax);
+		appendBinary(buffer, (int)tuple->certifiedBeliefs.size());
+		FOR (k, tuple->certifiedBeliefs.size())
+		{
+			appendValue(buffer, (const BeliefTreeNode*)tuple->certifiedBeliefs[k]);
+		}
+		appendValue(buffer, tuple->certifiedBeliefTimeStamps);
+		appendBinary(buffer, (int)tuple->maxMeta.size());
+		FOR (k, tuple->maxMeta.size())
+		{
+			appendValue(buffer, tuple->maxMeta[k]->cacheIndex);
+			appendValue(buffer, tuple->maxMeta[k]->timestamp);
+			appendValue(buffer, tuple->maxMeta[k]->lastLB);
+		}
+	}
+
+	FOR (x, numX)
+	{
+		BeliefValuePairPool* pool = upperBoundSet->set[x];
+		appendBinary(buffer, &pool->cornerPoints.data[0], numY);
+		appendValue(buffer, (int)pool->points.size());
+		LISTFOREACH(SharedPointer<BeliefValuePair>, point, pool->points)
+		{
+			appendValue(buffer, (*point)->v);
+			appendValue(buffer, (*point)->disabled);
+			appendValue(buffer, *(*point)->b);
+		}
+	}
+
+	FOR (x, numX)
+	{
+		BeliefCache* cache = beliefCacheSet[x];
+		appendValue(buffer, cache->size());
+		FOR (row, cache->size())
+		{
+			BeliefCacheRow* cacheRow = cache->getRow(row);
+			AlphaPlanePoolDataTuple& lbData = lbDataTableSet[x]->set(row);
+			appendValue(buffer, *cacheRow->BELIEF);
+			appendValue(buffer, (double)cacheRow->LB);
+			appendValue(buffer, (double)cacheRow->UB);
+			appendValue(buffer, lbData.ALPHA_TIME_STAMP);
+			appendValue(buffer, (int)lbData.ALPHA_PLANES->size());
+			LISTFOREACH(SharedPointer<AlphaPlane>, plane, *lbData.ALPHA_PLANES)
+			{
+				appendValue(buffer, planeIds[&**plane]);
+			}
+			appendValue(buffer, ubDataTableSet[x]->set(row).UB_ACTION);
+			appendValue(buffer, binManagerSet->binManagerSet[x]->binManagerDataTable.set(row).binned);
+
+			BeliefTreeNode* cn = cacheRow->REACHABLE;
+			appendValue(buffer, cn->count);
+			appendValue(buffer, cn->checked);
+			appendValue(buffer, (int)cn->Q.size());
+			FOR (a, cn->Q.size())
+			{
+				BeliefTreeQEntry& Qa = cn->Q[a];
+				appendValue(buffer, Qa.immediateReward);
+				appendValue(buffer, Qa.lbVal);
+				appendValue(buffer, Qa.ubVal);
+				appendValue(buffer, Qa.valid);
+				appendValue(buffer, (int)Qa.stateOutcomes.size());
+				FOR (xn, Qa.stateOutcomes.size())
+				{
+					BeliefTreeObsState* xe = Qa.stateOutcomes[xn];
+					appendValue(buffer, xe != NULL);
+					if (xe == NULL)
+					{
+						continue;
+					}
+					appendValue(buffer, (int)xe->outcomes.size());
+					FOR (o, xe->outcomes.size())
+					{
+						BeliefTreeEdge* e = xe->outcomes[o];
+						appendValue(buffer, (const BeliefTreeNode*)(e == NULL ? NULL : e->nextState));
+						appendValue(buffer, e == NULL ? 0.0 : e->obsProb);
+					}
+				}
+			}
+		}
+	}
+
+	BeliefForest& globalroot = *(sampleEngine->getGlobalNode());
+	appendValue(buffer, (int)globalroot.sampleRootEdges.size());
+	FOR (r, globalroot.sampleRootEdges.size())
+	{
+		SampleRootEdge* eR = globalroot.sampleRootEdges[r];
+		appendValue(buffer, eR != NULL);
+		if (eR != NULL)
+		{
+			appendValue(buffer, (const BeliefTreeNode*)eR->sampleRoot);
+			appendValue(buffer, eR->sampleRootProb);
+		}
+	}
+	appendValue(buffer, globalroot.lbVal);
+	appendValue(buffer, globalroot.ubVal);
+
+	appendValue(buffer, sampleBP->numTrials);
+	appendValue(buffer, sampleBP->numSubOptimal);
+	appendValue(buffer, sampleBP->numBinProceed);
+	appendValue(buffer, sampleBP->numStatesExpanded);
+	appendValue(buffer, sampleBP->logOcc);
+	appendValue(buffer, sampleBP->depthArr);
+	appendValue(buffer, sampleBP->trialTargetPrecisionArr);
+	appendValue(buffer, sampleBP->newTrialFlagArr);
+	appendValue(buffer, sampleBP->nextNodeTargetUbArr);
+	appendValue(buffer, sampleBP->nextNodeTargetLbArr);
+	appendValue(buffer, sampleBP->priorityQueueArr);
+
+	FOR (x, numX)
+	{
+		BinManager* bins = binManagerSet->binManagerSet[x];
+		appendValue(buffer, bins->highest);
+		appendValue(buffer, bins->lowest);
+		appendValue(buffer, bins->bin_level_count);
+		appendValue(buffer, bins->binLevels_intervals);
+		appendValue(buffer, bins->binLevels_nodes);
+		appendValue(buffer, bins->binLevels);
+		appendValue(buffer, bins->previous_lowerbound);
+	}
+
+	appendValue(buffer, pruneEngine->pruneInterval);
+	appendValue(buffer, pruneEngine->currentRound);
+	// elapsed is the run time of this process at the first pass
+	appendValue(buffer, pruneEngine->firstPass ? 0.0 : GlobalResource::getInstance()->getRunTime() - pruneEngine->elapsed);
+	appendValue(buffer, pruneEngine->bglobal_delta);
+	appendValue(buffer, pruneEngine->state);
+	appendValue(buffer, pruneEngine->firstPass);
+	FOR (x, numX)
+	{
+		PruneAlphaPlane* lbPrune = lowerBoundSet->set[x]->pruneEngine;
+		appendValue(buffer, lbPrune->lastPruneNumPlanes);
+		appendValue(buffer, lbPrune->global_delta);
+		appendValue(buffer, lbPrune->numSettled);
+		appendValue(buffer, lbPrune->pruneTime);
+		appendValue(buffer, lbPrune->numPrune);
+		appendValue(buffer, upperBoundSet->set[x]->pruneEngine->lastPruneNumPts);
+	}
+
+	appendValue(buffer, activeRoot);
+	appendValue(buffer, skipSample);
+	appendValue(buffer, currentBeliefIndexArr);
+	appendValue(buffer, sampledBeliefs);
+
+	checkpointThread = thread(&SARSOP::writeCheckpointFile, this);
+}
+
+// runs on checkpointThread, the previous checkpoint is replaced only once the new one is complete
+void SARSOP::writeCheckpointFile()
+{
+	string fileName = solverParams->checkpointFile;
+	string tempFileName = fileName + ".tmp";
+	{
+		ofstream out(tempFileName.c_str(), ios::binary);
+		out.write(&checkpointBuffer[0], checkpointBuffer.size());
+		if (!out)
+		{
+			cerr << "WARNING: couldn't write checkpoint to " << tempFileName << endl;
+			return;
+		}
+	}
+
+#ifdef _WIN32
+	// rename does not replace an existing file on Windows, elsewhere it
+	// replaces it atomically and the old checkpoint stays until then
+	remove(fileName.c_str());
+#endif
+	if (rename(tempFileName.c_str(), fileName.c_str()) != 0)
+	{
+		cerr << "WARNING: couldn't rename " << tempFileName << " to " << fileName << ": " << strerror(errno) << endl;
+	}
+}
+
+// Restores the bounds in place of initializeBounds, the nodes the planes
+// certify are linked by readCheckpointState once the rows are read
+void SARSOP::readCheckpoint(const string& fileName)
+{
+	ifstream& in = checkpointIn;
+	in.open(fileName.c_str(), ios::binary);
+	if (!in)
+	{
+		cerr << "ERROR: couldn't open checkpoint " << fileName << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	int numX = problem->XStates->size();
+	int numY = problem->YStates->size();
+	char magic[8];
+	int dims[3];
+	readBinary(in, magic, 8);
+	readBinary(in, dims, 3);
+	if (!in || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0
+		|| dims[0] != numX || dims[1] != numY || dims[2] != problem->getNumActions())
+	{
+		cerr << "ERROR: " << fileName << " is not a checkpoint of this model" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	readValue(in, resumedTime);
+	readValue(in, numBackups);
+	printIndex = numBackups/CHECK_INTERVAL;
+
+	int numPlanes = readCount(in);
+	for (int i = 0; i < numPlanes && in; i++)
+	{
+		SharedPointer<AlphaPlane> plane (new AlphaPlane());
+		SARSOPAlphaPlaneTuple* tuple = (SARSOPAlphaPlaneTuple*)plane->solverData;
+		bool inPool;
+		readValue(in, plane->sval);
+		readValue(in, inPool);
+		readValue(in, plane->action);
+		readValue(in, plane->timeStamp);
+		readValue(in, plane->used);
+		plane->alpha->resize(numY);
+		readBinary(in, &plane->alpha->data[0], numY);
+		readValue(in, tuple->certed);
+		readValue(in, tuple->sanityMax);
+
+		tuple->certifiedBeliefs.resize(readCount(in), NULL);
+		FOR (k, tuple->certifiedBeliefs.size())
+		{
+			cacherow_stval index;
+			readValue(in, index);
+			if (index.sval != -1)
+			{
+				resumedLinks.push_back(make_pair(&tuple->certifiedBeliefs[k], index));
+			}
+		}
+		readValue(in, tuple->certifiedBeliefTimeStamps);
+
+		int numMaxMeta = readCount(in);
+		for (int k = 0; k < numMaxMeta && in; k++)
+		{
+			AlphaPlaneMaxMeta* maxMeta = new AlphaPlaneMaxMeta();
+			readValue(in, maxMeta->cacheIndex);
+			readValue(in, maxMeta->timestamp);
+			readValue(in, maxMeta->lastLB);
+			tuple->maxMeta.push_back(maxMeta);
+		}
+
+		if (plane->sval < 0 || plane->sval >= numX)
+		{
+			in.setstate(ios::failbit);
+			break;
+		}
+		if (inPool)
+		{
+			lowerBoundSet->set[plane->sval]->addAlphaPlane(plane);
+		}
+		resumedPlanes.push_back(plane);
+	}
+
+	FOR (x, numX)
+	{
+		BeliefValuePairPool* pool = upperBoundSet->set[x];
+		pool->cornerPoints.resize(numY);
+		readBinary(in, &pool->cornerPoints.data[0], numY);
+
+		int numPoints = readCount(in);
+		for (int i = 0; i < numPoints && in; i++)
+		{
+			double v;
+			bool disabled;
+			readValue(in, v);
+			readValue(in, disabled);
+			SharedPointer<belief_vector> b = readBelief(in, numY);
+			SharedPointer<BeliefValuePair> point = pool->addPoint(b, v);
+			if (point != NULL)
+			{
+				point->disabled = disabled;
+			}
+		}
+		pool->cornerPointsVersion++;	// as after the initialization of the bounds
+	}
+
+	if (!in)
+	{
+		cerr << "ERROR: checkpoint " << fileName << " is truncated" << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
+// Restores the belief tree, the bins and the state of the sample and prune
+// engines and of the solve loop from the rest of the checkpoint
+void SARSOP::readCheckpointState()
+{
+	ifstream& in = checkpointIn;
+	const string& fileName = solverParams->resumeFile;
+	int numX = problem->XStates->size();
+	int numY = problem->YStates->size();
+	SampleBP* sampleBP = (SampleBP*)sampleEngine;
+	bool corrupt = false;
+
+	FOR (x, numX)
+	{
+		BeliefCache* cache = beliefCacheSet[x];
+		int numRows = readCount(in);
+		for (int i = 0; i < numRows && in; i++)
+		{
+			SharedPointer<belief_vector> b = readBelief(in, numY);
+			int row = cache->addBeliefRowWithoutCheck(b);
+			BeliefCacheRow* cacheRow = cache->getRow(row);
+			double lb, ub;
+			readValue(in, lb);
+			readValue(in, ub);
+			cacheRow->LB = lb;
+			cacheRow->UB = ub;
+
+			AlphaPlanePoolDataTuple& lbData = lbDataTableSet[x]->set(row);
+			readValue(in, lbData.ALPHA_TIME_STAMP);
+			lbData.ALPHA_PLANES = new list<SharedPointer<AlphaPlane> >();
+			int numAlphas = readCount(in);
+			for (int k = 0; k < numAlphas && in; k++)
+			{
+				int id;
+				readValue(in, id);
+				if (id < 0 || id >= (int)resumedPlanes.size())
+				{
+					corrupt = true;
+					break;
+				}
+				lbData.ALPHA_PLANES->push_back(resumedPlanes[id]);
+			}
+			readValue(in, ubDataTableSet[x]->set(row).UB_ACTION);
+			readValue(in, binManagerSet->binManagerSet[x]->binManagerDataTable.set(row).binned);
+
+			BeliefTreeNode* cn = new BeliefTreeNode();
+			cn->s = new BeliefWithState();
+			cn->s->sval = x;
+			cn->s->bvec = b;
+			cn->cacheIndex.row = row;
+			cn->cacheIndex.sval = x;
+			cacheRow->REACHABLE = cn;
+			readValue(in, cn->count);
+			readValue(in, cn->checked);
+			cn->Q.resize(readCount(in));
+			FOR (a, cn->Q.size())
+			{
+				BeliefTreeQEntry& Qa = cn->Q[a];
+				readValue(in, Qa.immediateReward);
+				readValue(in, Qa.lbVal);
+				readValue(in, Qa.ubVal);
+				readValue(in, Qa.valid);
+				Qa.stateOutcomes.resize(readCount(in), NULL);
+				FOR (xn, Qa.stateOutcomes.size())
+				{
+					bool present;
+					readValue(in, present);
+					if (!present)
+					{
+						continue;
+					}
+					BeliefTreeObsState* xe = new BeliefTreeObsState();
+					Qa.stateOutcomes[xn] = xe;
+					xe->outcomes.resize(readCount(in), NULL);
+					FOR (o, xe->outcomes.size())
+					{
+						cacherow_stval index;
+						double obsProb;
+						readValue(in, index);
+						readValue(in, obsProb);
+						if (index.sval != -1)
+						{
+							BeliefTreeEdge* e = new BeliefTreeEdge();
+							e->obsProb = obsProb;
+							xe->outcomes[o] = e;
+							resumedLinks.push_back(make_pair(&e->nextState, index));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	BeliefForest& globalroot = *(sampleEngine->getGlobalNode());
+	globalroot.sampleRootEdges.resize(readCount(in), NULL);
+	FOR (r, globalroot.sampleRootEdges.size())
+	{
+		bool present;
+		readValue(in, present);
+		if (present)
+		{
+			cacherow_stval index;
+			SampleRootEdge* eR = new SampleRootEdge();
+			readValue(in, index);
+			readValue(in, eR->sampleRootProb);
+			globalroot.sampleRootEdges[r] = eR;
+			resumedLinks.push_back(make_pair(&eR->sampleRoot, index));
+		}
+	}
+	readValue(in, globalroot.lbVal);
+	readValue(in, globalroot.ubVal);
+
+	readValue(in, sampleBP->numTrials);
+	readValue(in, sampleBP->numSubOptimal);
+	readValue(in, sampleBP->numBinProceed);
+	readValue(in, sampleBP->numStatesExpanded);
+	readValue(in, sampleBP->logOcc);
+	readValue(in, sampleBP->depthArr);
+	readValue(in, sampleBP->trialTargetPrecisionArr);
+	readValue(in, sampleBP->newTrialFlagArr);
+	readValue(in, sampleBP->nextNodeTargetUbArr);
+	readValue(in, sampleBP->nextNodeTargetLbArr);
+	readValue(in, sampleBP->priorityQueueArr);
+
+	FOR (x, numX)
+	{
+		BinManager* bins = binManagerSet->binManagerSet[x];
+		readValue(in, bins->highest);
+		readValue(in, bins->lowest);
+		readValue(in, bins->bin_level_count);
+		readValue(in, bins->binLevels_intervals);
+		readValue(in, bins->binLevels_nodes);
+		readValue(in, bins->binLevels);
+		readValue(in, bins->previous_lowerbound);
+	}
+
+	double sinceFirstPass;
+	readValue(in, pruneEngine->pruneInterval);
+	readValue(in, pruneEngine->currentRound);
+	readValue(in, sinceFirstPass);
+	readValue(in, pruneEngine->bglobal_delta);
+	readValue(in, pruneEngine->state);
+	readValue(in, pruneEngine->firstPass);
+	pruneEngine->elapsed = GlobalResource::getInstance()->getRunTime() - sinceFirstPass;
+	FOR (x, numX)
+	{
+		PruneAlphaPlane* lbPrune = lowerBoundSet->set[x]->pruneEngine;
+		readValue(in, lbPrune->lastPruneNumPlanes);
+		readValue(in, lbPrune->global_delta);
+		readValue(in, lbPrune->numSettled);
+		readValue(in, lbPrune->pruneTime);
+		readValue(in, lbPrune->numPrune);
+		readValue(in, upperBoundSet->set[x]->pruneEngine->lastPruneNumPts);
+	}
+
+	readValue(in, activeRoot);
+	readValue(in, skipSample);
+	readValue(in, currentBeliefIndexArr);
+	readValue(in, sampledBeliefs);
+
+	if (!in)
+	{
+		cerr << "ERROR: checkpoint " << fileName << " is truncated" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	FOR (i, resumedLinks.size())
+	{
+		cacherow_stval& index = resumedLinks[i].second;
+		if (index.sval < 0 || index.sval >= numX || index.row < 0 || index.row >= beliefCacheSet[index.sval]->size())
+		{
+			corrupt = true;
+			break;
+		}
+		*resumedLinks[i].first = beliefCacheSet[index.sval]->getRow(index.row)->REACHABLE;
+	}
+	if (corrupt || (int)sampleBP->depthArr.size() != (int)globalroot.sampleRootEdges.size()
+		|| (int)currentBeliefIndexArr.size() != (int)globalroot.sampleRootEdges.size())
+	{
+		cerr << "ERROR: checkpoint " << fileName << " is corrupt" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	resumedPlanes.clear();
+	resumedLinks.clear();
+	in.close();
+	cout << "  resumed " << fileName << " : " << sampleBP->numTrials << " trials, " << numBackups << " backups, " << resumedTime << "s" << endl;
+}
+
 
 BeliefTreeNode& SARSOP::getMaxExcessUncRoot(BeliefForest& globalroot) 
 {
@@ -742,11 +1542,26 @@ void SARSOP::initialize(SharedPointer<MOMDP> problem)
 	lowerBoundSet->setBeliefCache(beliefCacheSet);
 	lowerBoundSet->setDataTable(lbDataTableSet);
 
-	initializeBounds(this->solverParams->targetPrecision);
+	if (solverParams->resumeFile.empty())
+	{
+		initializeBounds(this->solverParams->targetPrecision);
+	}
+	else
+	{
+		readCheckpoint(solverParams->resumeFile);
+	}
 	initSampleEngine(problem);
 
 	pruneEngine = new SARSOPPrune(this);
+	if (!solverParams->resumeFile.empty())
+	{
+		readCheckpointState();
+	}
 
+	if (solverParams->parallelBackup)
+	{
+		ubThread = thread(&SARSOP::ubThreadLoop, this);
+	}
 }
 void SARSOP::initSampleEngine(SharedPointer<MOMDP> problem)
 {
@@ -788,8 +1603,20 @@ void SARSOP::initializeBounds(double _targetPrecision)
 
 	DEBUG_LOG( cout << fixed << setprecision(2) << elapsed << "s blb.initialize(targetPrecision) done" << endl; );
 
+	if (!solverParams->seedPolicyFile.empty())
+	{
+		heurTimer.restart();
+		SeedLBInitializer slb(problem, lowerBoundSet);
+		slb.numThreads = solverParams->initThreads;
+		slb.initialize(solverParams->seedPolicyFile, targetPrecision);
+		elapsed = heurTimer.elapsed();
+		DEBUG_LOG( cout << fixed << setprecision(2) << elapsed << "s slb.initialize(seedPolicyFile) done" << endl; );
+	}
+
 	heurTimer.restart();
 	FastInfUBInitializer fib(problem, upperBoundSet); 
+	fib.numThreads = solverParams->initThreads;
+	fib.warmStartFile = solverParams->fibWarmStartFile;
 	fib.initialize(targetPrecision);
 	elapsed = heurTimer.elapsed();
 	DEBUG_LOG(cout << fixed << setprecision(2) << elapsed << "s fib.initialize(targetPrecision) done" << endl;);
@@ -881,13 +1708,89 @@ cacherow_stval SARSOP::backup(cacherow_stval beliefNState)
 	numBackups++;
 	
 	GlobalResource::getInstance()->setTimeStamp(numBackups);
-	lowerBoundSet->backup(cn);
-	upperBoundSet->backup(cn);
+	if (solverParams->parallelBackup)
+	{
+		parallelBackup(cn);
+	}
+	else
+	{
+		lowerBoundSet->backup(cn);
+		upperBoundSet->backup(cn);
+	}
 	//numBackups++;
 	GlobalResource::getInstance()->setTimeStamp(numBackups);
 	return beliefNState;
 }
 
+// backup of cn with the upper bound value computed on ubThread
+void SARSOP::parallelBackup(BeliefTreeNode* cn)
+{
+	{
+		lock_guard<mutex> lock(ubMutex);
+		ubNode = cn;
+	}
+	ubStart.notify_one();
+
+	lowerBoundSet->backup(cn);
+
+	{
+		unique_lock<mutex> lock(ubMutex);
+		while (ubNode != NULL)
+		{
+			ubDone.wait(lock);
+		}
+		if (ubFailed)
+		{
+			// rethrown on the solver thread, which writes out the policy
+			throw bad_alloc();
+		}
+	}
+
+	BackupBeliefValuePairMOMDP* ubBackup = (BackupBeliefValuePairMOMDP*)upperBoundBackup;
+	SharedPointer<BeliefValuePair> result = ubBackup->setNewUBValue(cn, ubValue, ubAction);
+	upperBoundSet->backupDone(cn, result);
+}
+
+// getNewUBValue only reads the upper bound pool and writes the Q values and
+// cached upper bounds of the belief, which the lower bound backup does not use
+void SARSOP::ubThreadLoop()
+{
+	BackupBeliefValuePairMOMDP* ubBackup = (BackupBeliefValuePairMOMDP*)upperBoundBackup;
+	unique_lock<mutex> lock(ubMutex);
+	while (true)
+	{
+		while (ubNode == NULL && !ubStop)
+		{
+			ubStart.wait(lock);
+		}
+		if (ubStop)
+		{
+			return;
+		}
+
+		BeliefTreeNode* cn = ubNode;
+		lock.unlock();
+		int maxUBAction = 0;
+		double newUBVal = 0;
+		bool failed = false;
+		try
+		{
+			newUBVal = ubBackup->getNewUBValue(*cn, &maxUBAction);
+		}
+		catch (bad_alloc&)
+		{
+			failed = true;
+		}
+		lock.lock();
+
+		ubValue = newUBVal;
+		ubAction = maxUBAction;
+		ubFailed = failed;
+		ubNode = NULL;
+		ubDone.notify_one();
+	}
+}
+
 cacherow_stval SARSOP::backupLBonly(cacherow_stval beliefNState){
 
 	unsigned int stateidx = beliefNState.sval;
@@ -914,7 +1817,14 @@ void SARSOP::writePolicy(string fileName, string problemName)
 
 void SARSOP::writeToFile(const std::string& outFileName, string problemName) 
 {
-	lowerBoundSet->writeToFile(outFileName, problemName);
+	if (solverParams->binaryPolicyValueSize > 0)
+	{
+		lowerBoundSet->writeToBinaryFile(outFileName, problemName, solverParams->binaryPolicyValueSize);
+	}
+	else
+	{
+		lowerBoundSet->writeToFile(outFileName, problemName);
+	}
 
 }
 
@@ -1,6 +1,10 @@
 #ifndef SARSOP_H
 #define SARSOP_H
+#include <fstream>
 #include <list>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "PointBasedAlgorithm.h"
 #include "Bound.h"
 #include "BoundSet.h"
@@ -44,7 +48,54 @@ namespace momdp
 	class SARSOP :	public PointBasedAlgorithm
 	{
 	private:
-
+		// Parallel backup (--parallel-backup): the new upper bound value of a
+		// belief is computed on ubThread while its lower bound is backed up on
+		// the solver thread. The two only read their own pool, and the new
+		// point is added once both are done, so the bounds are the same as
+		// the ones of the serial backup. The nodes of a sampled path are
+		// still backed up one after the other (a parent reads the bounds its
+		// children just got, and the pool lookups keep per-belief caches and
+		// scratch vectors), so at most two threads run. Both halves allocate
+		// MObjects, whose memory accounting in GlobalResource is atomic.
+		std::thread ubThread;
+		std::mutex ubMutex;
+		std::condition_variable ubStart;
+		std::condition_variable ubDone;
+		BeliefTreeNode* ubNode;	// belief being backed up, NULL when ubThread is idle
+		double ubValue;
+		int ubAction;
+		bool ubFailed;	// the memory limit was hit on ubThread
+		bool ubStop;
+
+		void ubThreadLoop();
+		void parallelBackup(BeliefTreeNode* cn);
+
+		// Checkpoints (--checkpoint): the state the search goes on from, that
+		// is the bounds, the belief tree with its cache rows, the bins, the
+		// sampling and pruning state and the position of the solve loop, is
+		// copied to checkpointBuffer on the solver thread and written to the
+		// file on checkpointThread while the search continues. --resume
+		// restores the bounds in place of their initialization
+		// (readCheckpoint) and the rest once the sample and prune engines
+		// exist (readCheckpointState).
+		std::thread checkpointThread;
+		vector<char> checkpointBuffer;
+		double lastCheckpointTime;
+		double resumedTime;	// solving time of the runs before the resumed checkpoint
+		ifstream checkpointIn;	// the resumed checkpoint, open until readCheckpointState
+		vector<SharedPointer<AlphaPlane> > resumedPlanes;	// planes of the resumed checkpoint by id
+		vector<pair<BeliefTreeNode**, cacherow_stval> > resumedLinks;	// set once all the nodes are read
+
+		// position of the solve loop, saved in checkpoints
+		int activeRoot;
+		bool skipSample;	// all roots have ended their last trial and precision gap <= 0
+		vector<cacherow_stval> currentBeliefIndexArr;
+		list<cacherow_stval> sampledBeliefs;	// path backed up at the start of the next iteration
+
+		void writeCheckpoint();
+		void writeCheckpointFile();
+		void readCheckpoint(const string& fileName);
+		void readCheckpointState();
 
 	public:
 
@@ -13,6 +13,7 @@ namespace momdp
 {
 	class SARSOPPrune :public Prune
 	{
+		friend class SARSOP;	// saves and restores the pruning state in checkpoints
 	private:
 		SARSOP* sarsopSolver;
 		int pruneInterval; //numBackups between each 2 prunings
@@ -35,6 +36,12 @@ namespace momdp
 			state = 2;
 			firstPass = true;
 			setDelta(sarsopSolver->solverParams->delta);
+			FOR (stateidx, sarsopSolver->lowerBoundSet->set.size())
+			{
+				PruneAlphaPlane* engine = sarsopSolver->lowerBoundSet->set[stateidx]->pruneEngine;
+				engine->numThreads = sarsopSolver->solverParams->pruneThreads;
+				engine->background = sarsopSolver->solverParams->backgroundPrune;
+			}
 
 		}
 
@@ -46,6 +46,7 @@ namespace momdp{
     };
 
     class SampleBP: public Sample{
+	friend class SARSOP;	// saves and restores the trials in checkpoints
 	private:
 	    //attributes
 #if USE_HSVI_ADAPTIVE_DEPTH
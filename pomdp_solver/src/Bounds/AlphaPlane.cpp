@@ -6,7 +6,7 @@
 using namespace std;
 
 
-AlphaPlane::AlphaPlane(void) : alpha (new alpha_vector())
+AlphaPlane::AlphaPlane(void) : alpha (new alpha_vector()), poolColumn(-1)
 {
 	
 	solverData = new SARSOPAlphaPlaneTuple();
@@ -34,6 +34,7 @@ public:
 		Tuple* solverData;
 		int timeStamp;
 		int used; //for recording its usage in corner point dominations
+		int poolColumn; //column of the plane in the matrix of its AlphaPlanePool, -1 if none
 	
 
 		void setTimeStamp(int _timeStamp);
@@ -1,8 +1,10 @@
 #include "AlphaPlanePool.h"
 #include "BeliefCache.h"
 #include "SARSOP.h"
+#include "GlobalResource.h"
 #include <exception>
 #include <stdexcept>
+#include <algorithm>
 using namespace std;
 
 
@@ -16,6 +18,172 @@ SharedPointer<AlphaPlane> AlphaPlanePool::getValueAlpha(SharedPointer<Belief>& b
 void AlphaPlanePool::addAlphaPlane(SharedPointer<AlphaPlane> plane)
 {
 	planes.push_back(plane);
+	appendColumn(plane);
+}
+
+void AlphaPlanePool::setAlphaPlanes(const list<SharedPointer<AlphaPlane> >& nextPlanes)
+{
+	// the columns are tombstoned in place if nextPlanes keeps their order,
+	// so ties between planes are broken the same way as in the list
+	vector<char> kept(columns.size(), 0);
+	bool inOrder = true;
+	int lastColumn = -1;
+	LISTFOREACH(SharedPointer<AlphaPlane>, pr, nextPlanes)
+	{
+		int c = (*pr)->poolColumn;
+		if (c <= lastColumn || c >= (int)columns.size() || columns[c] != *pr)
+		{
+			inOrder = false;
+			break;
+		}
+		kept[c] = 1;
+		lastColumn = c;
+	}
+
+	planes = nextPlanes;
+	if (!inOrder)
+	{
+		rebuildColumns();
+		return;
+	}
+
+	FOR(c, columns.size())
+	{
+		if (!kept[c] && columns[c] != NULL)
+		{
+			columns[c]->poolColumn = -1;
+			columns[c] = NULL;
+			numDead++;
+		}
+	}
+	if (2 * numDead > (int)columns.size())
+	{
+		relayout(capacity);
+	}
+}
+
+void AlphaPlanePool::clearAlphaPlanes()
+{
+	planes.clear();
+	rebuildColumns();
+}
+
+void AlphaPlanePool::appendColumn(SharedPointer<AlphaPlane>& plane)
+{
+	if (columns.empty() && numDead == 0)
+	{
+		numStates = plane->alpha->size();
+	}
+	assert(plane->alpha->size() == numStates);
+
+	if ((int)columns.size() == capacity)
+	{
+		// compacting frees enough room if at least half of the columns are
+		// dead, the matrix grows by half so its slack stays within a third
+		relayout(2 * numDead >= (int)columns.size() && numDead > 0 ? capacity : max(16, capacity + capacity / 2));
+	}
+
+	int c = columns.size();
+	const vector<REAL_VALUE>& alpha = plane->alpha->data;
+	for (int s = 0; s < numStates; s++)
+	{
+		matrix[s * capacity + c] = alpha[s];
+	}
+	if (!columnStamps.empty() && plane->timeStamp < columnStamps.back())
+	{
+		stampsSorted = false;
+	}
+	plane->poolColumn = c;
+	columns.push_back(plane);
+	columnStamps.push_back(plane->timeStamp);
+}
+
+void AlphaPlanePool::swapMatrix(vector<REAL_VALUE>& newMatrix)
+{
+	bool grows = newMatrix.size() > matrix.size();
+	GlobalResource::getInstance()->memoryUsage += newMatrix.size() * sizeof(REAL_VALUE);
+	GlobalResource::getInstance()->memoryUsage -= matrix.size() * sizeof(REAL_VALUE);
+	matrix.swap(newMatrix);
+	if (grows)
+	{
+		GlobalResource::getInstance()->checkMemoryUsage();
+	}
+}
+
+// Move the live columns to the front of a matrix with newCapacity columns
+void AlphaPlanePool::relayout(int newCapacity)
+{
+	vector<REAL_VALUE> newMatrix(numStates * newCapacity);
+	vector<SharedPointer<AlphaPlane> > newColumns;
+	vector<int> newStamps;
+	newColumns.reserve(newCapacity);
+	FOR(c, columns.size())
+	{
+		if (columns[c] == NULL)
+		{
+			continue;
+		}
+		int nc = newColumns.size();
+		for (int s = 0; s < numStates; s++)
+		{
+			newMatrix[s * newCapacity + nc] = matrix[s * capacity + c];
+		}
+		columns[c]->poolColumn = nc;
+		newColumns.push_back(columns[c]);
+		newStamps.push_back(columnStamps[c]);
+	}
+
+	swapMatrix(newMatrix);
+	columns.swap(newColumns);
+	columnStamps.swap(newStamps);
+	capacity = newCapacity;
+	numDead = 0;
+}
+
+void AlphaPlanePool::rebuildColumns()
+{
+	FOR(c, columns.size())
+	{
+		if (columns[c] != NULL)
+		{
+			columns[c]->poolColumn = -1;
+		}
+	}
+	vector<REAL_VALUE> empty;
+	swapMatrix(empty);
+	columns.clear();
+	columnStamps.clear();
+	capacity = 0;
+	numDead = 0;
+	stampsSorted = true;
+
+	LISTFOREACH_NOCONST(SharedPointer<AlphaPlane>, pr, planes)
+	{
+		appendColumn(*pr);
+	}
+}
+
+void AlphaPlanePool::computeValues(const belief_vector& b, int first)
+{
+	int n = (int)columns.size() - first;
+	values.assign(max(n, 1), 0.0);
+	if (n <= 0)
+	{
+		return;
+	}
+
+	// same order of the additions as inner_prod(DenseVector, SparseVector);
+	// the inner loop runs over contiguous columns and is vectorized
+	REAL_VALUE* v = &values[0];
+	FOR_CV(b)
+	{
+		const REAL_VALUE* row = &matrix[CV_INDEX(b) * capacity + first];
+		REAL_VALUE p = CV_VAL(b);
+		for (int c = 0; c < n; c++)
+		{
+			v[c] += row[c] * p;
+		}
+	}
 }
 
 
@@ -60,9 +228,21 @@ SharedPointer<AlphaPlane> AlphaPlanePool::getBestAlphaPlane( SharedPointer<belie
 	DEBUG_TRACE( cout << "alphaPlanePool->planes.size() " << this->planes.size() << endl; );
 	DEBUG_TRACE( cout << "maxval " << maxval << endl; );
 
-	LISTFOREACH(SharedPointer<AlphaPlane>, pr,  this->planes) 
+	// planes added before lastTimeStamp are skipped without computing their values
+	int first = 0;
+	if (stampsSorted)
 	{
-		SharedPointer<AlphaPlane> al = *pr;
+		first = upper_bound(columnStamps.begin(), columnStamps.end(), lastTimeStamp) - columnStamps.begin();
+	}
+	computeValues(*b, first);
+
+	for (int c = first; c < (int)columns.size(); c++)
+	{
+		SharedPointer<AlphaPlane>& al = columns[c];
+		if (al == NULL)
+		{
+			continue;
+		}
 
 		DEBUG_TRACE( cout << "al->timeStamp" << al->timeStamp  << endl; );
 		DEBUG_TRACE( cout << "lastTimeStamp" << lastTimeStamp << endl; );
@@ -72,7 +252,7 @@ SharedPointer<AlphaPlane> AlphaPlanePool::getBestAlphaPlane( SharedPointer<belie
 #if USE_MASKED_ALPHA
 			if (!mask_subset( b, al->mask )) continue;
 #endif
-			val = inner_prod(*al->alpha, *b );
+			val = values[c - first];
 			DEBUG_TRACE( cout << "val = inner_prod(al->alpha, b ); alpha:" << endl );
 			DEBUG_TRACE( al->alpha->write( cout ) << endl );
 				
@@ -150,10 +330,15 @@ SharedPointer<AlphaPlane> AlphaPlanePool::getBestAlphaPlane1( SharedPointer<beli
 	double val, maxval = -99e+20;
 	SharedPointer<AlphaPlane> ret = NULL;
 
-	LISTFOREACH(SharedPointer<AlphaPlane>, pr,  this->planes) 
+	computeValues(*b, 0);
+	FOR(c, columns.size())
 	{
-		SharedPointer<AlphaPlane> al = *pr;
-		val = inner_prod( *(al->alpha), *b );
+		SharedPointer<AlphaPlane>& al = columns[c];
+		if (al == NULL)
+		{
+			continue;
+		}
+		val = values[c];
 		if (val > maxval) {
 			maxval = val;
 			ret = al;
@@ -26,7 +26,7 @@ namespace momdp
 	class AlphaPlanePool :	public Bound<AlphaPlane>
 	{
 	public:
-		AlphaPlanePool(Backup<AlphaPlane> *_backupEngine)
+		AlphaPlanePool(Backup<AlphaPlane> *_backupEngine) : capacity(0), numStates(0), numDead(0), stampsSorted(true)
 		{
 			this->setBackupEngine(_backupEngine);
 		}
@@ -34,6 +34,8 @@ namespace momdp
 
 		virtual ~AlphaPlanePool(void)
 		{
+			vector<REAL_VALUE> empty;
+			swapMatrix(empty);
 		}
 
 
@@ -83,11 +85,35 @@ namespace momdp
 
 		virtual double getValue(SharedPointer<belief_vector>& belief, SharedPointer<AlphaPlane>* bestAlpha);
 
+		// modify planes only through addAlphaPlane, setAlphaPlanes and clearAlphaPlanes, which keep the plane matrix in sync
 		list<SharedPointer<AlphaPlane> > planes;
 		void addAlphaPlane(SharedPointer<AlphaPlane> plane);
+		void setAlphaPlanes(const list<SharedPointer<AlphaPlane> >& nextPlanes);  // keep nextPlanes, usually a subset of planes
+		void clearAlphaPlanes();
 	private:
-		
-		
+		// The planes are also stored as the columns of a contiguous states x
+		// planes matrix (entry of state s of column c at matrix[s * capacity + c]),
+		// so the values of all planes at a sparse belief are computed in one
+		// pass over the belief entries, each adding a scaled matrix row.
+		// Columns of removed planes are tombstoned (NULL in columns) and
+		// compacted away when they make up half of the matrix. The matrix is
+		// not an MObject, its bytes are added to GlobalResource::memoryUsage
+		// by swapMatrix.
+		vector<REAL_VALUE> matrix;
+		vector<SharedPointer<AlphaPlane> > columns;
+		vector<int> columnStamps;	// time stamps of the columns when added
+		int capacity;
+		int numStates;
+		int numDead;
+		bool stampsSorted;	// columnStamps is non-decreasing
+		vector<REAL_VALUE> values;	// scratch for computeValues
+
+		void appendColumn(SharedPointer<AlphaPlane>& plane);
+		void relayout(int newCapacity);
+		void swapMatrix(vector<REAL_VALUE>& newMatrix);
+		void rebuildColumns();
+		// values[c - first] = inner_prod(column c, b) for columns first..end
+		void computeValues(const belief_vector& b, int first);
 	};
 }
 
@@ -94,6 +94,97 @@ void AlphaPlanePoolSet::writeToFile(const std::string& outFileName, string probl
 	out << "</AlphaVector> </Policy>" << endl;
 }
 
+template <class T> static void writeValues(ofstream& out, const vector<REAL_VALUE>& values)
+{
+	vector<T> converted(values.begin(), values.end());
+	out.write((const char*)&converted[0], converted.size() * sizeof(T));
+}
+
+void AlphaPlanePoolSet::writeToBinaryFile(const std::string& outFileName, string problemName, int valueSize) 
+{
+	ofstream out(outFileName.c_str(), ios::binary);
+	if (!out) 
+	{
+		cerr << "ERROR: Bounds::writeToBinaryFile: couldn't open " << outFileName << " for writing " << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	int vectorLength = problem->YStates->size();
+	vector<int> actions, svals, numEntries;
+	FOR (sval, set.size())
+	{
+		LISTFOREACH(SharedPointer<AlphaPlane>, plane, set[sval]->planes)
+		{
+			int numNonZeros = 0;
+			FOR (i, vectorLength)
+			{
+				if ((*(*plane)->alpha)(i) != 0)
+				{
+					numNonZeros++;
+				}
+			}
+			actions.push_back((*plane)->action);
+			svals.push_back(sval);
+			// sparse only when the indices take less space than the zeros
+			numEntries.push_back(numNonZeros * (sizeof(int) + valueSize) < vectorLength * valueSize ? numNonZeros : vectorLength);
+		}
+	}
+
+	int header[5] = { vectorLength, (int)set.size(), (int)actions.size(), valueSize, (int)problemName.size() };
+	out.write(BINARY_POLICY_MAGIC, 8);
+	out.write((const char*)header, 5 * sizeof(int));
+	out.write(problemName.c_str(), problemName.size());
+	if (!actions.empty())
+	{
+		out.write((const char*)&actions[0], actions.size() * sizeof(int));
+		out.write((const char*)&svals[0], svals.size() * sizeof(int));
+		out.write((const char*)&numEntries[0], numEntries.size() * sizeof(int));
+	}
+
+	int k = 0;
+	vector<int> indices;
+	vector<REAL_VALUE> values;
+	FOR (sval, set.size())
+	{
+		LISTFOREACH(SharedPointer<AlphaPlane>, plane, set[sval]->planes)
+		{
+			const DenseVector& alpha = *(*plane)->alpha;
+			indices.clear();
+			values.clear();
+			FOR (i, vectorLength)
+			{
+				if (numEntries[k] == vectorLength || alpha(i) != 0)
+				{
+					indices.push_back(i);
+					values.push_back(alpha(i));
+				}
+			}
+			if (numEntries[k] != vectorLength && !indices.empty())
+			{
+				out.write((const char*)&indices[0], indices.size() * sizeof(int));
+			}
+			if (!values.empty())
+			{
+				if (valueSize == sizeof(float))
+				{
+					writeValues<float>(out, values);
+				}
+				else
+				{
+					writeValues<double>(out, values);
+				}
+			}
+			k++;
+		}
+	}
+
+	if (!out)
+	{
+		cerr << "ERROR: Bounds::writeToBinaryFile: couldn't write " << outFileName << endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
 //write out policy in old format
 /*
 void AlphaPlanePoolSet::writeToFile(const std::string& outFileName) 
@@ -13,6 +13,14 @@
 
 #define sparse_vector
 
+// Binary policy file (--binary-policy), read by AlphaVectorPolicy like the XML policy:
+//   "APPLPOL1", int vectorLength, numObsValue, numVectors, valueSize (4 for float, 8 for double),
+//   int length of the model name, the model name
+//   int action[numVectors], int obsValue[numVectors], int numEntries[numVectors]
+//   for each vector, numEntries values if numEntries is vectorLength, else
+//   numEntries int indices followed by their numEntries values
+#define BINARY_POLICY_MAGIC "APPLPOL1"
+
 using namespace std;
 using namespace momdp;
 namespace momdp 
@@ -97,6 +105,7 @@ namespace momdp
 		SharedPointer<AlphaPlane> getBestAlphaPlane1(BeliefWithState& beliefandState);
 		
 		void writeToFile(const std::string& outFileName, string problemName) ; //write in new XML format
+		void writeToBinaryFile(const std::string& outFileName, string problemName, int valueSize) ; //write in binary format, with float or double values
 //		void writeToFile(const std::string& outFileName) ; //write in out IV format
 	};
 }
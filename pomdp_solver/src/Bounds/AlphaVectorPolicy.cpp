@@ -2,6 +2,8 @@
 #include <cfloat>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
 extern "C"{
 #include "xml_parse_lib.h"
 }
@@ -38,8 +40,153 @@ static std::string stripWhiteSpace(const std::string& s)
 	}
 }
 
+template <class T> static void readValues(const char* data, int count, REAL_VALUE* values)
+{
+	vector<T> read(count);
+	memcpy(&read[0], data, count * sizeof(T));
+	copy(read.begin(), read.end(), values);
+}
+
+// the file written by AlphaPlanePoolSet::writeToBinaryFile, read in one block
+bool AlphaVectorPolicy::readFromBinaryFile(FILE* infile)
+{
+	fseek(infile, 0, SEEK_END);
+	long fileSize = ftell(infile);
+	fseek(infile, 0, SEEK_SET);
+	vector<char> buffer(fileSize);
+	if (fileSize < 8 + 5 * (long)sizeof(int) || fread(&buffer[0], 1, fileSize, infile) != (size_t)fileSize)
+	{
+		cerr << "ERROR:\n\tBinary policy file is truncated" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	int header[5];
+	memcpy(header, &buffer[8], sizeof(header));
+	int vectorLength = header[0];
+	int numObsValue = header[1];
+	int numVectors = header[2];
+	int valueSize = header[3];
+	int nameLength = header[4];
+	if(vectorLength != problem->YStates->size()){
+		cerr << "ERROR:\n\tVector length does not match problem unobserved state size" << endl;
+		exit(EXIT_FAILURE);
+	}
+	if(numObsValue > alphaPlanePoolSet->set.size())
+	{
+		cerr << "Policy file has more observed state than given POMDP model's, are you using the correct policy file?" << endl;
+		exit(EXIT_FAILURE);
+	}
+	if(valueSize != sizeof(float) && valueSize != sizeof(double)){
+		cerr << "ERROR:\n\tBinary policy values are neither float nor double" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	if (nameLength < 0 || numVectors < 0 || 8 + sizeof(header) + (size_t)nameLength > buffer.size())
+	{
+		cerr << "ERROR:\n\tBinary policy file is truncated" << endl;
+		exit(EXIT_FAILURE);
+	}
+	size_t pos = 8 + sizeof(header) + nameLength;
+	if (3 * (size_t)numVectors * sizeof(int) > buffer.size() - pos)
+	{
+		cerr << "ERROR:\n\tBinary policy file is truncated" << endl;
+		exit(EXIT_FAILURE);
+	}
+	vector<int> actions(numVectors), svals(numVectors), numEntries(numVectors);
+	if (numVectors > 0)
+	{
+		memcpy(&actions[0], &buffer[pos], numVectors * sizeof(int));
+		pos += numVectors * sizeof(int);
+		memcpy(&svals[0], &buffer[pos], numVectors * sizeof(int));
+		pos += numVectors * sizeof(int);
+		memcpy(&numEntries[0], &buffer[pos], numVectors * sizeof(int));
+		pos += numVectors * sizeof(int);
+	}
+
+	vector<int> indices;
+	vector<REAL_VALUE> values;
+	FOR (k, numVectors)
+	{
+		bool dense = (numEntries[k] == vectorLength);
+		size_t planeSize = numEntries[k] * (valueSize + (dense ? 0 : sizeof(int)));
+		if (numEntries[k] < 0 || numEntries[k] > vectorLength || pos + planeSize > buffer.size()){
+			cerr << "ERROR:\n\tVector is too short, are you using the correct policy file?" << endl;
+			exit(EXIT_FAILURE);
+		}
+
+		SharedPointer<AlphaPlane> plane (new AlphaPlane());
+		plane->alpha->resize(vectorLength);
+		plane->action = actions[k];
+		plane->sval = svals[k];
+		if (dense)
+		{
+			values.resize(vectorLength);
+		}
+		else
+		{
+			indices.resize(numEntries[k]);
+			values.resize(numEntries[k]);
+			if (numEntries[k] > 0)
+			{
+				memcpy(&indices[0], &buffer[pos], numEntries[k] * sizeof(int));
+			}
+			pos += numEntries[k] * sizeof(int);
+		}
+		if (numEntries[k] > 0)
+		{
+			if (valueSize == sizeof(float))
+			{
+				readValues<float>(&buffer[pos], numEntries[k], &values[0]);
+			}
+			else
+			{
+				readValues<double>(&buffer[pos], numEntries[k], &values[0]);
+			}
+		}
+		pos += numEntries[k] * valueSize;
+
+		if (dense)
+		{
+			plane->alpha->data.swap(values);
+		}
+		else
+		{
+			FOR (i, numEntries[k])
+			{
+				if (indices[i] < 0 || indices[i] >= vectorLength){
+					cerr << "ERROR:\n\tEntry index out of the vector, are you using the correct policy file?" << endl;
+					exit(EXIT_FAILURE);
+				}
+				plane->alpha->data[indices[i]] = values[i];
+			}
+		}
+
+		if(plane->sval < 0 || plane->sval >= alphaPlanePoolSet->set.size())
+		{
+			cerr << "Policy file has more observed state than given POMDP model's, are you using the correct policy file?" << endl;
+			exit(EXIT_FAILURE);
+		}
+		alphaPlanePoolSet->set[plane->sval]->addAlphaPlane(plane);
+	}
+
+	return true;
+}
+
 bool AlphaVectorPolicy::readFromFile(const std::string& inFileName)
 {
+    // binary policy files start with BINARY_POLICY_MAGIC, others are XML
+    FILE* binaryFile = fopen(inFileName.c_str(),"rb");
+    if(binaryFile != 0)
+    {
+	char magic[8];
+	if(fread(magic, 1, sizeof(magic), binaryFile) == sizeof(magic) && memcmp(magic, BINARY_POLICY_MAGIC, sizeof(magic)) == 0)
+	{
+	    bool policyRead = readFromBinaryFile(binaryFile);
+	    fclose(binaryFile);
+	    return policyRead;
+	}
+	fclose(binaryFile);
+    }
     
     char tag[MaxStr], contents[MaxStr], tagname[MaxStr], attrname[MaxStr], value[MaxStr];
     float x1, y1, z1, x2, y2, z2, t0, t1;
@@ -148,7 +295,7 @@ bool AlphaVectorPolicy::readFromFile(const std::string& inFileName)
 		}
 		plane.alpha->data[i] =atof(dvalue);
 	    }
-	    alphaPlanePoolSet->set[plane.sval]->planes.push_back(plane.duplicate());
+	    alphaPlanePoolSet->set[plane.sval]->addAlphaPlane(plane.duplicate());
 	}
 	else if(string(tagname)=="SparseVector"){
 	    xml_parse( infile, tag, contents, MaxStr, &linum );
@@ -162,7 +309,7 @@ bool AlphaVectorPolicy::readFromFile(const std::string& inFileName)
 		xml_parse( infile, tag, contents, MaxStr, &linum );
 		xml_grab_tag_name( tag, tagname, MaxStr);
 	    }
-	    alphaPlanePoolSet->set[plane.sval]->planes.push_back(plane.duplicate());
+	    alphaPlanePoolSet->set[plane.sval]->addAlphaPlane(plane.duplicate());
 	}
 	xml_parse(infile, tag,contents, MaxStr, &linum );
 	xml_parse_tag_only( infile, tag, MaxStr, &linum );		//read the vector tag
@@ -1,6 +1,7 @@
 #ifndef AlphaVectorPolicy_H
 #define AlphaVectorPolicy_H
 
+#include <cstdio>
 #include <vector>
 #include <string>
 #include "MOMDP.h"
@@ -18,6 +19,8 @@ namespace momdp
 		SharedPointer<MOMDP> problem;
 		AlphaPlanePoolSet* alphaPlanePoolSet;
 		string policyFile;
+
+		bool readFromBinaryFile(FILE* infile);
 	public:
 		AlphaVectorPolicy(SharedPointer<MOMDP> problem);
 		int getBestActionLookAhead(BeliefWithState& b);
@@ -38,6 +41,7 @@ namespace momdp
 		void GetRewardVec(BeliefWithState& b, std::vector<double> & rewardVec);
 
 		bool readFromFile(const std::string& inFileName);
+		AlphaPlanePoolSet* getAlphaPlanePoolSet(void) { return alphaPlanePoolSet; }
 	};
 }
 
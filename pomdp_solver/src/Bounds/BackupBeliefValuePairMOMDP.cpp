@@ -24,9 +24,16 @@ SharedPointer<BeliefValuePair> BackupBeliefValuePairMOMDP::backup(BeliefTreeNode
 {
 	int maxUBAction;
 
+	double newUBVal = getNewUBValue(*cn, &maxUBAction);
+	return setNewUBValue(cn, newUBVal, maxUBAction);
+}
+
+// adds the value computed by getNewUBValue to the pool, split from backup so
+// that the value can be computed on another thread (see SARSOP::parallelBackup)
+SharedPointer<BeliefValuePair> BackupBeliefValuePairMOMDP::setNewUBValue(BeliefTreeNode* cn, double newUBVal, int maxUBAction)
+{
 	state_val stateidx = cn->s->sval;
 
-	double newUBVal = getNewUBValue(*cn, &maxUBAction);
 	SharedPointer<BeliefValuePair> result = boundSet->addPoint(cn->s, newUBVal);    
 
 	if(maxUBAction < 0)
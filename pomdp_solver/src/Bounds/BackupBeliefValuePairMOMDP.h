@@ -38,6 +38,7 @@ namespace momdp
 		}
 
 		virtual SharedPointer<BeliefValuePair> backup(BeliefTreeNode * node);
+		SharedPointer<BeliefValuePair> setNewUBValue(BeliefTreeNode * node, double newUBVal, int maxUBAction);
 		virtual	double getNewUBValueQ(BeliefTreeNode& cn, int a);
 		virtual double getNewUBValueSimple(BeliefTreeNode& cn, int* maxUBActionP);
 		virtual double getNewUBValueUseCache(BeliefTreeNode& cn, int* maxUBActionP);
@@ -3,7 +3,6 @@
 BeliefValuePair::BeliefValuePair(void)
 {
 	disabled = false;
-	version = 0;
 }
 
 BeliefValuePair::~BeliefValuePair(void)
@@ -15,11 +15,8 @@ namespace momdp
 	public:
 		SharedPointer<belief_vector>  b;
 		double v;
-		double innver_cornerPoints; // cached value, used by BeliefValuePair->getValue
 		bool disabled;
 
-		unsigned int version; // avoid recalculating the upper bound value, used by BeliefValuePair->getValue
-
 	};
 }
 #endif
@@ -1,5 +1,6 @@
 #include "BeliefValuePairPool.h"
 #include <exception>
+#include <climits>
 using namespace std;
 
 
@@ -9,15 +10,7 @@ REAL_VALUE BeliefValuePairPool::getValue(SharedPointer<Belief>& b)
 
 	REAL_VALUE val, min_val;
 	REAL_VALUE ratio, min_ratio;
-	vector<SparseVector_Entry>::const_iterator  bi, bend;
-
-	vector<SparseVector_Entry>::const_iterator  ci, cend;
-
-	SparseVector tmp, bhat;
-	REAL_VALUE cval;
 	REAL_VALUE inner_cornerPoints_b;
-	REAL_VALUE inner_cornerPoints_c;
-	bool bdone = false;
 
 	inner_cornerPoints_b = inner_prod( cornerPoints, *b );
 
@@ -31,82 +24,67 @@ REAL_VALUE BeliefValuePairPool::getValue(SharedPointer<Belief>& b)
 
 	min_val = inner_cornerPoints_b;
 
-	for(list<SharedPointer<BeliefValuePair> >::iterator iter = points.begin(); iter!=points.end(); iter ++) 
+	int numPoints = packedPoints.size();
+	if (numPoints == 0)
 	{
+		return min_val;
+	}
+	updatePackedCorners();
 
-		if ((*iter)->disabled) 
-		{
-			//cout << "skipping" << endl;
-			continue;
-		}
-
-		belief_vector& c = *((*iter)->b);
-		cval = (*iter)->v;
-
-
-		//cout << "c.size() " << c.size() << " cval " << cval << endl;
+	// scatter b, so that b(j) / c(j) is a lookup for each non-zero c(j) of a point
+	const vector<SparseVector_Entry>& bdata = b->data;
+	if (denseBelief.size() != b->size())
+	{
+		denseBelief.assign(b->size(), 0.0);
+	}
+	int bLo = INT_MAX;
+	int bHi = -1;
+	if (!bdata.empty())
+	{
+		bLo = bdata.front().index;
+		bHi = bdata.back().index;
+	}
+	FOR (i, bdata.size())
+	{
+		denseBelief[bdata[i].index] = bdata[i].value;
+	}
 
-		DEBUG_TRACE( cout << "UpperBound::getValue:1 " << " pr->version: " << (*iter)->version << " cornerPointsVersion " << cornerPointsVersion << endl;);
-		if((*iter)->version == cornerPointsVersion) 
+	FOR (k, numPoints) 
+	{
+		// a point with a non-zero outside of the support of b has min_ratio = 0,
+		// so it is useless, the range test skips most of them without a scan
+		if (packedLo[k] < bLo || packedHi[k] > bHi)
 		{
-			DEBUG_TRACE( cout << "UpperBound::getValue:2 " << endl; );
-			inner_cornerPoints_c = (*iter)->innver_cornerPoints;
+			continue;
 		}
-		else 
+		if (packedPoints[k]->disabled) 
 		{
-			DEBUG_TRACE( cout << "UpperBound::getValue:3 " << endl; );
-
-			inner_cornerPoints_c = inner_prod( cornerPoints, c );
-			(*iter)->innver_cornerPoints = inner_cornerPoints_c;
-			(*iter)->version = cornerPointsVersion;
+			//cout << "skipping" << endl;
+			continue;
 		}
 
-		// 			if (inner_cornerPoints_c <= cval)
-		// 			{
-		// 		  // FIX: should figure out a way to prune c here
-		// 		  //cout << "  bad cval" << endl;
-		// 				continue;
-		// 			}
-
 		min_ratio = 99e+20;
 
-		bi = b->data.begin();
-		bend = b->data.end();
-
-		ci = c.data.begin();
-		cend = c.data.end();
-
-		for (; ci != cend; ci++) {
-			if (0.0 == ci->value) continue;
-
-			// advance until bi->index >= ci->index
-			while (1) {
-				if (bi == bend) {
-					bdone = true;
-					goto break_ci_loop;
-				}
-				if (bi->index >= ci->index) break;
-				bi++;
-			}
-
-			if (bi->index > ci->index) {
+		int j = packedStart[k];
+		int end = packedStart[k + 1];
+		for (; j < end; j++)
+		{
+			REAL_VALUE bj = denseBelief[packedIndex[j]];
+			if (0.0 == bj)
+			{
 				// we found a j such that b(j) = 0 and c(j) != 0, which implies
 				// min_ratio = 0, so this c is useless and should be skipped
-				//cout << "  skipping out" << endl;
-				goto continue_Points_loop;
+				break;
 			}
-
-			ratio = bi->value / ci->value;
+			ratio = bj / packedValue[j];
 			if (ratio < min_ratio) min_ratio = ratio;
 		}
-break_ci_loop:
-		if (bdone) {
-			for (; ci != cend; ci++) {
-				if (0.0 != ci->value) goto continue_Points_loop;
-			}
+		if (j < end)
+		{
+			continue;
 		}
 
-		val = inner_cornerPoints_b + min_ratio * ( cval - inner_cornerPoints_c );
+		val = inner_cornerPoints_b + min_ratio * ( packedV[k] - packedCorner[k] );
 #if 1
 		if (min_ratio > 1) 
 		{
@@ -117,6 +95,7 @@ break_ci_loop:
 			} 
 			else 
 			{
+				belief_vector& c = *(packedPoints[k]->b);
 				cout << "ERROR: min_ratio > 1 in upperBoundInternal!" << endl;
 				cout << "  (min_ratio-1)=" << (min_ratio-1) << endl;
 				cout << "  normb=" << b->norm_1() << endl;
@@ -135,13 +114,79 @@ break_ci_loop:
 #endif
 
 		if (val < min_val) min_val = val;
-continue_Points_loop:
-		;
+	}
+
+	FOR (i, bdata.size())
+	{
+		denseBelief[bdata[i].index] = 0.0;
 	}
 
 	return min_val;
 }
 
+// inner_prod(cornerPoints, c) of the packed points, recomputed for all points when the corner points change
+void BeliefValuePairPool::updatePackedCorners()
+{
+	if (packedCornerVersion != cornerPointsVersion)
+	{
+		packedCornerVersion = cornerPointsVersion;
+		packedCornerCount = 0;
+	}
+	for (int k = packedCornerCount; k < (int)packedPoints.size(); k++)
+	{
+		packedCorner[k] = inner_prod( cornerPoints, *(packedPoints[k]->b) );
+	}
+	packedCornerCount = packedPoints.size();
+}
+
+// append the non-zeros of bvp to the packed points
+void BeliefValuePairPool::packPoint(BeliefValuePair* bvp)
+{
+	int lo = INT_MAX;
+	int hi = -1;
+	const vector<SparseVector_Entry>& cdata = bvp->b->data;
+	FOR (i, cdata.size())
+	{
+		if (0.0 == cdata[i].value) continue;
+
+		packedIndex.push_back(cdata[i].index);
+		packedValue.push_back(cdata[i].value);
+		if (lo == INT_MAX) lo = cdata[i].index;
+		hi = cdata[i].index;
+	}
+	packedStart.push_back(packedIndex.size());
+	packedLo.push_back(lo);
+	packedHi.push_back(hi);
+	packedV.push_back(bvp->v);
+	packedCorner.push_back(0.0);
+	packedPoints.push_back(bvp);
+}
+
+// rebuild the packed points from points, must be called after points are removed
+void BeliefValuePairPool::repackPoints()
+{
+	packedStart.assign(1, 0);
+	packedIndex.clear();
+	packedValue.clear();
+	packedLo.clear();
+	packedHi.clear();
+	packedV.clear();
+	packedCorner.clear();
+	packedPoints.clear();
+	packedCornerCount = 0;
+
+	for(list<SharedPointer<BeliefValuePair> >::iterator iter = points.begin(); iter!=points.end(); iter ++) 
+	{
+		packPoint(&**iter);
+	}
+}
+
+void BeliefValuePairPool::clearPoints()
+{
+	points.clear();
+	repackPoints();
+}
+
 
 
 REAL_VALUE BeliefValuePairPool::getValue_NoInterpolation(const belief_vector& b) 
@@ -173,6 +218,7 @@ SharedPointer<BeliefValuePair> BeliefValuePairPool::addPoint(SharedPointer<belie
 		bvp->v = val;
 
 		points.push_back(bvp);
+		packPoint(&*bvp);
 		return bvp;
 	}
 	else 
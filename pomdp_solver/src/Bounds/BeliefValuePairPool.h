@@ -56,6 +56,9 @@ namespace momdp
 		{
 			this->setBackupEngine(_backupEngine);
 			cornerPointsVersion = 0;
+			packedCornerVersion = 0;
+			packedCornerCount = 0;
+			packedStart.push_back(0);
 		}
 		PruneBeliefValuePair* pruneEngine;
 
@@ -87,10 +90,30 @@ namespace momdp
 		// update helper functions
 		SharedPointer<BeliefValuePair> addPoint(SharedPointer<belief_vector>&  b, double val);
 		int whichCornerPoint(const SharedPointer<belief_vector>&  b) const;
+		void repackPoints();
+		void clearPoints();
 
 	private:	
 		void printCorners() const;
 
+		// points in the order of the list, packed for getValue: the non-zeros of
+		// point k are packedIndex/packedValue[packedStart[k] .. packedStart[k+1]-1],
+		// packedLo/packedHi[k] are the first and last of their indices
+		vector<int> packedStart;
+		vector<int> packedIndex;
+		vector<REAL_VALUE> packedValue;
+		vector<int> packedLo;
+		vector<int> packedHi;
+		vector<REAL_VALUE> packedV;
+		vector<REAL_VALUE> packedCorner; // inner_prod(cornerPoints, c) for the first packedCornerCount points
+		vector<BeliefValuePair*> packedPoints; // owned by points
+		unsigned int packedCornerVersion;
+		int packedCornerCount;
+		vector<REAL_VALUE> denseBelief; // scratch for getValue, all zero between calls
+
+		void packPoint(BeliefValuePair* bvp);
+		void updatePackedCorners();
+
 
 	};
 
@@ -101,11 +101,17 @@ namespace momdp
 		virtual SharedPointer<BeliefValuePair> backup(BeliefTreeNode * node)
 		{
 			SharedPointer<BeliefValuePair> result = backupEngine->backup(node);
+			backupDone(node, result);
+			return result;
+		}
+
+		// calls the backup handlers, for backups not done by backup() (see SARSOP::parallelBackup)
+		void backupDone(BeliefTreeNode * node, SharedPointer<BeliefValuePair> result)
+		{
 			for(size_t i = 0 ; i < onBackup.size(); i++)
 			{
 				(*onBackup[i])(solver, node, result);
 			}
-			return result;
 		}
 
 	};
@@ -210,7 +210,7 @@ namespace momdp {
 			{
 				if (a == 0) 
 				{
-					bound->set[sval]->planes.clear();
+					bound->set[sval]->clearAlphaPlanes();
 				}
 
 				DEBUG_TRACE(cout << "als[sval] " << sval << endl; );
@@ -491,7 +491,7 @@ namespace momdp {
 			{
 				if (a == 0) 
 				{
-					bound->set[sval]->planes.clear();
+					bound->set[sval]->clearAlphaPlanes();
 				}
 
 				DEBUG_TRACE(cout << "als[sval] " << sval << endl; );
@@ -16,6 +16,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <cstring>
 
 #include "MOMDP.h"
 #include "FastInfUBInitializer.h"
@@ -28,12 +29,17 @@ using namespace std;
 //#define DEBUGSYL_290908 1
 //#define DEBUGSYL_160908a 1
 
+// first bytes of a warm start file, followed by the number of actions, X states
+// and Y states as ints, then the FIB vectors as doubles
+#define FIB_FILE_MAGIC "APPLFIB1"
+
 namespace momdp {
 
 	FastInfUBInitializer::FastInfUBInitializer( SharedPointer<MOMDP> problem, BeliefValuePairPoolSet* _bound)
 	{
 		pomdp = ( SharedPointer<MOMDP>) problem;
 		bound = _bound;
+		numThreads = 0;
 
 		// pomdp->XStates->size()
 		//alphasByState.resize(pomdp->XStates->size());   // SYL260809 commented out
@@ -44,6 +50,7 @@ namespace momdp {
 	FastInfUBInitializer::FastInfUBInitializer(SharedPointer<MOMDP> problem)
 	{
 		pomdp = ( SharedPointer<MOMDP>) problem;
+		numThreads = 0;
 
 		// pomdp->XStates->size()
 		//alphasByState.resize(pomdp->XStates->size());   // SYL260809 commented out
@@ -88,10 +95,80 @@ namespace momdp {
 	}
 
 
+	// reads the FIB vectors of a previous run, values[(a * numX + x) * numY + y]
+	bool FastInfUBInitializer::readWarmStart(vector<double>& values)
+	{
+		if (warmStartFile.empty())
+		{
+			return false;
+		}
+		ifstream in(warmStartFile.c_str(), ios::binary);
+		if (!in)
+		{
+			// first run, the file is written when the iteration converges
+			return false;
+		}
+
+		int numActions = pomdp->actions->size();
+		int numX = pomdp->XStates->size();
+		int numY = pomdp->YStates->size();
+		char magic[8];
+		int dims[3];
+		in.read(magic, sizeof(magic));
+		in.read((char*)dims, sizeof(dims));
+		if (!in || memcmp(magic, FIB_FILE_MAGIC, sizeof(magic)) != 0
+			|| dims[0] != numActions || dims[1] != numX || dims[2] != numY)
+		{
+			cerr << "WARNING: " << warmStartFile << " does not hold FIB vectors for this model, starting from the MDP bound" << endl;
+			return false;
+		}
+		if (pomdp->discount >= 1)
+		{
+			cerr << "WARNING: FIB warm start needs a discount below 1, starting from the MDP bound" << endl;
+			return false;
+		}
+
+		values.resize(numActions * numX * numY);
+		in.read((char*)&values[0], values.size() * sizeof(double));
+		if (!in)
+		{
+			cerr << "WARNING: " << warmStartFile << " is truncated, starting from the MDP bound" << endl;
+			return false;
+		}
+		return true;
+	}
+
+	void FastInfUBInitializer::writeWarmStart(const vector<double>& values)
+	{
+		if (warmStartFile.empty())
+		{
+			return;
+		}
+		ofstream out(warmStartFile.c_str(), ios::binary);
+		int dims[3] = { (int)pomdp->actions->size(), (int)pomdp->XStates->size(), (int)pomdp->YStates->size() };
+		out.write(FIB_FILE_MAGIC, 8);
+		out.write((const char*)dims, sizeof(dims));
+		out.write((const char*)&values[0], values.size() * sizeof(double));
+		if (!out)
+		{
+			cerr << "WARNING: couldn't write FIB vectors to " << warmStartFile << endl;
+		}
+	}
+
+	// Started from the MDP bound, the iterates decrease towards the FIB fixed
+	// point and stay above it. From the vectors of another model they may not, so
+	// the distance to the fixed point, at most maxResidual * discount / (1 -
+	// discount) for the last residual, is added to keep a valid upper bound.
+	double FastInfUBInitializer::warmStartMargin(double maxResidual)
+	{
+		return maxResidual * pomdp->discount / (1 - pomdp->discount);
+	}
+
 	void FastInfUBInitializer::initMDP_unfac(double targetPrecision)
 	{
 		// set alpha to be the mdp upper bound
 		FullObsUBInitializer m;
+		m.numThreads = numThreads;
 		m.valueIteration_unfac(pomdp, targetPrecision);
 		DenseVector calpha;
 		copy(calpha, m.alpha);
@@ -114,70 +191,123 @@ namespace momdp {
 		// calculates the fast informed bound (Hauskrecht, JAIR 2000)
 		std::vector< DenseVector > al(pomdp->actions->size());
 		std::vector< DenseVector > nextAl(pomdp->actions->size());
-		DenseVector tmp, beta_aoi, beta_ao, diff;
 		double maxResidual;
 		alpha_vector backup;
+		int numStates = pomdp->XStates->size() * pomdp->YStates->size();
 
-		initMDP_unfac(MDP_RESIDUAL);
+		vector<double> warmValues;
+		bool warmStarted = readWarmStart(warmValues);
+		if (warmStarted)
+		{
+			FOR (a, pomdp->actions->size()) 
+			{
+				al[a].resize(numStates);
+				nextAl[a].resize(numStates);
+				FOR (i, numStates) 
+				{
+					al[a](i) = warmValues[a * numStates + i];
+				}
+			}
+		}
+		else
+		{
+			initMDP_unfac(MDP_RESIDUAL);
 
-		// TODO:: bound->elapsed = bound->heurTimer.elapsed();
-		// TODO:: printf("%.2fs initMDP(MDP_RESIDUAL) done\n", bound->elapsed);
+			// TODO:: bound->elapsed = bound->heurTimer.elapsed();
+			// TODO:: printf("%.2fs initMDP(MDP_RESIDUAL) done\n", bound->elapsed);
 
-		// initialize al array with weak MDP upper bound
-		FullObsUBInitializer m;
-		m.pomdp = pomdp;
-		alpha_vector& alpha = alphas[0];
-		copy(m.alpha, alpha);
+			// initialize al array with weak MDP upper bound
+			FullObsUBInitializer m;
+			m.pomdp = pomdp;
+			alpha_vector& alpha = alphas[0];
+			copy(m.alpha, alpha);
 
-		FOR (a, pomdp->actions->size()) 
-		{
-			//al[a].resize(pomdp->YStates->size());
-			//nextAl[a].resize(pomdp->YStates->size());
-			al[a].resize(pomdp->XStates->size() * pomdp->YStates->size());
-			nextAl[a].resize(pomdp->XStates->size() * pomdp->YStates->size());
-			m.nextAlphaAction_unfac(al[a], a);
+			FOR (a, pomdp->actions->size()) 
+			{
+				//al[a].resize(pomdp->YStates->size());
+				//nextAl[a].resize(pomdp->YStates->size());
+				al[a].resize(numStates);
+				nextAl[a].resize(numStates);
+				m.nextAlphaAction_unfac(al[a], a);
+			}
 		}
 
-		// iterate FIB update rule to approximate convergence
+		// iterate FIB update rule to approximate convergence, the actions are
+		// split between the threads, which only read al
+		int threads = sweepThreadCount(numThreads, pomdp);
+		vector<double> threadResidual(threads);
 		do {
-			FOR (a, pomdp->actions->size()) {
-				DenseVector& beta_a = nextAl[a];
-
-				set_to_zero( beta_a );
-				
-
-				FOR (o, pomdp->observations->size()) {
-					FOR (i, pomdp->actions->size()) {
-						emult_column( tmp, *(*(pomdp->pomdpO))[a], o, al[i] );
-						//	  emult_column( tmp, pomdp->pomdpO[a], o, al[i] );
-						mult( beta_aoi, tmp, *(*(pomdp->pomdpTtr))[a] );
-						//	  mult( beta_aoi, tmp, pomdp->pomdpTtr[a] );
-						if (0 == i) {
-							beta_ao = beta_aoi;
-						} else {
-							max_assign( beta_ao, beta_aoi );
+			parallelRanges(pomdp->actions->size(), threads, [&](int first, int last, int t)
+			{
+				DenseVector tmp, beta_aoi, beta_ao, diff;
+				threadResidual[t] = 0;
+
+				for (int a = first; a < last; a++) {
+					DenseVector& beta_a = nextAl[a];
+
+					set_to_zero( beta_a );
+					
+
+					FOR (o, pomdp->observations->size()) {
+						FOR (i, pomdp->actions->size()) {
+							emult_column( tmp, *(*(pomdp->pomdpO))[a], o, al[i] );
+							//	  emult_column( tmp, pomdp->pomdpO[a], o, al[i] );
+							mult( beta_aoi, tmp, *(*(pomdp->pomdpTtr))[a] );
+							//	  mult( beta_aoi, tmp, pomdp->pomdpTtr[a] );
+							if (0 == i) {
+								beta_ao = beta_aoi;
+							} else {
+								max_assign( beta_ao, beta_aoi );
+							}
 						}
+						beta_a += beta_ao;
 					}
-					beta_a += beta_ao;
-				}
 
-				beta_a *= pomdp->discount;
-				copy_from_column( tmp, (*(pomdp->pomdpR)), a );
-				//     copy_from_column( tmp, pomdp->pomdpR, a );
-				beta_a += tmp;
-			}
+					beta_a *= pomdp->discount;
+					copy_from_column( tmp, (*(pomdp->pomdpR)), a );
+					//     copy_from_column( tmp, pomdp->pomdpR, a );
+					beta_a += tmp;
+
+					diff = beta_a;
+					diff -= al[a];
+					threadResidual[t] = std::max( threadResidual[t], diff.norm_inf() );
+				}
+			});
 
 			maxResidual = 0;
+			FOR (t, threads) {
+				maxResidual = std::max( maxResidual, threadResidual[t] );
+			}
 			FOR (a, pomdp->actions->size()) {
-				diff = nextAl[a];
-				diff -= al[a];
-				maxResidual = std::max( maxResidual, diff.norm_inf() );
-
 				al[a] = nextAl[a];
 			}
 
 		} while ( maxResidual > targetPrecision );
 
+		if (!warmStartFile.empty())
+		{
+			vector<double> values(pomdp->actions->size() * numStates);
+			FOR (a, pomdp->actions->size()) 
+			{
+				FOR (i, numStates) 
+				{
+					values[a * numStates + i] = al[a](i);
+				}
+			}
+			writeWarmStart(values);
+		}
+		if (warmStarted)
+		{
+			double margin = warmStartMargin(maxResidual);
+			FOR (a, pomdp->actions->size()) 
+			{
+				FOR (i, numStates) 
+				{
+					al[a](i) += margin;
+				}
+			}
+		}
+
 		if (!getFIBvectors)
 		{	DenseVector dalpha;
 			FOR (a, pomdp->actions->size()) 
@@ -234,7 +364,7 @@ namespace momdp {
 			// write out result - do it for each of the BoundsSet
 			FOR (state_idx, pomdp->XStates->size()) 
 			{
-				bound->set[state_idx]->points.clear();
+				bound->set[state_idx]->clearPoints();
 				copy(bound->set[state_idx]->cornerPoints,dalphas[state_idx]);
 	
 				/*cout << "state_idx  " << state_idx << endl;
@@ -272,6 +402,7 @@ namespace momdp {
 	{
 		// set alpha to be the mdp upper bound
 		// FullObsUBInitializer m;		// SYL260809 commented out
+		m.numThreads = numThreads;
 		m.valueIteration(pomdp, targetPrecision); // this puts the MDP vector at m.alphaByState 
 
 		//alphasByState.clear();  
@@ -321,110 +452,126 @@ namespace momdp {
 		std::vector< std::vector<DenseVector> > al(pomdp->actions->size());
 		std::vector< std::vector<DenseVector> > nextAl(pomdp->actions->size());
 
-		DenseVector tmp, tmp2, diff, beta_ao; //beta_aoi, beta_aoiSum
-		DenseVector beta_aoXn_unweighted, beta_aoXn;
 		double maxResidual;
 		//alpha_vector backup;
+		int numX = pomdp->XStates->size();
+		int numY = pomdp->YStates->size();
 
-		FullObsUBInitializer M;  // SYL260809 added 
-
-		initMDP(MDP_RESIDUAL, M); // SYL260809 modified
+		matrices.gather(pomdp);
 
-		//TODO:: bound->elapsed = bound->heurTimer.elapsed();
-		//TODO:: printf("%.2fs initMDP(MDP_RESIDUAL) done\n", bound->elapsed);
-
-
-		// SYL260809 commented out - the MDP upper bound is already in M.alphaByState
-		/* 
-		// initialize al array with weak MDP upper bound
-		FullObsUBInitializer m;
-		m.pomdp = pomdp;
-		m.alphaByState.resize(pomdp->XStates->size());
-
-		//alpha_vector& alpha = alphas[0];
-		//copy(m.alpha, alpha);
-		FOR (state_idx, pomdp->XStates->size()) {
-			copy(m.alphaByState[state_idx], alphasByState[state_idx]);
+		vector<double> warmValues;
+		bool warmStarted = readWarmStart(warmValues);
+		if (warmStarted)
+		{
+			FOR (a, pomdp->actions->size()) 
+			{
+				al[a].resize(numX);
+				nextAl[a].resize(numX);
+				FOR (Xc, numX) 
+				{
+					al[a][Xc].resize(numY);
+					FOR (y, numY) 
+					{
+						al[a][Xc](y) = warmValues[(a * numX + Xc) * numY + y];
+					}
+				}
+			}
 		}
-		*/
+		else
+		{
+			FullObsUBInitializer M;  // SYL260809 added 
 
-		/* FOR (a, pomdp->actions->size()) {
-		al[a].resize(pomdp->YStates->size());
-		nextAl[a].resize(pomdp->YStates->size());
-		m.nextAlphaAction(al[a], a);
-		} */
+			initMDP(MDP_RESIDUAL, M); // SYL260809 modified
 
-		FOR (a, pomdp->actions->size()) {
-			al[a].resize(pomdp->XStates->size());
-			nextAl[a].resize(pomdp->XStates->size());
+			//TODO:: bound->elapsed = bound->heurTimer.elapsed();
+			//TODO:: printf("%.2fs initMDP(MDP_RESIDUAL) done\n", bound->elapsed);
+
+			FOR (a, pomdp->actions->size()) {
+				al[a].resize(numX);
+				nextAl[a].resize(numX);
 
-			M.nextAlphaAction(al[a], a); // SYL260809 prevly: m.nextAlphaAction(al[a], a);
+				M.nextAlphaAction(al[a], a); // SYL260809 prevly: m.nextAlphaAction(al[a], a);
+			}
 		}
 
-		bool	valid_o_and_Xn; // SYL260809 to allow skipping operation for an observation o, if there are
-					// no valid Xn values (for given action a) associated with it
+		// the actions are split between the threads, which only read al
+		int threads = sweepThreadCount(numThreads, pomdp);
+		vector<double> threadResidual(threads);
 		do {
-			// SYL260809 keep track of maximum residual
-			maxResidual = 0;
-
-			FOR (a, pomdp->actions->size()) 
+			parallelRanges(pomdp->actions->size(), threads, [&](int first, int last, int t)
 			{
-				std::vector< DenseVector >& beta_a = nextAl[a];
+				DenseVector tmp, tmp2, diff, beta_ao; //beta_aoi, beta_aoiSum
+				DenseVector beta_aoXn_unweighted, beta_aoXn;
+				bool	valid_o_and_Xn; // SYL260809 to allow skipping operation for an observation o, if there are
+							// no valid Xn values (for given action a) associated with it
 
-				FOR (Xc, pomdp->XStates->size()) 
+				// SYL260809 keep track of maximum residual
+				threadResidual[t] = 0;
+
+				for (int a = first; a < last; a++) 
 				{
-					beta_a[Xc].resize(pomdp->YStates->size());
+					std::vector< DenseVector >& beta_a = nextAl[a];
 
-					FOR (o, pomdp->observations->size()) 
+					FOR (Xc, numX) 
 					{
-						beta_ao.resize(pomdp->YStates->size());
-						valid_o_and_Xn = false; // SYL260809
+						beta_a[Xc].resize(numY);
 
-						FOR (Xn, pomdp->XStates->size()) 
+						FOR (o, pomdp->observations->size()) 
 						{
-						  if (!(pomdp->XTrans->getMatrix(a, Xc)->isColumnEmpty(Xn)))
-						  {
-						     if (!(pomdp->obsProb->getMatrix(a, Xn)->isColumnEmpty(o)))
-						     {
-						     	valid_o_and_Xn = true;	 // SYL260809
-					
-							FOR (i, pomdp->actions->size()) 
+							beta_ao.resize(numY);
+							valid_o_and_Xn = false; // SYL260809
+
+							FOR (Xn, numX) 
 							{
-								emult_column( tmp, *pomdp->obsProb->getMatrix(a, Xn), o, al[i][Xn] );
-								mult( tmp2, *pomdp->YTrans->getMatrix(a, Xc, Xn), tmp); // SYL270809
-								// SYL270809 mult(vector, matrix, vector) is faster than mult(vector, vector, matrix)
-								//mult( tmp2, tmp, *pomdp->XYTrans->getMatrixTr(a, Xc) );
-		
-								if (0 == i) {
-									beta_aoXn_unweighted = tmp2;
-								} else {
-									max_assign( beta_aoXn_unweighted, tmp2 );
+							  if (!(matrices.XTrans(a, Xc).isColumnEmpty(Xn)))
+							  {
+							     if (!(matrices.ObsProb(a, Xn).isColumnEmpty(o)))
+							     {
+							     	valid_o_and_Xn = true;	 // SYL260809
+						
+								FOR (i, pomdp->actions->size()) 
+								{
+									emult_column( tmp, matrices.ObsProb(a, Xn), o, al[i][Xn] );
+									mult( tmp2, matrices.YTrans(a, Xc, Xn), tmp); // SYL270809
+									// SYL270809 mult(vector, matrix, vector) is faster than mult(vector, vector, matrix)
+									//mult( tmp2, tmp, *pomdp->XYTrans->getMatrixTr(a, Xc) );
+			
+									if (0 == i) {
+										beta_aoXn_unweighted = tmp2;
+									} else {
+										max_assign( beta_aoXn_unweighted, tmp2 );
+									}
+
 								}
 
+								emult_column(beta_aoXn, matrices.XTrans(a, Xc), Xn, beta_aoXn_unweighted);
+								beta_ao += beta_aoXn;
+							    }
+							  }
 							}
+										// SYL260809
+							if (valid_o_and_Xn)	// false means there's no valid Xn (given the 
+										//action and Xc) for this observation o
+								beta_a[Xc] += beta_ao; //beta_ao;
 
-							emult_column(beta_aoXn, *pomdp->XTrans->getMatrix(a, Xc), Xn, beta_aoXn_unweighted);
-							beta_ao += beta_aoXn;
-						    }
-						  }
 						}
-									// SYL260809
-						if (valid_o_and_Xn)	// false means there's no valid Xn (given the 
-									//action and Xc) for this observation o
-							beta_a[Xc] += beta_ao; //beta_ao;
-
-					}
 
-					beta_a[Xc] *= pomdp->discount;
-					
-					copy_from_column( tmp, *pomdp->rewards->getMatrix(Xc), a );
-					beta_a[Xc] += tmp;
+						beta_a[Xc] *= pomdp->discount;
+						
+						copy_from_column( tmp, matrices.Rewards(Xc), a );
+						beta_a[Xc] += tmp;
 
-					// SYL260809 keep track of maximum residual
-					diff = beta_a[Xc];
-					diff -= al[a][Xc];
-					maxResidual = std::max( maxResidual, diff.norm_inf() );
+						// SYL260809 keep track of maximum residual
+						diff = beta_a[Xc];
+						diff -= al[a][Xc];
+						threadResidual[t] = std::max( threadResidual[t], diff.norm_inf() );
+					}
 				}
+			});
+
+			maxResidual = 0;
+			FOR (t, threads) {
+				maxResidual = std::max( maxResidual, threadResidual[t] );
 			}
 
 			// SYL260809  assign the FIB vectors for next iteration
@@ -439,6 +586,36 @@ namespace momdp {
 
 		} while ( maxResidual > targetPrecision );
 
+		if (!warmStartFile.empty())
+		{
+			vector<double> values(pomdp->actions->size() * numX * numY);
+			FOR (a, pomdp->actions->size()) 
+			{
+				FOR (Xc, numX) 
+				{
+					FOR (y, numY) 
+					{
+						values[(a * numX + Xc) * numY + y] = al[a][Xc](y);
+					}
+				}
+			}
+			writeWarmStart(values);
+		}
+		if (warmStarted)
+		{
+			double margin = warmStartMargin(maxResidual);
+			FOR (a, pomdp->actions->size()) 
+			{
+				FOR (Xc, numX) 
+				{
+					FOR (y, numY) 
+					{
+						al[a][Xc](y) += margin;
+					}
+				}
+			}
+		}
+
 		//cout << "targetPrecision : " << targetPrecision << endl;
 
 
@@ -494,7 +671,7 @@ namespace momdp {
 				}
 	
 				// at this point, the vector at dalpha[state_idx] has taken into account terminal state
-				bound->set[state_idx]->points.clear();
+				bound->set[state_idx]->clearPoints();
 				copy(bound->set[state_idx]->cornerPoints,dalpha);
 	
 			} 
@@ -28,6 +28,13 @@ namespace momdp {
 
 		std::vector<alpha_vector> alphas;	// am assuming that we dont really need more than one set (for all state indexes) of alphas
 
+		int numThreads; // for the sweeps over the actions, 0 means one per core
+
+		// If set, the FIB vectors are read from this file to start the iteration
+		// instead of the MDP bound, when it was written for a model of the same
+		// size, and the converged vectors are written back to it.
+		string warmStartFile;
+
 		// SYL260809 commented out - it's not needed now that only one FullObsUBInitializer object is created
 		//std::vector<alpha_vector> alphasByState;
 
@@ -41,6 +48,12 @@ namespace momdp {
 
 
 	protected:
+		UBInitMatrices matrices;
+
+		bool readWarmStart(vector<double>& values);
+		void writeWarmStart(const vector<double>& values);
+		double warmStartMargin(double maxResidual);
+
 		void initMDP(double targetPrecision, FullObsUBInitializer& m);  // SYL260809 prevly: void initMDP(double targetPrecision);
 		void initFIB(double targetPrecision, bool getFIBvectors);
 
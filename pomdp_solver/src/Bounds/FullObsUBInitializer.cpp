@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <thread>
 
 #include "FullObsUBInitializer.h"
 
@@ -29,6 +30,72 @@ using namespace std;
 
 namespace momdp {
 
+	void UBInitMatrices::gather(SharedPointer<MOMDP> pomdp)
+	{
+		numActions = pomdp->actions->size();
+		numX = pomdp->XStates->size();
+
+		xTrans.resize(numActions * numX);
+		yTrans.resize(numActions * numX * numX);
+		obsProb.resize(numActions * numX);
+		rewards.resize(numX);
+		FOR (a, numActions) 
+		{
+			FOR (x, numX) 
+			{
+				xTrans[a * numX + x] = &*pomdp->XTrans->getMatrix(a, x);
+				obsProb[a * numX + x] = &*pomdp->obsProb->getMatrix(a, x);
+				FOR (xn, numX) 
+				{
+					yTrans[(a * numX + x) * numX + xn] = &*pomdp->YTrans->getMatrix(a, x, xn);
+				}
+			}
+		}
+		FOR (x, numX) 
+		{
+			rewards[x] = &*pomdp->rewards->getMatrix(x);
+		}
+	}
+
+	int sweepThreadCount(int numThreads, SharedPointer<MOMDP> pomdp)
+	{
+		int numActions = pomdp->actions->size();
+		if (numThreads <= 0)
+		{
+			double size = (double)numActions * pomdp->XStates->size() * pomdp->YStates->size();
+			if (size < PARALLEL_SWEEP_MIN_SIZE)
+			{
+				return 1;
+			}
+			numThreads = max(1, (int)thread::hardware_concurrency());
+		}
+		return max(1, min(numThreads, numActions));
+	}
+
+	void parallelRanges(int n, int numThreads, const std::function<void(int, int, int)>& body)
+	{
+		if (numThreads > n)
+		{
+			numThreads = n;
+		}
+		if (numThreads <= 1)
+		{
+			body(0, n, 0);
+			return;
+		}
+
+		vector<thread> threads;
+		for (int t = 1; t < numThreads; t++)
+		{
+			threads.push_back(thread(body, n * t / numThreads, n * (t + 1) / numThreads, t));
+		}
+		body(0, n / numThreads, 0);
+		FOR (t, threads.size()) 
+		{
+			threads[t].join();
+		}
+	}
+
 	void FullObsUBInitializer::nextAlphaAction_unfac(DenseVector& result, int a) 
 	{
 		DenseVector R_xa;
@@ -40,24 +107,32 @@ namespace momdp {
 
 	double FullObsUBInitializer::valueIterationOneStep_unfac(void) 
 	{
-		DenseVector nextAlpha(pomdp->XStates->size() * pomdp->YStates->size());
-		DenseVector naa(pomdp->XStates->size() * pomdp->YStates->size());
+		int size = pomdp->XStates->size() * pomdp->YStates->size();
 		DenseVector tmp;
 		double maxResidual;
 
-		nextAlphaAction_unfac(nextAlpha,0);
-
-		FOR (a, pomdp->actions->size()) 
+		// each thread takes the max over a range of actions, then the max is taken
+		// over the threads; the max is exact, so the number of threads does not matter
+		int threads = sweepThreadCount(numThreads, pomdp);
+		std::vector<DenseVector> threadAlpha(threads);
+		parallelRanges(pomdp->actions->size(), threads, [&](int first, int last, int t)
 		{
-			nextAlphaAction_unfac(naa,a);
+			DenseVector& nextAlpha = threadAlpha[t];
+			DenseVector naa(size);
 
-			FOR (s, pomdp->XStates->size() * pomdp->YStates->size()) 
+			nextAlpha.resize(size);
+			nextAlphaAction_unfac(nextAlpha, first);
+			for (int a = first + 1; a < last; a++) 
 			{
-				if (naa(s) > nextAlpha(s))
-				{
-					nextAlpha(s) = naa(s);
-				}
+				nextAlphaAction_unfac(naa,a);
+				max_assign(nextAlpha, naa);
 			}
+		});
+
+		DenseVector& nextAlpha = threadAlpha[0];
+		for (int t = 1; t < threads; t++) 
+		{
+			max_assign(nextAlpha, threadAlpha[t]);
 		}
 
 		tmp.resize( alpha.size() );
@@ -175,6 +250,7 @@ namespace momdp {
 	}
 
 
+	// uses matrices, so that it can be called from several threads
 	void FullObsUBInitializer::nextAlphaAction(std::vector<DenseVector>& resultByState, int a) 
 	{
 
@@ -188,13 +264,13 @@ namespace momdp {
 			// total expected next value
 			FOR (Xn, pomdp->XStates->size()) 
 			{
-				if (!(pomdp->XTrans->getMatrix(a, state_idx)->isColumnEmpty(Xn)))
+				if (!(matrices.XTrans(a, state_idx).isColumnEmpty(Xn)))
 				{
 					// expected next value for Xn
-				  mult( tmp, *pomdp->YTrans->getMatrix(a, state_idx, Xn), alphaByState[Xn]);
+				  mult( tmp, matrices.YTrans(a, state_idx, Xn), alphaByState[Xn]);
 					// SYL260809 prevly is as below. The current function called, mult(result, matrix, vector), seems faster
 					//mult( tmp, alphaByState[Xn], *pomdp->XYTrans->matrixTr[a][state_idx] );
-					emult_column( resultThisState, *pomdp->XTrans->getMatrix(a, state_idx), Xn, tmp );
+					emult_column( resultThisState, matrices.XTrans(a, state_idx), Xn, tmp );
 					resultSum += resultThisState;
 
 				} 
@@ -203,7 +279,7 @@ namespace momdp {
 			}
 
 			resultSum *= pomdp->discount;
-			copy_from_column( R_xa, *pomdp->rewards->getMatrix(state_idx), a );
+			copy_from_column( R_xa, matrices.Rewards(state_idx), a );
 			resultSum += R_xa;
 			resultByState[state_idx] = resultSum;
 		} 
@@ -215,27 +291,38 @@ namespace momdp {
 		//DenseVector nextAlpha(pomdp->getBeliefSize()), naa(pomdp->getBeliefSize());
 		DenseVector tmp; //, tmpzero(pomdp->YStates->size());
 		double maxResidual; // = 0;
+		int numX = pomdp->XStates->size();
 
-		std::vector<DenseVector> nextAlpha(pomdp->XStates->size()), naa(pomdp->XStates->size());
-
-		nextAlphaAction(nextAlpha,0);
-		//FOR (a, pomdp->actions->size()) {
-		for (unsigned int a=1; a < pomdp->actions->size(); a++) 
+		// each thread takes the max over a range of actions, then the max is taken
+		// over the threads; the max is exact, so the number of threads does not matter
+		int threads = sweepThreadCount(numThreads, pomdp);
+		std::vector<std::vector<DenseVector> > threadAlpha(threads, std::vector<DenseVector>(numX));
+		parallelRanges(pomdp->actions->size(), threads, [&](int first, int last, int t)
 		{
-			nextAlphaAction(naa,a);		
-			FOR (state_idx, pomdp->XStates->size()) 
+			std::vector<DenseVector>& nextAlpha = threadAlpha[t];
+			std::vector<DenseVector> naa(numX);
+
+			nextAlphaAction(nextAlpha, first);
+			for (int a = first + 1; a < last; a++) 
 			{
-				FOR (s, pomdp->getBeliefSize()) 
+				nextAlphaAction(naa,a);		
+				FOR (state_idx, numX) 
 				{
-					if (naa[state_idx](s) > nextAlpha[state_idx](s)) 
-					{
-						nextAlpha[state_idx](s) = naa[state_idx](s);
-					}
+					max_assign(nextAlpha[state_idx], naa[state_idx]);
 				}
 			}
+		});
+
+		std::vector<DenseVector>& nextAlpha = threadAlpha[0];
+		for (int t = 1; t < threads; t++) 
+		{
+			FOR (state_idx, numX) 
+			{
+				max_assign(nextAlpha[state_idx], threadAlpha[t][state_idx]);
+			}
 		}
 
-		FOR (state_idx, pomdp->XStates->size()) 
+		FOR (state_idx, numX) 
 		{
 			//tmp.resize( alphaByState[state_idx].size() );
 			tmp = alphaByState[state_idx];
@@ -258,6 +345,7 @@ namespace momdp {
 	void FullObsUBInitializer::valueIteration(SharedPointer<MOMDP> _pomdp, double eps) 
 	{
 		pomdp = _pomdp;
+		matrices.gather(pomdp);
 
 		alphaByState.resize(pomdp->XStates->size());
 
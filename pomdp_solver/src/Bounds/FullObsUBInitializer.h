@@ -8,15 +8,63 @@
 #ifndef INCFullObsUBInitializer_h
 #define INCFullObsUBInitializer_h
 
+#include <functional>
 #include "MOMDP.h"
 
 #define MDP_MAX_ITERS (1000000)
+// models with fewer actions * states entries are swept on a single thread
+#define PARALLEL_SWEEP_MIN_SIZE (4096)
 
 namespace momdp {
 
+	// Raw pointers to the matrices of the model, gathered once before the sweeps.
+	// getMatrix returns shared pointers, whose reference counts must not be
+	// updated from several threads.
+	class UBInitMatrices
+	{
+	public:
+		int numActions;
+		int numX;
+		vector<SparseMatrix*> xTrans;	// [a * numX + x]
+		vector<SparseMatrix*> yTrans;	// [(a * numX + x) * numX + xn]
+		vector<SparseMatrix*> obsProb;	// [a * numX + xn]
+		vector<SparseMatrix*> rewards;	// [x]
+
+		void gather(SharedPointer<MOMDP> pomdp);
+
+		const SparseMatrix& XTrans(int a, int x) const
+		{
+			return *xTrans[a * numX + x];
+		}
+		const SparseMatrix& YTrans(int a, int x, int xn) const
+		{
+			return *yTrans[(a * numX + x) * numX + xn];
+		}
+		const SparseMatrix& ObsProb(int a, int xn) const
+		{
+			return *obsProb[a * numX + xn];
+		}
+		const SparseMatrix& Rewards(int x) const
+		{
+			return *rewards[x];
+		}
+	};
+
+	// number of threads for the sweeps over the actions of pomdp, numThreads = 0
+	// means one per core
+	int sweepThreadCount(int numThreads, SharedPointer<MOMDP> pomdp);
+
+	// calls body(first, last, thread) on numThreads threads, for contiguous
+	// ranges [first, last) covering [0, n)
+	void parallelRanges(int n, int numThreads, const std::function<void(int, int, int)>& body);
+
 	class FullObsUBInitializer {
 	public:
 		SharedPointer<MOMDP> pomdp;	
+		int numThreads; // for the sweeps of valueIteration, 0 means one per core
+		UBInitMatrices matrices; // gathered by valueIteration
+
+		FullObsUBInitializer(void) : numThreads(0) {}
 
   // data and methods for factored version
   std::vector<DenseVector> alphaByState;
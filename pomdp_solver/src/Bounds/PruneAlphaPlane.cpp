@@ -8,7 +8,10 @@
 #include "AlphaPlanePool.h"
 #include "GlobalResource.h"
 #include "SARSOP.h"
+#include "FullObsUBInitializer.h"
 #include <cfloat>
+#include <algorithm>
+#include <unordered_map>
 
 
 using namespace std;
@@ -25,13 +28,47 @@ namespace momdp
 		global_delta = 0.1;
 		pruneTime = 0.0;
 		numPrune = 0;
+		numThreads = 1;
+		background = false;
+		numSettled = 0;
+		pruneDone = false;
+	}
+
+	PruneAlphaPlane::~PruneAlphaPlane()
+	{
+		if (pruneThread.joinable())
+		{
+			pruneThread.join();
+		}
+	}
+
+	int PruneAlphaPlane::threadCount(double work)
+	{
+		if (numThreads > 0)
+		{
+			return numThreads;
+		}
+		if (work < PARALLEL_PRUNE_MIN_SIZE)
+		{
+			return 1;
+		}
+		return max(1, (int)thread::hardware_concurrency());
 	}
 
 	void PruneAlphaPlane::updateCertsAndUses(int timeStamp){
 
 		DEBUG_TRACE(cout << "PruneAlpha::updateCertsAndUses timeStamp " << timeStamp << endl;);
 
-		prunePlanes();
+		// in the background the dominated planes go on a later call, the
+		// solver does not wait for a pass here
+		if (!background)
+		{
+			prunePlanes();
+		}
+		else if (!pollBackgroundPrune() && numSettled < (int)alphaPlanePool->planes.size())
+		{
+			startBackgroundPrune();
+		}
 		//cout << "Current Delta: " << global_delta << endl;
 		updateCertsByDeltaDominance(global_delta, timeStamp); 
 		updateUsesByCorners();
@@ -45,6 +82,11 @@ namespace momdp
 	}
 
 	bool PruneAlphaPlane::isMax(SharedPointer<AlphaPlane> alphaPlane)
+	{
+		return isMax(alphaPlane.get());
+	}
+
+	bool PruneAlphaPlane::isMax(AlphaPlane* alphaPlane)
 	{
 		SARSOPAlphaPlaneTuple* dataTuple = (SARSOPAlphaPlaneTuple *) alphaPlane->solverData;
 		return dataTuple->maxMeta.size() != 0;
@@ -63,6 +105,7 @@ namespace momdp
 	{
 		list<SharedPointer<AlphaPlane> > next_planes;
 		next_planes.clear();
+		int index = 0, settled = 0;
 
 		//iterate planes, only retain the ones which has certificates or has
 		//	been useful at corners
@@ -77,6 +120,10 @@ namespace momdp
 			if(tempTuple->certifiedBeliefs.size()>0 || try_alpha->used>0 || isMax(try_alpha) )
 			{
 				next_planes.push_back(try_alpha);
+				if (index < numSettled)
+				{
+					settled++;
+				}
 			}
 			else
 			{
@@ -106,8 +153,10 @@ cout << "Last alpha in the pool (not deleting) for sval: " << alphaPlanePool->sv
 				//needs delete !!
 				//}
 			}
+			index++;
 		}
-		alphaPlanePool->planes = next_planes;
+		alphaPlanePool->setAlphaPlanes(next_planes);
+		numSettled = settled;	// the kept settled planes are still the first ones
 		lastPruneNumPlanes = alphaPlanePool->planes.size();
 		if (lastPruneNumPlanes == 0)
 		{
@@ -195,21 +244,39 @@ cout << "Last alpha in the pool (not deleting) for sval: " << alphaPlanePool->sv
 		//cout << "Sanity :: Max Alpha : " << maxCount << endl;
 	}
 
+	// The certificates of each plane are checked on the threads, then moved to
+	// their new planes in the order of the pool. A certificate moved during the
+	// pass carries the newest time stamp of the pool, so the check of its new
+	// plane keeps it, as it does when the planes are checked one after the other.
 	void PruneAlphaPlane::updateCertsByDeltaDominance(double delta, int timeStamp)
 	{
 		DEBUG_TRACE(cout << "updateCertsByDeltaDominance" << endl;);
 
+		vector<AlphaPlane*> planes;
 		LISTFOREACH(SharedPointer<AlphaPlane>,  try_pair,  alphaPlanePool->planes) 
 		{
-			SharedPointer<AlphaPlane> try_alpha = *try_pair;
-			updateCerts(try_alpha, delta, timeStamp);
-			
+			planes.push_back((*try_pair).get());
+		}
 
-			if(isMax(try_alpha))
+		vector< vector<CertUpdate> > updates(planes.size());
+		double work = (double)planes.size() * planes.size() * problem->getBeliefSize();
+		parallelRanges(planes.size(), threadCount(work), [&](int first, int last, int t)
+		{
+			for (int p = first; p < last; p++)
 			{
-				DEBUG_TRACE( cout << "isMax" << endl );
-				updateMax(try_alpha, delta, timeStamp);
+				checkCerts(planes, planes[p], delta, updates[p]);
+
+				if(isMax(planes[p]))
+				{
+					DEBUG_TRACE( cout << "isMax" << endl );
+					updateMax(planes, planes[p]);
+				}
 			}
+		});
+
+		FOR (p, planes.size())
+		{
+			moveCerts(planes[p], updates[p]);
 		}
 	}//end method: updateCertsByDeltaDominance
 
@@ -358,7 +425,7 @@ cout << "alphaPlanePool->planes.size() !> 0 !!!" <<endl;
 		}
 	}
 
-	void PruneAlphaPlane::updateMax(SharedPointer<AlphaPlane> plane, double delta, int timeStamp)
+	void PruneAlphaPlane::updateMax(const vector<AlphaPlane*>& planes, AlphaPlane* plane)
 	{
 		vector<AlphaPlaneMaxMeta*> nextMaxMeta;
 
@@ -372,18 +439,17 @@ cout << "alphaPlanePool->planes.size() !> 0 !!!" <<endl;
 			//if(alphaPlanePool->beliefCache ->getRow(i)->isFringe)
 			if(alphaPlanePool->beliefCache ->getRow(i)->REACHABLE->isFringe())
 			{
-				const SharedPointer<belief_vector>  b = alphaPlanePool->beliefCache ->getRow(i)->BELIEF;
-				//const SharedPointer<belief_vector>  b = GlobalResource::getInstance()->beliefCache ->getRow(i)->BELIEF;
+				const belief_vector& b = *alphaPlanePool->beliefCache ->getRow(i)->BELIEF;
 				
 				int lastTimeStamp = (*entry)->timestamp;
 				maxTimeStamp = lastTimeStamp;
-				LISTFOREACH(SharedPointer<AlphaPlane>,  try_pair,  alphaPlanePool->planes) 
+				FOR (p, planes.size()) 
 				{
-					SharedPointer<AlphaPlane> try_alpha = * try_pair;
+					AlphaPlane* try_alpha = planes[p];
 					//only not examined alphas are examined
 					if(try_alpha->timeStamp > lastTimeStamp)
 					{
-						double dotProductValue = inner_prod( *(try_alpha -> alpha),*b);
+						double dotProductValue = inner_prod( *(try_alpha -> alpha),b);
 						if(dotProductValue > (*entry)->lastLB )
 						{
 							removeThis = true;
@@ -494,101 +560,85 @@ cout << "alphaPlanePool->planes.size() !> 0 !!!" <<endl;
 	*/
 	
 
-	void PruneAlphaPlane::updateCerts(SharedPointer<AlphaPlane> plane, double delta, int timeStamp)
+	void PruneAlphaPlane::checkCerts(const vector<AlphaPlane*>& planes, AlphaPlane* plane, double delta, vector<CertUpdate>& updates)
 	{
-		DEBUG_TRACE(cout << "updateCerts" << endl;);
-
-
 		SARSOPAlphaPlaneTuple *planeTuple = (SARSOPAlphaPlaneTuple *)(plane->solverData);
-		//for each previously certifing BeliefTreeNode, check whether it still dominates
-		int oldCertState = planeTuple -> certed;
+		alpha_vector alpha_distance;
 
-		for(int i=0; i<(int)planeTuple->certifiedBeliefs.size(); i++)
+		//for each previously certifing BeliefTreeNode, check whether it still dominates
+		updates.resize(planeTuple->certifiedBeliefs.size());
+		FOR (i, updates.size())
 		{
-
-			DEBUG_TRACE(cout << "i " << i << endl;);
-
 			BeliefTreeNode* n = planeTuple->certifiedBeliefs.at(i);
-			SharedPointer<belief_vector>  b = n->s->bvec;
-
-			int lastTimeStamp, maxTimeStamp;
-			double value, maxValue;
-			bool dominated;
-			if(n->count > 0)
+			CertUpdate& update = updates[i];
+			update.maxPlane = NULL;
+			update.drop = (n->count <= 0);
+			if (update.drop)
 			{
+				continue;
+			}
 
-				DEBUG_TRACE(cout << "n->count " << n->count << endl;);
-
-				//check whether it is still worth retaining certificate
-				lastTimeStamp = planeTuple->certifiedBeliefTimeStamps.at(i);
-				maxTimeStamp = lastTimeStamp;
-				value = inner_prod( *(plane->alpha), *b);
-				maxValue = value;
-				dominated = false;
-				SharedPointer<AlphaPlane> maxPlane = NULL;//may cause trouble later
-				LISTFOREACH(SharedPointer<AlphaPlane>,  try_pair,  alphaPlanePool->planes) 
-				{
-					SharedPointer<AlphaPlane> try_alpha = * try_pair;
-
+			//check whether it is still worth retaining certificate
+			const belief_vector& b = *n->s->bvec;
+			int lastTimeStamp = planeTuple->certifiedBeliefTimeStamps.at(i);
+			int maxTimeStamp = lastTimeStamp;
+			double maxValue = inner_prod( *(plane->alpha), b);
+			AlphaPlane* maxPlane = NULL;
+			FOR (p, planes.size()) 
+			{
+				AlphaPlane* try_alpha = planes[p];
 
 #if USE_MASKED_ALPHA
-					if (!mask_subset( *b, try_alpha->mask )) continue;
+				if (!mask_subset( b, try_alpha->mask )) continue;
 #endif
-					//only not examined alphas are examined
-
-					DEBUG_TRACE(cout << "try_alpha->timeStamp " << try_alpha->timeStamp << endl;);
-					DEBUG_TRACE(cout << "lastTimeStamp " << lastTimeStamp << endl;);
-					
-					if(try_alpha->timeStamp > lastTimeStamp)
+				//only not examined alphas are examined
+				if(try_alpha->timeStamp > lastTimeStamp)
+				{
+					double newValue = inner_prod( *(try_alpha->alpha),b);
+					if(maxValue < newValue-0.00000000000001)
 					{
-						alpha_vector alpha_distance;
-						// TODO:: see if can eliminate this vector copy
-						copy(alpha_distance,  *(plane->alpha));
-						double newValue = inner_prod( *(try_alpha->alpha),*b);
-
-						DEBUG_TRACE(cout << "maxValue " << maxValue << endl;);
-						DEBUG_TRACE(cout << "newValue " << newValue << endl;);
-
-						if(maxValue < newValue-0.00000000000001)
-						{
-							DEBUG_TRACE(cout << "smaller " << endl;);
-							//store delta statistics
-							if (maxPlane != NULL)
-							{
-								DEBUG_TRACE(cout << "maxPlane != NULL " << endl;);
-								copy(alpha_distance, *(maxPlane->alpha));
-							}
-
-							alpha_distance -=( *(try_alpha->alpha));
-							double squareDelta = (newValue - maxValue)*	(newValue-maxValue)/(alpha_distance.norm_2());
-							double deltaValue = sqrt(squareDelta);
-							//check dominance
-							if (deltaValue > delta){
-								maxPlane = try_alpha;
-								dominated = true;
-								maxValue = newValue;
-							}
-						}
-						//update maxTimeStamp when needed
-						if (try_alpha->timeStamp > maxTimeStamp)
-						{
-							maxTimeStamp = try_alpha->timeStamp;
+						//store delta statistics
+						copy(alpha_distance, maxPlane != NULL ? *(maxPlane->alpha) : *(plane->alpha));
+						alpha_distance -=( *(try_alpha->alpha));
+						double squareDelta = (newValue - maxValue)*	(newValue-maxValue)/(alpha_distance.norm_2());
+						double deltaValue = sqrt(squareDelta);
+						//check dominance
+						if (deltaValue > delta){
+							maxPlane = try_alpha;
+							maxValue = newValue;
 						}
 					}
+					//update maxTimeStamp when needed
+					if (try_alpha->timeStamp > maxTimeStamp)
+					{
+						maxTimeStamp = try_alpha->timeStamp;
+					}
 				}
+			}
 
-				//do updates of attributes for n, plane and maxPlaneif dominated
-				if(dominated)
-				{
-					maxPlane->addDominatedBelief(maxTimeStamp, n);
-					planeTuple->certifiedBeliefs.at(i)= NULL;
-				}
+			update.maxPlane = maxPlane;
+			update.maxTimeStamp = maxTimeStamp;
+		}
+	}
+
+	void PruneAlphaPlane::moveCerts(AlphaPlane* plane, const vector<CertUpdate>& updates)
+	{
+		SARSOPAlphaPlaneTuple *planeTuple = (SARSOPAlphaPlaneTuple *)(plane->solverData);
+
+		// the certificates after updates.size() moved to plane in this pass and stay
+		FOR (i, updates.size())
+		{
+			if (updates[i].maxPlane != NULL)
+			{
+				updates[i].maxPlane->addDominatedBelief(updates[i].maxTimeStamp, planeTuple->certifiedBeliefs.at(i));
+				planeTuple->certifiedBeliefs.at(i)= NULL;
 			}
-			else
+			else if (updates[i].drop)
 			{
 				planeTuple->certifiedBeliefs.at(i)= NULL;
 			}
 		}
+
 		//erase beliefs which no longer dominates
 		int size = planeTuple->certifiedBeliefs.size();
 		vector<BeliefTreeNode*> remainingBeliefs;
@@ -601,34 +651,8 @@ cout << "alphaPlanePool->planes.size() !> 0 !!!" <<endl;
 				remainingTimeStamps.push_back(t);
 			}
 		}
-		if( planeTuple->certifiedBeliefs.size()>0 && remainingBeliefs.size()==0)
-		{
-		}
 		planeTuple->certifiedBeliefs = remainingBeliefs;
 		planeTuple->certifiedBeliefTimeStamps = remainingTimeStamps;
-
-		// Hanna's algorithm
-		/*
-		int newCertState = plane->certed;
-		//cout << "oldCertState " << oldCertState << " newCertState " << newCertState << endl;
-		if(newCertState == 0)
-		{
-			//cout << "Loose all certs" << endl;
-			if(plane -> misPruned == 0)
-			{
-				plane -> misPruned = 1;
-			}
-		}
-		*/
-		/*
-		if(newCertState > 0 && plane -> isMax == 0)
-		{
-		if(plane -> misKept == 0)
-		{
-		plane -> misKept = 1;
-		}
-		}
-		*/
 	}
 
 
@@ -693,82 +717,229 @@ cout << "alphaPlanePool->planes.size() !> 0 !!!" <<endl;
 		}
 	}
 
-	//most used pruning methods
-	void PruneAlphaPlane::prunePlanes(void)
+	// Sets keep to the planes the pairwise dominance pass keeps: each plane in
+	// turn removes the kept planes it dominates, or is dropped if one of them
+	// dominates it. The first settled planes do not dominate each other, so
+	// they are all kept and only the later ones are compared. The relation of
+	// a block of planes with the planes before them is computed on the threads,
+	// then the pass goes through the block.
+	void PruneAlphaPlane::findDominated(const vector<AlphaPlane*>& planes, int settled, vector<char>& keep)
 	{
-		list<SharedPointer<AlphaPlane> > next_planes;
-		list<list<SharedPointer<AlphaPlane> >::iterator> erase_ptrs;
-		bool try_dominates_in, in_dominates_try;
+		enum { NONE, TRY_DOMINATES, IN_DOMINATES };
+		int n = planes.size();
+		vector<int> next;	// kept planes, in order
+		for (int k = 0; k < settled; k++)
+		{
+			next.push_back(k);
+		}
 
-		LISTFOREACH_NOCONST(SharedPointer<AlphaPlane>,  try_pair,  alphaPlanePool->planes) 
+		vector<int> candidates;
+		vector<int> nextPos;
+		vector<char> relation;
+		for (int k0 = settled; k0 < n; )
 		{
-			SharedPointer<AlphaPlane> try_alpha = *try_pair;
-			erase_ptrs.clear();
-			LISTFOREACH_NOCONST(SharedPointer<AlphaPlane>,  in_pair,  next_planes) 
+			int m = next.size();
+			int blockSize = min(n - k0, max(1, PRUNE_BLOCK_ENTRIES / (m + 1)));
+			candidates = next;
+			for (int b = 0; b < blockSize; b++)
 			{
-				SharedPointer<AlphaPlane> in_alpha = *in_pair;
+				candidates.push_back(k0 + b);
+			}
+			int width = candidates.size();
 
-#if USE_MASKED_ALPHA
-				try_dominates_in = mask_dominates(try_alpha->alpha, in_alpha->alpha, ZMDP_BOUNDS_PRUNE_EPS,
-					try_alpha->mask,  in_alpha->mask);
-#else
-				try_dominates_in = dominates(*try_alpha->alpha, *in_alpha->alpha, ZMDP_BOUNDS_PRUNE_EPS);
-#endif
-				if (try_dominates_in) 
+			relation.assign((size_t)blockSize * width, NONE);
+			double work = (double)blockSize * width * problem->getBeliefSize();
+			parallelRanges(blockSize, threadCount(work), [&](int first, int last, int t)
+			{
+				for (int b = first; b < last; b++)
 				{
-					// delay erasure since we're still iterating through the set
-					erase_ptrs.push_back(in_pair);
+					const alpha_vector& try_alpha = *planes[k0 + b]->alpha;
+					char* row = &relation[(size_t)b * width];
+					for (int c = 0; c < m + b; c++)
+					{
+						const alpha_vector& in_alpha = *planes[candidates[c]]->alpha;
+						if (dominates(try_alpha, in_alpha, ZMDP_BOUNDS_PRUNE_EPS))
+						{
+							row[c] = TRY_DOMINATES;
+						}
+						else if (dominates(in_alpha, try_alpha, ZMDP_BOUNDS_PRUNE_EPS))
+						{
+							row[c] = IN_DOMINATES;
+						}
+					}
 				}
-				else
+			});
+
+			nextPos.resize(m);
+			FOR (i, m)
+			{
+				nextPos[i] = i;
+			}
+			for (int b = 0; b < blockSize; b++)
+			{
+				const char* row = &relation[(size_t)b * width];
+				bool dominated = false;
+				bool dominates = false;
+				FOR (i, nextPos.size())
 				{
-#if USE_MASKED_ALPHA
-					in_dominates_try = mask_dominates(in_alpha->alpha, try_alpha->alpha, ZMDP_BOUNDS_PRUNE_EPS,
-						in_alpha->mask,  try_alpha->mask);
-#else
-					in_dominates_try = dominates(*in_alpha->alpha, *try_alpha->alpha, ZMDP_BOUNDS_PRUNE_EPS);
-#endif
-					if (in_dominates_try) goto next_try_pair;
+					if (row[nextPos[i]] == IN_DOMINATES)
+					{
+						// the planes it dominates so far are not removed
+						dominated = true;
+						break;
+					}
+					dominates |= (row[nextPos[i]] == TRY_DOMINATES);
 				}
+				if (dominated)
+				{
+					continue;
+				}
+				if (dominates)
+				{
+					nextPos.erase(remove_if(nextPos.begin(), nextPos.end(), [&](int c) { return row[c] == TRY_DOMINATES; }), nextPos.end());
+				}
+				nextPos.push_back(m + b);
 			}
 
-			// resolve delayed erasure
-			LISTFOREACH_NOCONST(list<SharedPointer<AlphaPlane> >::iterator,  erase_ptr,  erase_ptrs) 
+			next.clear();
+			FOR (i, nextPos.size())
 			{
-				list<SharedPointer<AlphaPlane> >::iterator  x, xp1;
-				SharedPointer<AlphaPlane> testDeleteAlphaPlane = (**erase_ptr);
-				SARSOPAlphaPlaneTuple *planeTuple = (SARSOPAlphaPlaneTuple *)(testDeleteAlphaPlane->solverData);
-				if(planeTuple->certed==0)
-				{
-					//delete testDeleteAlphaPlane;
-					// no need to delete as the smart pointer should be able to handle it
-				}
-				else if(planeTuple->certed<0)
+				next.push_back(candidates[nextPos[i]]);
+			}
+			k0 += blockSize;
+		}
+
+		keep.assign(n, 0);
+		FOR (i, next.size())
+		{
+			keep[next[i]] = 1;
+		}
+	}
+
+	// keeps the planes of the pool marked in keep, which become the settled planes
+	void PruneAlphaPlane::setKeptPlanes(const vector<char>& keep)
+	{
+		list<SharedPointer<AlphaPlane> > next_planes;
+		int k = 0;
+		LISTFOREACH(SharedPointer<AlphaPlane>,  try_pair,  alphaPlanePool->planes) 
+		{
+			if (keep[k++])
+			{
+				next_planes.push_back(*try_pair);
+			}
+			else
+			{
+				SARSOPAlphaPlaneTuple *planeTuple = (SARSOPAlphaPlaneTuple *)((*try_pair)->solverData);
+				if(planeTuple->certed<0)
 				{
 					printf("error2: certed num less than 0!!!!!!!!!!\n");
 				}
-				x = xp1 = (*erase_ptr);
-				xp1++;
-				next_planes.erase(x,xp1);
 			}
-			next_planes.push_back(try_alpha );
-next_try_pair: ;
 		}
 #if USE_DEBUG_PRINT
 		cout << "... pruned # planes from " << planes.size()
 			<< " down to " << next_planes.size() << endl;
 #endif
-		alphaPlanePool->planes = next_planes;
+		alphaPlanePool->setAlphaPlanes(next_planes);
 		lastPruneNumPlanes = alphaPlanePool->planes.size();
+		numSettled = lastPruneNumPlanes;
+	}
+
+	//most used pruning methods
+	void PruneAlphaPlane::prunePlanes(void)
+	{
+		finishBackgroundPrune();
+
+		vector<AlphaPlane*> planes;
+		LISTFOREACH(SharedPointer<AlphaPlane>,  try_pair,  alphaPlanePool->planes) 
+		{
+			planes.push_back((*try_pair).get());
+		}
+		vector<char> keep;
+		findDominated(planes, min(numSettled, (int)planes.size()), keep);
+		setKeptPlanes(keep);
+	}
+
+	void PruneAlphaPlane::startBackgroundPrune()
+	{
+		snapshot.assign(alphaPlanePool->planes.begin(), alphaPlanePool->planes.end());
+		snapshotPlanes.clear();
+		FOR (k, snapshot.size())
+		{
+			snapshotPlanes.push_back(snapshot[k].get());
+		}
+		int settled = min(numSettled, (int)snapshot.size());
+		pruneDone = false;
+		pruneThread = thread([this, settled]()
+		{
+			findDominated(snapshotPlanes, settled, snapshotKeep);
+			pruneDone = true;
+		});
+	}
+
+	// removes the planes of the snapshot pruneThread dropped, if it is done;
+	// returns true while it runs
+	bool PruneAlphaPlane::pollBackgroundPrune()
+	{
+		if (!pruneThread.joinable())
+		{
+			return false;
+		}
+		if (!pruneDone)
+		{
+			return true;
+		}
+		finishBackgroundPrune();
+		return false;
+	}
+
+	void PruneAlphaPlane::finishBackgroundPrune()
+	{
+		if (!pruneThread.joinable())
+		{
+			return;
+		}
+		pruneThread.join();
+
+		// the planes added since the snapshot are after the ones of the snapshot
+		unordered_map<AlphaPlane*, char> snapshotKeepOf;
+		FOR (k, snapshotPlanes.size())
+		{
+			snapshotKeepOf[snapshotPlanes[k]] = snapshotKeep[k];
+		}
+		vector<char> keep;
+		int settled = 0;
+		LISTFOREACH(SharedPointer<AlphaPlane>,  try_pair,  alphaPlanePool->planes) 
+		{
+			unordered_map<AlphaPlane*, char>::iterator found = snapshotKeepOf.find((*try_pair).get());
+			keep.push_back(found == snapshotKeepOf.end() || found->second);
+			settled += (found != snapshotKeepOf.end() && found->second);
+		}
+		setKeptPlanes(keep);
+		numSettled = settled;
+
+		snapshot.clear();
+		snapshotPlanes.clear();
 	}
 
 	// prune planes if the number has grown significantly
 	// since the last check
 	void PruneAlphaPlane::prune(void)
 	{
+		if (background && pollBackgroundPrune())
+		{
+			return;
+		}
+
 		unsigned int nextPruneNumPlanes = max(lastPruneNumPlanes + 10,
 			(int) (lastPruneNumPlanes * 1.1));
 		if (alphaPlanePool->planes.size() > nextPruneNumPlanes) 
 		{
+			if (background)
+			{
+				startBackgroundPrune();
+				return;
+			}
 #if DEBUGSYL_100908
 cout <<"Prune() for sval : " << alphaPlanePool->sval << " alphaPlanePool->planes.size() :"<< alphaPlanePool->planes.size() << endl;
 #endif
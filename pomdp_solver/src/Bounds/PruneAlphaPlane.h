@@ -9,17 +9,35 @@
 #ifndef PruneAlphaPlane_H
 #define PruneAlphaPlane_H
 
+#include <atomic>
+#include <thread>
 #include "MOMDP.h"
 #include "AlphaPlane.h"
+
+// pairs of planes times the number of states below which pruning runs on one thread
+#define PARALLEL_PRUNE_MIN_SIZE (1e8)
+// entries of the dominance relation computed at once by prunePlanes
+#define PRUNE_BLOCK_ENTRIES (1 << 22)
+
 using namespace std;
 using namespace momdp;
 namespace momdp
 {
 	class AlphaPlanePool;
+
+	// what the check of the certificates of a plane decided for one of them
+	struct CertUpdate
+	{
+		AlphaPlane* maxPlane;	// plane the certificate moves to, NULL to leave it
+		int maxTimeStamp;
+		bool drop;
+	};
+
 	class PruneAlphaPlane 
 	{
 	public:
 		PruneAlphaPlane();
+		~PruneAlphaPlane();
 
 		SharedPointer<MOMDP> problem;
 		AlphaPlanePool* alphaPlanePool;
@@ -27,6 +45,16 @@ namespace momdp
 
 		double global_delta;
 
+		// The checks of the pruning passes are spread over the planes on
+		// numThreads threads (0 for one per core on large pools). Pointwise
+		// dominance only compares the planes added since the last pass, the
+		// first numSettled planes of the pool do not dominate each other.
+		// With background, prune() checks a snapshot of the pool on
+		// pruneThread and removes the dominated planes on a later call.
+		int numThreads;
+		bool background;
+		int numSettled;
+
 		double pruneTime;
 		int numPrune;
 		// int state;	//SYL COMMENTED OUT
@@ -38,6 +66,7 @@ namespace momdp
 			problem = _problem;
 			alphaPlanePool = _alphaPlanePool;
 			global_delta = 0.1;
+			numSettled = 0;
 
 			pruneTime = 0.0;
 			numPrune = 0;
@@ -68,8 +97,11 @@ namespace momdp
 		//protected pruning related methods
 		/////////////////////////////////////
 		void updateCorners(SharedPointer<AlphaPlane> plane, std::vector<double, std::allocator<double> >* values, std::vector<SharedPointer<AlphaPlane>, std::allocator<SharedPointer<AlphaPlane> > >* indices);
-		void updateCerts(SharedPointer<AlphaPlane> plane, double delta, int timeStamp);
-		void updateMax(SharedPointer<AlphaPlane> plane, double delta, int timeStamp);
+		// run on the threads of updateCertsByDeltaDominance, they read the
+		// planes and write the data of plane only
+		void checkCerts(const vector<AlphaPlane*>& planes, AlphaPlane* plane, double delta, vector<CertUpdate>& updates);
+		void updateMax(const vector<AlphaPlane*>& planes, AlphaPlane* plane);
+		void moveCerts(AlphaPlane* plane, const vector<CertUpdate>& updates);
 		void updateUsesByCorners(void);
 		void updateCertsByDeltaDominance(double delta, int timeStamp);
 
@@ -83,6 +115,21 @@ namespace momdp
 		//void decreaseDelta();
 
 		static bool isMax(SharedPointer<AlphaPlane> alphaPlane);
+		static bool isMax(AlphaPlane* alphaPlane);
+
+		int threadCount(double work);
+		void findDominated(const vector<AlphaPlane*>& planes, int settled, vector<char>& keep);
+		void setKeptPlanes(const vector<char>& keep);
+
+		std::thread pruneThread;
+		std::atomic<bool> pruneDone;
+		vector<SharedPointer<AlphaPlane> > snapshot;	// keeps the planes of pruneThread alive, changed on the solver thread only
+		vector<AlphaPlane*> snapshotPlanes;
+		vector<char> snapshotKeep;
+
+		void startBackgroundPrune();
+		bool pollBackgroundPrune();
+		void finishBackgroundPrune();
 
 	};
 };
@@ -55,6 +55,7 @@ namespace momdp{
 			xp1++;
 			bvPairPool->points.erase( x, xp1 );
 		}
+		bvPairPool->repackPoints();
 
 #if USE_DEBUG_PRINT
 		cout << "... pruned # points from " << oldNum << " down to " << points.size() << endl;
@@ -0,0 +1,292 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include <iostream>
+#include <algorithm>
+
+#include "MOMDP.h"
+#include "SARSOP.h"
+#include "BeliefTransition.h"
+#include "SeedLBInitializer.h"
+
+using namespace std;
+
+using namespace momdp;
+
+namespace momdp {
+
+	SeedLBInitializer::SeedLBInitializer(SharedPointer<MOMDP> _pomdp, AlphaPlanePoolSet* _bound)
+	{
+		pomdp = (SharedPointer<MOMDP>) _pomdp;
+		bound = _bound;
+		numThreads = 0;
+	}
+
+	// same bound as BlindLBInitializer::initBlindWorstCaseIntegrated, the value
+	// of always taking the safest action is at least max_a min_s R(s,a) / (1 - discount)
+	void SeedLBInitializer::initBlindValues(void)
+	{
+		double worstCaseReward = -99e+20;
+		FOR (a, pomdp->getNumActions()) 
+		{
+			double worstStateVal = 99e+20;
+			FOR (sval, pomdp->XStates->size()) 
+			{	
+				SharedPointer<SparseMatrix>  rewardMatrix = pomdp->rewards->getMatrix(sval);
+				FOR (s, pomdp->YStates->size()) 
+				{
+					worstStateVal = std::min(worstStateVal, rewardMatrix->operator ()(s,a));
+				}
+			}
+			worstCaseReward = std::max(worstCaseReward, worstStateVal);
+		}
+
+		double worstCaseLongTerm = worstCaseReward / (1 - pomdp->getDiscount());
+		blindValues.resize(pomdp->XStates->size());
+		FOR (sval, pomdp->XStates->size())
+		{
+			blindValues[sval].resize(pomdp->YStates->size());
+			FOR (i, pomdp->YStates->size()) 
+			{
+				if (!pomdp->isPOMDPTerminalState[sval][i]) 
+				{
+					blindValues[sval](i) = worstCaseLongTerm;
+				}
+			}
+		}
+	}
+
+	// node of the best plane of the policy at b, -1 if the policy has no plane for b->sval
+	int SeedLBInitializer::getNode(SharedPointer<BeliefWithState> b)
+	{
+		int x = b->sval;
+		SharedPointer<AlphaPlane> plane = policy->getAlphaPlanePoolSet()->set[x]->getBestAlphaPlane1(b->bvec);
+		if (plane == NULL)
+		{
+			return -1;
+		}
+
+		int node = nodeOfColumn[x][plane->poolColumn];
+		if (node == -1)
+		{
+			node = values.size();
+			nodeOfColumn[x][plane->poolColumn] = node;
+			values.push_back(*plane->alpha);
+			actions.push_back(plane->action);
+			svals.push_back(x);
+			successors.resize(successors.size() + pomdp->XStates->size() * pomdp->observations->size(), -1);
+		}
+		return node;
+	}
+
+	// fixes the branches of node n that b reaches and no earlier belief did
+	void SeedLBInitializer::expandNode(int n, SharedPointer<BeliefWithState> b, vector< pair<int, SharedPointer<BeliefWithState> > >& expansions)
+	{
+		int numX = pomdp->XStates->size();
+		int numObs = pomdp->observations->size();
+		int a = actions[n];
+		obsState_prob_vector xProbs;
+		obs_prob_vector oProbs;
+
+		pomdp->getObsStateProbVector(xProbs, *b, a);
+		FOREACH(SparseVector_Entry, xe, xProbs.data)
+		{
+			if (xe->value <= OBS_IS_ZERO_EPS)
+			{
+				continue;
+			}
+			int xn = xe->index;
+
+			pomdp->getObsProbVector(oProbs, *b, a, xn);
+			FOREACH(SparseVector_Entry, oe, oProbs.data)
+			{
+				int branch = (n * numX + xn) * numObs + oe->index;
+				if (oe->value <= OBS_IS_ZERO_EPS || successors[branch] != -1)
+				{
+					continue;
+				}
+				SharedPointer<BeliefWithState> nextBelief = pomdp->beliefTransition->nextBelief(b, a, oe->index, xn);
+				int next = getNode(nextBelief);
+				successors[branch] = next;
+				if (next != -1)
+				{
+					expansions.push_back(make_pair(next, nextBelief));
+				}
+			}
+		}
+	}
+
+	bool SeedLBInitializer::buildGraph(void)
+	{
+		// breadth first, every branch fixed adds one expansion
+		vector< pair<int, SharedPointer<BeliefWithState> > > expansions;
+		FOR (x, pomdp->XStates->size())
+		{
+			if ((*pomdp->initialBeliefX)(x) > OBS_IS_ZERO_EPS)
+			{
+				SharedPointer<BeliefWithState> root (new BeliefWithState());
+				copy(*root->bvec, *pomdp->getInitialBeliefY(x));
+				root->sval = x;
+				int node = getNode(root);
+				if (node != -1)
+				{
+					expansions.push_back(make_pair(node, root));
+				}
+			}
+		}
+		if (expansions.empty())
+		{
+			cerr << "WARNING: the seed policy has no planes for the initial belief, the lower bound is not seeded" << endl;
+			return false;
+		}
+
+		for (size_t i = 0; i < expansions.size(); i++)
+		{
+			// copied, expandNode appends to expansions
+			pair<int, SharedPointer<BeliefWithState> > expansion = expansions[i];
+			expandNode(expansion.first, expansion.second, expansions);
+			expansions[i].second = NULL;
+		}
+		return true;
+	}
+
+	void SeedLBInitializer::sweep(const vector<DenseVector>& from, vector<DenseVector>& to)
+	{
+		int numObs = pomdp->observations->size();
+		int numX = pomdp->XStates->size();
+		int numY = pomdp->YStates->size();
+
+		parallelRanges(from.size(), sweepThreadCount(numThreads, pomdp), [&](int first, int last, int t)
+		{
+			DenseVector tmp, tmp2, next, beta_Xn;
+			for (int n = first; n < last; n++)
+			{
+				int a = actions[n];
+				int x = svals[n];
+				DenseVector& beta = to[n];
+				beta.resize(numY);
+
+				FOR (xn, numX)
+				{
+					if (matrices.XTrans(a, x).isColumnEmpty(xn))
+					{
+						continue;
+					}
+
+					// sum over the observations of O(o | xn, y', a) succ(y')
+					next.resize(numY);
+					FOR (o, numObs)
+					{
+						if (matrices.ObsProb(a, xn).isColumnEmpty(o))
+						{
+							continue;
+						}
+						int succ = successors[(n * numX + xn) * numObs + o];
+						emult_column(tmp, matrices.ObsProb(a, xn), o, succ == -1 ? blindValues[xn] : from[succ]);
+						next += tmp;
+					}
+					mult(tmp2, matrices.YTrans(a, x, xn), next);
+					emult_column(beta_Xn, matrices.XTrans(a, x), xn, tmp2);
+					beta += beta_Xn;
+				}
+
+				beta *= pomdp->discount;
+				copy_from_column(tmp, matrices.Rewards(x), a);
+				beta += tmp;
+			}
+		});
+	}
+
+	bool SeedLBInitializer::initialize(const string& policyFile, double targetPrecision)
+	{
+		if (pomdp->discount >= 1)
+		{
+			cerr << "WARNING: seeding the lower bound needs a discount below 1, the lower bound is not seeded" << endl;
+			return false;
+		}
+
+		// exits if the policy does not have the states of the model
+		policy = new AlphaVectorPolicy(pomdp);
+		policy->readFromFile(policyFile);
+		AlphaPlanePoolSet* seedSet = policy->getAlphaPlanePoolSet();
+		nodeOfColumn.resize(pomdp->XStates->size());
+		FOR (x, pomdp->XStates->size())
+		{
+			LISTFOREACH(SharedPointer<AlphaPlane>, plane, seedSet->set[x]->planes)
+			{
+				if ((*plane)->action >= pomdp->getNumActions())
+				{
+					cerr << "WARNING: " << policyFile << " has more actions than the model, the lower bound is not seeded" << endl;
+					return false;
+				}
+			}
+			nodeOfColumn[x].assign(seedSet->set[x]->planes.size(), -1);
+		}
+
+		matrices.gather(pomdp);
+		initBlindValues();
+		if (!buildGraph())
+		{
+			return false;
+		}
+
+		// With gap = max (values - next), the planes values - gap / (1 -
+		// discount) are below their own sweep, so below the values of the
+		// controller, and so is their sweep next - discount * gap / (1 - discount).
+		vector<DenseVector> next(values.size());
+		double shift;
+		int numSweeps = 0;
+		while (true)
+		{
+			sweep(values, next);
+			numSweeps++;
+
+			double gap = 0;
+			FOR (n, values.size())
+			{
+				FOR (y, pomdp->YStates->size())
+				{
+					gap = std::max(gap, values[n](y) - next[n](y));
+				}
+			}
+			shift = pomdp->discount * gap / (1 - pomdp->discount);
+			if (shift <= targetPrecision || numSweeps >= SEED_MAX_SWEEPS)
+			{
+				break;
+			}
+			values.swap(next);
+		}
+
+		FOR (n, next.size())
+		{
+			int sval = svals[n];
+			SharedPointer<AlphaPlane> plane (new AlphaPlane());
+			copy(*plane->alpha, next[n]);
+			FOR (y, pomdp->YStates->size())
+			{
+				// terminal states are worth exactly 0 to every controller, as
+				// for the planes of BlindLBInitializer
+				if (pomdp->isPOMDPTerminalState[sval][y])
+				{
+					(*plane->alpha)(y) = 0.0;
+				}
+				else
+				{
+					(*plane->alpha)(y) -= shift;
+				}
+			}
+			plane->action = actions[n];
+			plane->sval = sval;
+			plane->setTimeStamp(0);
+
+			SARSOPAlphaPlaneTuple *tempTuple = (SARSOPAlphaPlaneTuple *)plane->solverData;
+			tempTuple->certed = 0; //init certed count to 0
+
+			bound->set[sval]->addAlphaPlane(plane);
+		}
+
+		DEBUG_LOG(cout << "seeded the lower bound with " << next.size() << " planes after " << numSweeps << " sweeps, shifted by " << shift << endl;);
+		return true;
+	}
+
+}; // namespace momdp
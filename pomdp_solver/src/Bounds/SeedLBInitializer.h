@@ -0,0 +1,65 @@
+#ifndef INCSeedLBInitializer_h
+#define INCSeedLBInitializer_h
+
+#include <string>
+#include "MOMDP.h"
+
+#include "FacmodelStructs.h"
+#include "AlphaPlanePool.h"
+#include "AlphaPlanePoolSet.h"
+#include "AlphaVectorPolicy.h"
+#include "FullObsUBInitializer.h"
+
+// maximum number of evaluation sweeps of the seed controller
+#define SEED_MAX_SWEEPS (200)
+
+namespace momdp {
+
+// Adds the alpha planes of a policy solved for a related model (same states,
+// actions and observations, e.g. another placement of the shelters) to the
+// lower bound. The planes are valid lower bounds of the old model only, so
+// the policy is read as a controller, like a policy graph: from the initial
+// belief, the node of the best plane takes the action of the plane and moves,
+// for each observation, to the node of the best plane at the next belief.
+// A branch is fixed by the first belief reaching the node that reaches the
+// branch, branches never reached continue with the blind worst case bound.
+// The values of the nodes are evaluated on
+// the new model by sweeps of
+//   n <- R(., a_n) + discount * sum_{x', o} T O succ[n][x'][o]
+// and shifted down by the largest amount a node exceeds its next sweep over
+// (1 - discount), which puts them below the true values of the controller.
+struct SeedLBInitializer
+{
+	SharedPointer<MOMDP> pomdp;
+	AlphaPlanePoolSet* bound;
+	int numThreads; // for the sweeps, 0 means one per core
+
+	SeedLBInitializer(SharedPointer<MOMDP> _pomdp, AlphaPlanePoolSet* _bound);
+
+	// returns false, leaving the bound unchanged, if the policy cannot seed
+	// this model; the shift of the planes is at most targetPrecision unless
+	// the sweeps stop at SEED_MAX_SWEEPS
+	bool initialize(const std::string& policyFile, double targetPrecision);
+
+protected:
+	UBInitMatrices matrices;
+	SharedPointer<AlphaVectorPolicy> policy;
+	std::vector< std::vector<int> > nodeOfColumn;	// node of each plane of the policy, by observed state and pool column
+	std::vector<DenseVector> blindValues;		// worst case value of each observed state
+
+	// controller nodes
+	std::vector<DenseVector> values;
+	std::vector<int> actions;
+	std::vector<int> svals;
+	std::vector<int> successors;	// [(node * numX + xn) * numObs + o], -1 for the blind bound
+
+	void initBlindValues(void);
+	int getNode(SharedPointer<BeliefWithState> b);
+	void expandNode(int n, SharedPointer<BeliefWithState> b, std::vector< pair<int, SharedPointer<BeliefWithState> > >& expansions);
+	bool buildGraph(void);
+	void sweep(const std::vector<DenseVector>& from, std::vector<DenseVector>& to);
+};
+
+}; // namespace momdp
+
+#endif /* INCSeedLBInitializer_h */
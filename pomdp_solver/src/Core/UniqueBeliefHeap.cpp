@@ -19,44 +19,71 @@ using namespace stdext;
 
 namespace momdp
 {
-	int UniqueBeliefHeap::addBeliefRowPair(SharedPointer<belief_vector>& bel, int row)
+	UniqueBeliefHeap::UniqueBeliefHeap() : numHashes(0)
 	{
-		//  string newHash = bel.hashCode();
-		// cout << "addBeliefRowPair: bel size: " << bel.size() << endl;
-
+		HashSlot empty;
+		empty.hash = 0;
+		empty.first = -1;
+		empty.last = -1;
+		slots.resize(1024, empty);
+	}
 
-		string newHash = bel->md5HashValue();
-		//cout << "Hash: " << newHash << endl;
+	// slot of hash, or the empty slot where it would be inserted
+	int UniqueBeliefHeap::findSlot(unsigned long long hash) const
+	{
+		int mask = slots.size() - 1;
+		int i = (int)hash & mask;
+		while(slots[i].first != -1 && slots[i].hash != hash)
+		{
+			i = (i + 1) & mask;
+		}
+		return i;
+	}
 
+	void UniqueBeliefHeap::grow()
+	{
+		vector<HashSlot> oldSlots;
+		oldSlots.swap(slots);
+
+		HashSlot empty;
+		empty.hash = 0;
+		empty.first = -1;
+		empty.last = -1;
+		slots.resize(2 * oldSlots.size(), empty);
+		for(int i = 0; i < oldSlots.size(); i++)
+		{
+			if(oldSlots[i].first != -1)
+			{
+				slots[findSlot(oldSlots[i].hash)] = oldSlots[i];
+			}
+		}
+	}
 
-		//if(!isStorageMaterial(bel))
-		//{
-		//	cout << "Trying to add a duplicate hash key " << newHash << endl;
-		//	return -1;
-		//}
+	int UniqueBeliefHeap::addBeliefRowPair(SharedPointer<belief_vector>& bel, int row)
+	{
+		unsigned long long newHash = bel->hashValue();
 
-		map<string, vector<BeliefVector_RowIndexPair> > ::iterator iter = uniqueBelHeap.find(newHash);
-		
-		if(iter == uniqueBelHeap.end())
+		// keep the load factor at most 1/2, so probe sequences stay short
+		if(2 * (numHashes + 1) > slots.size())
 		{
-			vector<BeliefVector_RowIndexPair> *vecBvrip = new vector<BeliefVector_RowIndexPair>();
-			
-			BeliefVector_RowIndexPair *bvrip = new BeliefVector_RowIndexPair(bel, row);
-			vecBvrip->push_back(*bvrip);
+			grow();
+		}
 
-			uniqueBelHeap[newHash] = *vecBvrip;
+		pairs.push_back(BeliefVector_RowIndexPair(bel, row));
+		int index = pairs.size() - 1;
+
+		HashSlot& slot = slots[findSlot(newHash)];
+		if(slot.first == -1)
+		{
+			slot.hash = newHash;
+			slot.first = index;
+			numHashes++;
 		}
 		else
 		{
-			BeliefVector_RowIndexPair *bvrip = new BeliefVector_RowIndexPair(bel, row);
-			iter->second.push_back(*bvrip);
-			//uniqueBelHeap[newHash].push_back();
+			pairs[slot.last].next = index;
 		}
-
-		
-
-		//cout << "-------------- " << uniqueBelHeap[newHash].size() << " -----------------------------" << endl;
-		//printHashMap();
+		slot.last = index;
 
 		return row;
 	}
@@ -68,54 +95,69 @@ namespace momdp
 		return (rowIndex >= 0);
 	}
 
+	int UniqueBeliefHeap::findPair(unsigned long long hash, const belief_vector& bel) const
+	{
+		const HashSlot& slot = slots[findSlot(hash)];
+		for(int i = slot.first; i != -1; i = pairs[i].next)
+		{
+			// Consider different if single differs
+			if(!pairs[i].vector->isDifferentByAtLeastSingleEntry(bel, HashResolveRes))
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
 	int UniqueBeliefHeap::getBeliefRowIndex(SharedPointer<belief_vector>& bel)const 
 	{
-		string newHash = bel->md5HashValue();
+		unsigned long long newHash = bel->hashValue();
 		GlobalResource::getInstance()->hashRequest ++;
-		map<string, vector<BeliefVector_RowIndexPair> > ::const_iterator iter = uniqueBelHeap.find(newHash);
-		if(iter != uniqueBelHeap.end())
+		const HashSlot& slot = slots[findSlot(newHash)];
+		int found = -1;
+		if(slot.first != -1)
 		{
 			GlobalResource::getInstance()->hashSame ++;
 			// same hash, should go and check each element inside
-			vector<BeliefVector_RowIndexPair> vecBvrip = iter->second;
-			for(int i = 0 ; i < vecBvrip.size(); i++)
+			found = findPair(newHash, *bel);
+			if(found == -1)
 			{
-				BeliefVector_RowIndexPair bvrip = vecBvrip[i];
-
-				// Resolve by total difference, currently disabled
-				/* 
-				double	diff = bvrip.vector->totalDifference(bel);
-				if (diff < 0.0001)
-				{
-					// difference small enough to be considered same vector;
-					//cout << "Not Collision : diff: " << diff << endl;
-					return bvrip.row;
-				}
-				*/
-				
-				// Consider different if single differs
-				if(!bvrip.vector->isDifferentByAtLeastSingleEntry(*bel, HashResolveRes))
-				{
-					return bvrip.row;
-				}
+				//cout << "Collision" << endl;
+				GlobalResource::getInstance()->hashCollision ++;
 			}
-			//cout << "Collision" << endl;
-			GlobalResource::getInstance()->hashCollision ++;
-			return -1;
 		}
-		else
+
+		// a belief within the tolerance may be in the slot of a neighbour
+		// cell, the first added one is returned
+		vector<unsigned long long> neighbours;
+		bel->neighbourHashes(HashResolveRes, neighbours);
+		for(int n = 0; n < neighbours.size(); n++)
 		{
-			return -1;
+			int other = findPair(neighbours[n], *bel);
+			if(other != -1 && (found == -1 || other < found))
+			{
+				found = other;
+			}
 		}
+
+		return found == -1 ? -1 : pairs[found].row;
 	}
 
 	
 	void UniqueBeliefHeap::printHashMap()const 
 	{
-		map<string, vector<BeliefVector_RowIndexPair> > ::const_iterator iter = uniqueBelHeap.begin();
-		for(; iter != uniqueBelHeap.end();iter++)
+		for(int s = 0; s < slots.size(); s++)
 		{
-			cout << "Key: " << iter->first << " Length: " << iter->second.size() << endl;
+			if(slots[s].first == -1)
+			{
+				continue;
+			}
+			int length = 0;
+			for(int i = slots[s].first; i != -1; i = pairs[i].next)
+			{
+				length++;
+			}
+			cout << "Key: " << hex << slots[s].hash << dec << " Length: " << length << endl;
 		}
 
 	}
@@ -10,8 +10,6 @@
 #ifndef UNIQUEBELIEFHEAP3_H
 #define UNIQUEBELIEFHEAP3_H
 
-#include <map>
-#include <string>
 #include <vector>
 #include "MathLib.h"
 #include "MObject.h"
@@ -25,18 +23,36 @@ namespace momdp{
 		{
 			vector = bel;
 			this->row = row;
+			next = -1;
 		}
 
 		SharedPointer<belief_vector> vector;
 		int row;
+		int next; // next pair with the same hash, -1 if none
 	};
 	class UniqueBeliefHeap
 	{
 	private:
-		map<string, vector<BeliefVector_RowIndexPair> > uniqueBelHeap;
+		// Open addressing (linear probing) table from the hash of a belief to
+		// the pairs with that hash, chained by next in the order they were added
+		struct HashSlot
+		{
+			unsigned long long hash;
+			int first; // -1 if the slot is empty
+			int last;
+		};
+		vector<HashSlot> slots; // the size is a power of two
+		int numHashes;
+		vector<BeliefVector_RowIndexPair> pairs;
 
+		int findSlot(unsigned long long hash) const;
+		// first added pair of the slot of hash within the resolve tolerance of bel, -1 if none
+		int findPair(unsigned long long hash, const belief_vector& bel) const;
+		void grow();
 		bool hasBelief(SharedPointer<belief_vector>& bel);
 	public:
+		UniqueBeliefHeap();
+
 		/** 
 		* @brief This for adding a belief and row pair
 		* 
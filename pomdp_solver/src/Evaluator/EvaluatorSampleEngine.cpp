@@ -74,7 +74,7 @@ namespace momdp
 		DEBUG_TRACE( cout << "EvaluatorSampleEngine::getNode stateidx " << stateidx; );
 		DEBUG_TRACE( cout << " s" << endl; );
 		DEBUG_TRACE( s->write(cout) << endl; );
-		DEBUG_TRACE( cout << " hash: " << s->md5HashValue() << endl; );
+		DEBUG_TRACE( cout << " hash: " << s->hashValue() << endl; );
 
 		int row = (*beliefCacheSet)[stateidx]->getBeliefRowIndex(s);
 
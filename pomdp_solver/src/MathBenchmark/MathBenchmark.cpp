@@ -0,0 +1,128 @@
+/**
+ * The code is released under GPL v2
+ */
+
+// Times the sparse matrix kernels on a model: belief updates along random
+// walks, and products of the Y transition matrices with a dense vector as
+// in the upper bound sweeps. Build with "make mathbench".
+
+#include "MOMDP.h"
+#include "ParserSelector.h"
+#include "GlobalResource.h"
+#include "solverUtils.h"
+#include "BeliefTransition.h"
+#include "CPTimer.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+using namespace std;
+using namespace momdp;
+
+// steps of a random walk
+#define WALK_LENGTH 30
+
+void print_usage(const char* cmdName)
+{
+	cout << "Usage: " << cmdName << " POMDPModelFileName numWalks numSweeps\n" << endl;
+	cout << "Example:" << endl;
+	cout << "  " << cmdName << " ../examples/POMDP/TagAvoid.pomdp 3000 20" << endl;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 4)
+	{
+		print_usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	int numWalks = atoi(argv[2]);
+	int numSweeps = atoi(argv[3]);
+
+	SolverParams* p = &GlobalResource::getInstance()->solverParams;
+	p->problemName = argv[1];
+	SharedPointer<MOMDP> problem = ParserSelector::loadProblem(argv[1], *p);
+	int numActions = problem->getNumActions();
+	srand(1);
+
+	// belief updates along random walks from the initial belief
+	CPTimer timer;
+	timer.start();
+	int numUpdates = 0;
+	double check = 0;
+	FOR (walk, numWalks)
+	{
+		SharedPointer<BeliefWithState> b (new BeliefWithState());
+		int x = 0;
+		FOR (xx, problem->XStates->size())
+		{
+			if ((*problem->initialBeliefX)(xx) > 0)
+			{
+				x = xx;
+				break;
+			}
+		}
+		copy(*b->bvec, *problem->getInitialBeliefY(x));
+		b->sval = x;
+
+		FOR (d, WALK_LENGTH)
+		{
+			int a = rand() % numActions;
+			obsState_prob_vector xProbs;
+			problem->getObsStateProbVector(xProbs, *b, a);
+			if (xProbs.data.empty())
+			{
+				break;
+			}
+			int xn = xProbs.data[rand() % xProbs.data.size()].index;
+
+			obs_prob_vector oProbs;
+			problem->getObsProbVector(oProbs, *b, a, xn);
+			if (oProbs.data.empty())
+			{
+				break;
+			}
+			int o = oProbs.data[rand() % oProbs.data.size()].index;
+
+			b = problem->beliefTransition->nextBelief(b, a, o, xn);
+			numUpdates++;
+			check += b->bvec->data.size();
+		}
+	}
+	double updateTime = timer.elapsed();
+
+	// products of the transition matrices with a dense vector
+	timer.restart();
+	DenseVector v(problem->YStates->size()), result;
+	FOR (i, v.size())
+	{
+		v(i) = i % 7;
+	}
+	int numProducts = 0;
+	FOR (sweep, numSweeps)
+	{
+		FOR (a, numActions)
+		{
+			FOR (xc, problem->XStates->size())
+			{
+				FOR (xn, problem->XStates->size())
+				{
+					if (problem->XTrans->getMatrix(a, xc)->isColumnEmpty(xn))
+					{
+						continue;
+					}
+					mult(result, *problem->YTrans->getMatrix(a, xc, xn), v);
+					check += result(0);
+					numProducts++;
+				}
+			}
+		}
+	}
+	double productTime = timer.elapsed();
+
+	printf("belief updates  : %d in %.3fs (%.2f us each)\n", numUpdates, updateTime, numUpdates > 0 ? updateTime / numUpdates * 1e6 : 0.0);
+	printf("matrix products : %d in %.3fs\n", numProducts, productTime);
+	// printed so the work is not optimized away, and to compare builds
+	printf("checksum        : %g\n", check);
+	return 0;
+}
@@ -25,22 +25,10 @@ DenseVector::~DenseVector(void)
 // Arithmetic
 DenseVector* DenseVector::mult( SparseMatrix& A)
 	{
-		vector<SparseVector_Entry>::const_iterator  Ai, col_end;
 		assert( size() == A.size1() );
 		
 		DenseVector* result = new DenseVector( A.size2() );
-
-		FOR (c, A.size2()) 
-		{
-			col_end = A.data.begin() + A.col_starts[c+1];
-			for (Ai = A.data.begin() + A.col_starts[c];
-				Ai != col_end;
-				Ai++) 
-			{
-					(*result)(c) += (*this)(Ai->index) * Ai->value;
-			}
-		}
-
+		momdp::mult(*result, *this, A);
 		return result;
 	}
 
@@ -73,18 +73,13 @@ namespace momdp
 	{
 		assert( 0 <= c && c < A.size2() );
 
-		vector<SparseVector_Entry>::const_iterator  Ai, col_start, col_end;
-
-		vector<SparseVector_Entry>::iterator  ri;
-
-
-		col_start = A.data.begin() + A.col_starts[c];
-		col_end   = A.data.begin() + A.col_starts[c+1];
+		int col_start = A.col_starts[c];
+		int col_end   = A.col_starts[c+1];
 
 		result.resize( A.size1() );
 		result.data.resize( col_end - col_start );
-		for (Ai = col_start, ri=result.data.begin(); Ai != col_end; Ai++, ri++) {
-			(*ri) = (*Ai);
+		for (int k = col_start; k < col_end; k++) {
+			result.data[k - col_start] = SparseVector_Entry(A.indices[k], A.values[k]);
 		}
 	}
 
@@ -93,14 +88,11 @@ namespace momdp
 		unsigned int c)
 	{
 		assert( 0 <= c && c < A.size2() );
-		vector<SparseVector_Entry>::const_iterator  Ai, col_end;
-
 
 		result.resize( A.size1() );
 
-		col_end = A.data.begin() + A.col_starts[c+1];
-		for (Ai = A.data.begin() + A.col_starts[c]; Ai != col_end; Ai++) {
-			result(Ai->index) = Ai->value;
+		for (int k = A.col_starts[c]; k < A.col_starts[c+1]; k++) {
+			result(A.indices[k]) = A.values[k];
 		}
 	}
 
@@ -124,43 +116,40 @@ namespace momdp
 	// result = A * x
 	void mult(DenseVector& result, const SparseMatrix& A, const SparseVector& x)
 	{
-		vector<SparseVector_Entry>::const_iterator  Ai, col_end;
-
-		int xind;
-		double xval;
-
 		result.resize( x.size() );
 
+		const int* index = A.indices.data();
+		const MATRIX_VALUE* value = A.values.data();
+		const int* col_starts = A.col_starts.data();
+		REAL_VALUE* r = result.data.data();
 		FOREACH(SparseVector_Entry, xi,  x.data) {
-			xind = xi->index;
-			xval = xi->value;
-			col_end = A.data.begin() + A.col_starts[xind+1];
-			for (Ai = A.data.begin() + A.col_starts[xind];
-				Ai != col_end;
-				Ai++) {
-					result.data[Ai->index] += xval * Ai->value;
+			double xval = xi->value;
+			for (int k = col_starts[xi->index]; k < col_starts[xi->index+1]; k++) {
+				r[index[k]] += xval * value[k];
 			}
 		}
 	}
 
 	void mult(DenseVector& result, const SparseMatrix& A, const DenseVector& x)
 	{
-		// 		SparseVector tmp;
-		// 		copy(tmp, x);
-		// 		mult(result, A, tmp);
-		vector<SparseVector_Entry>::const_iterator  Ai, col_end;
-
-		double xval;
-
 		result.resize( x.size() );
 
+		const int* index = A.indices.data();
+		const MATRIX_VALUE* value = A.values.data();
+		const int* col_starts = A.col_starts.data();
+		REAL_VALUE* r = result.data.data();
 		FOR(xind, x.data.size())
 		{
-			xval = x.data[xind];
-			col_end = A.data.begin() + A.col_starts[xind+1];
-			for (Ai = A.data.begin() + A.col_starts[xind]; Ai != col_end; Ai++)
+			// the columns of the zero entries add nothing, the vectors of
+			// the belief transitions are mostly zero
+			double xval = x.data[xind];
+			if (xval == 0.0)
+			{
+				continue;
+			}
+			for (int k = col_starts[xind]; k < col_starts[xind+1]; k++)
 			{
-				result.data[Ai->index] += xval * Ai->value;
+				r[index[k]] += xval * value[k];
 			}
 		}
 	}
@@ -176,19 +165,18 @@ namespace momdp
 	// result = x * A
 	void mult(DenseVector& result, const DenseVector& x, const SparseMatrix& A)
 	{
-		vector<SparseVector_Entry>::const_iterator  Ai, col_end;
-
-
 		assert( x.size() == A.size1() );
 		result.resize( A.size2() );
 
+		const int* index = A.indices.data();
+		const MATRIX_VALUE* value = A.values.data();
+		const REAL_VALUE* xv = x.data.data();
 		FOR (c, A.size2()) {
-			col_end = A.data.begin() + A.col_starts[c+1];
-			for (Ai = A.data.begin() + A.col_starts[c];
-				Ai != col_end;
-				Ai++) {
-					result(c) += x(Ai->index) * Ai->value;
+			double sum = 0.0;
+			for (int k = A.col_starts[c]; k < A.col_starts[c+1]; k++) {
+				sum += xv[index[k]] * value[k];
 			}
+			result(c) = sum;
 		}
 	}
 
@@ -270,12 +258,18 @@ namespace momdp
 		assert( 0 <= c && c < A.size2() );
 		result.resize( x.size() );
 
-		emult_cc_internal( result,
-			A.data.begin() + A.col_starts[c],
-			A.data.begin() + A.col_starts[c+1],
-			x.data.begin(), x.data.end() );
-
-		//result.finalize();
+		vector<SparseVector_Entry>::const_iterator xi = x.data.begin();
+		for (int k = A.col_starts[c]; k < A.col_starts[c+1]; k++) {
+			while (xi != x.data.end() && xi->index < A.indices[k]) {
+				xi++;
+			}
+			if (xi == x.data.end()) {
+				return;
+			}
+			if (xi->index == A.indices[k]) {
+				result.push_back( A.indices[k], A.values[k] * xi->value);
+			}
+		}
 	}
 
 	// result = x .* y [for all i, result(i) = x(i) * y(i)]
@@ -302,9 +296,9 @@ namespace momdp
 		assert( A.size1() == x.size() );
 		assert( 0 <= c && c < A.size2() );
 		result.resize( x.size() );
-		emult_dc_internal( result, x,
-			A.data.begin() + A.col_starts[c],
-			A.data.begin() + A.col_starts[c+1] );
+		for (int k = A.col_starts[c]; k < A.col_starts[c+1]; k++) {
+			result(A.indices[k]) = x(A.indices[k]) * A.values[k];
+		}
 	}
 
 	// return x' * y
@@ -433,9 +427,21 @@ namespace momdp
 	{
 		assert( A.size1() == x.size() );
 		assert( 0 <= c && c < A.size2() );
-		return inner_prod_SparseVector_internal( A.data.begin() + A.col_starts[c],
-			A.data.begin() + A.col_starts[c+1],
-			x.data.begin(), x.data.end() );
+
+		double sum = 0.0;
+		vector<SparseVector_Entry>::const_iterator xi = x.data.begin();
+		for (int k = A.col_starts[c]; k < A.col_starts[c+1]; k++) {
+			while (xi != x.data.end() && xi->index < A.indices[k]) {
+				xi++;
+			}
+			if (xi == x.data.end()) {
+				return sum;
+			}
+			if (xi->index == A.indices[k]) {
+				sum += A.values[k] * xi->value;
+			}
+		}
+		return sum;
 	}
 
 	// return true if for all i: x(i) >= y(i) - eps
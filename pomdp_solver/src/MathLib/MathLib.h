@@ -30,14 +30,38 @@ namespace momdp
 		return ((REAL_VALUE)rand())/RAND_MAX;
 	}
 
+	// step of the belief entries in the hash of UniqueBeliefHeap. Beliefs are
+	// merged when no entry differs by more than HashResolveRes (1e-7), the
+	// step is far coarser so near-equal beliefs share a cell unless an entry
+	// is next to a cell boundary (those are probed on both sides), and fine
+	// enough that beliefs with the same support rarely share one.
+	constexpr REAL_VALUE BELIEF_HASH_QUANTUM = 1e-5;
+
+	// cell of a belief entry in the hash
 	inline REAL_VALUE BeliefEntryTruncate(REAL_VALUE input)
 	{
-		input *= 10^BELIEF_DECIMAL_PRECISION;
+		input /= BELIEF_HASH_QUANTUM;
 		input += 0.5;
 		input = floor(input);
 		return input;
 	}
 
+	// the cell across the nearest cell boundary if it is within tolerance of
+	// input, the cell of input otherwise
+	inline REAL_VALUE BeliefEntryNeighbour(REAL_VALUE input, REAL_VALUE tolerance)
+	{
+		REAL_VALUE cell = BeliefEntryTruncate(input);
+		if(BeliefEntryTruncate(input - tolerance) != cell)
+		{
+			return cell - 1;
+		}
+		if(BeliefEntryTruncate(input + tolerance) != cell)
+		{
+			return cell + 1;
+		}
+		return cell;
+	}
+
 	struct kmatrix_entry {
 		unsigned int r, c;
 		double value;
@@ -1,20 +1,16 @@
 #include "SparseMatrix.h"
 
 #include "DenseVector.h"
+#include "MathLib.h"
 using namespace momdp;
 namespace momdp
 {
 	REAL_VALUE SparseMatrix::operator()(int r, int c) const
 	{
-
-		vector<SparseVector_Entry>::const_iterator  di;
-
-		vector<SparseVector_Entry>::const_iterator  col_end = data.begin() + col_starts[c+1];
-
-		for (di = data.begin() + col_starts[c]; di != col_end; di++) {
-			if (di->index >= r) {
-				if (di->index == r) {
-					return di->value;
+		for (int k = col_starts[c]; k < col_starts[c+1]; k++) {
+			if (indices[k] >= r) {
+				if (indices[k] == r) {
+					return values[k];
 				} else {
 					return 0.0;
 				}
@@ -24,47 +20,21 @@ namespace momdp
 	}
 	DenseVector* SparseMatrix::mult(DenseVector& x)
 	{
-		// 		SparseVector tmp;
-		// 		copy(tmp, x);
-		// 		mult(result, A, tmp);
-		vector<SparseVector_Entry>::const_iterator  Ai, col_end;
-
-		double xval;
 		DenseVector *result = new DenseVector( x.size());
-
-		FOR(xind, x.size())
-		{
-			xval = x.data[xind];
-			col_end = data.begin() + col_starts[xind+1];
-			for (Ai = data.begin() + col_starts[xind]; Ai != col_end; Ai++)
-			{
-				(*result)(Ai->index) += xval * Ai->value;
-			}
-		}
-
+		momdp::mult(*result, *this, x);
 		return result;
 	}
 	DenseVector* SparseMatrix::mult(SparseVector& x)
 	{
-		vector<SparseVector_Entry>::const_iterator  Ai, col_end;
-
-		int xind;
-		double xval;
 		DenseVector *result = new DenseVector( x.size());
+		momdp::mult(*result, *this, x);
+		return result;
+	}
 
-		FOREACH(SparseVector_Entry, xi,  x.data) 
-		{
-			xind = xi->index;
-			xval = xi->value;
-			col_end = data.begin() + col_starts[xind+1];
-			for (Ai = data.begin() + col_starts[xind];
-				Ai != col_end;
-				Ai++) 
-			{
-					(*result)(Ai->index) += xval * Ai->value;
-			}
-		}
-
+	SharedPointer<SparseVector> SparseMatrix::emult_column(const SparseMatrix& A, int c, const SparseVector& x)
+	{
+		SharedPointer<SparseVector> result (new SparseVector( x.size() ));
+		momdp::emult_column(*result, A, c, x);
 		return result;
 	}
 
@@ -76,18 +46,16 @@ namespace momdp
 		FOREACH_NOCONST(int, ci,  col_starts) {
 			(*ci) = 0;
 		}
-		data.clear();
+		indices.clear();
+		values.clear();
 	}
 
 	void SparseMatrix::push_back(int r, int c, REAL_VALUE value)
 	{
-		//data.push_back( SparseVector_Entry( r, value ) );
-		int curSize = data.size();
-		data.resize(curSize+ 1);
-		data[curSize].index = r;
-		data[curSize].value =value;
+		indices.push_back(r);
+		values.push_back(value);
 
-		col_starts[c+1] = data.size();
+		col_starts[c+1] = indices.size();
 	}
 
 	void SparseMatrix::canonicalize(void)
@@ -122,15 +90,11 @@ namespace momdp
 
 	std::ostream& SparseMatrix::write(std::ostream& out) const
 	{
-		vector<SparseVector_Entry>::const_iterator  di, col_end;
-
-
 		out << size1_ << " " << size2_ << std::endl;
-		out << data.size() << std::endl;
+		out << indices.size() << std::endl;
 		FOR (c, size2_) {
-			col_end = data.begin() + col_starts[c+1];
-			for (di = data.begin() + col_starts[c]; di != col_end; di++) {
-				out << di->index << " " << c << " " << di->value << std::endl;
+			for (int k = col_starts[c]; k < col_starts[c+1]; k++) {
+				out << indices[k] << " " << c << " " << values[k] << std::endl;
 			}
 		}
 		return out;
@@ -138,15 +102,13 @@ namespace momdp
 
 	REAL_VALUE SparseMatrix::getMaxValue()
 	{
-		REAL_VALUE maxVal = data.begin()->value;
-		REAL_VALUE val;
-		FOREACH(SparseVector_Entry, entry,  data) 
+		REAL_VALUE maxVal = values[0];
+		FOR (k, values.size()) 
 		{
-			val = entry->value;
-			if(val>maxVal){
-				maxVal = val;
+			if(values[k]>maxVal){
+				maxVal = values[k];
 			}
-		}//end FOR_EACH
+		}
 		return maxVal;
 	}
 
@@ -17,12 +17,24 @@ namespace momdp
 
 	class DenseVector;
 
+	// type of the stored values, define SPARSE_MATRIX_FLOAT to halve the
+	// memory of the model matrices; the products are still summed in REAL_VALUE
+#ifdef SPARSE_MATRIX_FLOAT
+	typedef float MATRIX_VALUE;
+#else
+	typedef REAL_VALUE MATRIX_VALUE;
+#endif
+
+	// compressed sparse columns: the rows and values of the entries of column
+	// c are indices[k] and values[k] for col_starts[c] <= k < col_starts[c+1],
+	// in increasing row order
 	class SparseMatrix : public MObject
 	{
 		friend class SparseVector;
 		friend class DenseVector;
 	public:
-		vector< SparseVector_Entry > data;
+		vector< int > indices;
+		vector< MATRIX_VALUE > values;
 		int size1_, size2_;
 		vector< int > col_starts;
 
@@ -47,7 +59,7 @@ namespace momdp
 
 		int size1(void) const { return size1_; }
 		int size2(void) const { return size2_; }
-		int filled(void) const { return data.size(); }
+		int filled(void) const { return indices.size(); }
 
 		void resize(int _size1, int _size2);
 
@@ -67,38 +79,7 @@ namespace momdp
 		DenseVector* mult(DenseVector& x);
 
 
-		template <class T, class U> void emult_cc_internal(SparseVector& result, T xbegin, T xend,  U ybegin, U yend)
-		{
-			U yi = ybegin;
-			for (T xi = xbegin; xi != xend; xi++) {
-				while (1) {
-					if (yi == yend) return;
-					if (yi->index >= xi->index) {
-						if (yi->index == xi->index) {
-							result.push_back( xi->index, xi->value * yi->value);
-						}
-						break;
-					}
-					yi++;
-				}
-			}
-		}
-
-		SharedPointer<SparseVector> emult_column(const SparseMatrix& A, int c, const SparseVector& x)
-		{
-			assert( A.size1() == x.size() );
-			assert( 0 <= c && c < A.size2() );
-
-			SharedPointer<SparseVector> result (new SparseVector( x.size() ));
-
-			emult_cc_internal( *result,
-				A.data.begin() + A.col_starts[c],
-				A.data.begin() + A.col_starts[c+1],
-				x.data.begin(), x.data.end() );
-
-			//result->finalize();
-			return result;
-		}
+		SharedPointer<SparseVector> emult_column(const SparseMatrix& A, int c, const SparseVector& x);
 
 		// IO
 		void read(std::istream& in);
@@ -7,9 +7,9 @@
 #include <iomanip>
 #include <stdexcept>
 #include <limits>
+#include <cstring>
 
 #include "MathLib.h"
-#include "md5.h"
 using namespace std;
 
 using namespace momdp;
@@ -163,7 +163,7 @@ main_loop_done:
     }
 
 
-    SparseVector::SparseVector(void) : logicalSize(0)
+    SparseVector::SparseVector(void) : logicalSize(0), hashed(false)
     {
 
     }
@@ -503,114 +503,91 @@ main_loop_done:
     }
 
 
-    void SparseVector::finalize() 
+    // hash_combine followed by the splitmix64 finalizer, so that beliefs
+    // differing in a single entry get unrelated hashes
+    static inline unsigned long long hashCombine(unsigned long long seed, unsigned long long value)
     {
-	// become immutable
-	// TODO:: Temp Disabled
-
-	md5hash = getHashFromSparseVectorTruncated(*this);
-	//md5hash = getHashFromCVector(*this)	;
+	seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+	seed ^= seed >> 30;
+	seed *= 0xbf58476d1ce4e5b9ULL;
+	seed ^= seed >> 27;
+	seed *= 0x94d049bb133111ebULL;
+	seed ^= seed >> 31;
+	return seed;
     }
 
-    string SparseVector::md5HashValue()
+    // entries in cell 0 are left out, a belief may be merged with one
+    // missing them
+    static inline unsigned long long hashEntry(unsigned long long seed, int index, REAL_VALUE cell)
     {
-	if(md5hash.size() ==0)
+	if(cell == 0)
 	{
-	    throw runtime_error("Bug, belief sparse vector need to call finalize() method to compute hash value");
+	    return seed;
 	}
-
-	// Sanity check
-	//string str1 = getHashFromCVector(*this);
-	//if(str1.compare(md5hash) != 0)
-	//{
-	//	throw runtime_error("Bug, cached md5 is different now, someone changed the sparse vector after finalized method....");
-	//}
-
-	return md5hash;
+	unsigned long long bits;
+	memcpy(&bits, &cell, sizeof(bits));
+	return hashCombine(hashCombine(seed, (unsigned long long)index), bits);
     }
 
-    string SparseVector::convToString(unsigned char *bytes)
+    void SparseVector::finalize() 
     {
-	stringstream out;
-
-	// TODO, use setf 
-	//out.setf ( ios::hex, ios::basefield );       // set hex as the basefield
-	//out.width(2);
+	// become immutable
+	// TODO:: Temp Disabled
 
-	for(int i=0; i<16; i++)
+	// one pass over the truncated entries
+	unsigned long long result = 0;
+	FOR_CV((*this))
 	{
-	    out << setfill('0') << setw(2) << hex << (int) bytes[i];
-	}	
-
-	return out.str();
+	    result = hashEntry(result, CV_INDEX((*this)), BeliefEntryTruncate(CV_VAL((*this))));
+	}
+	hash = result;
+	hashed = true;
     }
 
-    string SparseVector::getHashFromCVector(SparseVector& x)	
+    void SparseVector::neighbourHashes(REAL_VALUE tolerance, std::vector<unsigned long long>& result) const
     {
-	MD5_CTX context;
-
-	unsigned char buffer[1024], digest[16];
-
-	//init md5
-	MD5 md5;
-	md5.MD5Init (&context);
-
-	std::vector<SparseVector_Entry>::const_iterator iter = x.data.begin();
-
-
-	for(; iter != x.data.end();iter++)
+	// entries within tolerance of a cell boundary (the first few only, an
+	// entry is that close with probability 2 * tolerance / quantum)
+	std::vector<int> nearBoundary;
+	for(int i = 0; i < data.size() && nearBoundary.size() < MAX_NEIGHBOUR_ENTRIES; i++)
 	{
-	    int len1 = sizeof (iter->index);
-	    md5.MD5Update (&context, (unsigned char *)&(iter->index), len1);
-
-	    double toTruncate = iter->value;
-	    int len2 = sizeof (toTruncate);
-	    toTruncate *=2^20;
-	    toTruncate = floor(toTruncate);
-	    md5.MD5Update (&context, (unsigned char *)&(toTruncate), len2);
-
-	}
-	/*
-	   generate hash, close the file and return the
-	   hash as std::string
-	   */
-	md5.MD5Final (digest, &context);
-	string result = convToString(digest);
-	return result;
-    }	
-    string SparseVector::getHashFromSparseVectorTruncated(SparseVector& x)	
-    {
-	MD5_CTX context;
-
-	unsigned char digest[16];
-
-	//init md5
-	MD5 md5;
-	md5.MD5Init (&context);
-
-	std::vector<SparseVector_Entry>::const_iterator iter = x.data.begin();
-
+	    if(BeliefEntryNeighbour(data[i].value, tolerance) != BeliefEntryTruncate(data[i].value))
+	    {
+		nearBoundary.push_back(i);
+	    }
+	}
 
-	for(; iter != x.data.end();iter++)
+	// every nonempty subset of them moved to the neighbour cell
+	for(int subset = 1; subset < (1 << nearBoundary.size()); subset++)
 	{
-	    int len1 = sizeof (iter->index);
-	    md5.MD5Update (&context, (unsigned char *)&(iter->index), len1);
-
-	    REAL_VALUE toTruncate = BeliefEntryTruncate(iter->value);
-	    int len2 = sizeof (toTruncate);
-
-	    md5.MD5Update (&context, (unsigned char *)&(toTruncate), len2);
+	    unsigned long long neighbour = 0;
+	    int next = 0;
+	    for(int i = 0; i < data.size(); i++)
+	    {
+		REAL_VALUE cell = BeliefEntryTruncate(data[i].value);
+		if(next < nearBoundary.size() && nearBoundary[next] == i)
+		{
+		    if((subset >> next) & 1)
+		    {
+			cell = BeliefEntryNeighbour(data[i].value, tolerance);
+		    }
+		    next++;
+		}
+		neighbour = hashEntry(neighbour, data[i].index, cell);
+	    }
+	    result.push_back(neighbour);
+	}
+    }
 
+    unsigned long long SparseVector::hashValue() const
+    {
+	if(!hashed)
+	{
+	    throw runtime_error("Bug, belief sparse vector need to call finalize() method to compute hash value");
 	}
-	/*
-	   generate hash, close the file and return the
-	   hash as std::string
-	   */
-	md5.MD5Final (digest, &context);
-	string result = convToString(digest);
-	return result;
 
-    }	
+	return hash;
+    }
 
 }
 
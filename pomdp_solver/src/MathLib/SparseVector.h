@@ -7,8 +7,6 @@
 
 #include "MObject.h"
 #include "Const.h"
-#include "md5wrapper.h"
-#include "md5.h"
 //#include "Belief.h"  // Commented out during merge on 02102009
 
 using namespace std;
@@ -38,7 +36,8 @@ namespace momdp
 		{
 			this->data = x.data;
 			this->logicalSize = x.logicalSize;
-			this->md5hash = x.md5hash;
+			this->hash = x.hash;
+			this->hashed = x.hashed;
 		}
 		vector< SparseVector_Entry > data;
 		void push_back( int index, REAL_VALUE value);
@@ -54,11 +53,12 @@ namespace momdp
 
 
 		// Hashing 
-		string md5hash;
+		unsigned long long hash; // of the truncated entries, computed by finalize()
+		bool hashed;
 
 	public:
 		SparseVector(void);
-		SparseVector(int _size) { resize(_size); }
+		SparseVector(int _size) : hashed(false) { resize(_size); }
 		virtual ~SparseVector(void);
 
 
@@ -144,13 +144,15 @@ namespace momdp
 
 
 
-		string md5HashValue();
+		unsigned long long hashValue() const;
+		// hashes of the vector with entries within tolerance of a cell
+		// boundary rounded to the other side (appended to result, empty if
+		// no entry is that close)
+		void neighbourHashes(REAL_VALUE tolerance, std::vector<unsigned long long>& result) const;
+		// entries probed on both sides by neighbourHashes
+		static const int MAX_NEIGHBOUR_ENTRIES = 4;
 		string ToString() const;
 
-		string convToString(unsigned char *bytes);
-		string getHashFromSparseVectorTruncated(SparseVector& x);
-		string getHashFromCVector(SparseVector& x);
-
 	};
 
 }
@@ -255,7 +255,7 @@ namespace momdp
 		{
 			// if over limit , throw bad_alloc
 			//if(memoryUsage > memoryLimit)
-			if(checkMemoryInterval >= MEMORY_USAGE_CHECK_INTERVAL)
+			if(checkMemoryInterval++ >= MEMORY_USAGE_CHECK_INTERVAL)
 			{
 				checkMemoryInterval = 0;
 				if(getCurrentProcessMemoryUsage() > solverParams.memoryLimit)
@@ -265,10 +265,6 @@ namespace momdp
 					//throw new bad_alloc();
 				}
 			}
-			else
-			{
-				checkMemoryInterval++;
-			}
 
 		}
 	}
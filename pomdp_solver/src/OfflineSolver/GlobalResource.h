@@ -5,6 +5,7 @@
 #define GLOBALRESOURCE_H
 
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -30,7 +31,7 @@ namespace momdp
 		//	CPTimer*	runtimeTimer;
 
 		GlobalResource();
-		int checkMemoryInterval;
+		std::atomic<int> checkMemoryInterval; // MObjects are allocated by the backup and pruning threads too
 
 
 	public:
@@ -86,7 +87,7 @@ namespace momdp
 		double stateGraphR;
 		int nInitMil;
 
-		unsigned long memoryUsage; // in bytes
+		std::atomic<unsigned long> memoryUsage; // in bytes
 
 		//typedef int (*pbSolverHookType)(PointBasedAlgorithm *);
 
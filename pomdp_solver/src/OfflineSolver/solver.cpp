@@ -171,6 +171,46 @@ void usage(const char* cmdName)
 "			by default.  If memory usage exceeds the specified value,\n" 
 "			ofsol writes out a policy and terminates. Set the value to be\n" 
 "			less than physical memory to avoid swapping.\n"
+	"  --parallel-backup	Back up the upper bound of each belief on a second thread\n"
+"			while its lower bound is backed up. The bounds are the same as\n"
+"			the ones of the serial backup. Off by default. Only the two\n"
+"			bounds of one belief node are backed up side by side, so at\n"
+"			most two threads are used. The timeout and the reported\n"
+"			times are wall clock time with this option.\n"
+	"  --init-threads numThreads\n"
+"			Use numThreads threads for the MDP and FIB upper bound\n"
+"			initialization. One thread by default, 0 uses one per core\n"
+"			and one on small models.\n"
+	"  --prune-threads numThreads\n"
+"			Use numThreads threads for the pruning of the lower bound. One\n"
+"			thread by default, 0 uses one per core and one on small\n"
+"			bounds. The planes kept are the same as the ones of the serial\n"
+"			pruning. The timeout and the reported times are wall clock time\n"
+"			unless numThreads is 1.\n"
+	"  --background-prune	Remove the dominated planes of the lower bound on a\n"
+"			separate thread while the search goes on. The bound may keep\n"
+"			dominated planes a little longer. Off by default. The solver\n"
+"			only waits for the pruning thread before it writes the policy.\n"
+	"  --fib-file fileName	Start the FIB upper bound iteration from the vectors saved\n"
+"			in fileName by a previous run on a model of the same size, and\n"
+"			save the converged vectors there. The MDP bound is used when\n"
+"			the file is missing or does not match the model.\n"
+	"  --seed-policy policyFileName\n"
+"			Seed the lower bound with the policy solved for a related\n"
+"			model with the same states, actions and observations, e.g.\n"
+"			another placement of an object. Its planes are evaluated on\n"
+"			this model and lowered to valid bounds. Together with --fib-file\n"
+"			this warm starts a family of similar models.\n"
+	"  --checkpoint fileName	Save the state of the run, i.e. the bounds, the belief tree,\n"
+"			the bins and the sampling state, to fileName every checkpoint\n"
+"			interval and when the run ends. The file is written in the\n"
+"			background.\n"
+	"  --checkpoint-interval timeInterval\n"
+"			Use timeInterval as the time in seconds between two\n"
+"			checkpoints. The default is 600.\n"
+	"  --resume fileName	Continue the run saved in the checkpoint fileName of the same\n"
+"			model. The search goes on from where the saved run stopped.\n"
+"			The timeout counts the time of the saved run.\n"
 	"  --trial-improvement-factor improvementConstant\n"
 "			Use improvementConstant as the trial improvement factor in the\n"
 "			sampling algorithm. At the default of 0.5, a trial terminates at\n" 
@@ -185,6 +225,10 @@ void usage(const char* cmdName)
 "			Use timeInterval as the time interval between two consecutive\n" 
 "			write-out of policy files. If this is not specified, the solver\n" 
 "			only writes out a policy file upon termination.\n"
+	"  --binary-policy double|float\n"
+"			Write the policy files in binary format, with double or float\n"
+"			values, in place of XML. The simulator, the evaluator and the\n"
+"			policy graph read both formats and load binary files faster.\n"
 		"\n"
 		"Examples:\n"
 		"  " << cmdName << " Hallway.pomdp\n"
@@ -225,6 +269,18 @@ void usage(const char* cmdName)
 	exit(-1);
 }
 
+// policy file in XML, or in binary format with --binary-policy
+void writePolicyFile(AlphaPlanePoolSet& alphaPlanePoolSet, const string& outFileName, SolverParams* p)
+{
+	if (p->binaryPolicyValueSize > 0)
+	{
+		alphaPlanePoolSet.writeToBinaryFile(outFileName, p->problemName, p->binaryPolicyValueSize);
+	}
+	else
+	{
+		alphaPlanePoolSet.writeToFile(outFileName, p->problemName);
+	}
+}
 
 int QMDPSolution(SharedPointer<MOMDP> problem, SolverParams* p)
 {
@@ -289,7 +345,7 @@ int QMDPSolution(SharedPointer<MOMDP> problem, SolverParams* p)
 		}
 	}
 	string outFileName (p->outPolicyFileName);
-	alphaPlanePoolSet.writeToFile(outFileName, p->problemName);
+	writePolicyFile(alphaPlanePoolSet, outFileName, p);
 	return 0;	
 }
 
@@ -300,6 +356,8 @@ int FIBSolution(SharedPointer<MOMDP> problem, SolverParams* p)
 	// no need to invoke POMDP solver
 
 	FastInfUBInitializer f(problem);
+	f.numThreads = p->initThreads;
+	f.warmStartFile = p->fibWarmStartFile;
 	DEBUG_LOG(cout << "Calling FastInfUBInitializer::getFIBsolution()" << endl;);		f.getFIBsolution(targetPrecision);
 
 	AlphaPlanePoolSet alphaPlanePoolSet(NULL);
@@ -321,7 +379,7 @@ int FIBSolution(SharedPointer<MOMDP> problem, SolverParams* p)
 		}
 	}
 	string outFileName (p->outPolicyFileName);
-	alphaPlanePoolSet.writeToFile(outFileName, p->problemName); 
+	writePolicyFile(alphaPlanePoolSet, outFileName, p); 
 	return 0;	
 }
 
@@ -332,6 +390,7 @@ int MDPSolution(SharedPointer<MOMDP> problem, SolverParams* p)
     // no need to invoke POMDP solver
     // solve MDP
     FullObsUBInitializer m;
+    m.numThreads = p->initThreads;
     if(problem->XStates->size() != 1 && problem->hasPOMDPMatrices())
     {
 	// un-factored 
@@ -420,7 +479,7 @@ int MDPSolution(SharedPointer<MOMDP> problem, SolverParams* p)
     }
 
     string outFileName (p->outPolicyFileName);
-    alphaPlanePoolSet.writeToFile(outFileName, p->problemName);
+    writePolicyFile(alphaPlanePoolSet, outFileName, p);
     return 0;	
 }
 int main(int argc, char **argv) 
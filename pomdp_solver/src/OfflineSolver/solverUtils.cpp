@@ -54,6 +54,12 @@ namespace momdp{
 		{NULL, -1}
 	};
 
+	static EnumEntry binaryPolicyValuesG[] = {
+		{"double", sizeof(double)},
+		{"float", sizeof(float)},
+		{NULL, -1}
+	};
+
 	int getEnum(const char* key, EnumEntry* table, const char* cmdName, const char *opt)
 	{
 		EnumEntry* i = table;
@@ -103,6 +109,16 @@ namespace momdp{
 		timeoutSeconds = -1;
 		delta = 0.1;
 		randomizationBP = false;
+		parallelBackup = false;
+		initThreads = 1;
+		pruneThreads = 1;
+		backgroundPrune = false;
+		fibWarmStartFile = "";
+		seedPolicyFile = "";
+		checkpointFile = "";
+		checkpointInterval = 600;
+		resumeFile = "";
+		binaryPolicyValueSize = 0;
 		overPruneThreshold = 50.0;
 		lowerPruneThreshold = 5.0;
 		dynamicDeltaPercentageMode = false;
@@ -148,6 +164,16 @@ namespace momdp{
 		{"timeout",			1,NULL,'T'}, // Use ARG as the timeout in seconds.  There is no time limit by default.
 		{"output",			1,NULL,'o'}, //  Use ARG as the name of policy output file. The file name is "out.policy" by default.
 		{"policy-interval",		1, NULL, 'i'}, // Use ARG as the time interval between two consecutive write-out of policy files. If this is not specified, ofsol only writes out a policy file upon termination.
+		{"parallel-backup",		0,NULL,'k'}, // Back up the upper and lower bounds of a belief on two threads. Off by default.
+		{"init-threads",		1,NULL,'e'}, // Use ARG threads for the upper bound initialization. One by default, 0 for one per core.
+		{"prune-threads",		1,NULL,'w'}, // Use ARG threads for the lower bound pruning. One by default, 0 for one per core on large bounds.
+		{"background-prune",		0,NULL,'q'}, // Remove the dominated planes of the lower bound on a separate thread. Off by default.
+		{"fib-file",			1,NULL,'u'}, // Start the FIB iteration from the vectors in file ARG and save the converged vectors there.
+		{"seed-policy",			1,NULL,'y'}, // Add the planes of policy file ARG, solved for a related model, to the lower bound.
+		{"checkpoint",			1,NULL,'K'}, // Periodically save the state of the run to file ARG.
+		{"checkpoint-interval",		1,NULL,'J'}, // Use ARG as the time in seconds between two checkpoints. The default is 600.
+		{"resume",			1,NULL,'r'}, // Continue the run saved in checkpoint file ARG.
+		{"binary-policy",		1,NULL,'Z'}, // Write the policy in binary format with ARG (double or float) values. The policy is written in XML by default.
 		{"trial-improvement-factor",     1,NULL, 'j'}, // Use ARG as the trial improvement factor. The default is 0.5. So, for example, a trial terminates at a node when its upper and lower bound gap is less than 0.5 of the gap at the root.  
 
 		// --------- internal use
@@ -295,6 +321,36 @@ namespace momdp{
 			case 'c': // do randmization in BP
 				p.randomizationBP = true;
 				break;
+			case 'k': // parallel backup
+				p.parallelBackup = true;
+				break;
+			case 'e': // threads of the upper bound initialization
+				p.initThreads = atoi(optarg);
+				break;
+			case 'w': // threads of the lower bound pruning
+				p.pruneThreads = atoi(optarg);
+				break;
+			case 'q': // background pruning
+				p.backgroundPrune = true;
+				break;
+			case 'u': // FIB warm start file
+				p.fibWarmStartFile = string(optarg);
+				break;
+			case 'y': // policy seeding the lower bound
+				p.seedPolicyFile = string(optarg);
+				break;
+			case 'K': // checkpoint file
+				p.checkpointFile = string(optarg);
+				break;
+			case 'J': // time between two checkpoints
+				p.checkpointInterval = atof(optarg);
+				break;
+			case 'r': // checkpoint to resume from
+				p.resumeFile = string(optarg);
+				break;
+			case 'Z': // binary policy file
+				p.binaryPolicyValueSize = getEnum(optarg, binaryPolicyValuesG, p.cmdName, "--binary-policy");
+				break;
 
 			case 'N': // number of trials
 				p.targetTrials = atoi(optarg);
@@ -92,6 +92,16 @@ namespace momdp{
 		bool dumpPolicyTrace; // added by Yanzhu
 		bool dumpPolicyTraceTime;
 		bool randomizationBP;
+		bool parallelBackup; // back up the upper bound of a node on a second thread
+		int initThreads; // threads of the upper bound initialization, 1 by default, 0 for one per core
+		int pruneThreads; // threads of the lower bound pruning, 1 by default, 0 for one per core on large bounds
+		bool backgroundPrune; // prune the lower bound on a separate thread
+		string fibWarmStartFile; // FIB vectors of a previous run, empty for none
+		string seedPolicyFile; // policy of a related model seeding the lower bound, empty for none
+		string checkpointFile; // snapshot of the run written periodically, empty for none
+		double checkpointInterval; // seconds between two snapshots
+		string resumeFile; // snapshot the run continues from, empty for none
+		int binaryPolicyValueSize; // bytes of the values of a binary policy file, 0 for the XML policy
 
 
 		SolverParams(void);
@@ -147,14 +147,12 @@ namespace momdp {
     }//end getRewardMatrix
 
     const double oldPOMDP::getMaxReward() const{
-        double maxVal = R.data.begin()->value;
-        double val;
-        FOREACH(SparseVector_Entry, entry,  R.data) {
-            val = entry->value;
-            if(val>maxVal){
-                maxVal = val;
+        double maxVal = R.values[0];
+        FOR (k, R.values.size()) {
+            if(R.values[k]>maxVal){
+                maxVal = R.values[k];
             }
-        }//end FOR_EACH
+        }
         return maxVal;
     }
 
@@ -61,44 +61,40 @@ void writeSparseVector(ostream& out, SparseVector& sv, int numStates) {
 void writeSparseMatrix(ostream& out, SparseMatrix& sm, SparseMatrix& smtr, int action, char type, int numStates) {
     
     //check sparsity of matrix
-    if(sm.data.size() < (sm.size1_ * sm.size2_)/20)
+    if(sm.filled() < (sm.size1_ * sm.size2_)/20)
     {
-	vector<SparseVector_Entry>::const_iterator  di, col_end;
 	FOR (c, sm.size2_) {
-	    col_end = sm.data.begin() + sm.col_starts[c+1];
-	    for (di = sm.data.begin() + sm.col_starts[c]; di != col_end; di++) {
+	    for (int k = sm.col_starts[c]; k < sm.col_starts[c+1]; k++) {
 
 		out << "\n<Entry>\n<Instance>";
-		out << "a" << action << " " << "s" << di->index << " " << type << c;
-		out << "</Instance>\n<ProbTable>" << di->value << "</ProbTable></Entry>";
+		out << "a" << action << " " << "s" << sm.indices[k] << " " << type << c;
+		out << "</Instance>\n<ProbTable>" << sm.values[k] << "</ProbTable></Entry>";
 	    }
 	}
     }
     else{
 	//use transposed matrix for dumping dense matrix
 	
-	vector<SparseVector_Entry>::const_iterator  di, col_end;
 	out << "\n<Entry>\n<Instance>";
 	out << "a" << action << " - - </Instance>\n<ProbTable>" ;
 
 	FOR (c, smtr.size2_) {
-	    col_end = smtr.data.begin() + smtr.col_starts[c+1];
 	    int index=0;
-	    for (di = smtr.data.begin() + smtr.col_starts[c]; di != col_end; di++) {
+	    for (int k = smtr.col_starts[c]; k < smtr.col_starts[c+1]; k++) {
 
-		if ( index == (signed) di->index )
+		if ( index == smtr.indices[k] )
 		{
 		    //non zero value
-		    out << di->value;
+		    out << smtr.values[k];
 		}
 		else
 		{
 		    //buffer up zero values
-		    for ( ;index < (signed) di->index; index ++ )
+		    for ( ;index < smtr.indices[k]; index ++ )
 		    {
 			out << "0 ";
 		    }
-		    out << di->value;
+		    out << smtr.values[k];
 		}
 
 		if ( index != numStates-1 )
@@ -127,14 +123,12 @@ void writeSparseMatrix(ostream& out, SparseMatrix& sm, SparseMatrix& smtr, int a
 //writeout SparseMatrix to POMDPX reward entries
 void writeSparseMatrixReward(ostream& out, SparseMatrix& sm)
 {
-    vector<SparseVector_Entry>::const_iterator  di, col_end;
     FOR (c, sm.size2_) {
-	col_end = sm.data.begin() + sm.col_starts[c+1];
-	for (di = sm.data.begin() + sm.col_starts[c]; di != col_end; di++) {
+	for (int k = sm.col_starts[c]; k < sm.col_starts[c+1]; k++) {
 
 	    out << "\n<Entry>\n<Instance>";
-	    out << "a" << c << " s" << di->index;
-	    out << "</Instance>\n<ValueTable>" << di->value << "</ValueTable></Entry>";
+	    out << "a" << c << " s" << sm.indices[k];
+	    out << "</Instance>\n<ValueTable>" << sm.values[k] << "</ValueTable></Entry>";
 	}
     }
 }
@@ -91,6 +91,11 @@ public:
 		return  double(std::clock() - _start_time) / CLOCKS_PER_SEC; 
 	}
 
+	// std::clock is already wall clock time with visual studio
+	void setWallClock(bool useWallClock)
+	{
+	}
+
 	
 private:
 	std::clock_t _start_time;
@@ -102,22 +107,23 @@ private:
 	public:
 		CPTimer()
 		{ 
-			times(&_start_time);
+			_start_real = times(&_start_time);
 			_elapsed = 0.0;
 			paused = false;
+			wallClock = false;
 		}
 	// postcondition: elapsed()==0
 	
 		void   start()
 		{ 
-			times(&_start_time);
+			_start_real = times(&_start_time);
 			_elapsed = 0.0;
 			paused = false;
 		} // post: elapsed()==0
 	
 		void   restart()
 		{
-			times(&_start_time);
+			_start_real = times(&_start_time);
 			_elapsed = 0.0;
 			paused = false;
 		} // post: elapsed()==0
@@ -126,7 +132,7 @@ private:
 		{
 			if(paused)
 			{
-				times(&_start_time);
+				_start_real = times(&_start_time);
 				paused = false;
 			}
 			
@@ -154,16 +160,38 @@ private:
 		double lastLap() const                  // return elapsed time in seconds
 		{
 			struct tms now;
-			times(&now);
+			clock_t nowReal = times(&now);
 			long int clk_tck = sysconf(_SC_CLK_TCK);
+			if(wallClock)
+			{
+				return ((double)(nowReal-_start_real))/clk_tck;
+			}
 			double utime = ((double)(now.tms_utime-_start_time.tms_utime))/clk_tck;
 			double stime = ((double)(now.tms_stime-_start_time.tms_stime))/clk_tck;
 			return  utime+stime;
 		}
+
+		// processor time counts every thread of the process, a solver that
+		// runs threads side by side times itself with the wall clock instead
+		void setWallClock(bool useWallClock)
+		{
+			if(!paused)
+			{
+				_elapsed += lastLap();
+				wallClock = useWallClock;
+				_start_real = times(&_start_time);
+			}
+			else
+			{
+				wallClock = useWallClock;
+			}
+		}
 	
 	private:
 		struct tms _start_time;
+		clock_t _start_real;
 		double _elapsed;
+		bool	wallClock;
 		bool	paused;
 #endif
 }; // timer
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+
+#include <UDP_Prot.h>
+#include <UDP_Receiver.h>
+
+/// loopback latency benchmark of the solver - simulator link.
+/// a stand-in simulator process answers each action with a state of the given size (framed when larger than a datagram)
+/// and the solver side measures the time from sending the action until the state is popped from the receiver queue.
+///
+/// usage:
+///		LoopbackBench.exe <num msgs> <state bytes> [port]	run benchmark (stand-in simulator is started as a child process)
+///		LoopbackBench.exe sim <port> <state bytes>			run stand-in simulator only
+///		LoopbackBench.exe solver <port> <num msgs>			run solver side only
+/// the results are written to stdout as json
+
+static const int s_DEFAULT_PORT = 5777;
+static const char s_END_ACTION = 127;
+/// time to wait for a state before counting it as lost
+static const int s_STATE_TIMEOUT_MS = 1000;
+
+using Clock = std::chrono::high_resolution_clock;
+
+int RunSimulator(int port, int stateBytes)
+{
+	UDP_Client sock;
+	if (!sock.Init(port))
+	{
+		std::cerr << "error in udp init\n";
+		exit(1);
+	}
+	sock.TimeOut(s_STATE_TIMEOUT_MS * 5);
+
+	std::vector<char> state(stateBytes);
+	for (int i = 0; i < stateBytes; ++i)
+		state[i] = static_cast<char>(i);
+
+	unsigned int seq = 0;
+	auto sendState = [&]
+	{
+		std::vector<std::vector<char>> datagrams;
+		UDP_Receiver::Frame(&state[0], state.size(), seq++, datagrams);
+		for (auto & datagram : datagrams)
+			sock.Write(&datagram[0], datagram.size());
+	};
+
+	// first state is letting the solver know the simulator address
+	sendState();
+
+	char buffer[UDP_Server::s_BUF_LEN];
+	while (true)
+	{
+		int size = sock.Read(buffer);
+		if (size <= 0 || buffer[0] == s_END_ACTION)
+			break;
+
+		sendState();
+	}
+
+	return 0;
+}
+
+int RunSolver(int port, int numMsgs, int stateBytes)
+{
+	UDP_Receiver sock;
+	if (!sock.Init(port))
+	{
+		std::cerr << "error in udp init\n";
+		exit(1);
+	}
+
+	std::vector<char> msg;
+	if (!sock.Read(msg, s_STATE_TIMEOUT_MS * 5))
+	{
+		std::cerr << "simulator is not responding\n";
+		exit(1);
+	}
+	stateBytes = msg.size();
+
+	std::vector<double> latency;
+	int numLost = 0;
+	auto start = Clock::now();
+	for (int i = 0; i < numMsgs; ++i)
+	{
+		char action = i % s_END_ACTION;
+		auto sent = Clock::now();
+		sock.Write(&action, sizeof(char));
+
+		if (!sock.Read(msg, s_STATE_TIMEOUT_MS) || msg.size() != stateBytes)
+		{
+			++numLost;
+			continue;
+		}
+
+		latency.emplace_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+	}
+	double duration = std::chrono::duration<double>(Clock::now() - start).count();
+
+	char end = s_END_ACTION;
+	sock.Write(&end, sizeof(char));
+
+	std::sort(latency.begin(), latency.end());
+	auto percentile = [&latency](double p) { return latency.size() == 0 ? 0.0 : latency[static_cast<int>(p * (latency.size() - 1))]; };
+	double mean = latency.size() == 0 ? 0.0 : std::accumulate(latency.begin(), latency.end(), 0.0) / latency.size();
+
+	std::cout << "{\n"
+		<< "\t\"msgs\": " << numMsgs << ",\n"
+		<< "\t\"stateBytes\": " << stateBytes << ",\n"
+		<< "\t\"lost\": " << numLost << ",\n"
+		<< "\t\"dropped\": " << sock.NumDropped() << ",\n"
+		<< "\t\"msgsPerSec\": " << (duration > 0 ? latency.size() / duration : 0.0) << ",\n"
+		<< "\t\"latencyUs\": { \"mean\": " << mean << ", \"p50\": " << percentile(0.5) << ", \"p90\": " << percentile(0.9)
+		<< ", \"p99\": " << percentile(0.99) << ", \"max\": " << percentile(1.0) << " }\n"
+		<< "}\n";
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		std::cerr << "usage: " << argv[0] << " <num msgs> <state bytes> [port]\n"
+			<< "       " << argv[0] << " sim <port> <state bytes>\n"
+			<< "       " << argv[0] << " solver <port> <num msgs>\n";
+		exit(1);
+	}
+
+	std::string mode = argv[1];
+	if (mode == "sim" && argc > 3)
+		return RunSimulator(std::stoi(argv[2]), std::stoi(argv[3]));
+	if (mode == "solver" && argc > 3)
+		return RunSolver(std::stoi(argv[2]), std::stoi(argv[3]), -1);
+
+	int numMsgs = std::stoi(argv[1]);
+	int stateBytes = std::stoi(argv[2]);
+	int port = argc > 3 ? std::stoi(argv[3]) : s_DEFAULT_PORT;
+
+	// start stand-in simulator process after the solver socket is bound
+	std::string simCmd = std::string("\"") + argv[0] + "\" sim " + std::to_string(port) + " " + std::to_string(stateBytes);
+	std::thread simulator([simCmd]
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		std::system(simCmd.c_str());
+	});
+
+	int ret = RunSolver(port, numMsgs, stateBytes);
+	simulator.join();
+	return ret;
+}
@@ -0,0 +1,81 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <utility>
+
+/// lock free queue for a single producer thread and a single consumer thread.
+/// capacity is rounded up to a power of 2, Push fails when the queue is full
+template <typename T>
+class SPSCQueue
+{
+public:
+	explicit SPSCQueue(size_t capacity);
+
+	SPSCQueue(const SPSCQueue &) = delete;
+	SPSCQueue & operator=(const SPSCQueue &) = delete;
+
+	/// called by producer only
+	bool Push(T && item);
+	/// called by consumer only
+	bool Pop(T & item);
+
+	bool Empty() const { return m_head.load(std::memory_order_seq_cst) == m_tail.load(std::memory_order_seq_cst); }
+
+private:
+	static const int s_CACHE_LINE = 64;
+
+	std::vector<T> m_buffer;
+	size_t m_mask;
+
+	// head and tail are on different cache lines so producer and consumer are not sharing a line
+	char m_pad0[s_CACHE_LINE];
+	/// next slot to pop (written by consumer)
+	std::atomic<size_t> m_head;
+	char m_pad1[s_CACHE_LINE];
+	/// next slot to push (written by producer)
+	std::atomic<size_t> m_tail;
+	char m_pad2[s_CACHE_LINE];
+};
+
+template <typename T>
+SPSCQueue<T>::SPSCQueue(size_t capacity)
+: m_buffer()
+, m_mask(0)
+, m_head(0)
+, m_tail(0)
+{
+	size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+
+	m_buffer.resize(size);
+	m_mask = size - 1;
+}
+
+template <typename T>
+bool SPSCQueue<T>::Push(T && item)
+{
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+		return false;
+
+	m_buffer[tail & m_mask] = std::move(item);
+	m_tail.store(tail + 1, std::memory_order_seq_cst);
+	return true;
+}
+
+template <typename T>
+bool SPSCQueue<T>::Pop(T & item)
+{
+	size_t head = m_head.load(std::memory_order_relaxed);
+	if (head == m_tail.load(std::memory_order_acquire))
+		return false;
+
+	item = std::move(m_buffer[head & m_mask]);
+	m_head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+#endif // SPSC_QUEUE_H
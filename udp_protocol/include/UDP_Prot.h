@@ -1,11 +1,26 @@
 #ifndef UDP_PROT_HPP
 #define UDP_PROT_HPP
 
-#ifndef WIN32_LEAN_AND_MEAN
-	#define WIN32_LEAN_AND_MEAN
+#ifdef _WIN32
+
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+
+	#include <winsock2.h> // socket
+
+#else
+
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+
+	typedef int SOCKET;
+	#define INVALID_SOCKET (-1)
+	#define SOCKET_ERROR (-1)
+
 #endif
 
-#include <winsock2.h> // socket
+#include <mutex>
 
 
 class UDP_Server
@@ -21,11 +36,24 @@ public:
 	bool Write(char * buffer, int size);
 	int TimeOut(int ms);
 
+	/*NON BLOCKING FUNCTIONS (used by receive thread of UDP_Receiver)*/
+
+	/// set socket to non blocking mode (Read return -1 when no datagram arrived)
+	bool NonBlocking();
+	/// wait up to ms for datagram to arrive. return true if there is datagram to read
+	bool WaitRead(int ms);
+	/// read all arrived datagrams (up to maxDatagrams) to buffers of size s_BUF_LEN. return number of datagrams read
+	int ReadBatch(char * buffers, int * sizes, int maxDatagrams);
+	/// write several datagrams in one call when available
+	bool WriteBatch(char ** buffers, const int * sizes, int numDatagrams);
+
 	static const int s_BUF_LEN = 2048;
 
 private:
 	SOCKET m_socket;
 	struct sockaddr_in m_siOther;
+	/// guard m_siOther when reading and writing from different threads
+	std::mutex m_siOtherMutex;
 };
 
 
@@ -48,4 +76,4 @@ private:
 	struct sockaddr_in m_server;
 };
 
-# endif // TCP_PROT_HPP
\ No newline at end of file
+# endif // TCP_PROT_HPP
@@ -0,0 +1,80 @@
+#ifndef UDP_RECEIVER_H
+#define UDP_RECEIVER_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "UDP_Prot.h"
+#include "SPSCQueue.h"
+
+/// non blocking udp server. a receive thread reads the arrived datagrams in batches, reassembles framed msgs
+/// and passes complete msgs to the reading thread through a lock free queue (reading never blocks the socket).
+///
+/// msgs larger than a datagram are split to frames : FRAME_MAGIC, msg seq, chunk idx, num chunks, payload chunk.
+/// smaller msgs are sent as is so the link stays compatible with peers that are not framing.
+class UDP_Receiver
+{
+public:
+	UDP_Receiver();
+	~UDP_Receiver();
+
+	UDP_Receiver(const UDP_Receiver &) = delete;
+	UDP_Receiver & operator=(const UDP_Receiver &) = delete;
+
+	bool IsInit() { return m_sock.IsInit(); };
+	/// bind port and start receive thread
+	bool Init(int portNum);
+
+	/// wait up to timeoutMs for a msg (0 for not waiting, -1 for no time limit). return true if msg is waiting
+	bool Wait(int timeoutMs);
+	/// pop next msg. return false if no msg arrived during timeoutMs
+	bool Read(std::vector<char> & msg, int timeoutMs = -1);
+	/// write msg to last peer (msgs larger than a datagram are framed)
+	bool Write(const char * buffer, int size);
+
+	/// number of msgs dropped because reader did not pop msgs
+	int NumDropped() const { return m_numDropped; };
+
+	/// split msg to datagrams (single unframed datagram when msg is fitting in datagram)
+	static void Frame(const char * buffer, int size, unsigned int seq, std::vector<std::vector<char>> & datagrams);
+
+	static const unsigned int s_FRAME_MAGIC = 0x314D5246; // "FRM1"
+	static const int s_FRAME_HEADER_LEN = 4 * sizeof(unsigned int);
+	static const int s_QUEUE_CAPACITY = 256;
+	/// max datagrams read in one batch
+	static const int s_BATCH_SIZE = 32;
+	/// time between checks of stop flag in receive thread
+	static const int s_POLL_MS = 50;
+
+private:
+	void ReceiverMainFunction();
+	/// insert datagram to msg under reassembly and push msg when complete
+	void InsertDatagram(const char * buffer, int size);
+	void PushMsg(std::vector<char> && msg);
+
+	UDP_Server m_sock;
+	SPSCQueue<std::vector<char>> m_msgs;
+
+	// reassembly (accessed only by receive thread)
+	std::vector<char> m_partial;
+	unsigned int m_partialSeq;
+	unsigned int m_nextChunk;
+	bool m_isPartialValid;
+
+	/// seq of next framed msg written
+	unsigned int m_writeSeq;
+	std::atomic<int> m_numDropped;
+
+	// for waking reader
+	std::mutex m_waitMutex;
+	std::condition_variable m_cond;
+	std::atomic<bool> m_isWaiting;
+
+	std::atomic<bool> m_stop;
+	std::thread m_thread;
+};
+
+#endif // UDP_RECEIVER_H
@@ -1,11 +1,30 @@
 #include "UDP_Prot.h"
 
-#include <Ws2tcpip.h>
 #include <iostream>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+
+#include <Ws2tcpip.h>
+
+using socklen_t = int;
+
+#else
+
+#include <arpa/inet.h>
+#include <sys/select.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 
+#define closesocket close
+
+#endif
 
 static bool InitWinSock()
 {
+#ifdef _WIN32
 	WSADATA wsaData;
 
 	memset(&wsaData, 0, sizeof(wsaData));
@@ -14,11 +33,28 @@ static bool InitWinSock()
 	int ret = WSAStartup(MAKEWORD(2, 2), &wsaData);
 
 	return 0 == ret;
+#else
+	return true;
+#endif
+}
+
+static int SetTimeOut(SOCKET sock, int ms)
+{
+#ifdef _WIN32
+	DWORD time = ms;
+	return setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char *)&time, sizeof (DWORD));
+#else
+	struct timeval time;
+	time.tv_sec = ms / 1000;
+	time.tv_usec = (ms % 1000) * 1000;
+	return setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (char *)&time, sizeof (time));
+#endif
 }
 
 UDP_Server::UDP_Server()
 : m_socket(INVALID_SOCKET)
 , m_siOther()
+, m_siOtherMutex()
 {
 }
 
@@ -61,22 +97,144 @@ bool UDP_Server::Init(int portNum)
 
 int UDP_Server::Read(char * buffer)
 {
-	static int slen = sizeof(m_siOther);
+	struct sockaddr_in other;
+	socklen_t slen = sizeof(other);
 
-	return recvfrom(m_socket, buffer, s_BUF_LEN, 0, (struct sockaddr *) &m_siOther, &slen);
+	int size = recvfrom(m_socket, buffer, s_BUF_LEN, 0, (struct sockaddr *) &other, &slen);
+	if (size >= 0)
+	{
+		std::lock_guard<std::mutex> lock(m_siOtherMutex);
+		m_siOther = other;
+	}
+	return size;
 }
 
 bool UDP_Server::Write(char * buffer, int size)
 {
-	int stat = sendto(m_socket, buffer, size, 0, (struct sockaddr *) &m_siOther, sizeof(m_siOther));
+	struct sockaddr_in other;
+	{
+		std::lock_guard<std::mutex> lock(m_siOtherMutex);
+		other = m_siOther;
+	}
+	int stat = sendto(m_socket, buffer, size, 0, (struct sockaddr *) &other, sizeof(other));
 
 	return stat != SOCKET_ERROR;
 }
 
 int UDP_Server::TimeOut(int ms)
 {
-	DWORD time = ms;
-	return setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, (char *)&time, sizeof (DWORD));
+	return SetTimeOut(m_socket, ms);
+}
+
+bool UDP_Server::NonBlocking()
+{
+#ifdef _WIN32
+	u_long mode = 1;
+	return ioctlsocket(m_socket, FIONBIO, &mode) == 0;
+#else
+	int flags = fcntl(m_socket, F_GETFL, 0);
+	return flags != -1 && fcntl(m_socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+bool UDP_Server::WaitRead(int ms)
+{
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET(m_socket, &readSet);
+
+	struct timeval time;
+	time.tv_sec = ms / 1000;
+	time.tv_usec = (ms % 1000) * 1000;
+
+	return select(static_cast<int>(m_socket) + 1, &readSet, nullptr, nullptr, &time) > 0;
+}
+
+int UDP_Server::ReadBatch(char * buffers, int * sizes, int maxDatagrams)
+{
+	struct sockaddr_in other;
+	int numRead = 0;
+
+#ifdef __linux__
+	// read all datagrams in one system call
+	std::vector<struct mmsghdr> msgs(maxDatagrams);
+	std::vector<struct iovec> iovecs(maxDatagrams);
+	memset(&msgs[0], 0, maxDatagrams * sizeof(struct mmsghdr));
+	for (int i = 0; i < maxDatagrams; ++i)
+	{
+		iovecs[i].iov_base = buffers + i * s_BUF_LEN;
+		iovecs[i].iov_len = s_BUF_LEN;
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+	msgs[0].msg_hdr.msg_name = &other;
+	msgs[0].msg_hdr.msg_namelen = sizeof(other);
+
+	numRead = recvmmsg(m_socket, &msgs[0], maxDatagrams, MSG_DONTWAIT, nullptr);
+	if (numRead <= 0)
+		return 0;
+
+	for (int i = 0; i < numRead; ++i)
+		sizes[i] = msgs[i].msg_len;
+#else
+	// read datagrams until socket is empty (socket should be non blocking)
+	for (; numRead < maxDatagrams; ++numRead)
+	{
+		socklen_t slen = sizeof(other);
+		int size = recvfrom(m_socket, buffers + numRead * s_BUF_LEN, s_BUF_LEN, 0, (struct sockaddr *) &other, &slen);
+		if (size < 0)
+			break;
+		sizes[numRead] = size;
+	}
+
+	if (numRead == 0)
+		return 0;
+#endif
+
+	std::lock_guard<std::mutex> lock(m_siOtherMutex);
+	m_siOther = other;
+	return numRead;
+}
+
+bool UDP_Server::WriteBatch(char ** buffers, const int * sizes, int numDatagrams)
+{
+	struct sockaddr_in other;
+	{
+		std::lock_guard<std::mutex> lock(m_siOtherMutex);
+		other = m_siOther;
+	}
+
+#ifdef __linux__
+	std::vector<struct mmsghdr> msgs(numDatagrams);
+	std::vector<struct iovec> iovecs(numDatagrams);
+	memset(&msgs[0], 0, numDatagrams * sizeof(struct mmsghdr));
+	for (int i = 0; i < numDatagrams; ++i)
+	{
+		iovecs[i].iov_base = buffers[i];
+		iovecs[i].iov_len = sizes[i];
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &other;
+		msgs[i].msg_hdr.msg_namelen = sizeof(other);
+	}
+
+	int sent = 0;
+	while (sent < numDatagrams)
+	{
+		int stat = sendmmsg(m_socket, &msgs[sent], numDatagrams - sent, 0);
+		if (stat <= 0)
+			return false;
+		sent += stat;
+	}
+	return true;
+#else
+	for (int i = 0; i < numDatagrams; ++i)
+	{
+		if (sendto(m_socket, buffers[i], sizes[i], 0, (struct sockaddr *) &other, sizeof(other)) == SOCKET_ERROR)
+			return false;
+	}
+	return true;
+#endif
 }
 
 UDP_Client::UDP_Client()
@@ -104,17 +262,14 @@ bool UDP_Client::Init(int portNum, char *host)
 	memset(&m_server, 0, sizeof(m_server));
 	m_server.sin_family = AF_INET;
 	m_server.sin_port = htons(portNum);
-	ULONG *srcAddr = new ULONG;
-	InetPton(AF_INET, host, srcAddr);
-	m_server.sin_addr.S_un.S_addr = *srcAddr;
+	inet_pton(AF_INET, host, &m_server.sin_addr);
 
-	delete srcAddr;
 	return true;
 }
 
 int UDP_Client::Read(char * buffer)
 {
-	static int slen = sizeof(struct sockaddr_in);
+	socklen_t slen = sizeof(struct sockaddr_in);
 	return recvfrom(m_socket, buffer, UDP_Server::s_BUF_LEN, 0, (struct sockaddr *) &m_server, &slen);
 }
 
@@ -129,6 +284,5 @@ bool UDP_Client::Write(char * buffer, int size)
 
 int UDP_Client::TimeOut(int ms)
 {
-	DWORD time = ms;
-	return setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, (char *)&time, sizeof (DWORD));
+	return SetTimeOut(m_socket, ms);
 }
@@ -0,0 +1,174 @@
+#include "UDP_Receiver.h"
+
+#include <cstring>
+#include <chrono>
+
+UDP_Receiver::UDP_Receiver()
+: m_sock()
+, m_msgs(s_QUEUE_CAPACITY)
+, m_partial()
+, m_partialSeq(0)
+, m_nextChunk(0)
+, m_isPartialValid(false)
+, m_writeSeq(0)
+, m_numDropped(0)
+, m_waitMutex()
+, m_cond()
+, m_isWaiting(false)
+, m_stop(false)
+, m_thread()
+{
+}
+
+UDP_Receiver::~UDP_Receiver()
+{
+	m_stop = true;
+	m_cond.notify_all();
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+bool UDP_Receiver::Init(int portNum)
+{
+	if (!m_sock.Init(portNum) || !m_sock.NonBlocking())
+		return false;
+
+	m_thread = std::thread([this] { this->ReceiverMainFunction(); });
+	return true;
+}
+
+bool UDP_Receiver::Wait(int timeoutMs)
+{
+	if (!m_msgs.Empty() || timeoutMs == 0)
+		return !m_msgs.Empty();
+
+	std::unique_lock<std::mutex> lock(m_waitMutex);
+	m_isWaiting = true;
+	auto isArrived = [this] { return !m_msgs.Empty() || m_stop; };
+	if (timeoutMs < 0)
+		m_cond.wait(lock, isArrived);
+	else
+		m_cond.wait_for(lock, std::chrono::milliseconds(timeoutMs), isArrived);
+	m_isWaiting = false;
+
+	return !m_msgs.Empty();
+}
+
+bool UDP_Receiver::Read(std::vector<char> & msg, int timeoutMs)
+{
+	return Wait(timeoutMs) && m_msgs.Pop(msg);
+}
+
+bool UDP_Receiver::Write(const char * buffer, int size)
+{
+	std::vector<std::vector<char>> datagrams;
+	Frame(buffer, size, m_writeSeq, datagrams);
+	if (datagrams.size() > 1)
+		++m_writeSeq;
+
+	std::vector<char *> buffers;
+	std::vector<int> sizes;
+	for (auto & datagram : datagrams)
+	{
+		buffers.emplace_back(&datagram[0]);
+		sizes.emplace_back(datagram.size());
+	}
+
+	return m_sock.WriteBatch(&buffers[0], &sizes[0], datagrams.size());
+}
+
+void UDP_Receiver::Frame(const char * buffer, int size, unsigned int seq, std::vector<std::vector<char>> & datagrams)
+{
+	// msg starting with magic is framed even if it is small so it will not be mistaken for a frame
+	bool isStartWithMagic = size >= sizeof(unsigned int) && *reinterpret_cast<const unsigned int *>(buffer) == s_FRAME_MAGIC;
+	if (size <= UDP_Server::s_BUF_LEN && !isStartWithMagic)
+	{
+		datagrams.emplace_back(buffer, buffer + size);
+		return;
+	}
+
+	int maxChunk = UDP_Server::s_BUF_LEN - s_FRAME_HEADER_LEN;
+	unsigned int numChunks = (size + maxChunk - 1) / maxChunk;
+	for (unsigned int chunk = 0; chunk < numChunks; ++chunk)
+	{
+		unsigned int header[] = { s_FRAME_MAGIC, seq, chunk, numChunks };
+		const char * start = buffer + chunk * maxChunk;
+		const char * end = chunk + 1 == numChunks ? buffer + size : start + maxChunk;
+
+		datagrams.emplace_back(reinterpret_cast<char *>(header), reinterpret_cast<char *>(header) + s_FRAME_HEADER_LEN);
+		datagrams.back().insert(datagrams.back().end(), start, end);
+	}
+}
+
+void UDP_Receiver::ReceiverMainFunction()
+{
+	std::vector<char> buffers(s_BATCH_SIZE * UDP_Server::s_BUF_LEN);
+	std::vector<int> sizes(s_BATCH_SIZE);
+
+	while (!m_stop)
+	{
+		if (!m_sock.WaitRead(s_POLL_MS))
+			continue;
+
+		int numRead = m_sock.ReadBatch(&buffers[0], &sizes[0], s_BATCH_SIZE);
+		for (int i = 0; i < numRead; ++i)
+			InsertDatagram(&buffers[i * UDP_Server::s_BUF_LEN], sizes[i]);
+	}
+}
+
+void UDP_Receiver::InsertDatagram(const char * buffer, int size)
+{
+	const unsigned int * header = reinterpret_cast<const unsigned int *>(buffer);
+	bool isFramed = size >= s_FRAME_HEADER_LEN && header[0] == s_FRAME_MAGIC;
+	if (!isFramed)
+	{
+		PushMsg(std::vector<char>(buffer, buffer + size));
+		return;
+	}
+
+	unsigned int seq = header[1];
+	unsigned int chunk = header[2];
+	unsigned int numChunks = header[3];
+
+	if (chunk == 0)
+	{
+		m_partial.clear();
+		m_partialSeq = seq;
+		m_nextChunk = 0;
+		m_isPartialValid = true;
+	}
+
+	// a chunk is lost (msg is dropped)
+	if (!m_isPartialValid || seq != m_partialSeq || chunk != m_nextChunk)
+	{
+		m_isPartialValid = false;
+		return;
+	}
+
+	m_partial.insert(m_partial.end(), buffer + s_FRAME_HEADER_LEN, buffer + size);
+	++m_nextChunk;
+
+	if (m_nextChunk == numChunks)
+	{
+		m_isPartialValid = false;
+		PushMsg(std::move(m_partial));
+		m_partial = std::vector<char>();
+	}
+}
+
+void UDP_Receiver::PushMsg(std::vector<char> && msg)
+{
+	if (!m_msgs.Push(std::move(msg)))
+	{
+		++m_numDropped;
+		return;
+	}
+
+	// lock to make sure reader is either waiting or will see the msg before waiting
+	if (m_isWaiting)
+	{
+		std::lock_guard<std::mutex> lock(m_waitMutex);
+	}
+	m_cond.notify_one();
+}